@@ -53,6 +53,7 @@ HEADERS += remoteutil.h
 HEADERS += rawsettingseditor.h
 HEADERS += programinfo.h          programinfoupdater.h
 HEADERS += programtypes.h         recordingtypes.h
+HEADERS += programinfobinary.h
 HEADERS += rssparse.h
 
 SOURCES += audio/audiooutput.cpp audio/audiooutputbase.cpp
@@ -77,6 +78,7 @@ SOURCES += remoteutil.cpp
 SOURCES += rawsettingseditor.cpp
 SOURCES += programinfo.cpp        programinfoupdater.cpp
 SOURCES += programtypes.cpp       recordingtypes.cpp
+SOURCES += programinfobinary.cpp
 SOURCES += rssparse.cpp
 
 # This stuff is not Qt5 compatible..
@@ -135,7 +137,7 @@ inc.files += visual.h output.h langsettings.h
 inc.files += mythexp.h storagegroupeditor.h
 inc.files += mythconfigdialogs.h mythconfiggroups.h
 inc.files += mythterminal.h       remoteutil.h
-inc.files += programinfo.h
+inc.files += programinfo.h       programinfobinary.h
 inc.files += programtypes.h       recordingtypes.h
 inc.files += rssparse.h
 
@@ -1540,6 +1540,156 @@ bool ProgramInfo::FromStringList(QStringList::const_iterator &it,
     return true;
 }
 
+/** \brief Serializes ProgramInfo with a ProgramInfoWriter, the compact
+ *         alternative to ToStringList() for long lists.
+ *
+ *   Holds the same fields as ToStringList(), in the same order, minus
+ *   the old cardid.
+ *  \sa FromBinary(ProgramInfoReader&)
+ */
+void ProgramInfo::ToBinary(ProgramInfoWriter &out) const
+{
+    out.PutString(title);
+    out.PutString(subtitle);
+    out.PutString(description);
+    out.PutUInt32(season);
+    out.PutUInt32(episode);
+    out.PutUInt32(totalepisodes);
+    out.PutString(syndicatedepisode);
+    out.PutString(category);
+    out.PutUInt32(chanid);
+    out.PutString(chanstr);
+    out.PutString(chansign);
+    out.PutString(channame);
+    out.PutString(pathname);
+    out.PutUInt64(filesize);
+
+    out.PutDateTime(startts);
+    out.PutDateTime(endts);
+    out.PutUInt32(findid);
+    out.PutString(hostname);
+    out.PutUInt32(sourceid);
+    out.PutUInt32(inputid);
+    out.PutInt32(recpriority);
+    out.PutUInt8(recstatus);
+    out.PutUInt32(recordid);
+
+    out.PutUInt8(rectype);
+    out.PutUInt8(dupin);
+    out.PutUInt8(dupmethod);
+    out.PutDateTime(recstartts);
+    out.PutDateTime(recendts);
+    out.PutUInt32(programflags);
+    out.PutString((!recgroup.isEmpty()) ? recgroup : "Default");
+    out.PutString(chanplaybackfilters);
+    out.PutString(seriesid);
+    out.PutString(programid);
+    out.PutString(inetref);
+
+    out.PutDateTime(lastmodified);
+    out.PutFloat(stars);
+    out.PutDate(originalAirDate);
+    out.PutString((!playgroup.isEmpty()) ? playgroup : "Default");
+    out.PutInt32(recpriority2);
+    out.PutUInt32(parentid);
+    out.PutString((!storagegroup.isEmpty()) ? storagegroup : "Default");
+    out.PutUInt16(properties);
+
+    out.PutUInt16(year);
+    out.PutUInt16(partnumber);
+    out.PutUInt16(parttotal);
+    out.PutUInt8(catType);
+
+    out.PutUInt32(recordedid);
+    out.PutString(inputname);
+    out.PutDateTime(bookmarkupdate);
+}
+
+/** \brief Initializes this ProgramInfo from the next program in a
+ *         ProgramInfoReader.
+ *  \return true if it succeeds, false if the data was damaged.
+ *  \sa ToBinary(ProgramInfoWriter&) const
+ */
+bool ProgramInfo::FromBinary(ProgramInfoReader &in)
+{
+    uint      origChanid     = chanid;
+    QDateTime origRecstartts = recstartts;
+
+    title             = in.GetString();
+    subtitle          = in.GetString();
+    description       = in.GetString();
+    season            = in.GetUInt32();
+    episode           = in.GetUInt32();
+    totalepisodes     = in.GetUInt32();
+    syndicatedepisode = in.GetString();
+    category          = in.GetString();
+    chanid            = in.GetUInt32();
+    chanstr           = in.GetString();
+    chansign          = in.GetString();
+    channame          = in.GetString();
+    pathname          = in.GetString();
+    filesize          = in.GetUInt64();
+
+    startts           = in.GetDateTime();
+    endts             = in.GetDateTime();
+    findid            = in.GetUInt32();
+    hostname          = in.GetString();
+    sourceid          = in.GetUInt32();
+    inputid           = in.GetUInt32();
+    recpriority       = in.GetInt32();
+    recstatus         = (int8_t) in.GetUInt8();
+    recordid          = in.GetUInt32();
+
+    rectype           = (RecordingType) in.GetUInt8();
+    dupin             = (RecordingDupInType) in.GetUInt8();
+    dupmethod         = (RecordingDupMethodType) in.GetUInt8();
+    recstartts        = in.GetDateTime();
+    recendts          = in.GetDateTime();
+    programflags      = in.GetUInt32();
+    recgroup          = in.GetString();
+    chanplaybackfilters = in.GetString();
+    seriesid          = in.GetString();
+    programid         = in.GetString();
+    inetref           = in.GetString();
+
+    lastmodified      = in.GetDateTime();
+    stars             = in.GetFloat();
+    originalAirDate   = in.GetDate();
+    playgroup         = in.GetString();
+    recpriority2      = in.GetInt32();
+    parentid          = in.GetUInt32();
+    storagegroup      = in.GetString();
+    properties        = in.GetUInt16();
+
+    year              = in.GetUInt16();
+    partnumber        = in.GetUInt16();
+    parttotal         = in.GetUInt16();
+    catType           = (CategoryType) in.GetUInt8();
+
+    recordedid        = in.GetUInt32();
+    inputname         = in.GetString();
+    bookmarkupdate    = in.GetDateTime();
+
+    if (!in.IsOk())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "FromBinary, damaged program data.");
+        return false;
+    }
+
+    if (!origChanid || !origRecstartts.isValid() ||
+        (origChanid != chanid) || (origRecstartts != recstartts))
+    {
+        availableStatus = asAvailable;
+        spread = -1;
+        startCol = -1;
+        sortTitle = QString();
+        inUseForWhat = QString();
+        positionMapDBReplacement = NULL;
+    }
+
+    return true;
+}
+
 /** \brief Converts ProgramInfo into QString QHash containing each field
  *         in ProgramInfo converted into localized strings.
  */
@@ -5422,10 +5572,16 @@ QMap<QString,bool> ProgramInfo::QueryJobsRunning(int type)
     return is_job_running;
 }
 
+/** \brief Returns the scheduler's pending list, as the conflicts flag
+ *         followed by the programs.
+ *  \param binary Set if the programs are in the ProgramInfoWriter form
+ *                rather than ProgramInfo::ToStringList() items
+ */
 QStringList ProgramInfo::LoadFromScheduler(
-    const QString &tmptable, int recordid)
+    const QString &tmptable, int recordid, bool &binary)
 {
     QStringList slist;
+    binary = false;
 
     MythScheduler *sched = gCoreContext->GetScheduler();
     if (sched && tmptable.isEmpty())
@@ -5443,9 +5599,10 @@ QStringList ProgramInfo::LoadFromScheduler(
     }
 
     slist.push_back(
-        (tmptable.isEmpty()) ?
-        QString("QUERY_GETALLPENDING") :
-        QString("QUERY_GETALLPENDING %1 %2").arg(tmptable).arg(recordid));
+        ((tmptable.isEmpty()) ?
+         QString("QUERY_GETALLPENDING") :
+         QString("QUERY_GETALLPENDING %1 %2").arg(tmptable).arg(recordid)) +
+        QString(" BINARY %1").arg(kProgramInfoBinaryVersion));
 
     if (!gCoreContext->SendReceiveStringList(slist) || slist.size() < 2)
     {
@@ -5454,6 +5611,7 @@ QStringList ProgramInfo::LoadFromScheduler(
         slist.clear();
     }
 
+    binary = true;
     return slist;
 }
 
@@ -5835,6 +5993,26 @@ bool LoadFromRecorded(
     const QMap<QString,bool> &isJobRunning,
     const QMap<QString, ProgramInfo*> &recMap,
     int sort)
+{
+    QString where;
+    if (possiblyInProgressRecordingsOnly)
+        where = "r.endtime >= NOW() AND r.starttime <= NOW()";
+
+    return LoadFromRecorded(destination, where, MSqlBindings(),
+                            inUseMap, isJobRunning, recMap, sort);
+}
+
+/** \brief Loads the recordings matching "where", a condition on the
+ *         recorded table aliased as r, or all of them if it is empty.
+ */
+bool LoadFromRecorded(
+    ProgramList &destination,
+    const QString &where,
+    const MSqlBindings &bindings,
+    const QMap<QString,uint32_t> &inUseMap,
+    const QMap<QString,bool> &isJobRunning,
+    const QMap<QString, ProgramInfo*> &recMap,
+    int sort)
 {
     destination.clear();
 
@@ -5845,8 +6023,8 @@ bool LoadFromRecorded(
     // ----------------------------------------------------------------------
 
     QString thequery = ProgramInfo::kFromRecordedQuery;
-    if (possiblyInProgressRecordingsOnly)
-        thequery += "WHERE r.endtime >= NOW() AND r.starttime <= NOW() ";
+    if (!where.isEmpty())
+        thequery += QString("WHERE %1 ").arg(where);
 
     if (sort)
         thequery += "ORDER BY r.starttime ";
@@ -5855,6 +6033,7 @@ bool LoadFromRecorded(
 
     MSqlQuery query(MSqlQuery::InitCon());
     query.prepare(thequery);
+    query.bindValues(bindings);
 
     if (!query.exec())
     {
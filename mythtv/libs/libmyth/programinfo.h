@@ -14,6 +14,7 @@
 #include "autodeletedeque.h"
 #include "recordingtypes.h"
 #include "programtypes.h"
+#include "programinfobinary.h"
 #include "mythdbcon.h"
 #include "mythexp.h"
 #include "mythdate.h"
@@ -278,6 +279,14 @@ class MPUBLIC ProgramInfo
         if (!FromStringList(it, list.end()))
             clear();
     }
+    /// Constructs the next ProgramInfo packed by a ProgramInfoWriter
+    ProgramInfo(ProgramInfoReader &in) :
+        chanid(0),
+        positionMapDBReplacement(NULL)
+    {
+        if (!FromBinary(in))
+            clear();
+    }
 
     ProgramInfo &operator=(const ProgramInfo &other);
     virtual void clone(const ProgramInfo &other,
@@ -290,6 +299,7 @@ class MPUBLIC ProgramInfo
 
     // Serializers
     void ToStringList(QStringList &list) const;
+    void ToBinary(ProgramInfoWriter &out) const;
     virtual void ToMap(InfoMap &progMap,
                        bool showrerecord = false,
                        uint star_range = 10) const;
@@ -681,7 +691,8 @@ class MPUBLIC ProgramInfo
     static uint64_t QueryBookmark(uint chanid, const QDateTime &recstartts);
     static QMap<QString,uint32_t> QueryInUseMap(void);
     static QMap<QString,bool> QueryJobsRunning(int type);
-    static QStringList LoadFromScheduler(const QString &altTable, int recordid);
+    static QStringList LoadFromScheduler(const QString &altTable, int recordid,
+                                         bool &binary);
 
     // Flagging map support methods
     void QueryMarkupMap(frm_dir_map_t&, MarkTypes type,
@@ -700,6 +711,7 @@ class MPUBLIC ProgramInfo
 
     bool FromStringList(QStringList::const_iterator &it,
                         QStringList::const_iterator  end);
+    bool FromBinary(ProgramInfoReader &in);
 
     static void QueryMarkupMap(
         const QString &video_pathname,
@@ -839,6 +851,15 @@ MPUBLIC bool LoadFromRecorded(
     const QMap<QString, ProgramInfo*> &recMap,
     int                 sort = 0);
 
+MPUBLIC bool LoadFromRecorded(
+    ProgramList        &destination,
+    const QString      &where,
+    const MSqlBindings &bindings,
+    const QMap<QString,uint32_t> &inUseMap,
+    const QMap<QString,bool> &isJobRunning,
+    const QMap<QString, ProgramInfo*> &recMap,
+    int                 sort = 0);
+
 template<typename TYPE>
 bool LoadFromScheduler(
     AutoDeleteDeque<TYPE*> &destination,
@@ -849,12 +870,34 @@ bool LoadFromScheduler(
     destination.clear();
     hasConflicts = false;
 
-    QStringList slist = ProgramInfo::LoadFromScheduler(altTable, recordid);
+    bool binary;
+    QStringList slist =
+        ProgramInfo::LoadFromScheduler(altTable, recordid, binary);
     if (slist.empty())
         return false;
 
     hasConflicts = slist[0].toInt();
 
+    if (binary)
+    {
+        QStringList::const_iterator sit = slist.begin()+1;
+        ProgramInfoReader reader;
+        if (!reader.FromStringList(sit, slist.end()))
+            return false;
+
+        for (uint i = 0; i < reader.size(); ++i)
+        {
+            destination.push_back(new TYPE(reader));
+            if (!reader.IsOk())
+            {
+                destination.clear();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     QStringList::const_iterator sit = slist.begin()+2;
     while (sit != slist.end())
     {
@@ -0,0 +1,255 @@
+// -*- Mode: c++ -*-
+
+// C++ headers
+#include <algorithm>
+using std::min;
+
+// ANSI C headers
+#include <string.h>
+
+// Qt headers
+#include <QtEndian>
+
+// MythTV headers
+#include "programinfobinary.h"
+#include "programinfo.h"
+#include "mythlogging.h"
+#include "mythdate.h"
+
+#define LOC QString("ProgramInfoBinary: ")
+
+/// Stands for an invalid QDateTime, as in ProgramInfo::ToStringList()
+static const uint32_t kInvalidTime = 0xffffffff;
+
+ProgramInfoWriter::ProgramInfoWriter(uint version) :
+    m_version(version), m_count(0)
+{
+    // Enough for a recording list without reallocating much
+    m_programs.reserve(16 * 1024);
+    m_strings.reserve(16 * 1024);
+}
+
+void ProgramInfoWriter::Add(const ProgramInfo &pginfo)
+{
+    pginfo.ToBinary(*this);
+    m_count++;
+}
+
+/// Appends the program count, the version and the base64 encoded
+/// string table and programs to "list".
+void ProgramInfoWriter::ToStringList(QStringList &list) const
+{
+    QByteArray data;
+    data.reserve(4 + m_strings.size() + m_programs.size());
+
+    uchar num[4];
+    qToLittleEndian((quint32) m_index.size(), num);
+    data.append(reinterpret_cast<const char*>(num), 4);
+    data.append(m_strings);
+    data.append(m_programs);
+
+    list << QString::number(m_count)
+         << QString::number(m_version)
+         << QString::fromLatin1(data.toBase64());
+}
+
+void ProgramInfoWriter::PutUInt16(uint16_t val)
+{
+    uchar buf[2];
+    qToLittleEndian((quint16) val, buf);
+    m_programs.append(reinterpret_cast<const char*>(buf), 2);
+}
+
+void ProgramInfoWriter::PutUInt32(uint32_t val)
+{
+    uchar buf[4];
+    qToLittleEndian((quint32) val, buf);
+    m_programs.append(reinterpret_cast<const char*>(buf), 4);
+}
+
+void ProgramInfoWriter::PutUInt64(uint64_t val)
+{
+    uchar buf[8];
+    qToLittleEndian((quint64) val, buf);
+    m_programs.append(reinterpret_cast<const char*>(buf), 8);
+}
+
+void ProgramInfoWriter::PutFloat(float val)
+{
+    uint32_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    PutUInt32(bits);
+}
+
+void ProgramInfoWriter::PutDateTime(const QDateTime &val)
+{
+    PutUInt32(val.isValid() ? val.toTime_t() : kInvalidTime);
+}
+
+void ProgramInfoWriter::PutDate(const QDate &val)
+{
+    PutInt32(val.isValid() ? val.toJulianDay() : 0);
+}
+
+void ProgramInfoWriter::PutString(const QString &val)
+{
+    QHash<QString,uint32_t>::const_iterator it = m_index.find(val);
+    if (it != m_index.end())
+    {
+        PutUInt32(*it);
+        return;
+    }
+
+    uint32_t index = m_index.size();
+    m_index.insert(val, index);
+
+    QByteArray utf8 = val.toUtf8();
+    uchar len[4];
+    qToLittleEndian((quint32) utf8.size(), len);
+    m_strings.append(reinterpret_cast<const char*>(len), 4);
+    m_strings.append(utf8);
+
+    PutUInt32(index);
+}
+
+ProgramInfoReader::ProgramInfoReader() :
+    m_count(0), m_ok(false), m_pos(NULL), m_end(NULL)
+{
+}
+
+/** \brief Reads the three items ProgramInfoWriter::ToStringList() wrote,
+ *         and the string table.
+ *  \return false if the items are missing, of an unknown version or
+ *          the string table is damaged
+ */
+bool ProgramInfoReader::FromStringList(QStringList::const_iterator &it,
+                                       QStringList::const_iterator  end)
+{
+    m_count = 0;
+    m_ok = false;
+    m_strings.clear();
+
+    QStringList::const_iterator first = it;
+    for (uint i = 0; i < 3; ++i, ++it)
+    {
+        if (it == end)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Not enough items in list.");
+            return false;
+        }
+    }
+
+    bool ok;
+    uint count = first->toUInt(&ok);
+    uint version = (first + 1)->toUInt();
+    if (!ok || !version || version > kProgramInfoBinaryVersion)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unknown version '%1'").arg(*(first + 1)));
+        return false;
+    }
+
+    m_data = QByteArray::fromBase64((first + 2)->toLatin1());
+    m_pos = m_data.constData();
+    m_end = m_pos + m_data.size();
+    m_ok = true;
+
+    uint32_t numstrings = GetUInt32();
+    if (numstrings > (uint32_t)(m_end - m_pos) / 4)
+        m_ok = false;
+    else
+        m_strings.reserve(numstrings);
+
+    for (uint32_t i = 0; i < numstrings && m_ok; ++i)
+    {
+        uint32_t len = GetUInt32();
+        const char *utf8 = Take(len);
+        if (utf8)
+            m_strings.push_back(QString::fromUtf8(utf8, len));
+    }
+
+    if (!m_ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Damaged string table.");
+        return false;
+    }
+
+    m_count = count;
+    return true;
+}
+
+/// Returns the next "bytes" bytes, or NULL if there aren't that many left.
+const char *ProgramInfoReader::Take(uint bytes)
+{
+    if (!m_ok || (uint)(m_end - m_pos) < bytes)
+    {
+        m_ok = false;
+        return NULL;
+    }
+    const char *p = m_pos;
+    m_pos += bytes;
+    return p;
+}
+
+uint8_t ProgramInfoReader::GetUInt8(void)
+{
+    const char *p = Take(1);
+    return p ? (uint8_t) *p : 0;
+}
+
+uint16_t ProgramInfoReader::GetUInt16(void)
+{
+    const char *p = Take(2);
+    return p ? qFromLittleEndian<quint16>(
+        reinterpret_cast<const uchar*>(p)) : 0;
+}
+
+uint32_t ProgramInfoReader::GetUInt32(void)
+{
+    const char *p = Take(4);
+    return p ? qFromLittleEndian<quint32>(
+        reinterpret_cast<const uchar*>(p)) : 0;
+}
+
+uint64_t ProgramInfoReader::GetUInt64(void)
+{
+    const char *p = Take(8);
+    return p ? qFromLittleEndian<quint64>(
+        reinterpret_cast<const uchar*>(p)) : 0;
+}
+
+float ProgramInfoReader::GetFloat(void)
+{
+    uint32_t bits = GetUInt32();
+    float val;
+    memcpy(&val, &bits, sizeof(val));
+    return val;
+}
+
+QDateTime ProgramInfoReader::GetDateTime(void)
+{
+    uint32_t secs = GetUInt32();
+    return (secs == kInvalidTime) ? QDateTime() : MythDate::fromTime_t(secs);
+}
+
+QDate ProgramInfoReader::GetDate(void)
+{
+    int32_t jd = GetInt32();
+    return jd ? QDate::fromJulianDay(jd) : QDate();
+}
+
+QString ProgramInfoReader::GetString(void)
+{
+    uint32_t index = GetUInt32();
+    if (index >= (uint32_t) m_strings.size())
+    {
+        m_ok = false;
+        return QString();
+    }
+    return m_strings[index];
+}
+
+uint ProgramInfoBinaryVersion(const QString &requested)
+{
+    return min(requested.toUInt(), kProgramInfoBinaryVersion);
+}
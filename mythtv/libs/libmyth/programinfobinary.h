@@ -0,0 +1,129 @@
+#ifndef _PROGRAM_INFO_BINARY_H_
+#define _PROGRAM_INFO_BINARY_H_
+
+// ANSI C headers
+#include <stdint.h> // for [u]int[32,64]_t
+
+// Qt headers
+#include <QStringList>
+#include <QByteArray>
+#include <QDateTime>
+#include <QVector>
+#include <QHash>
+
+// Myth
+#include "mythexp.h"
+
+class ProgramInfo;
+
+/// The newest binary ProgramInfo list encoding, see ProgramInfoWriter
+static const uint kProgramInfoBinaryVersion = 1;
+
+/** \brief Packs a list of ProgramInfo into the binary form a client can
+ *         ask for in place of ProgramInfo::ToStringList() items.
+ *
+ *  Numbers are stored as little endian fixed width integers and times
+ *  as seconds since the epoch. Each distinct string is stored once, in
+ *  a table, and the programs refer to it by index, so the titles,
+ *  channels and groups repeated all through a recording list cost four
+ *  bytes each after the first.
+ *
+ *  ToStringList() appends the number of programs, the version and the
+ *  base64 encoded table and programs as three stringlist items, which
+ *  ProgramInfoReader::FromStringList() reads back.
+ */
+class MPUBLIC ProgramInfoWriter
+{
+  public:
+    explicit ProgramInfoWriter(uint version = kProgramInfoBinaryVersion);
+
+    void Add(const ProgramInfo &pginfo);
+    uint size(void) const { return m_count; }
+    void ToStringList(QStringList &list) const;
+
+    // Used by ProgramInfo::ToBinary()
+    void PutUInt8(uint8_t val)   { m_programs.append((char) val); }
+    void PutUInt16(uint16_t val);
+    void PutUInt32(uint32_t val);
+    void PutInt32(int32_t val)   { PutUInt32((uint32_t) val); }
+    void PutUInt64(uint64_t val);
+    void PutFloat(float val);
+    void PutDateTime(const QDateTime &val);
+    void PutDate(const QDate &val);
+    void PutString(const QString &val);
+
+  private:
+    uint                    m_version;
+    uint                    m_count;
+    QHash<QString,uint32_t> m_index;
+    QByteArray              m_strings;
+    QByteArray              m_programs;
+};
+
+/** \brief Reads back the programs a ProgramInfoWriter packed.
+ *
+ *  Pass the reader to the ProgramInfo constructor once for each of
+ *  size() programs. Reading past the end of the data, or a string
+ *  index outside the table, makes IsOk() false and the programs read
+ *  from then on empty.
+ */
+class MPUBLIC ProgramInfoReader
+{
+  public:
+    ProgramInfoReader();
+
+    bool FromStringList(QStringList::const_iterator &it,
+                        QStringList::const_iterator  end);
+    uint size(void) const { return m_count; }
+    bool IsOk(void) const { return m_ok; }
+
+    // Used by ProgramInfo::FromBinary()
+    uint8_t   GetUInt8(void);
+    uint16_t  GetUInt16(void);
+    uint32_t  GetUInt32(void);
+    int32_t   GetInt32(void) { return (int32_t) GetUInt32(); }
+    uint64_t  GetUInt64(void);
+    float     GetFloat(void);
+    QDateTime GetDateTime(void);
+    QDate     GetDate(void);
+    QString   GetString(void);
+
+  private:
+    const char *Take(uint bytes);
+
+    uint             m_count;
+    bool             m_ok;
+    QByteArray       m_data;
+    const char      *m_pos;
+    const char      *m_end;
+    QVector<QString> m_strings;
+};
+
+/** \brief Serializes a list of ProgramInfo pointers for a MythProtocol
+ *         reply, as the program count and ProgramInfo::ToStringList()
+ *         items, or with a ProgramInfoWriter if "version" is not 0.
+ */
+template<typename T>
+void ProgramListToStringList(const T &programs, QStringList &list,
+                             uint version)
+{
+    typename T::const_iterator it = programs.begin();
+    if (version)
+    {
+        ProgramInfoWriter writer(version);
+        for (; it != programs.end(); ++it)
+            writer.Add(**it);
+        writer.ToStringList(list);
+        return;
+    }
+
+    list << QString::number(programs.size());
+    for (; it != programs.end(); ++it)
+        (*it)->ToStringList(list);
+}
+
+/// Returns the binary version to answer a request for "requested" with,
+/// 0 if the request should get the stringlist form.
+MPUBLIC uint ProgramInfoBinaryVersion(const QString &requested);
+
+#endif // _PROGRAM_INFO_BINARY_H_
@@ -27,7 +27,7 @@ vector<ProgramInfo *> *RemoteGetRecordedList(int sort)
 
     vector<ProgramInfo *> *info = new vector<ProgramInfo *>;
 
-    if (!RemoteGetRecordingList(*info, strlist))
+    if (!RemoteGetRecordingList(*info, strlist, true))
     {
         delete info;
         return NULL;
@@ -36,6 +36,89 @@ vector<ProgramInfo *> *RemoteGetRecordedList(int sort)
     return info;
 }
 
+/** \brief Fetches the recordings changed since an earlier call, with
+ *         QUERY_RECORDING_CHANGES.
+ *
+ *  \param token       The token from the last call, or "0" to fetch every
+ *                     recording. Replaced by the new token on success.
+ *  \param resend      Recordings to send whether changed or not, those
+ *                     last seen being recorded or in use.
+ *  \param recordedids Set to the ids of all the recordings, so the
+ *                     caller can tell which were deleted.
+ *  \param changed     The changed recordings are appended, the caller
+ *                     must delete them.
+ *  \param batch       More requests to send in the same round trip, with
+ *                     QUERY_BATCH. Each is replaced by its reply, or the
+ *                     list is emptied if the round trip failed.
+ *  \return true if the whole reply was received
+ */
+bool RemoteGetRecordingChanges(
+    QString &token, const QList<uint> &resend,
+    QList<uint> &recordedids, vector<ProgramInfo *> &changed,
+    QList<QStringList> *batch)
+{
+    QString str = QString("QUERY_RECORDING_CHANGES %1").arg(token);
+    QList<uint>::const_iterator rit = resend.begin();
+    for (; rit != resend.end(); ++rit)
+        str += QString(" %1").arg(*rit);
+    str += QString(" BINARY %1").arg(kProgramInfoBinaryVersion);
+
+    QStringList strlist(str);
+    bool sent;
+    if (batch && !batch->empty())
+    {
+        batch->prepend(strlist);
+        sent = RemoteBatchQuery(*batch);
+        if (sent)
+            strlist = batch->takeFirst();
+        else
+            batch->clear();
+    }
+    else
+    {
+        sent = gCoreContext->SendReceiveStringList(strlist);
+    }
+
+    if (!sent || strlist.size() < 3 || strlist[0] == "ERROR")
+        return false;
+
+    bool ok;
+    int numids = strlist[1].toInt(&ok);
+    if (!ok || numids < 0 || numids + 3 > strlist.size())
+        return false;
+
+    QStringList::const_iterator it = strlist.begin() + numids + 2;
+    ProgramInfoReader reader;
+    if (!reader.FromStringList(it, strlist.end()))
+    {
+        LOG(VB_GENERAL, LOG_ERR, "RemoteGetRecordingChanges() "
+            "could not read the changed recordings.");
+        return false;
+    }
+
+    vector<ProgramInfo *> programs;
+    for (uint i = 0; i < reader.size() && reader.IsOk(); i++)
+        programs.push_back(new ProgramInfo(reader));
+
+    if (!reader.IsOk())
+    {
+        LOG(VB_GENERAL, LOG_ERR, "RemoteGetRecordingChanges() "
+            "changed recordings are damaged.");
+        for (uint i = 0; i < programs.size(); i++)
+            delete programs[i];
+        return false;
+    }
+
+    recordedids.clear();
+    for (int i = 0; i < numids; i++)
+        recordedids.push_back(strlist[i + 2].toUInt());
+
+    changed.insert(changed.end(), programs.begin(), programs.end());
+
+    token = strlist[0];
+    return true;
+}
+
 bool RemoteGetLoad(float load[3])
 {
     QStringList strlist(QString("QUERY_LOAD"));
@@ -169,15 +252,50 @@ void RemoteGetAllScheduledRecordings(vector<ProgramInfo *> &scheduledlist)
 void RemoteGetAllExpiringRecordings(vector<ProgramInfo *> &expiringlist)
 {
     QStringList strList(QString("QUERY_GETEXPIRING"));
-    RemoteGetRecordingList(expiringlist, strList);
+    RemoteGetRecordingList(expiringlist, strList, true);
 }
 
+/** \brief Sends the request in "strList" and appends the programs in
+ *         the reply to "reclist".
+ *
+ *  \param binary Ask for the reply in the ProgramInfoWriter form, which
+ *                only QUERY_RECORDINGS, QUERY_GETEXPIRING,
+ *                QUERY_GETALLPENDING and QUERY_RECORDING_CHANGES offer
+ *  \return The number of programs appended
+ */
 uint RemoteGetRecordingList(
-    vector<ProgramInfo *> &reclist, QStringList &strList)
+    vector<ProgramInfo *> &reclist, QStringList &strList, bool binary)
 {
+    if (binary && !strList.isEmpty())
+        strList[0] += QString(" BINARY %1").arg(kProgramInfoBinaryVersion);
+
     if (!gCoreContext->SendReceiveStringList(strList) || strList.isEmpty())
         return 0;
 
+    if (binary)
+    {
+        QStringList::const_iterator it = strList.begin();
+        ProgramInfoReader reader;
+        if (!reader.FromStringList(it, strList.end()))
+            return 0;
+
+        uint reclist_initial_size = (uint) reclist.size();
+        for (uint i = 0; i < reader.size(); i++)
+        {
+            ProgramInfo *pginfo = new ProgramInfo(reader);
+            if (!reader.IsOk())
+            {
+                delete pginfo;
+                LOG(VB_GENERAL, LOG_ERR,
+                    "RemoteGetRecordingList() programs are damaged.");
+                break;
+            }
+            reclist.push_back(pginfo);
+        }
+
+        return ((uint) reclist.size()) - reclist_initial_size;
+    }
+
     int numrecordings = strList[0].toInt();
     if (numrecordings <= 0)
         return 0;
@@ -526,7 +644,7 @@ vector<ProgramInfo *> *RemoteGetCurrentlyRecordingList(void)
 
     vector<ProgramInfo *> *reclist = new vector<ProgramInfo *>;
     vector<ProgramInfo *> *info = new vector<ProgramInfo *>;
-    if (!RemoteGetRecordingList(*info, strlist))
+    if (!RemoteGetRecordingList(*info, strlist, true))
     {
         delete info;
         return reclist;
@@ -572,4 +690,38 @@ bool RemoteGetActiveBackends(QStringList *list)
     return true;
 }
 
+/** \brief Sends several requests to the master backend in one round
+ *         trip, using QUERY_BATCH.
+ *
+ *  \param requests The requests, each replaced by its reply on success.
+ *  \return true if all the replies were received
+ */
+bool RemoteBatchQuery(QList<QStringList> &requests)
+{
+    QStringList strlist(QString("QUERY_BATCH"));
+    QList<QStringList>::const_iterator it = requests.begin();
+    for (; it != requests.end(); ++it)
+        strlist << QString::number((*it).size()) << *it;
+
+    if (!gCoreContext->SendReceiveStringList(strlist))
+        return false;
+
+    QList<QStringList> replies;
+    for (int i = 0; i < strlist.size();)
+    {
+        bool ok;
+        int count = strlist[i].toInt(&ok);
+        if (!ok || count < 0 || i + 1 + count > strlist.size())
+            return false;
+        replies.push_back(strlist.mid(i + 1, count));
+        i += 1 + count;
+    }
+
+    if (replies.size() != requests.size())
+        return false;
+
+    requests = replies;
+    return true;
+}
+
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
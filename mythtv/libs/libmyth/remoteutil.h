@@ -5,6 +5,7 @@
 
 #include <QStringList>
 #include <QDateTime>
+#include <QList>
 
 #include <vector>
 using std::vector;
@@ -15,6 +16,10 @@ class ProgramInfo;
 class MythEvent;
 
 MPUBLIC vector<ProgramInfo *> *RemoteGetRecordedList(int sort);
+MPUBLIC bool RemoteGetRecordingChanges(
+    QString &token, const QList<uint> &resend,
+    QList<uint> &recordedids, vector<ProgramInfo *> &changed,
+    QList<QStringList> *batch = NULL);
 MPUBLIC bool RemoteGetLoad(float load[3]);
 MPUBLIC bool RemoteGetUptime(time_t &uptime);
 MPUBLIC
@@ -30,7 +35,8 @@ void RemoteGetAllScheduledRecordings(vector<ProgramInfo *> &scheduledlist);
 MPUBLIC
 void RemoteGetAllExpiringRecordings(vector<ProgramInfo *> &expiringlist);
 MPUBLIC uint RemoteGetRecordingList(vector<ProgramInfo *> &reclist,
-                                    QStringList &strList);
+                                    QStringList &strList,
+                                    bool binary = false);
 MPUBLIC vector<ProgramInfo *> *RemoteGetConflictList(const ProgramInfo *pginfo);
 MPUBLIC QDateTime RemoteGetPreviewLastModified(const ProgramInfo *pginfo);
 MPUBLIC QDateTime RemoteGetPreviewIfModified(
@@ -48,6 +54,7 @@ MPUBLIC vector<ProgramInfo *> *RemoteGetCurrentlyRecordingList(void);
 MPUBLIC bool RemoteGetFileList(QString host, QString path, QStringList* list,
                        QString sgroup, bool fileNamesOnly = false);
 MPUBLIC bool RemoteGetActiveBackends(QStringList *list);
+MPUBLIC bool RemoteBatchQuery(QList<QStringList> &requests);
 
 #endif
 
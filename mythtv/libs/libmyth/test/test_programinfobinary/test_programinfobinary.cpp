@@ -0,0 +1,3 @@
+#include "test_programinfobinary.h"
+
+QTEST_APPLESS_MAIN(TestProgramInfoBinary)
@@ -0,0 +1,303 @@
+/*
+ *  Class TestProgramInfoBinary
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "programinfo.h"
+#include "programinfobinary.h"
+#include "programtypes.h"
+
+/// Programs in the benchmark lists, a large recording list
+#define NUMPROGRAMS 2000
+
+class TestProgramInfoBinary : public QObject
+{
+    Q_OBJECT
+  private:
+    /// A recording list repeats a few titles, channels and groups
+    static ProgramInfo *mockRecording(uint i)
+    {
+        uint show = i % 25;
+        uint chan = i % 8;
+        QDateTime start = MythDate::fromTime_t(1400000000 + i * 3600);
+
+        ProgramInfo *pginfo = new ProgramInfo(
+            QString("Show %1").arg(show),  /* title */
+            QString("Episode %1").arg(i),  /* subtitle */
+            QString("What happens in episode %1 of show %2, "
+                    "in a sentence or two.").arg(i).arg(show),
+            "",                            /* syndicated episode */
+            "Drama",                       /* category */
+            1000 + chan,                   /* chanid */
+            QString::number(chan + 1),     /* channum */
+            QString("CH%1").arg(chan),     /* chansign */
+            QString("Channel %1").arg(chan), /* channame */
+            "",                            /* chan playback filters */
+            start,                         /* start ts */
+            start.addSecs(3600),           /* end ts */
+            start,                         /* rec start ts */
+            start.addSecs(3600),           /* rec end ts */
+            QString("SH%1").arg(show),     /* series id */
+            QString("EP%1").arg(i),        /* program id */
+            ProgramInfo::kCategorySeries,  /* cat type */
+            0.75f,                         /* stars */
+            2014,                          /* year */
+            (uint) 0,                      /* part number */
+            (uint) 0,                      /* part total */
+            QDate(2014, 1, 1 + i % 28),    /* original air date */
+            RecStatus::Recorded,           /* rec status */
+            10 + show,                     /* record id */
+            kAllRecord,                    /* rec type */
+            (uint) 0,                      /* find id */
+            true,                          /* comm free */
+            false,                         /* repeat */
+            (uint) 0,                      /* video props */
+            (uint) 0,                      /* audio props */
+            (uint) 0,                      /* subtitle type */
+            1 + i / 25,                    /* season */
+            1 + show,                      /* episode */
+            (uint) 25,                     /* total episodes */
+            ProgramList()                  /* sched List */
+        );
+        pginfo->SetPathname(QString("myth://Default@backend:6543/%1_%2.ts")
+                            .arg(1000 + chan).arg(1400000000 + i * 3600));
+        pginfo->SetHostname("backend");
+        pginfo->SetRecordingGroup((i % 3) ? "Default" : "Kids");
+        pginfo->SetFilesize(2000000000ULL + i);
+        pginfo->SetRecordingID(i + 1);
+        return pginfo;
+    }
+
+    static void mockRecordings(ProgramList &list)
+    {
+        for (uint i = 0; i < NUMPROGRAMS; i++)
+            list.push_back(mockRecording(i));
+    }
+
+    /// What MythSocket::WriteStringList() and ReadStringList() do to a
+    /// reply on the way over the socket
+    static QStringList overTheWire(const QStringList &list)
+    {
+        QByteArray utf8 = list.join("[]:[]").toUtf8();
+        return QString::fromUtf8(utf8.constData(), utf8.size())
+            .split("[]:[]");
+    }
+
+    static QStringList toStrings(const ProgramInfo &pginfo)
+    {
+        QStringList list;
+        pginfo.ToStringList(list);
+        return list;
+    }
+
+  private slots:
+    /**
+     * Every field survives, as the stringlist form shows it.
+     */
+    void roundTrip_test(void)
+    {
+        ProgramList programs;
+        mockRecordings(programs);
+
+        ProgramInfo *odd = mockRecording(0);
+        odd->SetTitle(QString::fromUtf8("Caf\xc3\xa9 [] :[]: \xe2\x82\xac"));
+        odd->SetRecordingGroup("");
+        odd->SetFilesize(0xFFFFFFFFFFULL);
+        programs.push_back(odd);
+        programs.push_back(new ProgramInfo("Dummy", "Category",
+                                           QDateTime(), QDateTime()));
+
+        QStringList list("token");
+        ProgramListToStringList(programs, list, kProgramInfoBinaryVersion);
+        list << "after";
+        list = overTheWire(list);
+
+        QStringList::const_iterator it = list.begin() + 1;
+        ProgramInfoReader reader;
+        QVERIFY(reader.FromStringList(it, list.end()));
+        QCOMPARE(reader.size(), (uint) programs.size());
+        QCOMPARE(*it, QString("after"));
+
+        ProgramList::const_iterator pit = programs.begin();
+        for (; pit != programs.end(); ++pit)
+        {
+            ProgramInfo pginfo(reader);
+            QVERIFY(reader.IsOk());
+            QCOMPARE(toStrings(pginfo), toStrings(**pit));
+        }
+    }
+
+    /**
+     * Asking for version 0 gets the old stringlist form, which old
+     * clients read.
+     */
+    void stringListForm_test(void)
+    {
+        ProgramList programs;
+        programs.push_back(mockRecording(1));
+        programs.push_back(mockRecording(2));
+
+        QStringList list;
+        ProgramListToStringList(programs, list, 0);
+        QCOMPARE(list.size(), 1 + 2 * NUMPROGRAMLINES);
+        QCOMPARE(list[0], QString("2"));
+
+        QStringList::const_iterator it = list.begin() + 1;
+        ProgramInfo first(it, list.end());
+        QCOMPARE(first.GetTitle(), programs[0]->GetTitle());
+    }
+
+    void negotiation_test(void)
+    {
+        QCOMPARE(ProgramInfoBinaryVersion("0"), 0U);
+        QCOMPARE(ProgramInfoBinaryVersion("junk"), 0U);
+        QCOMPARE(ProgramInfoBinaryVersion("1"), 1U);
+        QCOMPARE(ProgramInfoBinaryVersion("999"), kProgramInfoBinaryVersion);
+    }
+
+    /**
+     * Repeated strings are sent once, so a recording list shrinks.
+     */
+    void size_test(void)
+    {
+        ProgramList programs;
+        mockRecordings(programs);
+
+        QStringList text;
+        ProgramListToStringList(programs, text, 0);
+        QStringList binary;
+        ProgramListToStringList(programs, binary, kProgramInfoBinaryVersion);
+
+        int textSize = text.join("[]:[]").toUtf8().size();
+        int binarySize = binary.join("[]:[]").toUtf8().size();
+        qDebug() << "stringlist" << textSize << "bytes, binary"
+                 << binarySize << "bytes";
+        QVERIFY(binarySize < textSize);
+    }
+
+    void damaged_test(void)
+    {
+        ProgramList programs;
+        programs.push_back(mockRecording(1));
+        programs.push_back(mockRecording(2));
+
+        QStringList list;
+        ProgramListToStringList(programs, list, kProgramInfoBinaryVersion);
+        QCOMPARE(list.size(), 3);
+
+        // Unknown version
+        QStringList newer(list);
+        newer[1] = QString::number(kProgramInfoBinaryVersion + 1);
+        QStringList::const_iterator it = newer.begin();
+        ProgramInfoReader reader;
+        QVERIFY(!reader.FromStringList(it, newer.end()));
+
+        // Missing items
+        QStringList shorter(list.mid(0, 2));
+        it = shorter.begin();
+        QVERIFY(!reader.FromStringList(it, shorter.end()));
+
+        // Cut short in the second program
+        QByteArray data = QByteArray::fromBase64(list[2].toLatin1());
+        data.chop(10);
+        QStringList cut(list);
+        cut[2] = QString::fromLatin1(data.toBase64());
+        it = cut.begin();
+        QVERIFY(reader.FromStringList(it, cut.end()));
+        ProgramInfo first(reader);
+        QVERIFY(reader.IsOk());
+        QCOMPARE(first.GetTitle(), programs[0]->GetTitle());
+        ProgramInfo second(reader);
+        QVERIFY(!reader.IsOk());
+        QVERIFY(second.GetTitle().isEmpty());
+    }
+
+    /**
+     * The backend's side of a QUERY_RECORDINGS reply, up to the bytes
+     * MythSocket writes.
+     */
+    void serializeStringList_benchmark(void)
+    {
+        ProgramList programs;
+        mockRecordings(programs);
+
+        QBENCHMARK
+        {
+            QStringList list;
+            ProgramListToStringList(programs, list, 0);
+            QByteArray utf8 = list.join("[]:[]").toUtf8();
+        }
+    }
+
+    void serializeBinary_benchmark(void)
+    {
+        ProgramList programs;
+        mockRecordings(programs);
+
+        QBENCHMARK
+        {
+            QStringList list;
+            ProgramListToStringList(programs, list,
+                                    kProgramInfoBinaryVersion);
+            QByteArray utf8 = list.join("[]:[]").toUtf8();
+        }
+    }
+
+    /**
+     * The frontend's side, from the bytes MythSocket reads.
+     */
+    void deserializeStringList_benchmark(void)
+    {
+        ProgramList programs;
+        mockRecordings(programs);
+        QStringList list;
+        ProgramListToStringList(programs, list, 0);
+        QByteArray utf8 = list.join("[]:[]").toUtf8();
+
+        QBENCHMARK
+        {
+            QStringList strlist = QString::fromUtf8(
+                utf8.constData(), utf8.size()).split("[]:[]");
+            ProgramList result;
+            QStringList::const_iterator it = strlist.begin() + 1;
+            for (uint i = 0; i < strlist[0].toUInt(); i++)
+                result.push_back(new ProgramInfo(it, strlist.end()));
+        }
+    }
+
+    void deserializeBinary_benchmark(void)
+    {
+        ProgramList programs;
+        mockRecordings(programs);
+        QStringList list;
+        ProgramListToStringList(programs, list, kProgramInfoBinaryVersion);
+        QByteArray utf8 = list.join("[]:[]").toUtf8();
+
+        QBENCHMARK
+        {
+            QStringList strlist = QString::fromUtf8(
+                utf8.constData(), utf8.size()).split("[]:[]");
+            ProgramList result;
+            QStringList::const_iterator it = strlist.begin();
+            ProgramInfoReader reader;
+            reader.FromStringList(it, strlist.end());
+            for (uint i = 0; i < reader.size(); i++)
+                result.push_back(new ProgramInfo(reader));
+        }
+    }
+};
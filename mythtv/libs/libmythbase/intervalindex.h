@@ -0,0 +1,150 @@
+// -*- Mode: c++ -*-
+
+#ifndef __MYTH_INTERVAL_INDEX_H__
+#define __MYTH_INTERVAL_INDEX_H__
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/** \class IntervalIndex
+ *  \brief IntervalIndex finds the values whose intervals intersect a
+ *         query interval in O(log n + m), instead of looking at each.
+ *
+ *  Values are added with insert() and the index is built with build()
+ *  before querying.  Intervals are closed, so intervals which only
+ *  touch do intersect.  Matches are returned in insertion order, so
+ *  callers walking a list can use the index as a filter on that list
+ *  without changing anything else.
+ *
+ *  The index is an augmented binary search tree laid out implicitly
+ *  over the intervals sorted by start: the middle element of each range
+ *  is the root of the range and also stores the largest end in it.
+ */
+template<typename T, typename K>
+class IntervalIndex
+{
+  public:
+    /// Matches of a query, as insertion position and value.  Callers keep
+    /// one and pass it to every query, so that queries don't allocate.
+    typedef std::vector<std::pair<size_t, T> > Matches;
+
+    IntervalIndex() : m_built(true) {}
+
+    /// \brief Removes all intervals. O(n).
+    void clear(void)
+    {
+        m_entries.clear();
+        m_maxend.clear();
+        m_built = true;
+    }
+
+    /// \brief Adds the interval [start, end] for value. Amortized O(1).
+    void insert(const K &start, const K &end, const T &value)
+    {
+        Entry e;
+        e.start = start;
+        e.end   = end;
+        e.order = m_entries.size();
+        e.value = value;
+        m_entries.push_back(e);
+        m_built = false;
+    }
+
+    /// \brief Builds the index after the last insert(). O(n log n).
+    void build(void)
+    {
+        std::sort(m_entries.begin(), m_entries.end(), comp_start);
+        m_maxend.resize(m_entries.size());
+        if (!m_entries.empty())
+            build(0, m_entries.size());
+        m_built = true;
+    }
+
+    bool isBuilt(void) const { return m_built; }
+    size_t size(void) const { return m_entries.size(); }
+    bool empty(void) const { return m_entries.empty(); }
+
+    /// \brief Replaces result with all intervals intersecting
+    ///        [start, end], in insertion order. O(log n + m log m).
+    void intersecting(const K &start, const K &end, Matches &result) const
+    {
+        result.clear();
+        if (!m_entries.empty())
+            find(0, m_entries.size(), start, end, result);
+        std::sort(result.begin(), result.end(), comp_match);
+    }
+
+  private:
+    struct Entry
+    {
+        K      start;
+        K      end;
+        size_t order;
+        T      value;
+    };
+
+    static bool comp_start(const Entry &a, const Entry &b)
+    {
+        if (a.start < b.start)
+            return true;
+        if (b.start < a.start)
+            return false;
+        return a.order < b.order;
+    }
+
+    static bool comp_match(const std::pair<size_t, T> &a,
+                           const std::pair<size_t, T> &b)
+    {
+        return a.first < b.first;
+    }
+
+    const K &build(size_t lo, size_t hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        m_maxend[mid] = m_entries[mid].end;
+        if (lo < mid)
+        {
+            const K &left = build(lo, mid);
+            if (m_maxend[mid] < left)
+                m_maxend[mid] = left;
+        }
+        if (mid + 1 < hi)
+        {
+            const K &right = build(mid + 1, hi);
+            if (m_maxend[mid] < right)
+                m_maxend[mid] = right;
+        }
+        return m_maxend[mid];
+    }
+
+    void find(size_t lo, size_t hi, const K &start, const K &end,
+              Matches &found) const
+    {
+        size_t mid = lo + (hi - lo) / 2;
+
+        // Nothing in this range ends at or after start
+        if (m_maxend[mid] < start)
+            return;
+
+        if (lo < mid)
+            find(lo, mid, start, end, found);
+
+        // Everything from here on starts after end
+        if (end < m_entries[mid].start)
+            return;
+
+        if (!(m_entries[mid].end < start))
+            found.push_back(std::make_pair(m_entries[mid].order,
+                                           m_entries[mid].value));
+
+        if (mid + 1 < hi)
+            find(mid + 1, hi, start, end, found);
+    }
+
+    std::vector<Entry> m_entries;
+    std::vector<K>     m_maxend;
+    bool               m_built;
+};
+
+#endif // __MYTH_INTERVAL_INDEX_H__
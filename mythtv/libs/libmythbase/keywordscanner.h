@@ -0,0 +1,162 @@
+// -*- Mode: c++ -*-
+
+#ifndef __MYTH_KEYWORD_SCANNER_H__
+#define __MYTH_KEYWORD_SCANNER_H__
+
+#include <algorithm>
+#include <vector>
+
+#include <QString>
+
+/** \class KeywordScanner
+ *  \brief KeywordScanner finds which of a set of keywords occur in a
+ *         string in a single pass over the string.
+ *
+ *  Keywords are added with add(), which returns the keyword's bit in
+ *  the mask returned by scan(), and the automaton is built with build()
+ *  before scanning.  Up to 64 keywords are supported.  Matching ignores
+ *  case unless the scanner was created case sensitive.
+ *
+ *  This is an Aho-Corasick automaton, so a scan costs O(length of the
+ *  string) however many keywords there are.  It is meant to be used as
+ *  a cheap prefilter in front of regular expressions which can only
+ *  match if a literal is present.
+ */
+class KeywordScanner
+{
+  public:
+    explicit KeywordScanner(Qt::CaseSensitivity cs = Qt::CaseInsensitive)
+        : m_cs(cs), m_built(true), m_count(0)
+    {
+        m_states.push_back(State());
+    }
+
+    /// \brief Adds a keyword and returns its bit, or 0 if it was empty
+    ///        or there are already 64 keywords.
+    quint64 add(const QString &keyword)
+    {
+        if (keyword.isEmpty() || m_count >= 64)
+            return 0;
+
+        quint64 bit = 1ULL << m_count++;
+        uint state = 0;
+        for (int i = 0; i < keyword.length(); ++i)
+        {
+            ushort c = fold(keyword[i]);
+            int next = goTo(state, c);
+            if (next < 0)
+            {
+                next = m_states.size();
+                m_states.push_back(State());
+                Edge e;
+                e.c    = c;
+                e.next = next;
+                std::vector<Edge> &edges = m_states[state].edges;
+                edges.insert(std::lower_bound(edges.begin(), edges.end(), e),
+                             e);
+            }
+            state = next;
+        }
+        m_states[state].output |= bit;
+        m_built = false;
+        return bit;
+    }
+
+    /// \brief Computes the failure links after the last add().
+    void build(void)
+    {
+        // Breadth first, so the failure target of a state is always
+        // complete before the state itself is.
+        std::vector<uint> queue;
+        const std::vector<Edge> &root = m_states[0].edges;
+        for (size_t i = 0; i < root.size(); ++i)
+        {
+            m_states[root[i].next].fail = 0;
+            queue.push_back(root[i].next);
+        }
+        for (size_t q = 0; q < queue.size(); ++q)
+        {
+            uint state = queue[q];
+            const std::vector<Edge> &edges = m_states[state].edges;
+            for (size_t i = 0; i < edges.size(); ++i)
+            {
+                uint f = m_states[state].fail;
+                int target;
+                while ((target = goTo(f, edges[i].c)) < 0 && f)
+                    f = m_states[f].fail;
+                if (target < 0)
+                    target = 0;
+                State &child = m_states[edges[i].next];
+                child.fail    = target;
+                child.output |= m_states[target].output;
+                queue.push_back(edges[i].next);
+            }
+        }
+        m_built = true;
+    }
+
+    bool isBuilt(void) const { return m_built; }
+    uint size(void) const { return m_count; }
+
+    /// \brief Returns the bits of all keywords occurring in text.
+    quint64 scan(const QString &text) const
+    {
+        quint64 found = 0;
+        uint state = 0;
+        const QChar *p = text.constData();
+        const QChar *end = p + text.length();
+        for (; p != end; ++p)
+        {
+            ushort c = fold(*p);
+            int next;
+            while ((next = goTo(state, c)) < 0 && state)
+                state = m_states[state].fail;
+            state = (next < 0) ? 0 : next;
+            found |= m_states[state].output;
+        }
+        return found;
+    }
+
+  private:
+    struct Edge
+    {
+        ushort c;
+        uint   next;
+        bool operator<(const Edge &other) const { return c < other.c; }
+    };
+
+    struct State
+    {
+        State() : fail(0), output(0) {}
+        std::vector<Edge> edges;
+        uint              fail;
+        quint64           output;
+    };
+
+    ushort fold(QChar c) const
+    {
+        return (m_cs == Qt::CaseSensitive) ? c.unicode()
+                                           : c.toCaseFolded().unicode();
+    }
+
+    int goTo(uint state, ushort c) const
+    {
+        const std::vector<Edge> &edges = m_states[state].edges;
+        // Most states have one or two edges, a linear search is faster
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            if (edges[i].c == c)
+                return edges[i].next;
+            if (edges[i].c > c)
+                break;
+        }
+        return -1;
+    }
+
+    Qt::CaseSensitivity m_cs;
+    bool                m_built;
+    uint                m_count;
+    std::vector<State>  m_states;
+};
+
+#endif // __MYTH_KEYWORD_SCANNER_H__
@@ -22,7 +22,7 @@ HEADERS += mythlocale.h storagegroup.h
 HEADERS += mythcoreutil.h mythdownloadmanager.h mythtranslation.h
 HEADERS += unzip.h unzip_p.h zipentry_p.h iso639.h iso3166.h mythmedia.h
 HEADERS += mythmiscutil.h mythhdd.h mythcdrom.h autodeletedeque.h dbutil.h
-HEADERS += mythdeque.h mythlogging.h
+HEADERS += mythdeque.h mythlogging.h intervalindex.h keywordscanner.h
 HEADERS += mythbaseutil.h referencecounter.h referencecounterlist.h
 HEADERS += version.h mythcommandlineparser.h
 HEADERS += mythscheduler.h filesysteminfo.h hardwareprofile.h serverpool.h
@@ -76,7 +76,7 @@ inc.files += mythsocket.h mythsocket_cb.h mythlogging.h
 inc.files += mythcorecontext.h mythsystem.h storagegroup.h loggingserver.h
 inc.files += mythcoreutil.h mythlocale.h mythdownloadmanager.h
 inc.files += mythtranslation.h iso639.h iso3166.h mythmedia.h mythmiscutil.h
-inc.files += mythcdrom.h autodeletedeque.h dbutil.h mythdeque.h
+inc.files += mythcdrom.h autodeletedeque.h dbutil.h mythdeque.h intervalindex.h keywordscanner.h
 inc.files += referencecounter.h referencecounterlist.h mythcommandlineparser.h
 inc.files += mthread.h mthreadpool.h
 inc.files += filesysteminfo.h hardwareprofile.h bonjourregister.h serverpool.h
@@ -3,7 +3,6 @@
 #include <QMutexLocker>
 #include <QWaitCondition>
 #include <QList>
-#include <QQueue>
 #include <QHash>
 #include <QCoreApplication>
 #include <QFileInfo>
@@ -11,6 +10,7 @@
 #include <QMap>
 #include <QRegExp>
 #include <QVariantMap>
+#include <QtEndian>
 #include <iostream>
 
 using namespace std;
@@ -68,8 +68,75 @@ extern "C" {
 #include <android/log.h>
 #endif
 
+/// \brief Intrusive multiple producer, single consumer queue of
+///        LoggingItems.  Producers never block each other or the consumer,
+///        each enqueue is one atomic exchange.  Only the logging thread
+///        dequeues, or a producer holding logQueueMutex once that thread
+///        has finished.
+class LoggingQueue
+{
+  public:
+    LoggingQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+    /// \return true if the queue was empty
+    bool enqueue(LoggingItem *item)
+    {
+        bool wasEmpty = (m_count.fetchAndAddOrdered(1) == 0);
+        push(item);
+        return wasEmpty;
+    }
+
+    /// \return the oldest item, or NULL if there is none or the oldest is
+    ///         still being linked in by its producer
+    LoggingItem *dequeue(void)
+    {
+        LoggingQueueNode *tail = m_tail;
+        LoggingQueueNode *next = tail->m_next.loadAcquire();
+
+        if (tail == &m_stub)
+        {
+            if (!next)
+                return NULL;
+            m_tail = next;
+            tail = next;
+            next = next->m_next.loadAcquire();
+        }
+
+        if (!next)
+        {
+            // The tail can only be handed out once something follows it,
+            // so put the stub back behind it.
+            if (tail != m_head.loadAcquire())
+                return NULL;
+            push(&m_stub);
+            next = tail->m_next.loadAcquire();
+            if (!next)
+                return NULL;
+        }
+
+        m_tail = next;
+        m_count.fetchAndAddOrdered(-1);
+        return static_cast<LoggingItem *>(tail);
+    }
+
+    bool isEmpty(void) const { return m_count.loadAcquire() <= 0; }
+
+  private:
+    void push(LoggingQueueNode *node)
+    {
+        node->m_next.storeRelease(NULL);
+        LoggingQueueNode *prev = m_head.fetchAndStoreOrdered(node);
+        prev->m_next.storeRelease(node);
+    }
+
+    LoggingQueueNode                 m_stub;
+    QAtomicPointer<LoggingQueueNode> m_head;  ///< Last item pushed
+    LoggingQueueNode                *m_tail;  ///< Next item to pop
+    QAtomicInt                       m_count; ///< Items pushed, not popped
+};
+
 static QMutex                  logQueueMutex;
-static QQueue<LoggingItem *>   logQueue;
+static LoggingQueue            logQueue;
 static QRegExp                 logRegExp = QRegExp("[%]{1,2}");
 
 static LoggerThread           *logThread = NULL;
@@ -79,6 +146,10 @@ static QHash<uint64_t, char *> logThreadHash;
 static QMutex                   logThreadTidMutex;
 static QHash<uint64_t, int64_t> logThreadTidHash;
 
+static LoggingItem            *logItemPool[LOGITEM_POOL_SIZE];
+static QAtomicInt              logItemPoolUsed[LOGITEM_POOL_SIZE];
+static QAtomicInt              logItemPoolNext;
+
 static bool                    logThreadFinished = false;
 static bool                    debugRegistration = false;
 
@@ -98,6 +169,23 @@ QStringList             logPropagateArgList;
 #define TIMESTAMP_MAX 30
 #define MAX_STRING_LENGTH (LOGLINE_MAX+120)
 
+// Binary log record sent to mythlogserver.  Integers are little endian.
+//   0  uint8   magic           1  uint8   version
+//   2  uint8   type            3  int8    level
+//   4  int32   pid             8  int64   tid
+//  16  uint64  threadId       24  int64   epoch
+//  32  uint32  usec           36  int32   line
+//  40  int32   facility
+//  44  uint16  lengths of file, function, threadName, appName, table,
+//              logFile and message
+//  58  the strings themselves, not terminated
+// Bump the version for any change to this layout.  mythlogserver refuses
+// records of other versions and says so, rather than misreading them.
+#define LOGRECORD_MAGIC   0xB1
+#define LOGRECORD_VERSION 1
+#define LOGRECORD_STRINGS 7
+#define LOGRECORD_HEADER  (44 + 2 * LOGRECORD_STRINGS)
+
 LogLevel_t logLevel = (LogLevel_t)LOG_INFO;
 
 bool verboseInitialized = false;
@@ -144,54 +232,147 @@ void loggingGetTimeStamp(qlonglong *epoch, uint *usec)
 }
 
 LoggingItem::LoggingItem() :
-        ReferenceCounter("LoggingItem", false),
-        m_pid(-1), m_tid(-1), m_threadId(-1), m_usec(0), m_line(0),
-        m_type(kMessage), m_level((LogLevel_t)LOG_INFO), m_facility(0), m_epoch(0),
-        m_file(NULL), m_function(NULL), m_threadName(NULL), m_appName(NULL),
-        m_table(NULL), m_logFile(NULL)
+        ReferenceCounter("LoggingItem", false), m_poolSlot(-1)
 {
-    m_message[0]='\0';
-    m_message[LOGLINE_MAX]='\0';
+    clear();
 }
 
-LoggingItem::LoggingItem(const char *_file, const char *_function,
-                         int _line, LogLevel_t _level, LoggingType _type) :
-        ReferenceCounter("LoggingItem", false), m_pid(-1),
-        m_threadId((uint64_t)(QThread::currentThreadId())),
-        m_line(_line), m_type(_type), m_level(_level), m_facility(0),
-        m_file(strdup(_file)), m_function(strdup(_function)),
-        m_threadName(NULL), m_appName(NULL), m_table(NULL), m_logFile(NULL)
+LoggingItem::~LoggingItem()
 {
-    loggingGetTimeStamp(&m_epoch, &m_usec);
+}
 
-    m_message[0]='\0';
-    m_message[LOGLINE_MAX]='\0';
-    setThreadTid();
+/// \brief Reset all fields, as an item from the pool may have been used
+void LoggingItem::clear(void)
+{
+    m_pid = -1;
+    m_tid = -1;
+    m_threadId = (qulonglong)-1;
+    m_usec = 0;
+    m_line = 0;
+    m_type = kMessage;
+    m_level = (LogLevel_t)LOG_INFO;
+    m_facility = 0;
+    m_epoch = 0;
+    m_file[0] = '\0';
+    m_function[0] = '\0';
+    m_threadName[0] = '\0';
+    m_appName[0] = '\0';
+    m_table[0] = '\0';
+    m_logFile[0] = '\0';
+    m_message[0] = '\0';
+    m_message[LOGLINE_MAX] = '\0';
 }
 
-LoggingItem::~LoggingItem()
+/// \brief Copy a string into one of the inline fields, truncating it to fit
+void LoggingItem::copyArg(char *arg, size_t size, const char *val)
 {
-    free(m_file);
+    size_t len = val ? strlen(val) : 0;
+    if (len >= size)
+        len = size - 1;
+    if (len)
+        memcpy(arg, val, len);
+    arg[len] = '\0';
+}
 
-    free(m_function);
+/// \brief Take a free item from the pool, or from the heap if the pool is
+///        exhausted.  The pool items themselves are only allocated the first
+///        time their slot is used.
+LoggingItem *LoggingItem::acquire(void)
+{
+    uint start = (uint)logItemPoolNext.fetchAndAddRelaxed(1);
+    for (uint i = 0; i < LOGITEM_POOL_SIZE; i++)
+    {
+        uint slot = (start + i) % LOGITEM_POOL_SIZE;
+        if (!logItemPoolUsed[slot].testAndSetAcquire(0, 1))
+            continue;
 
-    free(m_threadName);
+        if (!logItemPool[slot])
+        {
+            logItemPool[slot] = new LoggingItem;
+            logItemPool[slot]->m_poolSlot = slot;
+        }
+        else
+            logItemPool[slot]->clear();
+        return logItemPool[slot];
+    }
 
-    free(m_appName);
+    return new LoggingItem;
+}
 
-    free(m_table);
+/// \brief Decrements the reference count, returning the item to the pool
+///        instead of deleting it when it reaches 0.
+int LoggingItem::DecrRef(void)
+{
+    if (m_poolSlot < 0)
+        return ReferenceCounter::DecrRef();
+
+    int val = m_referenceCount.fetchAndAddOrdered(-1) - 1;
+    if (val == 0)
+    {
+        m_referenceCount.fetchAndStoreOrdered(1);
+        logItemPoolUsed[m_poolSlot].fetchAndStoreRelease(0);
+    }
+    return val;
+}
 
-    free(m_logFile);
+/// \brief Encode the item as a binary log record for mythlogserver
+QByteArray LoggingItem::toByteArray(void) const
+{
+    QByteArray buf;
+    toByteArray(buf);
+    return buf;
 }
 
-QByteArray LoggingItem::toByteArray(void)
+/// \brief Encode the item as a binary log record for mythlogserver into buf,
+///        which does not need to allocate if it is reused.
+void LoggingItem::toByteArray(QByteArray &buf) const
 {
-    QVariantMap variant = QJsonWrapper::qobject2qvariant(this);
-    QByteArray json = QJsonWrapper::toJson(variant);
+    const char *strings[LOGRECORD_STRINGS] =
+        { m_file, m_function, m_threadName, m_appName, m_table, m_logFile,
+          m_message };
+    int lengths[LOGRECORD_STRINGS];
 
-    //cout << json.constData() << endl;
+    int size = LOGRECORD_HEADER;
+    for (int i = 0; i < LOGRECORD_STRINGS; i++)
+    {
+        lengths[i] = strlen(strings[i]);
+        size += lengths[i];
+    }
+    buf.resize(size);
+
+    uchar *p = (uchar *)buf.data();
+    p[0] = LOGRECORD_MAGIC;
+    p[1] = LOGRECORD_VERSION;
+    p[2] = (uchar)m_type;
+    p[3] = (uchar)(int8_t)m_level;
+    qToLittleEndian<qint32>(m_pid, p + 4);
+    qToLittleEndian<qint64>(m_tid, p + 8);
+    qToLittleEndian<quint64>(m_threadId, p + 16);
+    qToLittleEndian<qint64>(m_epoch, p + 24);
+    qToLittleEndian<quint32>(m_usec, p + 32);
+    qToLittleEndian<qint32>(m_line, p + 36);
+    qToLittleEndian<qint32>(m_facility, p + 40);
+    for (int i = 0; i < LOGRECORD_STRINGS; i++)
+        qToLittleEndian<quint16>(lengths[i], p + 44 + 2 * i);
+
+    p += LOGRECORD_HEADER;
+    for (int i = 0; i < LOGRECORD_STRINGS; i++)
+    {
+        memcpy(p, strings[i], lengths[i]);
+        p += lengths[i];
+    }
+}
 
-    return json;
+/// \brief Identify the format of a record received by mythlogserver
+/// \return The binary record version, 0 for the JSON of older clients
+///         or -1 if it is neither
+int LoggingItem::recordVersion(const QByteArray &buf)
+{
+    if (buf.size() >= 2 && (uchar)buf[0] == LOGRECORD_MAGIC)
+        return (uchar)buf[1];
+    if (buf.startsWith('{'))
+        return 0;
+    return -1;
 }
 
 /// \brief Get the name of the thread that produced the LoggingItem
@@ -200,7 +381,7 @@ char *LoggingItem::getThreadName(void)
 {
     static const char  *unknown = "thread_unknown";
 
-    if( m_threadName )
+    if( m_threadName[0] )
         return m_threadName;
 
     QMutexLocker locker(&logThreadMutex);
@@ -274,6 +455,12 @@ LoggerThread::LoggerThread(QString filename, bool progress, bool quiet,
     }
     m_locallogs = (m_appname == MYTH_APPNAME_MYTHLOGSERVER);
 
+    m_filenameRaw = m_filename.toLocal8Bit();
+    m_appnameRaw = m_appname.toLocal8Bit();
+    m_tablenameRaw = m_tablename.toLocal8Bit();
+    m_record.reserve(LOGRECORD_HEADER + 6 * LOGFIELD_MAX + LOGPATH_MAX +
+                     LOGLINE_MAX);
+
 #ifdef NOLOGSERVER
     if (!m_noserver && !logServerStart())
     {
@@ -384,35 +571,33 @@ void LoggerThread::run(void)
     #endif
     }
 
-    QMutexLocker qLock(&logQueueMutex);
-
-    while (!m_aborted || !logQueue.isEmpty())
+    while (true)
     {
-        qLock.unlock();
         qApp->processEvents(QEventLoop::AllEvents, 10);
         qApp->sendPostedEvents(NULL, QEvent::DeferredDelete);
 
-        qLock.relock();
+        // Handle whatever is queued up without taking the lock, but come
+        // back to the event loop now and then for the heartbeat.
+        LoggingItem *item;
+        int count = 0;
+        while (count++ < LOGITEM_POOL_SIZE && (item = logQueue.dequeue()))
+        {
+            fillItem(item);
+            handleItem(item);
+            logConsole(item);
+            item->DecrRef();
+        }
+
+        QMutexLocker qLock(&logQueueMutex);
         if (logQueue.isEmpty())
         {
+            if (m_aborted)
+                break;
             m_waitEmpty->wakeAll();
             m_waitNotEmpty->wait(qLock.mutex(), 100);
-            continue;
         }
-
-        LoggingItem *item = logQueue.dequeue();
-        qLock.unlock();
-
-        fillItem(item);
-        handleItem(item);
-        logConsole(item);
-        item->DecrRef();
-
-        qLock.relock();
     }
 
-    qLock.unlock();
-
     // This must be before the timer stop below or we deadlock when the timer
     // thread tries to deregister, and we wait for it.
     logThreadFinished = true;
@@ -618,7 +803,10 @@ void LoggerThread::handleItem(LoggingItem *item)
 #ifndef NOLOGSERVER
         // Send it to mythlogserver
         if (!logThreadFinished && m_zmqSocket)
-            m_zmqSocket->sendMessage(item->toByteArray());
+        {
+            item->toByteArray(m_record);
+            m_zmqSocket->sendMessage(m_record);
+        }
 #else
         if (logServerThread)
         {
@@ -715,16 +903,32 @@ bool LoggerThread::flush(int timeoutMS)
     return logQueue.isEmpty();
 }
 
+/// \brief Wake the logging thread if it is waiting for the queue to fill
+void LoggerThread::wakeNotEmpty(void)
+{
+    QMutexLocker qLock(&logQueueMutex);
+    m_waitNotEmpty->wakeAll();
+}
+
 void LoggerThread::fillItem(LoggingItem *item)
 {
     if (!item)
         return;
 
     item->setPid(m_pid);
-    item->setThreadName(item->getThreadName());
-    item->setAppName(m_appname);
-    item->setTable(m_tablename);
-    item->setLogFile(m_filename);
+    if (!item->m_threadName[0])
+    {
+        QMutexLocker locker(&logThreadMutex);
+        LoggingItem::copyArg(item->m_threadName, sizeof(item->m_threadName),
+                             logThreadHash.value(item->m_threadId,
+                                                 (char *)"thread_unknown"));
+    }
+    LoggingItem::copyArg(item->m_appName, sizeof(item->m_appName),
+                         m_appnameRaw.constData());
+    LoggingItem::copyArg(item->m_table, sizeof(item->m_table),
+                         m_tablenameRaw.constData());
+    LoggingItem::copyArg(item->m_logFile, sizeof(item->m_logFile),
+                         m_filenameRaw.constData());
     item->setFacility(m_facility);
 }
 
@@ -741,18 +945,84 @@ LoggingItem *LoggingItem::create(const char *_file,
                                  int _line, LogLevel_t _level,
                                  LoggingType _type)
 {
-    LoggingItem *item = new LoggingItem(_file, _function, _line, _level, _type);
+    LoggingItem *item = acquire();
+
+    item->m_threadId = (uint64_t)(QThread::currentThreadId());
+    item->m_line = _line;
+    item->m_type = _type;
+    item->m_level = _level;
+    copyArg(item->m_file, sizeof(item->m_file), _file);
+    copyArg(item->m_function, sizeof(item->m_function), _function);
+    loggingGetTimeStamp(&item->m_epoch, &item->m_usec);
+    item->setThreadTid();
 
     return item;
 }
 
+/// \brief  Create a LoggingItem from a binary log record
+/// \param  buf    the record, as made by toByteArray(), or the JSON sent
+///                by clients of the previous release
+/// \return LoggingItem that was created, or NULL if buf is not a valid record
 LoggingItem *LoggingItem::create(QByteArray &buf)
 {
-    // Deserialize buffer
-    QVariant variant = QJsonWrapper::parseJson(buf);
+    const uchar *p = (const uchar *)buf.constData();
+    int size = buf.size();
 
-    LoggingItem *item = new LoggingItem;
-    QJsonWrapper::qvariant2qobject(variant.toMap(), item);
+    // TODO Remove JSON support after the next release
+    if (recordVersion(buf) == 0)
+    {
+        bool ok;
+        QVariant variant = QJsonWrapper::parseJson(buf, &ok);
+        if (!ok || variant.type() != QVariant::Map)
+            return NULL;
+
+        LoggingItem *item = acquire();
+        QJsonWrapper::qvariant2qobject(variant.toMap(), item);
+        return item;
+    }
+
+    if (size < LOGRECORD_HEADER || p[0] != LOGRECORD_MAGIC ||
+        p[1] != LOGRECORD_VERSION)
+        return NULL;
+
+    int lengths[LOGRECORD_STRINGS];
+    int total = LOGRECORD_HEADER;
+    for (int i = 0; i < LOGRECORD_STRINGS; i++)
+    {
+        lengths[i] = qFromLittleEndian<quint16>(p + 44 + 2 * i);
+        total += lengths[i];
+    }
+    if (total != size)
+        return NULL;
+
+    LoggingItem *item = acquire();
+
+    item->m_type = (LoggingType)p[2];
+    item->m_level = (LogLevel_t)(int8_t)p[3];
+    item->m_pid = qFromLittleEndian<qint32>(p + 4);
+    item->m_tid = qFromLittleEndian<qint64>(p + 8);
+    item->m_threadId = qFromLittleEndian<quint64>(p + 16);
+    item->m_epoch = qFromLittleEndian<qint64>(p + 24);
+    item->m_usec = qFromLittleEndian<quint32>(p + 32);
+    item->m_line = qFromLittleEndian<qint32>(p + 36);
+    item->m_facility = qFromLittleEndian<qint32>(p + 40);
+
+    char *strings[LOGRECORD_STRINGS] =
+        { item->m_file, item->m_function, item->m_threadName, item->m_appName,
+          item->m_table, item->m_logFile, item->m_message };
+    size_t sizes[LOGRECORD_STRINGS] =
+        { sizeof(item->m_file), sizeof(item->m_function),
+          sizeof(item->m_threadName), sizeof(item->m_appName),
+          sizeof(item->m_table), sizeof(item->m_logFile), LOGLINE_MAX + 1 };
+
+    const char *src = (const char *)p + LOGRECORD_HEADER;
+    for (int i = 0; i < LOGRECORD_STRINGS; i++)
+    {
+        size_t len = qMin((size_t)lengths[i], sizes[i] - 1);
+        memcpy(strings[i], src, len);
+        strings[i][len] = '\0';
+        src += lengths[i];
+    }
 
     return item;
 }
@@ -799,31 +1069,33 @@ void LogPrintLine( uint64_t mask, LogLevel_t level, const char *file, int line,
     if (formatcopy)
         free(formatcopy);
 
-    QMutexLocker qLock(&logQueueMutex);
-
 #if defined( _MSC_VER ) && defined( _DEBUG )
         OutputDebugStringA( item->m_message );
         OutputDebugStringA( "\n" );
 #endif
 
-    logQueue.enqueue(item);
+    bool wasEmpty = logQueue.enqueue(item);
 
     if (logThread && logThreadFinished && !logThread->isRunning())
     {
-        while (!logQueue.isEmpty())
+        // The lock makes us the only consumer of the queue
+        QMutexLocker qLock(&logQueueMutex);
+        while ((item = logQueue.dequeue()))
         {
-            item = logQueue.dequeue();
-            qLock.unlock();
             logThread->handleItem(item);
             logThread->logConsole(item);
             item->DecrRef();
-            qLock.relock();
         }
     }
     else if (logThread && !logThreadFinished && (type & kFlush))
     {
+        QMutexLocker qLock(&logQueueMutex);
         logThread->flush();
     }
+    else if (logThread && wasEmpty)
+    {
+        logThread->wakeNotEmpty();
+    }
 }
 
 
@@ -963,8 +1235,6 @@ void loggingRegisterThread(const QString &name)
     if (logThreadFinished)
         return;
 
-    QMutexLocker qLock(&logQueueMutex);
-
     LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__,
                                             __LINE__, (LogLevel_t)LOG_DEBUG,
                                             kRegistering);
@@ -982,8 +1252,6 @@ void loggingDeregisterThread(void)
     if (logThreadFinished)
         return;
 
-    QMutexLocker qLock(&logQueueMutex);
-
     LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__, __LINE__,
                                             (LogLevel_t)LOG_DEBUG,
                                             kDeregistering);
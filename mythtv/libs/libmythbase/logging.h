@@ -6,6 +6,8 @@
 #include <QQueue>
 #include <QTime>
 #include <QPointer>
+#include <QAtomicPointer>
+#include <QByteArray>
 
 #include <stdint.h>
 #include <stdlib.h>
@@ -34,6 +36,11 @@ namespace nzmqt {
 }
 
 #define LOGLINE_MAX (2048-120)
+#define LOGFIELD_MAX 255    ///< Longest file, function, thread or app name
+#define LOGPATH_MAX  1023   ///< Longest logfile path
+
+/// Number of LoggingItems kept for reuse rather than freed
+#define LOGITEM_POOL_SIZE 128
 
 class QString;
 class MSqlQuery;
@@ -59,13 +66,25 @@ class LoggerThread;
 typedef struct tm tmType;
 
 #define SET_LOGGING_ARG(arg){ \
-                                free(arg); \
-                                arg = strdup(val.toLocal8Bit().constData()); \
+                                copyArg(arg, sizeof(arg), \
+                                        val.toLocal8Bit().constData()); \
                             }
 
+/// \brief Link used to chain LoggingItems in the lock-free logging queue
+class LoggingQueueNode
+{
+  public:
+    QAtomicPointer<LoggingQueueNode> m_next;
+};
+
 /// \brief The logging items that are generated by LOG() and are sent to the
 ///        console and to mythlogserver via ZeroMQ
-class LoggingItem: public QObject, public ReferenceCounter
+///
+/// Items come from a fixed pool and go back to it when the last reference
+/// is dropped, so a LOG() call does not touch the heap.  All the strings are
+/// held inline for the same reason, and are truncated if they don't fit.
+class LoggingItem: public QObject, public ReferenceCounter,
+                   public LoggingQueueNode
 {
     Q_OBJECT
 
@@ -97,7 +116,11 @@ class LoggingItem: public QObject, public ReferenceCounter
     static LoggingItem *create(const char *, const char *, int, LogLevel_t,
                                LoggingType);
     static LoggingItem *create(QByteArray &buf);
-    QByteArray toByteArray(void);
+    QByteArray toByteArray(void) const;
+    void toByteArray(QByteArray &buf) const;
+    static int recordVersion(const QByteArray &buf);
+
+    virtual int DecrRef(void);
 
     int                 pid() const         { return m_pid; };
     qlonglong           tid() const         { return m_tid; };
@@ -146,6 +169,8 @@ class LoggingItem: public QObject, public ReferenceCounter
     const char *rawMessage() const     { return m_message; };
 
   protected:
+    static void copyArg(char *arg, size_t size, const char *val);
+
     int                 m_pid;
     qlonglong           m_tid;
     qulonglong          m_threadId;
@@ -155,19 +180,21 @@ class LoggingItem: public QObject, public ReferenceCounter
     LogLevel_t          m_level;
     int                 m_facility;
     qlonglong           m_epoch;
-    char               *m_file;
-    char               *m_function;
-    char               *m_threadName;
-    char               *m_appName;
-    char               *m_table;
-    char               *m_logFile;
+    char                m_file[LOGFIELD_MAX+1];
+    char                m_function[LOGFIELD_MAX+1];
+    char                m_threadName[LOGFIELD_MAX+1];
+    char                m_appName[LOGFIELD_MAX+1];
+    char                m_table[LOGFIELD_MAX+1];
+    char                m_logFile[LOGPATH_MAX+1];
     char                m_message[LOGLINE_MAX+1];
 
   private:
     LoggingItem();
-    LoggingItem(const char *_file, const char *_function,
-                int _line, LogLevel_t _level, LoggingType _type);
     ~LoggingItem();
+    static LoggingItem *acquire(void);
+    void clear(void);
+
+    int                 m_poolSlot; ///< Slot in the item pool, -1 if none
 };
 
 /// \brief The logging thread that consumes the logging queue and dispatches
@@ -187,10 +214,12 @@ class LoggerThread : public QObject, public MThread
     bool flush(int timeoutMS = 200000);
     void handleItem(LoggingItem *item);
     void fillItem(LoggingItem *item);
+    void wakeNotEmpty(void);
   private:
     QWaitCondition *m_waitNotEmpty; ///< Condition variable for waiting
                                     ///  for the queue to not be empty
-                                    ///  Protected by logQueueMutex
+                                    ///  Protected by logQueueMutex, which
+                                    ///  producers only take to wake us
     QWaitCondition *m_waitEmpty;    ///< Condition variable for waiting
                                     ///  for the queue to be empty
                                     ///  Protected by logQueueMutex
@@ -203,6 +232,11 @@ class LoggerThread : public QObject, public MThread
     int  m_quiet;       ///< silence the console (console only)
     QString m_appname;      ///< Cached application name
     QString m_tablename;    ///< Cached table name for db logging
+    QByteArray m_filenameRaw;   ///< m_filename as copied into each item
+    QByteArray m_appnameRaw;    ///< m_appname as copied into each item
+    QByteArray m_tablenameRaw;  ///< m_tablename as copied into each item
+    QByteArray m_record;    ///< Buffer each item is encoded into for
+                            ///  mythlogserver, reused to avoid allocation
     int m_facility;         ///< Cached syslog facility (or -1 to disable)
     pid_t m_pid;            ///< Cached pid value
     bool m_locallogs;       ///< Are we logging locally (i.e. this is the
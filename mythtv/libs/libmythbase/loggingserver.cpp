@@ -5,6 +5,7 @@
 #include <QList>
 #include <QQueue>
 #include <QHash>
+#include <QSet>
 #include <QCoreApplication>
 #include <QFileInfo>
 #include <QStringList>
@@ -82,6 +83,9 @@ typedef QMap<LoggerBase *, ClientList *> RevClientMap;
 
 static QMutex                       logClientMapMutex;
 static ClientMap                    logClientMap;
+/// Clients whose records can't be read, so they are only warned about once.
+/// Protected by logClientMapMutex
+static QSet<QString>                logBadClients;
 
 static QAtomicInt                   logClientCount;
 
@@ -1056,8 +1060,10 @@ void FileLogger::receivedMessage(const QList<QByteArray> &msg)
     }
 #endif
 
-    QByteArray json     = msg.at(1);
-    LoggingItem *item   = LoggingItem::create(json);
+    QByteArray record   = msg.at(1);
+    LoggingItem *item   = LoggingItem::create(record);
+    if (!item)
+        return;
     logmsg(item);
     item->DecrRef();
 }
@@ -1079,8 +1085,10 @@ void SyslogLogger::receivedMessage(const QList<QByteArray> &msg)
     }
 #endif
 
-    QByteArray json     = msg.at(1);
-    LoggingItem *item   = LoggingItem::create(json);
+    QByteArray record   = msg.at(1);
+    LoggingItem *item   = LoggingItem::create(record);
+    if (!item)
+        return;
     logmsg(item);
     item->DecrRef();
 }
@@ -1112,8 +1120,10 @@ void DatabaseLogger::receivedMessage(const QList<QByteArray> &msg)
     }
 #endif
 
-    QByteArray json     = msg.at(1);
-    LoggingItem *item   = LoggingItem::create(json);
+    QByteArray record   = msg.at(1);
+    LoggingItem *item   = LoggingItem::create(record);
+    if (!item)
+        return;
     logmsg(item);
     item->DecrRef();
 }
@@ -1335,9 +1345,9 @@ void LogForwardThread::forwardMessage(LogMessage *msg)
     QByteArray clientBa = msg->first();
     QString clientId = QString(clientBa.toHex());
 
-    QByteArray json     = msg->at(1);
+    QByteArray record   = msg->at(1);
 
-    if (json.size() == 0)
+    if (record.size() == 0)
     {
         // This is either a ping response or a first gasp
         logClientMapMutex.lock();
@@ -1366,7 +1376,22 @@ void LogForwardThread::forwardMessage(LogMessage *msg)
     }
     else
     {
-        LoggingItem *item = LoggingItem::create(json);
+        LoggingItem *item = LoggingItem::create(record);
+        if (!item)
+        {
+            // Warn once per client, a mismatched client sends nothing else
+            if (!logBadClients.contains(clientId))
+            {
+                logBadClients.insert(clientId);
+                LOG(VB_GENERAL, LOG_WARNING,
+                    QString("Dropping log records from client %1, "
+                            "record version %2 is not supported. "
+                            "Is it from another MythTV version?")
+                    .arg(clientId).arg(LoggingItem::recordVersion(record)));
+            }
+            return;
+        }
+        logBadClients.remove(clientId);
 
         logClientCount.ref();
         LOG(VB_FILE, LOG_DEBUG, QString("New Logging Client: ID: %1 (#%2)")
@@ -1451,7 +1476,7 @@ void LogForwardThread::forwardMessage(LogMessage *msg)
     if (logItem && logItem->list && !logItem->list->isEmpty())
     {
         LoggerList::iterator it = logItem->list->begin();
-        LoggingItem *item = LoggingItem::create(json);
+        LoggingItem *item = LoggingItem::create(record);
         if (!item)
             return;
         for (; it != logItem->list->end(); ++it)
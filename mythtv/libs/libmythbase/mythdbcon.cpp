@@ -30,6 +30,7 @@
 #endif
 
 static const uint kPurgeTimeout = 60 * 60;
+static const int  kPreparedCacheSize = 64; // per connection
 
 bool TestDatabase(QString dbHostName,
                   QString dbUserName,
@@ -70,7 +71,7 @@ bool TestDatabase(QString dbHostName,
     return ret;
 }
 
-MSqlDatabase::MSqlDatabase(const QString &name)
+MSqlDatabase::MSqlDatabase(const QString &name) : m_generation(0)
 {
     m_name = name;
     m_name.detach();
@@ -97,6 +98,8 @@ MSqlDatabase::MSqlDatabase(const QString &name)
 
 MSqlDatabase::~MSqlDatabase()
 {
+    ClearPreparedQueries();
+
     if (m_db.isOpen())
     {
         m_db.close();
@@ -131,6 +134,8 @@ bool MSqlDatabase::OpenDatabase(bool skipdb)
 
     if (!m_db.isOpen())
     {
+        ClearPreparedQueries();
+
         if (!skipdb)
             m_dbparms = GetMythDB()->GetDatabaseParams();
         m_db.setDatabaseName(m_dbparms.dbName);
@@ -238,13 +243,17 @@ bool MSqlDatabase::KickDatabase(void)
     m_lastDBKick = MythDate::current().addSecs(-60);
 
     if (!m_db.isOpen())
+    {
+        ClearPreparedQueries();
         m_db.open();
+    }
 
     return m_db.isOpen();
 }
 
 bool MSqlDatabase::Reconnect()
 {
+    ClearPreparedQueries();
     m_db.close();
     m_db.open();
 
@@ -266,11 +275,58 @@ void MSqlDatabase::InitSessionVars()
     m_db.exec("SET @@session.sql_mode=''");
 }
 
+/// \brief Take the cached prepared statement for query, if there is one.
+///
+/// The statement is removed from the cache while the caller uses it, so two
+/// MSqlQuery objects on one connection never share a statement.
+bool MSqlDatabase::TakePreparedQuery(const QString &query, QSqlQuery &handle)
+{
+    QMutexLocker locker(&m_preparedLock);
+
+    QHash<QString, QSqlQuery>::iterator it = m_prepared.find(query);
+    if (it == m_prepared.end())
+        return false;
+
+    handle = *it;
+    m_prepared.erase(it);
+    m_preparedLRU.removeOne(query);
+    return true;
+}
+
+/// \brief Put a statement from TakePreparedQuery() or a new one back in the
+///        cache, dropping the least recently used one if the cache is full.
+void MSqlDatabase::ReturnPreparedQuery(const QString &query,
+                                       const QSqlQuery &handle,
+                                       uint generation)
+{
+    QMutexLocker locker(&m_preparedLock);
+
+    // Prepared before a reconnect, or someone else already put one back
+    if (generation != m_generation || m_prepared.contains(query))
+        return;
+
+    m_prepared.insert(query, handle);
+    m_preparedLRU.prepend(query);
+
+    if (m_preparedLRU.size() > kPreparedCacheSize)
+        m_prepared.remove(m_preparedLRU.takeLast());
+}
+
+/// \brief Drop all cached statements, they don't survive the session.
+void MSqlDatabase::ClearPreparedQueries(void)
+{
+    QMutexLocker locker(&m_preparedLock);
+
+    m_prepared.clear();
+    m_preparedLRU.clear();
+    m_generation++;
+}
+
 // -----------------------------------------------------------------------
 
 
 
-MDBManager::MDBManager()
+MDBManager::MDBManager() : m_preparedHits(0), m_preparedMisses(0)
 {
     m_nextConnID = 0;
     m_connCount = 0;
@@ -478,6 +534,7 @@ void MDBManager::CloseDatabases()
     {
         LOG(VB_DATABASE, LOG_INFO,
             "Closing DB connection named '" + (*it)->m_name + "'");
+        (*it)->ClearPreparedQueries();
         (*it)->m_db.close();
         delete (*it);
         m_connCount--;
@@ -490,6 +547,7 @@ void MDBManager::CloseDatabases()
         MSqlDatabase *db = slist.takeFirst();
         LOG(VB_DATABASE, LOG_INFO,
             "Closing DB connection named '" + db->m_name + "'");
+        db->ClearPreparedQueries();
         db->m_db.close();
         delete db;
 
@@ -499,6 +557,10 @@ void MDBManager::CloseDatabases()
             m_DDCon = NULL;
     }
     m_lock.unlock();
+
+    LOG(VB_DATABASE, LOG_INFO,
+        QString("Prepared statement cache: %1 hits, %2 misses")
+            .arg(GetPreparedHits()).arg(GetPreparedMisses()));
 }
 
 
@@ -518,6 +580,8 @@ MSqlQuery::MSqlQuery(const MSqlQueryInfo &qi)
     m_isConnected = false;
     m_db = qi.db;
     m_returnConnection = qi.returnConnection;
+    m_prepared = false;
+    m_preparedGeneration = 0;
 
     m_isConnected = m_db && m_db->isOpen();
 
@@ -528,6 +592,8 @@ MSqlQuery::MSqlQuery(const MSqlQueryInfo &qi)
 
 MSqlQuery::~MSqlQuery()
 {
+    ReleasePrepared();
+
     if (m_returnConnection)
     {
         MDBManager *dbmanager = GetMythDB()->GetDBManager();
@@ -729,6 +795,9 @@ bool MSqlQuery::exec(const QString &query)
         return false;
     }
 
+    // This replaces any prepared statement in our handle
+    m_prepared = false;
+
     bool result = QSqlQuery::exec(query);
 
     // if the query failed with "MySQL server has gone away"
@@ -815,6 +884,9 @@ bool MSqlQuery::prepare(const QString& query)
         return false;
     }
 
+    // Give back the statement we hold under the text it was prepared with
+    ReleasePrepared();
+
     m_last_prepared_query = query;
 
 #ifdef DEBUG_QT4_PORT
@@ -843,20 +915,50 @@ bool MSqlQuery::prepare(const QString& query)
         return false;
     }
 
-    // QT docs indicate that there are significant speed ups and a reduction
-    // in memory usage by enabling forward-only cursors
-    //
-    // Unconditionally enable this since all existing uses of the database
-    // iterate forward over the result set.
-    setForwardOnly(true);
-
-    bool ok = QSqlQuery::prepare(query);
+    MDBManager *dbmanager = GetMythDB()->GetDBManager();
+    bool ok;
 
-    // if the prepare failed with "MySQL server has gone away"
-    // Close and reopen the database connection and retry the query if it
-    // connects again
-    if (!ok && QSqlQuery::lastError().number() == 2006 && Reconnect())
+    if (m_db->TakePreparedQuery(query, *this))
+    {
+        // Cached statements were prepared forward-only, below, but still
+        // hold the last user's values. A fresh prepare starts with every
+        // placeholder unbound, which MySQL gets as NULL, and callers which
+        // only bind some of them rely on that.
+        int bound = QSqlQuery::boundValues().size();
+        for (int i = 0; i < bound; ++i)
+            QSqlQuery::bindValue(i, QVariant(), QSql::In);
+
+        if (dbmanager)
+            dbmanager->m_preparedHits.ref();
         ok = true;
+    }
+    else
+    {
+        if (dbmanager)
+            dbmanager->m_preparedMisses.ref();
+
+        // Our handle may still be shared with the statement we just
+        // gave back to the cache, so start from a fresh one.
+        QSqlQuery::operator=(QSqlQuery(m_db->db()));
+
+        // QT docs indicate that there are significant speed ups and a
+        // reduction in memory usage by enabling forward-only cursors
+        //
+        // Unconditionally enable this since all existing uses of the
+        // database iterate forward over the result set.
+        setForwardOnly(true);
+
+        ok = QSqlQuery::prepare(query);
+
+        // if the prepare failed with "MySQL server has gone away"
+        // Close and reopen the database connection and retry the query if
+        // it connects again
+        if (!ok && QSqlQuery::lastError().number() == 2006 && Reconnect())
+            ok = true;
+    }
+
+    m_prepared = ok;
+    m_preparedGeneration = m_db->GetGeneration();
 
     if (!ok && !(GetMythDB()->SuppressDBMessages()))
     {
@@ -920,13 +1022,27 @@ bool MSqlQuery::Reconnect(void)
     if (!m_last_prepared_query.isEmpty())
     {
         MSqlBindings tmp = QSqlQuery::boundValues();
-        if (!QSqlQuery::prepare(m_last_prepared_query))
+        m_prepared = QSqlQuery::prepare(m_last_prepared_query);
+        m_preparedGeneration = m_db->GetGeneration();
+        if (!m_prepared)
             return false;
         bindValues(tmp);
     }
     return true;
 }
 
+/// \brief Give the statement in our handle back to the connection's cache
+void MSqlQuery::ReleasePrepared(void)
+{
+    if (!m_prepared || !m_db)
+        return;
+
+    m_prepared = false;
+    QSqlQuery::finish();
+    m_db->ReturnPreparedQuery(m_last_prepared_query, *this,
+                              m_preparedGeneration);
+}
+
 void MSqlAddMoreBindings(MSqlBindings &output, MSqlBindings &addfrom)
 {
     MSqlBindings::Iterator it;
@@ -10,6 +10,8 @@
 #include <QDateTime>
 #include <QMutex>
 #include <QList>
+#include <QHash>
+#include <QAtomicInt>
 
 #include "mythbaseexp.h"
 #include "mythdbparams.h"
@@ -42,11 +44,25 @@ class MSqlDatabase
     bool Reconnect(void);
     void InitSessionVars(void);
 
+    bool TakePreparedQuery(const QString &query, QSqlQuery &handle);
+    void ReturnPreparedQuery(const QString &query, const QSqlQuery &handle,
+                             uint generation);
+    void ClearPreparedQueries(void);
+    uint GetGeneration(void) const { return m_generation; }
+
   private:
     QString m_name;
     QSqlDatabase m_db;
     QDateTime m_lastDBKick;
     DatabaseParams m_dbparms;
+
+    /// Prepared statements not in use by an MSqlQuery, by query text.
+    /// Every statement is tied to the session it was prepared in, so the
+    /// cache is emptied and m_generation bumped whenever we reconnect.
+    QMutex m_preparedLock;
+    QHash<QString, QSqlQuery> m_prepared;   // protected by m_preparedLock
+    QList<QString> m_preparedLRU;           // protected by m_preparedLock
+    uint m_generation;
 };
 
 /// \brief DB connection pool, used by MSqlQuery. Do not use directly.
@@ -60,6 +76,14 @@ class MBASE_PUBLIC MDBManager
     void CloseDatabases(void);
     void PurgeIdleConnections(bool leaveOne = false);
 
+    /// \brief Number of MSqlQuery::prepare() calls which reused a cached
+    ///        prepared statement
+    uint GetPreparedHits(void) const { return m_preparedHits.loadAcquire(); }
+    /// \brief Number of MSqlQuery::prepare() calls which had to prepare
+    ///        the statement on the server
+    uint GetPreparedMisses(void) const
+        { return m_preparedMisses.loadAcquire(); }
+
   protected:
     MSqlDatabase *popConnection(bool reuse);
     void pushConnection(MSqlDatabase *db);
@@ -84,6 +108,9 @@ class MBASE_PUBLIC MDBManager
     MSqlDatabase *m_schedCon;
     MSqlDatabase *m_DDCon;
     QHash<QThread*, DBList> m_static_pool;
+
+    QAtomicInt m_preparedHits;
+    QAtomicInt m_preparedMisses;
 };
 
 /// \brief MSqlDatabase Info, used by MSqlQuery. Do not use directly.
@@ -157,6 +184,10 @@ class MBASE_PUBLIC MSqlQuery : private QSqlQuery
     bool exec(const QString &query);
 
     /// \brief QSqlQuery::prepare() is not thread safe in Qt <= 3.3.2
+    ///
+    /// Statements are cached per connection, so preparing the same query
+    /// text again is normally free.  Bind every placeholder before each
+    /// exec(), since a reused statement still holds its last values.
     bool prepare(const QString &query);
 
     void bindValue(const QString &placeholder, const QVariant &val);
@@ -218,11 +249,14 @@ class MBASE_PUBLIC MSqlQuery : private QSqlQuery
 
     bool seekDebug(const char *type, bool result,
                    int where, bool relative) const;
+    void ReleasePrepared(void);
 
     MSqlDatabase *m_db;
     bool m_isConnected;
     bool m_returnConnection;
     QString m_last_prepared_query; // holds a copy of the last prepared query
+    bool m_prepared;        // m_last_prepared_query is prepared in our handle
+    uint m_preparedGeneration;  // MSqlDatabase generation it was prepared in
 #ifdef DEBUG_QT4_PORT
     QRegExp m_testbindings;
 #endif
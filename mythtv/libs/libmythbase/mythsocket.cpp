@@ -533,6 +533,24 @@ int MythSocket::Write(const char *data, int size)
     return ret;
 }
 
+/** \brief Waits until everything passed to Write() or WriteStringList()
+ *         has been handed to the operating system.
+ *
+ *  This must be called before writing to the socket descriptor directly,
+ *  e.g. with sendfile(2), so data is not sent out of order.
+ */
+bool MythSocket::WaitForBytesWritten(int max_wait_ms)
+{
+    bool ret = false;
+    QMetaObject::invokeMethod(
+        this, "WaitForBytesWrittenReal",
+        (QThread::currentThread() != m_thread->qthread()) ?
+        Qt::BlockingQueuedConnection : Qt::DirectConnection,
+        Q_ARG(int, max_wait_ms),
+        Q_ARG(bool*, &ret));
+    return ret;
+}
+
 int MythSocket::Read(char *data, int size, int max_wait_ms)
 {
     int ret = -1;
@@ -1026,6 +1044,18 @@ void MythSocket::ReadReal(char *data, int size, int max_wait_ms, int *ret)
         (m_tcpSocket->bytesAvailable() > 0) ? 1 : 0);
 }
 
+void MythSocket::WaitForBytesWrittenReal(int max_wait_ms, bool *ret)
+{
+    MythTimer t; t.start();
+    while ((m_tcpSocket->state() == QAbstractSocket::ConnectedState) &&
+           (m_tcpSocket->bytesToWrite() > 0) &&
+           (t.elapsed() < max_wait_ms))
+    {
+        m_tcpSocket->waitForBytesWritten(max(2, max_wait_ms - t.elapsed()));
+    }
+    *ret = (m_tcpSocket->bytesToWrite() == 0);
+}
+
 void MythSocket::ResetReal(void)
 {
     vector<char> trash;
@@ -67,6 +67,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     int Write(const char*, int size);
     int Read(char*, int size, int max_wait_ms);
     void Reset(void);
+    bool WaitForBytesWritten(int max_wait_ms);
 
     static const uint kShortTimeout;
     static const uint kLongTimeout;
@@ -90,6 +91,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     void WriteReal(const char*, int size, int *ret);
     void ReadReal(char*, int size, int max_wait_ms, int *ret);
     void ResetReal(void);
+    void WaitForBytesWrittenReal(int max_wait_ms, bool *ret);
 
     void IsDataAvailableReal(bool *ret) const;
 
@@ -308,6 +308,11 @@ void MythSystemLegacy::Term(bool force)
     d->Term(force);
 }
 
+qint64 MythSystemLegacy::GetPid(void) const
+{
+    return d ? d->GetPid() : 0;
+}
+
 void MythSystemLegacy::Signal(MythSignal sig)
 {
     if (!d)
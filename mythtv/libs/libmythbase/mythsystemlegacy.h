@@ -107,6 +107,8 @@ class MBASE_PUBLIC MythSystemLegacy : public QObject
     // FIXME: Can Term be wrapped into Signal?
     void Term(bool force = false);
     void Signal(MythSignal);
+    /// Process id of the child, 0 if it has not been started
+    qint64 GetPid(void) const;
 
     // FIXME: Should be IsBackground() + documented
     bool isBackground(void)   { return GetSetting("RunInBackground"); }
@@ -35,6 +35,7 @@ class MythSystemLegacyPrivate : public QObject, public ReferenceCounter
     virtual void Term(bool force=false) = 0;
     virtual void Signal(int sig) = 0;
     virtual void JumpAbort(void) = 0;
+    virtual qint64 GetPid(void) const = 0;
 
     virtual bool ParseShell(const QString &cmd, QString &abscmd,
                             QStringList &args) = 0;
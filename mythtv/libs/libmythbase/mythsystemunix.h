@@ -95,6 +95,7 @@ class MBASE_PUBLIC MythSystemLegacyUnix : public MythSystemLegacyPrivate
         virtual void Term(bool force=false) MOVERRIDE;
         virtual void Signal(int sig) MOVERRIDE;
         virtual void JumpAbort(void) MOVERRIDE;
+        virtual qint64 GetPid(void) const MOVERRIDE { return m_pid; }
 
         virtual bool ParseShell(const QString &cmd, QString &abscmd,
                                 QStringList &args) MOVERRIDE;
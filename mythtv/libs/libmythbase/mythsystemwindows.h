@@ -94,6 +94,8 @@ class MBASE_PUBLIC MythSystemLegacyWindows : public MythSystemLegacyPrivate
         virtual void Term(bool force=false) MOVERRIDE;
         virtual void Signal(int sig) MOVERRIDE;
         virtual void JumpAbort(void) MOVERRIDE;
+        virtual qint64 GetPid(void) const MOVERRIDE
+            { return m_child ? GetProcessId(m_child) : 0; }
 
         virtual bool ParseShell(const QString &cmd, QString &abscmd,
                                 QStringList &args) MOVERRIDE;
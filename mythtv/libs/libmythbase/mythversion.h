@@ -44,8 +44,8 @@
  *       http://www.mythtv.org/wiki/Category:Myth_Protocol_Commands
  *       http://www.mythtv.org/wiki/Category:Myth_Protocol
  */
-#define MYTH_PROTO_VERSION "88"
-#define MYTH_PROTO_TOKEN "XmasGift"
+#define MYTH_PROTO_VERSION "91"
+#define MYTH_PROTO_TOKEN "PackedPine"
 
 /** \brief Increment this whenever the MythTV core database schema changes.
  *
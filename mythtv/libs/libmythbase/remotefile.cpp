@@ -1223,6 +1223,36 @@ void RemoteFile::SetTimeout(bool fast)
     timeoutisfast = fast;
 }
 
+/**
+ * GetTransferStats: returns the backend's counters for this transfer.
+ * These are the bytes sent, the bytes of those sent with sendfile(), the
+ * number of blocks sent, the ms spent sending them and the ms since the
+ * transfer was opened. Empty for local files or if the backend failed.
+ */
+QStringList RemoteFile::GetTransferStats(void)
+{
+    if (isLocal())
+        return QStringList();
+
+    QMutexLocker locker(&lock);
+
+    if (!CheckConnection())
+    {
+        LOG(VB_NETWORK, LOG_ERR,
+            "RemoteFile::GetTransferStats(): Couldn't connect");
+        return QStringList();
+    }
+
+    QStringList strlist( QString(query).arg(recordernum) );
+    strlist << "REQUEST_STATS";
+
+    if (!controlSock->SendReceiveStringList(strlist, 5) ||
+        strlist.size() != 5)
+        return QStringList();
+
+    return strlist;
+}
+
 QDateTime RemoteFile::LastModified(const QString &url)
 {
     if (isLocal(url))
@@ -60,6 +60,7 @@ class MBASE_PUBLIC RemoteFile
     bool isLocal(void) const;
     long long GetFileSize(void) const;
     long long GetRealFileSize(void);
+    QStringList GetTransferStats(void);
 
     QStringList GetAuxiliaryFiles(void) const
         { return auxfiles; }
@@ -0,0 +1,215 @@
+/*
+ *  Class TestIntervalIndex
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <vector>
+using namespace std;
+
+#include "test_intervalindex.h"
+#include "intervalindex.h"
+
+typedef IntervalIndex<int, int> TestIndex;
+
+struct TestInterval
+{
+    int start;
+    int end;
+};
+
+static vector<int> values(const TestIndex::Matches &matches)
+{
+    vector<int> result;
+    for (uint i = 0; i < matches.size(); ++i)
+        result.push_back(matches[i].second);
+    return result;
+}
+
+static vector<int> linear(const vector<TestInterval> &list, int start, int end)
+{
+    vector<int> result;
+    for (uint i = 0; i < list.size(); ++i)
+    {
+        if (list[i].end < start || list[i].start > end)
+            continue;
+        result.push_back(i);
+    }
+    return result;
+}
+
+void TestIntervalIndex::empty(void)
+{
+    TestIndex index;
+    TestIndex::Matches result;
+
+    index.build();
+    index.intersecting(0, 100, result);
+    QVERIFY(result.empty());
+    QVERIFY(index.empty());
+}
+
+void TestIntervalIndex::closed_intervals(void)
+{
+    TestIndex index;
+    index.insert(0, 10, 1);
+    index.insert(10, 20, 2);
+    index.insert(21, 30, 3);
+    index.build();
+
+    TestIndex::Matches result;
+    index.intersecting(10, 10, result);
+    QCOMPARE(result.size(), (size_t)2);
+    QCOMPARE(result[0].second, 1);
+    QCOMPARE(result[1].second, 2);
+
+    // Earlier matches are replaced
+    index.intersecting(20, 21, result);
+    QCOMPARE(result.size(), (size_t)2);
+    QCOMPARE(result[0].second, 2);
+    QCOMPARE(result[1].second, 3);
+
+    index.intersecting(31, 40, result);
+    QVERIFY(result.empty());
+}
+
+void TestIntervalIndex::insertion_order(void)
+{
+    TestIndex index;
+    index.insert(50, 60, 0);
+    index.insert(0, 100, 1);
+    index.insert(55, 56, 2);
+    index.insert(10, 52, 3);
+    index.build();
+
+    TestIndex::Matches result;
+    index.intersecting(51, 55, result);
+    QCOMPARE(result.size(), (size_t)4);
+    for (int i = 0; i < 4; ++i)
+    {
+        QCOMPARE(result[i].first, (size_t)i);
+        QCOMPARE(result[i].second, i);
+    }
+}
+
+void TestIntervalIndex::random_data(void)
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("maxlen");
+
+    QTest::newRow("short") << 1000 << 10;
+    QTest::newRow("long") << 1000 << 5000;
+    QTest::newRow("mixed") << 5000 << 500;
+    QTest::newRow("one") << 1 << 10;
+}
+
+void TestIntervalIndex::random(void)
+{
+    QFETCH(int, count);
+    QFETCH(int, maxlen);
+
+    qsrand(count + maxlen);
+
+    vector<TestInterval> list;
+    TestIndex index;
+    for (int i = 0; i < count; ++i)
+    {
+        TestInterval t;
+        t.start = qrand() % 10000;
+        t.end = t.start + qrand() % maxlen;
+        list.push_back(t);
+        index.insert(t.start, t.end, i);
+    }
+    index.build();
+
+    TestIndex::Matches result;
+    for (int i = 0; i < 1000; ++i)
+    {
+        int start = qrand() % 11000 - 500;
+        int end = start + qrand() % maxlen;
+        index.intersecting(start, end, result);
+        QVERIFY(values(result) == linear(list, start, end));
+    }
+}
+
+void TestIntervalIndex::benchmark_schedule_data(void)
+{
+    QTest::addColumn<bool>("useIndex");
+
+    QTest::newRow("Index") << true;
+    QTest::newRow("Linear") << false;
+}
+
+void TestIntervalIndex::benchmark_schedule(void)
+{
+    QFETCH(bool, useIndex);
+
+    // 200 channels of half hour and hour long shows for 14 days, with
+    // one in eight of them matching a rule.  Recordings start up to 2
+    // minutes early and end up to 5 minutes late.
+    vector<TestInterval> list;
+    qsrand(42);
+    for (int chan = 0; chan < 200; ++chan)
+    {
+        int t = 0;
+        while (t < 14 * 24 * 3600)
+        {
+            int len = (qrand() % 2 + 1) * 1800;
+            if (qrand() % 8 == 0)
+            {
+                TestInterval r;
+                r.start = t - (qrand() % 3) * 60;
+                r.end = t + len + (qrand() % 6) * 60;
+                list.push_back(r);
+            }
+            t += len;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    uint64_t queries = 0;
+    uint64_t found = 0;
+    QBENCHMARK
+    {
+        if (useIndex)
+        {
+            TestIndex index;
+            for (uint i = 0; i < list.size(); ++i)
+                index.insert(list[i].start, list[i].end, i);
+            index.build();
+
+            TestIndex::Matches result;
+            for (uint i = 0; i < list.size(); ++i)
+            {
+                index.intersecting(list[i].start, list[i].end, result);
+                found += result.size();
+            }
+        }
+        else
+        {
+            for (uint i = 0; i < list.size(); ++i)
+                found += linear(list, list[i].start, list[i].end).size();
+        }
+        queries += list.size();
+    }
+    qint64 ns = timer.nsecsElapsed();
+    QVERIFY(found >= queries);
+    qDebug() << QString("%1 recordings, %2 queries/sec")
+        .arg(list.size())
+        .arg(ns ? (queries * 1000000000.0 / ns) : 0.0, 0, 'f', 0);
+}
+
+QTEST_APPLESS_MAIN(TestIntervalIndex)
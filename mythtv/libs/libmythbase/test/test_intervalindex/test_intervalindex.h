@@ -0,0 +1,42 @@
+/*
+ *  Class TestIntervalIndex
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+class TestIntervalIndex: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void empty(void);
+
+    /** intervals which only touch the query intersect it */
+    void closed_intervals(void);
+
+    /** matches come back in insertion order, not start order */
+    void insertion_order(void);
+
+    /** random intervals must give the same matches as a linear scan */
+    void random_data(void);
+    void random(void);
+
+    /** conflict checks for two weeks of a large guide, one query per
+     *  candidate recording like SchedNewRecords() does */
+    void benchmark_schedule_data(void);
+    void benchmark_schedule(void);
+};
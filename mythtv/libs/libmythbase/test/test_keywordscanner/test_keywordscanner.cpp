@@ -0,0 +1,113 @@
+/*
+ *  Class TestKeywordScanner
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_keywordscanner.h"
+#include "keywordscanner.h"
+
+void TestKeywordScanner::empty(void)
+{
+    KeywordScanner scanner;
+    scanner.build();
+    QCOMPARE(scanner.scan("anything"), (quint64)0);
+
+    QCOMPARE(scanner.add(""), (quint64)0);
+    quint64 a = scanner.add("a");
+    scanner.build();
+    QCOMPARE(scanner.scan(""), (quint64)0);
+    QCOMPARE(scanner.scan("bab"), a);
+}
+
+void TestKeywordScanner::overlapping(void)
+{
+    KeywordScanner scanner;
+    quint64 he   = scanner.add("he");
+    quint64 she  = scanner.add("she");
+    quint64 his  = scanner.add("his");
+    quint64 hers = scanner.add("hers");
+    scanner.build();
+
+    QCOMPARE(scanner.scan("ushers"), he | she | hers);
+    QCOMPARE(scanner.scan("ahishe"), he | she | his);
+    QCOMPARE(scanner.scan("hhhhh"), (quint64)0);
+}
+
+void TestKeywordScanner::case_sensitivity(void)
+{
+    KeywordScanner folded;
+    quint64 a = folded.add("Also in HD");
+    folded.build();
+    QCOMPARE(folded.scan("Drama. ALSO IN hd."), a);
+
+    KeywordScanner exact(Qt::CaseSensitive);
+    quint64 b = exact.add("Also in HD");
+    exact.build();
+    QCOMPARE(exact.scan("Drama. ALSO IN hd."), (quint64)0);
+    QCOMPARE(exact.scan("Drama. Also in HD."), b);
+}
+
+void TestKeywordScanner::random_data(void)
+{
+    QTest::addColumn<int>("keywords");
+    QTest::addColumn<int>("alphabet");
+
+    QTest::newRow("few") << 4 << 3;
+    QTest::newRow("many") << 64 << 4;
+    QTest::newRow("wide") << 32 << 26;
+}
+
+void TestKeywordScanner::random(void)
+{
+    QFETCH(int, keywords);
+    QFETCH(int, alphabet);
+
+    qsrand(keywords + alphabet);
+
+    QStringList list;
+    KeywordScanner scanner;
+    for (int i = 0; i < keywords; ++i)
+    {
+        QString word;
+        int len = qrand() % 5 + 1;
+        for (int j = 0; j < len; ++j)
+            word += QChar('a' + qrand() % alphabet);
+        list << word;
+        scanner.add(word);
+    }
+    scanner.build();
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        QString text;
+        int len = qrand() % 40;
+        for (int j = 0; j < len; ++j)
+        {
+            QChar c('a' + qrand() % alphabet);
+            text += (qrand() % 2) ? c.toUpper() : c;
+        }
+
+        quint64 expected = 0;
+        for (int k = 0; k < list.size(); ++k)
+        {
+            if (text.contains(list[k], Qt::CaseInsensitive))
+                expected |= 1ULL << k;
+        }
+        QCOMPARE(scanner.scan(text), expected);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestKeywordScanner)
@@ -0,0 +1,244 @@
+/*
+ *  Class TestLogging
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <vector>
+using namespace std;
+
+#include "test_logging.h"
+#include "mythlogging.h"
+#include "logging.h"
+
+static LoggingItem *make_item(void)
+{
+    LoggingItem *item = LoggingItem::create(
+        "recorders/dvbstreamhandler.cpp", "RunTS", 371,
+        (LogLevel_t)LOG_INFO, kMessage);
+    item->setPid(4242);
+    item->setTid(4243);
+    item->setFacility(3);
+    item->setThreadName("DVBRead");
+    item->setAppName("mythbackend");
+    item->setTable("logging");
+    item->setLogFile("/var/log/mythtv/mythbackend.log");
+    item->setMessage("DVBSH[0](/dev/dvb/adapter0/frontend0): "
+                     "RunTS(): begin");
+    return item;
+}
+
+void TestLogging::record_roundtrip(void)
+{
+    LoggingItem *item = make_item();
+    item->setLevel(LOG_ANY);
+    QByteArray record = item->toByteArray();
+
+    LoggingItem *copy = LoggingItem::create(record);
+    QVERIFY(copy != NULL);
+    QCOMPARE(copy->pid(), item->pid());
+    QCOMPARE(copy->tid(), item->tid());
+    QCOMPARE(copy->threadId(), item->threadId());
+    QCOMPARE(copy->usec(), item->usec());
+    QCOMPARE(copy->line(), item->line());
+    QCOMPARE(copy->type(), item->type());
+    QCOMPARE(copy->level(), (int)LOG_ANY);
+    QCOMPARE(copy->facility(), item->facility());
+    QCOMPARE(copy->epoch(), item->epoch());
+    QCOMPARE(copy->file(), item->file());
+    QCOMPARE(copy->function(), item->function());
+    QCOMPARE(copy->threadName(), item->threadName());
+    QCOMPARE(copy->appName(), item->appName());
+    QCOMPARE(copy->table(), item->table());
+    QCOMPARE(copy->logFile(), item->logFile());
+    QCOMPARE(copy->message(), item->message());
+
+    // Reusing a buffer gives the same record
+    QByteArray buf("something much longer than we will need for this");
+    buf.resize(4096);
+    item->toByteArray(buf);
+    QCOMPARE(buf, record);
+
+    copy->DecrRef();
+    item->DecrRef();
+}
+
+void TestLogging::record_malformed(void)
+{
+    LoggingItem *item = make_item();
+    QByteArray record = item->toByteArray();
+    item->DecrRef();
+
+    QByteArray buf = record.left(record.size() - 1);
+    QVERIFY(LoggingItem::create(buf) == NULL);
+
+    buf = record + 'x';
+    QVERIFY(LoggingItem::create(buf) == NULL);
+
+    buf = record.left(10);
+    QVERIFY(LoggingItem::create(buf) == NULL);
+
+    buf = "{\"message\":";
+    QVERIFY(LoggingItem::create(buf) == NULL);
+
+    buf = "[\"message\"]";
+    QVERIFY(LoggingItem::create(buf) == NULL);
+
+    buf = QByteArray();
+    QVERIFY(LoggingItem::create(buf) == NULL);
+    QCOMPARE(LoggingItem::recordVersion(buf), -1);
+}
+
+void TestLogging::record_version(void)
+{
+    LoggingItem *item = make_item();
+    QByteArray record = item->toByteArray();
+    item->DecrRef();
+
+    QCOMPARE(LoggingItem::recordVersion(record), (int)(uchar)record[1]);
+    QVERIFY(LoggingItem::recordVersion(record) > 0);
+
+    // A record from another version is refused even if it would parse
+    record[1] = (char)(record[1] + 1);
+    QCOMPARE(LoggingItem::recordVersion(record), (int)(uchar)record[1]);
+    QVERIFY(LoggingItem::create(record) == NULL);
+}
+
+void TestLogging::record_json(void)
+{
+    // As sent by clients of the previous release
+    QByteArray buf(
+        "{\"appName\":\"mythfrontend\",\"epoch\":1476662400,"
+        "\"facility\":-1,\"file\":\"mythmainwindow.cpp\","
+        "\"function\":\"Init\",\"level\":6,\"line\":1042,"
+        "\"logFile\":\"/var/log/mythtv/mythfrontend.log\","
+        "\"message\":\"Using Frameless Window\",\"pid\":4242,"
+        "\"table\":\"\",\"threadId\":140245,\"threadName\":\"UI\","
+        "\"tid\":4243,\"type\":1,\"usec\":500}");
+    QCOMPARE(LoggingItem::recordVersion(buf), 0);
+
+    LoggingItem *item = LoggingItem::create(buf);
+    QVERIFY(item != NULL);
+    QCOMPARE(item->pid(), 4242);
+    QCOMPARE(item->tid(), (qlonglong)4243);
+    QCOMPARE(item->threadId(), (qulonglong)140245);
+    QCOMPARE(item->usec(), (uint)500);
+    QCOMPARE(item->line(), 1042);
+    QCOMPARE(item->type(), 1);
+    QCOMPARE(item->level(), 6);
+    QCOMPARE(item->facility(), -1);
+    QCOMPARE(item->epoch(), (qlonglong)1476662400);
+    QCOMPARE(item->file(), QString("mythmainwindow.cpp"));
+    QCOMPARE(item->function(), QString("Init"));
+    QCOMPARE(item->threadName(), QString("UI"));
+    QCOMPARE(item->appName(), QString("mythfrontend"));
+    QCOMPARE(item->table(), QString());
+    QCOMPARE(item->logFile(), QString("/var/log/mythtv/mythfrontend.log"));
+    QCOMPARE(item->message(), QString("Using Frameless Window"));
+    item->DecrRef();
+}
+
+void TestLogging::long_strings(void)
+{
+    QString name(LOGFIELD_MAX * 2, 'n');
+    QString path(LOGPATH_MAX * 2, 'p');
+    QString message(LOGLINE_MAX * 2, 'm');
+
+    LoggingItem *item = make_item();
+    item->setThreadName(name);
+    item->setLogFile(path);
+    item->setMessage(message);
+    QCOMPARE(item->threadName(), name.left(LOGFIELD_MAX));
+    QCOMPARE(item->logFile(), path.left(LOGPATH_MAX));
+    QCOMPARE(item->message(), message.left(LOGLINE_MAX));
+
+    QByteArray record = item->toByteArray();
+    LoggingItem *copy = LoggingItem::create(record);
+    QVERIFY(copy != NULL);
+    QCOMPARE(copy->threadName(), item->threadName());
+    QCOMPARE(copy->logFile(), item->logFile());
+    QCOMPARE(copy->message(), item->message());
+
+    copy->DecrRef();
+    item->DecrRef();
+}
+
+void TestLogging::item_pool(void)
+{
+    for (int i = 0; i < LOGITEM_POOL_SIZE * 3; ++i)
+    {
+        LoggingItem *item = LoggingItem::create(
+            "file", "function", i, (LogLevel_t)LOG_DEBUG, kMessage);
+        QCOMPARE(item->message(), QString());
+        QCOMPARE(item->threadName(), QString());
+        QCOMPARE(item->line(), i);
+        item->setMessage("used");
+        item->setThreadName("used");
+        item->DecrRef();
+    }
+
+    // Hold more items than the pool has, with an extra reference on some
+    // like the database logger takes.
+    vector<LoggingItem *> items;
+    for (int i = 0; i < LOGITEM_POOL_SIZE + 16; ++i)
+    {
+        LoggingItem *item = LoggingItem::create(
+            "file", "function", i, (LogLevel_t)LOG_DEBUG, kMessage);
+        item->setMessage(QString::number(i));
+        if (i % 2)
+            item->IncrRef();
+        items.push_back(item);
+    }
+    for (uint i = 0; i < items.size(); ++i)
+    {
+        QCOMPARE(items[i]->message(), QString::number(i));
+        for (uint j = 0; j < i; ++j)
+            QVERIFY(items[i] != items[j]);
+    }
+    for (uint i = 0; i < items.size(); ++i)
+    {
+        if (i % 2)
+            QCOMPARE(items[i]->DecrRef(), 1);
+        QCOMPARE(items[i]->DecrRef(), 0);
+    }
+}
+
+void TestLogging::benchmark_encode(void)
+{
+    LoggingItem *item = make_item();
+    QByteArray buf;
+
+    QElapsedTimer timer;
+    timer.start();
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    QBENCHMARK
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            item->toByteArray(buf);
+            bytes += buf.size();
+        }
+        records += 1000;
+    }
+    qint64 ns = timer.nsecsElapsed();
+    item->DecrRef();
+
+    qDebug() << QString("%1 bytes per record, %2 records/sec")
+        .arg(bytes / records)
+        .arg(ns ? (records * 1000000000.0 / ns) : 0.0, 0, 'f', 0);
+}
+
+QTEST_APPLESS_MAIN(TestLogging)
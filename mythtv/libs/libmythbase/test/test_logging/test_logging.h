@@ -0,0 +1,47 @@
+/*
+ *  Class TestLogging
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+class TestLogging: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /** an item survives being sent to mythlogserver and back */
+    void record_roundtrip(void);
+
+    /** truncated or foreign buffers are refused, not misread */
+    void record_malformed(void);
+
+    /** records of another binary version are refused */
+    void record_version(void);
+
+    /** the JSON of the previous release is still read */
+    void record_json(void);
+
+    /** strings too long for their field are cut, not overrun */
+    void long_strings(void);
+
+    /** items from the pool come back cleared, and the heap is used
+     *  once the pool runs out */
+    void item_pool(void);
+
+    /** cost of encoding an item for mythlogserver */
+    void benchmark_encode(void);
+};
@@ -0,0 +1,169 @@
+/*
+ *  Class TestMythDBCon
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "mythdbcon.h"
+#include "mythdb.h"
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+#define MSKIP(MSG) QSKIP(MSG, SkipAll)
+#else
+#define MSKIP(MSG) QSKIP(MSG)
+#endif
+
+/**
+ * These need a MySQL server. They use the one in the MYTHTEST_DBHOST,
+ * MYTHTEST_DBUSER, MYTHTEST_DBPASS and MYTHTEST_DBNAME environment
+ * variables, or the usual mythtv/mythtv login on localhost, and are
+ * skipped if it can't be reached.
+ */
+class TestMythDBCon : public QObject
+{
+    Q_OBJECT
+
+  private:
+    static QString env(const char *name, const QString &def)
+    {
+        QString val = QString::fromLocal8Bit(qgetenv(name));
+        return val.isEmpty() ? def : val;
+    }
+
+    /// Runs the query prepared in "query" and returns the one value
+    /// it selects
+    static int selected(MSqlQuery &query)
+    {
+        if (!query.exec() || !query.next())
+            return -1;
+        return query.value(0).toInt();
+    }
+
+  private slots:
+    void initTestCase(void)
+    {
+        if (!QSqlDatabase::isDriverAvailable("QMYSQL"))
+            MSKIP("The Qt MySQL driver is not installed");
+
+        DatabaseParams params;
+        params.dbHostName   = env("MYTHTEST_DBHOST", "localhost");
+        params.dbHostPing   = false;
+        params.dbPort       = 3306;
+        params.dbUserName   = env("MYTHTEST_DBUSER", "mythtv");
+        params.dbPassword   = env("MYTHTEST_DBPASS", "mythtv");
+        params.dbName       = env("MYTHTEST_DBNAME", "mythconverg");
+        params.dbType       = "QMYSQL";
+        params.localEnabled = false;
+        params.wolEnabled   = false;
+        params.wolReconnect = 1;
+        params.wolRetry     = 3;
+        GetMythDB()->SetDatabaseParams(params);
+
+        MSqlQuery query(MSqlQuery::InitCon());
+        if (!query.isConnected())
+            MSKIP("No database to test with");
+    }
+
+    /**
+     * Preparing a second query on the same MSqlQuery runs the second
+     * query, also when both come from the prepared statement cache.
+     */
+    void prepareTwoQueries_test(void)
+    {
+        MSqlQuery query(MSqlQuery::InitCon());
+
+        for (uint i = 0; i < 3; i++)
+        {
+            query.prepare("SELECT 1");
+            QCOMPARE(selected(query), 1);
+
+            query.prepare("SELECT 2");
+            QCOMPARE(selected(query), 2);
+        }
+    }
+
+    /**
+     * A statement given back by one MSqlQuery is reused by the next one
+     * which prepares the same text.
+     */
+    void reuseStatement_test(void)
+    {
+        MDBManager *dbmanager = GetMythDB()->GetDBManager();
+
+        {
+            MSqlQuery query(MSqlQuery::InitCon());
+            query.prepare("SELECT 3");
+            QCOMPARE(selected(query), 3);
+        }
+
+        uint hits = dbmanager->GetPreparedHits();
+        {
+            MSqlQuery query(MSqlQuery::InitCon());
+            query.prepare("SELECT 3");
+            QCOMPARE(selected(query), 3);
+        }
+        QCOMPARE(dbmanager->GetPreparedHits(), hits + 1);
+    }
+
+    /**
+     * A reused statement starts with no values bound, like a new one, so
+     * a placeholder left unbound is NULL rather than the last value.
+     */
+    void reusedStatementUnbound_test(void)
+    {
+        {
+            MSqlQuery query(MSqlQuery::InitCon());
+            query.prepare("SELECT IFNULL(:VALUE, -1)");
+            query.bindValue(":VALUE", 6);
+            QCOMPARE(selected(query), 6);
+        }
+
+        uint hits = GetMythDB()->GetDBManager()->GetPreparedHits();
+        {
+            MSqlQuery query(MSqlQuery::InitCon());
+            query.prepare("SELECT IFNULL(:VALUE, -1)");
+            QCOMPARE(selected(query), -1);
+        }
+        QCOMPARE(GetMythDB()->GetDBManager()->GetPreparedHits(), hits + 1);
+    }
+
+    /**
+     * Two MSqlQuery objects on one connection never share a statement.
+     */
+    void nestedQueries_test(void)
+    {
+        MSqlQuery outer(MSqlQuery::InitCon());
+        outer.prepare("SELECT 4 UNION ALL SELECT 5");
+        QVERIFY(outer.exec());
+
+        int expected = 4;
+        while (outer.next())
+        {
+            QCOMPARE(outer.value(0).toInt(), expected++);
+
+            MSqlQuery inner(MSqlQuery::InitCon());
+            inner.prepare("SELECT 4 UNION ALL SELECT 5");
+            QCOMPARE(selected(inner), 4);
+        }
+        QCOMPARE(expected, 6);
+    }
+
+    void cleanupTestCase(void)
+    {
+        GetMythDB()->GetDBManager()->CloseDatabases();
+    }
+};
@@ -2027,7 +2027,8 @@ QString ImageManagerFe::ScanImagesAction(bool start, bool local)
 /*!
  * \brief Returns storage group scanner status
  * \return QStringList State ("ERROR" | "OK"), SG scanner id "1",
- * Progress count, Total
+ * Progress count, Total, Images/sec, Scan duration (ms). When idle the rate &
+ * duration are those of the last scan
  */
 QStringList ImageManagerFe::ScanQuery()
 {
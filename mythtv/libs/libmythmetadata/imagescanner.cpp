@@ -1,10 +1,121 @@
 #include "imagescanner.h"
 
+#include <QCoreApplication>
+#include <QDateTime>
+
 #include "mythlogging.h"
 #include "mythcorecontext.h"  // for events
 
 #include "imagemetadata.h"
 
+//! Number of dir entries that walkers may read ahead of the scanner
+static const int kReadAheadLimit = 20000;
+
+//! Quiet period after a watched dir changes before a scan is started, ms
+static const int kSettleTime = 5000;
+
+
+/*!
+ \brief Constructor
+ \details Lives in the application thread, whose event loop delivers the
+ filesystem notifications
+ \param listener Scanner to notify of changes
+*/
+ImageScanWatcher::ImageScanWatcher(ImageScanListener &listener)
+    : QObject(), m_listener(listener),
+      m_watcher(new QFileSystemWatcher(this)), m_settle(new QTimer(this)),
+      m_changed(), m_mutex()
+{
+    m_settle->setSingleShot(true);
+    m_settle->setInterval(kSettleTime);
+
+    connect(m_watcher, SIGNAL(directoryChanged(const QString &)),
+            this,      SLOT(DirChanged(const QString &)));
+    connect(m_settle,  SIGNAL(timeout()), this, SLOT(Settled()));
+
+    moveToThread(QCoreApplication::instance()->thread());
+}
+
+
+/*!
+ \brief Replaces the watched dirs
+ \details May be called from any thread
+ \param dirs Absolute paths of dirs to watch. Empty stops watching
+*/
+void ImageScanWatcher::Watch(const QStringList &dirs)
+{
+    QMetaObject::invokeMethod(this, "SetDirs", Qt::QueuedConnection,
+                              Q_ARG(QStringList, dirs));
+}
+
+
+/*!
+ \brief Returns dirs that have changed since the last call
+ \return QSet<QString> Absolute paths of changed dirs
+*/
+QSet<QString> ImageScanWatcher::TakeChanged()
+{
+    QMutexLocker locker(&m_mutex);
+    QSet<QString> changed = m_changed;
+    m_changed.clear();
+    return changed;
+}
+
+
+/*!
+ \brief Updates watches to match a list of dirs
+ \param dirs Absolute paths of dirs to watch
+*/
+void ImageScanWatcher::SetDirs(const QStringList &dirs)
+{
+    QSet<QString> wanted  = dirs.toSet();
+    QSet<QString> current = m_watcher->directories().toSet();
+
+    QStringList stale = (current - wanted).toList();
+    QStringList added = (wanted - current).toList();
+
+    if (!stale.isEmpty())
+        m_watcher->removePaths(stale);
+    if (!added.isEmpty())
+        m_watcher->addPaths(added);
+
+    int watched = m_watcher->directories().size();
+    if (watched < wanted.size())
+        LOG(VB_GENERAL, LOG_WARNING,
+            QString("Only watching %1 of %2 image dirs (inotify limit ?)")
+            .arg(watched).arg(wanted.size()));
+    else
+        LOG(VB_FILE, LOG_INFO, QString("Watching %1 image dirs").arg(watched));
+}
+
+
+/*!
+ \brief Notes a changed dir and (re)starts the quiet period
+ \param path Absolute path of changed dir
+*/
+void ImageScanWatcher::DirChanged(const QString &path)
+{
+    LOG(VB_FILE, LOG_DEBUG, QString("Directory %1 changed").arg(path));
+
+    m_mutex.lock();
+    m_changed.insert(path);
+    m_mutex.unlock();
+
+    // Wait for copies/moves to finish
+    m_settle->start();
+}
+
+
+/*!
+ \brief Notifies the scanner once dirs have stopped changing
+*/
+void ImageScanWatcher::Settled()
+{
+    LOG(VB_FILE, LOG_INFO, "Image dirs have changed");
+    m_listener.DirsChanged();
+}
+
+
 /*!
  \brief Constructor
  \param dbfs Database/filesystem adapter
@@ -13,14 +124,21 @@
 template <class DBFS>
 ImageScanThread<DBFS>::ImageScanThread(DBFS *const dbfs, ImageThumb<DBFS> *thumbGen)
     : MThread("ImageScanner"),
-      m_scanning(false), m_mutexState(),
+      m_scanning(false), m_rescan(false), m_watchScan(false), m_mutexState(),
       m_clearQueue(),    m_mutexQueue(),
       m_dbfs(*dbfs),
       m_thumb(*thumbGen),
       m_dbDirMap(), m_dbFileMap(), m_seenDir(), m_seenFile(),
       m_changedImages(),
-      m_bcastTimer(),
-      m_progressCount(0), m_progressTotalCount(0), m_mutexProgress(),
+      m_dbDirs(), m_dbDirsByParent(), m_dbFilesByParent(),
+      m_dirtyDirs(), m_scannedDirs(),
+      m_incremental(false), m_lastScanStart(0), m_skippedDirs(0),
+      m_walkers(), m_readAhead(), m_claimed(), m_readAheadSize(0),
+      m_walkStop(false), m_walkTaken(), m_mutexWalk(),
+      m_bcastTimer(), m_scanTimer(),
+      m_progressCount(0), m_progressTotalCount(0),
+      m_lastScanTime(0), m_lastScanCount(0), m_mutexProgress(),
+      m_watcher(new ImageScanWatcher(*this)),
       m_dir(m_dbfs.GetImageFilters()),
       m_exclusions()
 { }
@@ -31,6 +149,7 @@ ImageScanThread<DBFS>::~ImageScanThread()
 {
     cancel();
     wait();
+    delete m_watcher;
 }
 
 
@@ -46,6 +165,7 @@ void ImageScanThread<DBFS>::cancel()
 
     QMutexLocker locker(&m_mutexState);
     m_scanning = false;
+    m_rescan   = false;
 }
 
 
@@ -86,6 +206,10 @@ void ImageScanThread<DBFS>::ChangeState(bool scan)
     QMutexLocker locker(&m_mutexState);
     m_scanning = scan;
 
+    // Requested scans are full so that files rewritten in place are found
+    if (scan)
+        m_watchScan = false;
+
     // Restart thread if not already running
     if (!isRunning())
         start();
@@ -105,21 +229,54 @@ void ImageScanThread<DBFS>::EnqueueClear(int devId, const QString &action)
     m_clearQueue << qMakePair(devId, action);
     m_mutexQueue.unlock();
 
+    // Watches are restored by the next scan
+    m_watcher->Clear();
+
     ChangeState(false);
 }
 
 
+/*!
+ \brief Starts a scan because watched dirs have changed
+ \details If a scan is already running, another will follow it
+*/
+template <class DBFS>
+void ImageScanThread<DBFS>::DirsChanged()
+{
+    QMutexLocker locker(&m_mutexState);
+    if (m_scanning)
+        m_rescan = true;
+    else
+        m_watchScan = true;
+    m_scanning = true;
+
+    // Restart thread if not already running
+    if (!isRunning())
+        start();
+}
+
+
 /*!
  \brief Returns number of images scanned & total number to scan
- \return QStringList (scanner id, #done, #total)
+ \details Also returns the rate & duration of the scan. When idle these are
+ for the last scan.
+ \return QStringList (scanner id, #done, #total, images/sec, duration ms)
 */
 template <class DBFS>
 QStringList ImageScanThread<DBFS>::GetProgress()
 {
     QMutexLocker locker(&m_mutexProgress);
+
+    bool   scanning = m_progressTotalCount > 0;
+    qint64 ms       = scanning ? m_scanTimer.elapsed() : m_lastScanTime;
+    int    count    = scanning ? m_progressCount : m_lastScanCount;
+    double rate     = ms ? count * 1000.0 / ms : 0.0;
+
     return QStringList() << QString::number(gCoreContext->IsBackend())
                          << QString::number(m_progressCount)
-                         << QString::number(m_progressTotalCount);
+                         << QString::number(m_progressTotalCount)
+                         << QString::number(rate, 'f', 1)
+                         << QString::number(ms);
 }
 
 
@@ -128,6 +285,10 @@ QStringList ImageScanThread<DBFS>::GetProgress()
  \details Scans all dirs and files and populates database with
  metadata for each. Broadcasts progress events whilst scanning, initiates
  thumbnail generation and notifies clients when finished.
+ Requested scans are always full. If enabled by the GalleryWatchDirs setting,
+ scanned dirs are then watched for changes and the rescans that these start
+ do not list dirs that are unchanged since the last completed scan (unless
+ disabled by the GalleryIncrementalScan setting).
 */
 template <class DBFS>
 void ImageScanThread<DBFS>::run()
@@ -165,6 +326,8 @@ void ImageScanThread<DBFS>::run()
         {
             LOG(VB_GENERAL, LOG_INFO,  "Starting scan");
 
+            uint scanStart = QDateTime::currentMSecsSinceEpoch() / 1000;
+
             // Load known directories and files from the database
             if (!m_dbfs.ReadAllImages(m_dbFileMap, m_dbDirMap))
                 // Abort on any Db error
@@ -172,6 +335,23 @@ void ImageScanThread<DBFS>::run()
 
             bool firstScan = m_dbFileMap.isEmpty();
 
+            // Index Db images by parent so that unchanged dirs need not be listed
+            m_dbDirs = m_dbDirMap;
+            foreach (const ImagePtr &im, m_dbDirMap)
+                m_dbDirsByParent.insert(im->m_parentId, im);
+            foreach (const ImagePtr &im, m_dbFileMap)
+                m_dbFilesByParent.insert(im->m_parentId, im);
+
+            m_mutexState.lock();
+            bool watchScan = m_watchScan;
+            m_mutexState.unlock();
+
+            // Only rescans started by the watcher skip unchanged dirs
+            m_incremental = watchScan && !firstScan && m_lastScanStart > 0
+                    && gCoreContext->GetBoolSetting("GalleryIncrementalScan", true);
+            m_dirtyDirs   = m_watcher->TakeChanged();
+            m_skippedDirs = 0;
+
             // Pause thumb generator so that scans are fast as possible
             m_thumb.PauseBackground(true);
 
@@ -180,9 +360,13 @@ void ImageScanThread<DBFS>::run()
 
             CountFiles(paths.values());
 
+            // Read every root ahead of the scan
+            StartWalkers(paths);
+
             // Now start the actual syncronization
             m_seenFile.clear();
             m_changedImages.clear();
+            m_scannedDirs.clear();
             StringMap::const_iterator i = paths.constBegin();
             while (i != paths.constEnd() && IsScanning())
             {
@@ -190,6 +374,10 @@ void ImageScanThread<DBFS>::run()
                 ++i;
             }
 
+            bool completed = IsScanning();
+
+            StopWalkers();
+
             // Release thumb generator asap
             m_thumb.PauseBackground(false);
 
@@ -207,15 +395,42 @@ void ImageScanThread<DBFS>::run()
             m_dbFileMap.clear();
             m_dbDirMap.clear();
             m_seenDir.clear();
+            m_dbDirs.clear();
+            m_dbDirsByParent.clear();
+            m_dbFilesByParent.clear();
+            m_dirtyDirs.clear();
 
             m_mutexProgress.lock();
             // (count == total) signals scan end
             Broadcast(m_progressTotalCount);
+            m_lastScanTime  = m_scanTimer.elapsed();
+            m_lastScanCount = m_progressCount;
             // Must reset counts for scan queries
             m_progressCount = m_progressTotalCount = 0;
             m_mutexProgress.unlock();
 
-            LOG(VB_GENERAL, LOG_INFO,  "Finished scan");
+            LOG(VB_GENERAL, LOG_INFO,
+                QString("Finished scan: %1 images in %2 ms (%3/sec), "
+                        "%4 unchanged dirs skipped")
+                .arg(m_lastScanCount).arg(m_lastScanTime)
+                .arg(m_lastScanTime
+                     ? m_lastScanCount * 1000.0 / m_lastScanTime : 0.0,
+                     0, 'f', 1)
+                .arg(m_skippedDirs));
+
+            if (completed)
+            {
+                m_lastScanStart = scanStart;
+
+                if (gCoreContext->GetBoolSetting("GalleryWatchDirs", false))
+                    m_watcher->Watch(m_scannedDirs);
+                else
+                    m_watcher->Clear();
+            }
+            else
+                // An interrupted scan leaves dirs partially synced
+                m_lastScanStart = 0;
+            m_scannedDirs.clear();
 
             // For initial scans pause briefly to give thumb generator a headstart
             // before being deluged by client requests
@@ -225,10 +440,15 @@ void ImageScanThread<DBFS>::run()
             // Notify clients of completion with removed & changed images
             m_dbfs.Notify("IMAGE_DB_CHANGED", mesg);
 
-            ChangeState(false);
+            // Dirs that changed during the scan need another
+            m_mutexState.lock();
+            m_scanning  = m_scanning && m_rescan;
+            m_watchScan = m_rescan;
+            m_rescan    = false;
+            m_mutexState.unlock();
         }
     }
-    while (ClearsPending());
+    while (ClearsPending() || IsScanning());
 
     RunEpilog();
 }
@@ -265,10 +485,22 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
     }
 
     // Create directory node
-    int id = SyncDirectory(dirInfo, devId, base, parentId);
+    bool unchanged;
+    int id = SyncDirectory(dirInfo, devId, base, parentId, unchanged);
+
+    m_scannedDirs << dirInfo.absoluteFilePath();
+
+    if (unchanged)
+    {
+        SyncUnchanged(dirInfo, id, devId, base);
+        return;
+    }
+
+    // Sync its contents, as read by a walker if it got here first
+    QFileInfoList list;
+    if (!TakeListing(dirInfo.absoluteFilePath(), list))
+        list = dir.entryInfoList();
 
-    // Sync its contents
-    QFileInfoList list = dir.entryInfoList();
     foreach(const QFileInfo &fileInfo, list)
     {
         if (!IsScanning())
@@ -290,6 +522,11 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
             QMutexLocker locker(&m_mutexProgress);
             ++m_progressCount;
 
+            // Incremental scans only estimate the total, which must not be
+            // reached before the end
+            if (m_incremental && m_progressCount >= m_progressTotalCount)
+                m_progressTotalCount = m_progressCount + 1;
+
             // Throttle updates
             if (m_bcastTimer.elapsed() > 250)
                 Broadcast(m_progressCount);
@@ -301,7 +538,7 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
 /*!
  \brief Updates/populates db for a dir
  \details Db is updated if dir modified time has changed since last scan.
- Contents are scanned even if dir is unchanged.
+ Unchanged dirs hold the same entries as the last scan, which need not be listed.
  Clones are dirs within the Storage Group with the same path (relative to SG).
  They resolve to a single Db dir - their contents are amalgamated.
  ie. <SG dir 1>/somePath/dirName and <SG dir 2>/somePath/dirName result in a
@@ -310,12 +547,16 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
  \param devId Id of device containing dir
  \param base Device path
  \param parentId Db id of the dir's parent
+ \param[out] unchanged Set if the dir has the same entries as the last scan
  \return int Db id of this dir in db
 */
 template <class DBFS>
- int ImageScanThread<DBFS>::SyncDirectory(const QFileInfo &dirInfo, int devId, const QString &base, int parentId)
+ int ImageScanThread<DBFS>::SyncDirectory(const QFileInfo &dirInfo, int devId,
+                                          const QString &base, int parentId,
+                                          bool &unchanged)
 {
     QString absFilePath = dirInfo.absoluteFilePath();
+    unchanged = false;
 
     LOG(VB_FILE, LOG_DEBUG, QString("Syncing directory %1").arg(absFilePath));
 
@@ -344,6 +585,10 @@ template <class DBFS>
             // Note modified images
             m_changedImages << QString::number(dir->m_id);
         }
+        else if (Unchanged(absFilePath, *dir))
+        {
+            unchanged = true;
+        }
 
         // Remove the entry from the dbList
         m_dbDirMap.remove(dir->m_filePath);
@@ -396,6 +641,256 @@ template <class DBFS>
 }
 
 
+/*!
+ \brief Determines whether a dir has the same entries as the last scan
+ \details Adding, removing or renaming entries updates a dir's modified time.
+ Used by scanner & walkers so only reads state that is fixed during a scan.
+ \param absPath Absolute path of dir
+ \param dir Dir as found by this scan
+ \return ImagePtr The Db dir if unchanged, otherwise NULL
+*/
+template <class DBFS>
+ImagePtr ImageScanThread<DBFS>::Unchanged(const QString &absPath,
+                                          ImageItemK &dir) const
+{
+    if (!m_incremental || m_dirtyDirs.contains(absPath))
+        return ImagePtr();
+
+    ImagePtr dbDir = m_dbDirs.value(dir.m_filePath);
+
+    // Clones amalgamate several dirs so their modified time is ambiguous.
+    // Changes made in the same second as the last scan may have been missed
+    if (dbDir && dbDir->m_type == kDirectory
+            && dbDir->m_modTime == dir.m_modTime
+            && dir.m_modTime < m_lastScanStart)
+        return dbDir;
+
+    return ImagePtr();
+}
+
+
+/*!
+ \brief Syncs a dir that has the same entries as the last scan
+ \details Its files are known from the Db so are neither listed nor examined.
+ Only subdirs are synced as their contents may have changed.
+ \note Files rewritten in place do not change their dir, so are not detected.
+ \param dirInfo Dir info
+ \param id Db id of the dir
+ \param devId Device id being scanned
+ \param base Root device path
+*/
+template <class DBFS>
+void ImageScanThread<DBFS>::SyncUnchanged(const QFileInfo &dirInfo, int id,
+                                          int devId, const QString &base)
+{
+    QString absPath = dirInfo.absoluteFilePath();
+
+    LOG(VB_FILE, LOG_DEBUG, QString("Unchanged directory %1").arg(absPath));
+
+    ++m_skippedDirs;
+
+    ImageList files = m_dbFilesByParent.values(id);
+    foreach (const ImagePtr &im, files)
+    {
+        // Remove it from removed list
+        m_dbFileMap.remove(im->m_filePath);
+        // Detect duplicates
+        m_seenFile.insert(im->m_filePath, ImageAdapterBase::ConstructPath(
+                              absPath, ImageAdapterBase::BaseNameOf(im->m_filePath)));
+    }
+
+    m_mutexProgress.lock();
+    m_progressCount += files.size();
+    if (m_bcastTimer.elapsed() > 250)
+        Broadcast(m_progressCount);
+    m_mutexProgress.unlock();
+
+    foreach (const ImagePtr &im, m_dbDirsByParent.values(id))
+    {
+        if (!IsScanning())
+            return;
+
+        SyncSubTree(QFileInfo(ImageAdapterBase::ConstructPath(
+                                  absPath, ImageAdapterBase::BaseNameOf(im->m_filePath))),
+                    id, devId, base);
+    }
+}
+
+
+/*!
+ \brief Reads a dir subtree ahead of the scanner
+ \details Run by a walker thread for each scan root. Lists dirs & stats their
+ entries so that the scanner finds them cached. Unchanged dirs are not listed.
+ \param dirInfo Dir info at root of this subtree
+ \param root True for a scan root
+ \param devId Device id being scanned
+ \param base Root device path
+ \param exclusions Pattern of dir names to ignore, for use by this thread only
+ \return bool False if walkers must stop
+*/
+template <class DBFS>
+bool ImageScanThread<DBFS>::Walk(const QFileInfo &dirInfo, bool root, int devId,
+                                 const QString &base, const REGEXP &exclusions)
+{
+    if (!IsScanning())
+        return false;
+
+    if (MATCHES(exclusions, dirInfo.fileName()))
+        return true;
+
+    QString absPath = dirInfo.absoluteFilePath();
+
+    // Only the root/non-root distinction of the parent matters for its path
+    ImagePtrK im(m_dbfs.CreateItem(dirInfo, root ? GALLERY_DB_ID : PHOTO_DB_ID,
+                                   devId, base));
+
+    ImagePtr dbDir = root ? ImagePtr() : Unchanged(absPath, *im);
+    if (dbDir)
+    {
+        foreach (const ImagePtr &sub, m_dbDirsByParent.values(dbDir->m_id))
+        {
+            QString name = ImageAdapterBase::BaseNameOf(sub->m_filePath);
+            if (!Walk(QFileInfo(ImageAdapterBase::ConstructPath(absPath, name)),
+                      false, devId, base, exclusions))
+                return false;
+        }
+        return true;
+    }
+
+    QDir dir = m_dir;
+    if (!dir.cd(absPath))
+        return true;
+
+    QStringList subDirs;
+    {
+        QFileInfoList list = dir.entryInfoList();
+
+        // Stat entries now, rather than in the scanner. The listing is shared
+        // with the scanner once stored so must not be used afterwards
+        foreach (const QFileInfo &fileInfo, list)
+        {
+            if (fileInfo.isDir())
+                subDirs << fileInfo.absoluteFilePath();
+            else
+                fileInfo.lastModified();
+        }
+
+        if (!StoreListing(absPath, list))
+            return false;
+    }
+
+    foreach (const QString &path, subDirs)
+        if (!Walk(QFileInfo(path), false, devId, base, exclusions))
+            return false;
+
+    return true;
+}
+
+
+/*!
+ \brief Passes a dir listing from a walker to the scanner
+ \details Blocks whilst too many entries are waiting for the scanner.
+ Listings of dirs that the scanner has already reached are discarded.
+ \param absPath Absolute path of dir
+ \param list Dir entries
+ \return bool False if walkers must stop
+*/
+template <class DBFS>
+bool ImageScanThread<DBFS>::StoreListing(const QString &absPath,
+                                         const QFileInfoList &list)
+{
+    QMutexLocker locker(&m_mutexWalk);
+
+    while (!m_walkStop && m_readAheadSize > kReadAheadLimit)
+        m_walkTaken.wait(&m_mutexWalk);
+
+    if (m_walkStop)
+        return false;
+
+    if (!m_claimed.remove(absPath))
+    {
+        m_readAhead.insert(absPath, list);
+        m_readAheadSize += list.size();
+    }
+    return true;
+}
+
+
+/*!
+ \brief Gets the listing of a dir read by a walker
+ \details If it hasn't been read yet, the walker will discard it
+ \param[in] absPath Absolute path of dir
+ \param[out] list Dir entries
+ \return bool True if the listing was read ahead
+*/
+template <class DBFS>
+bool ImageScanThread<DBFS>::TakeListing(const QString &absPath,
+                                        QFileInfoList &list)
+{
+    QMutexLocker locker(&m_mutexWalk);
+
+    QHash<QString, QFileInfoList>::iterator it = m_readAhead.find(absPath);
+    if (it == m_readAhead.end())
+    {
+        if (!m_walkers.isEmpty())
+            m_claimed.insert(absPath);
+        return false;
+    }
+
+    list = it.value();
+    m_readAheadSize -= list.size();
+    m_readAhead.erase(it);
+    m_walkTaken.wakeAll();
+    return true;
+}
+
+
+/*!
+ \brief Starts a walker for each scan root
+ \details Roots (SG dirs or local devices) are often separate disks, which are
+ then read in parallel. The scanner still syncs them in order, which determines
+ how clones & duplicates are resolved.
+ \param paths Map of <device id, root path>
+*/
+template <class DBFS>
+void ImageScanThread<DBFS>::StartWalkers(const StringMap &paths)
+{
+    m_mutexWalk.lock();
+    m_walkStop = false;
+    m_mutexWalk.unlock();
+
+    StringMap::const_iterator i = paths.constBegin();
+    for (; i != paths.constEnd(); ++i)
+    {
+        Walker *walker = new Walker(*this, i.value(), i.key(), i.value());
+        m_walkers << walker;
+        walker->start();
+    }
+}
+
+
+/*!
+ \brief Stops walkers and discards unused listings
+*/
+template <class DBFS>
+void ImageScanThread<DBFS>::StopWalkers()
+{
+    m_mutexWalk.lock();
+    m_walkStop = true;
+    m_walkTaken.wakeAll();
+    m_mutexWalk.unlock();
+
+    // Waits for them to finish
+    qDeleteAll(m_walkers);
+
+    QMutexLocker locker(&m_mutexWalk);
+    m_walkers.clear();
+    m_readAhead.clear();
+    m_claimed.clear();
+    m_readAheadSize = 0;
+}
+
+
 /*!
   \brief Read image date, orientation, comment from metadata
   \param[in] path Image filepath
@@ -572,6 +1067,11 @@ void ImageScanThread<DBFS>::CountFiles(const QStringList &paths)
     excPattern.replace(",", "|");   // Convert list to OR's
 
     QString pattern = QString("^(%1)$").arg(excPattern);
+
+    // Files in unchanged dirs may no longer be excluded
+    if (pattern != m_exclusions.pattern())
+        m_incremental = false;
+
     m_exclusions = REGEXP(pattern);
 
     LOG(VB_FILE, LOG_DEBUG, QString("Exclude regexp is \"%1\"").arg(pattern));
@@ -580,14 +1080,23 @@ void ImageScanThread<DBFS>::CountFiles(const QStringList &paths)
     QMutexLocker locker(&m_mutexProgress);
     m_progressCount       = 0;
     m_progressTotalCount  = 0;
+    m_scanTimer.start();
 
-    // Use global image filters
-    QDir dir = m_dir;
-    foreach(const QString &sgDir, paths)
+    if (m_incremental)
     {
-        // Ignore missing dirs
-        if (dir.cd(sgDir))
-            CountTree(dir);
+        // Counting would list unchanged dirs, so estimate from the Db.
+        m_progressTotalCount = m_dbFileMap.size();
+    }
+    else
+    {
+        // Use global image filters
+        QDir dir = m_dir;
+        foreach(const QString &sgDir, paths)
+        {
+            // Ignore missing dirs
+            if (dir.cd(sgDir))
+                CountTree(dir);
+        }
     }
     // 0 signifies a scan start
     Broadcast(0);
@@ -603,11 +1112,15 @@ void ImageScanThread<DBFS>::CountFiles(const QStringList &paths)
 template <class DBFS>
 void ImageScanThread<DBFS>::Broadcast(int progress)
 {
+    qint64 ms   = m_scanTimer.elapsed();
+    double rate = ms ? progress * 1000.0 / ms : 0.0;
+
     // Only 2 scanners are ever visible (FE & BE) so use bool as scanner id
     QStringList status;
     status << QString::number(gCoreContext->IsBackend())
            << QString::number(progress)
-           << QString::number(m_progressTotalCount);
+           << QString::number(m_progressTotalCount)
+           << QString::number(rate, 'f', 1);
 
     m_dbfs.Notify("IMAGE_SCAN_STATUS", status);
 
@@ -8,6 +8,12 @@
 //!
 //! Clone directories & duplicate files can only occur in a Storage Group/Backend scanner.
 //! They can never occur with local devices/Frontend scanner
+//!
+//! Optionally dirs are watched so that changes start a rescan. These rescans
+//! are incremental: a dir whose modified time matches the Db is known to
+//! hold the same entries as before, so its files are not listed again. Only its
+//! subdirs are visited. Requested scans are always full so that files rewritten
+//! in place are detected. Each scan root is read ahead by its own thread.
 
 #ifndef IMAGESCANNER_H
 #define IMAGESCANNER_H
@@ -15,6 +21,9 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QTimer>
 
 #if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
     #include <QRegularExpression>
@@ -29,9 +38,46 @@
 #include "imagethumbs.h"
 
 
+//! Receives changes detected by an ImageScanWatcher
+class META_PUBLIC ImageScanListener
+{
+public:
+    virtual ~ImageScanListener() {}
+    virtual void DirsChanged() = 0;
+};
+
+
+//! Watches scanned dirs (using inotify on Linux) & notifies the scanner of changes
+class META_PUBLIC ImageScanWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ImageScanWatcher(ImageScanListener &listener);
+
+    void          Watch(const QStringList &dirs);
+    void          Clear() { Watch(QStringList()); }
+    QSet<QString> TakeChanged();
+
+private slots:
+    void SetDirs(const QStringList &dirs);
+    void DirChanged(const QString &path);
+    void Settled();
+
+private:
+    Q_DISABLE_COPY(ImageScanWatcher)
+
+    ImageScanListener  &m_listener; //!< Scanner to notify
+    QFileSystemWatcher *m_watcher;  //!< Watches dirs
+    QTimer             *m_settle;   //!< Delays notification until changes stop
+    QSet<QString>       m_changed;  //!< Dirs changed since last scan
+    QMutex              m_mutex;    //!< Protects changed dirs
+};
+
+
 //! Image Scanner thread requires a database/filesystem adapter
 template <class DBFS>
-class META_PUBLIC ImageScanThread : public MThread
+class META_PUBLIC ImageScanThread : public MThread, public ImageScanListener
 {
 public:
     ImageScanThread(DBFS *const dbfs, ImageThumb<DBFS> *thumbGen);
@@ -43,6 +89,7 @@ public:
     void        ChangeState(bool scan);
     void        EnqueueClear(int devId, const QString &action);
     QStringList GetProgress();
+    void        DirsChanged();
 
 protected:
     void run();
@@ -50,10 +97,49 @@ protected:
 private:
     Q_DISABLE_COPY(ImageScanThread)
 
+    //! A thread reading the dirs of a scan root ahead of the scanner
+    class Walker : public MThread
+    {
+    public:
+        Walker(ImageScanThread &scanner, const QString &root,
+               int devId, const QString &base)
+            : MThread("ImageScanWalker"), m_scanner(scanner),
+              m_root(root), m_devId(devId), m_base(base),
+              // Each thread matches with its own copy
+              m_exclusions(scanner.m_exclusions.pattern()) {}
+        ~Walker() { wait(); }
+
+    protected:
+        void run()
+        {
+            RunProlog();
+            setPriority(QThread::LowPriority);
+            m_scanner.Walk(QFileInfo(m_root), true, m_devId, m_base,
+                           m_exclusions);
+            RunEpilog();
+        }
+
+    private:
+        ImageScanThread &m_scanner;
+        QString m_root;
+        int     m_devId;
+        QString m_base;
+        REGEXP  m_exclusions;
+    };
+
     void SyncSubTree(const QFileInfo &dirInfo, int parentId, int devId,
                      const QString &base);
     int  SyncDirectory(const QFileInfo &dirInfo, int devId,
-                       const QString &base, int parentId);
+                       const QString &base, int parentId, bool &unchanged);
+    void SyncUnchanged(const QFileInfo &dirInfo, int id, int devId,
+                       const QString &base);
+    ImagePtr Unchanged(const QString &absPath, ImageItemK &dir) const;
+    bool Walk(const QFileInfo &dirInfo, bool root, int devId,
+              const QString &base, const REGEXP &exclusions);
+    bool StoreListing(const QString &absPath, const QFileInfoList &list);
+    bool TakeListing(const QString &absPath, QFileInfoList &list);
+    void StartWalkers(const StringMap &paths);
+    void StopWalkers();
     void PopulateMetadata(const QString &path, int type,
                           QString &comment, uint &time, int &orientation);
     void SyncFile(const QFileInfo &fileInfo, int devId,
@@ -65,6 +151,8 @@ private:
     typedef QPair<int, QString> ClearTask;
 
     bool              m_scanning;   //!< The requested scan state
+    bool              m_rescan;     //!< Scan again when current scan finishes
+    bool              m_watchScan;  //!< Scan was started by the watcher
     QMutex            m_mutexState; //!< Mutex protecting scan state
     QList<ClearTask>  m_clearQueue; //!< Queue of pending Clear requests
     QMutex            m_mutexQueue; //!< Mutex protecting Clear requests
@@ -82,12 +170,46 @@ private:
     //! Ids of dirs/files that have been updates/modified.
     QStringList m_changedImages;
 
+    //! Dirs in the Db at start of scan. Read by walkers so never modified
+    ImageHash                 m_dbDirs;
+    //! Db dirs by the Db id of their parent
+    QMultiHash<int, ImagePtr> m_dbDirsByParent;
+    //! Db files by the Db id of their parent
+    QMultiHash<int, ImagePtr> m_dbFilesByParent;
+    //! Abs paths of dirs reported changed by the watcher
+    QSet<QString> m_dirtyDirs;
+    //! Abs paths of dirs synced by current scan
+    QStringList   m_scannedDirs;
+    //! Whether unchanged dirs can be skipped by current scan
+    bool          m_incremental;
+    //! Start time of last completed scan. Dirs modified since are rescanned
+    uint          m_lastScanStart;
+    //! Number of unchanged dirs skipped by current scan
+    int           m_skippedDirs;
+
+    QList<Walker*> m_walkers;  //!< Threads reading dirs ahead of the scan
+    //! Dir listings read ahead, Map<abs dir path, dir entries>
+    QHash<QString, QFileInfoList> m_readAhead;
+    //! Abs paths of dirs that the scanner listed before a walker did
+    QSet<QString>  m_claimed;
+    int            m_readAheadSize; //!< Number of entries read ahead
+    bool           m_walkStop;      //!< Requests walkers to quit
+    QWaitCondition m_walkTaken;     //!< Signals listings taken by the scanner
+    QMutex         m_mutexWalk;     //!< Protects read ahead
+
     //! Elapsed time since last progress event generated
     QElapsedTimer m_bcastTimer;
+    //! Elapsed time since current scan started
+    QElapsedTimer m_scanTimer;
     int           m_progressCount;      //!< Number of images scanned
     int           m_progressTotalCount; //!< Total number of images to scan
+    qint64        m_lastScanTime;       //!< Duration of last scan, ms
+    int           m_lastScanCount;      //!< Number of images in last scan
     QMutex        m_mutexProgress;      //!< Progress counts mutex
 
+    //! Watches scanned dirs, if enabled
+    ImageScanWatcher *m_watcher;
+
     //! Global working dir for file detection
     QDir m_dir;
     //! Pattern of dir names to ignore whilst scanning
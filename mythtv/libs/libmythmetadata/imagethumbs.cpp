@@ -1,6 +1,7 @@
 #include "imagethumbs.h"
 
 #include <QDir>
+#include <QImageReader>
 #include <QStringList>
 
 #include "mythlogging.h"
@@ -12,16 +13,26 @@
 
 #include "imagemetadata.h"
 
+//! Size of picture thumbnails
+static const QSize kThumbSize(240, 180);
+
+
 /*!
  \brief Constructor
  \param name Thread name
  \param dbfs Filesystem/Database adapter
+ \param threads Number of threads working through the queues
 */
 template <class DBFS>
-ThumbThread<DBFS>::ThumbThread(const QString &name, DBFS *const dbfs)
-    : MThread(name), m_dbfs(*dbfs),
-      m_requestQ(), m_backgroundQ(), m_doBackground(true)
-{}
+ThumbThread<DBFS>::ThumbThread(const QString &name, DBFS *const dbfs,
+                               int threads)
+    : m_name(name), m_dbfs(*dbfs),
+      m_requestQ(), m_backgroundQ(), m_doBackground(true),
+      m_running(0), m_active(0), m_backgroundActive(0), m_backgroundDone(0)
+{
+    for (int i = 0; i < qMax(threads, 1); ++i)
+        m_workers.append(new Worker(name, *this));
+}
 
 
 /*!
@@ -31,7 +42,7 @@ template <class DBFS>
 ThumbThread<DBFS>::~ThumbThread()
 {
     cancel();
-    wait();
+    qDeleteAll(m_workers);
 }
 
 
@@ -45,6 +56,10 @@ void ThumbThread<DBFS>::cancel()
     QMutexLocker locker(&m_mutex);
     m_requestQ.clear();
     m_backgroundQ.clear();
+
+    // Otherwise the last task to finish reports the end
+    if (m_backgroundDone && !m_backgroundActive)
+        Broadcast(true);
 }
 
 
@@ -66,8 +81,32 @@ void ThumbThread<DBFS>::Enqueue(const TaskPtr &task)
             m_requestQ.insert(task->m_priority, task);
 
         // restart if not already running
-        if ((m_doBackground || !background) && !this->isRunning())
-            this->start();
+        if (m_doBackground || !background)
+            StartWorkers();
+    }
+}
+
+
+/*!
+ \brief Starts idle workers, one for each queued task they can take
+ \note Queue mutex must be held before calling this
+*/
+template <class DBFS>
+void ThumbThread<DBFS>::StartWorkers()
+{
+    int queued = m_requestQ.size();
+    if (m_doBackground)
+        queued += m_backgroundQ.size();
+    int wanted = qMin(m_running + queued, m_workers.size());
+
+    for (int i = 0; i < m_workers.size() && m_running < wanted; ++i)
+    {
+        // A worker which has just run out of tasks may still be finishing
+        if (!m_workers[i]->isRunning())
+        {
+            m_workers[i]->start();
+            ++m_running;
+        }
     }
 }
 
@@ -81,7 +120,7 @@ void ThumbThread<DBFS>::AbortDevice(int devId, const QString &action)
 {
     if (action == "DEVICE CLOSE ALL" || action == "DEVICE CLEAR ALL")
     {
-        if (isRunning())
+        if (m_running)
             LOG(VB_FILE, LOG_INFO,
                 QString("Aborting all thumbnails %1").arg(action));
 
@@ -97,9 +136,14 @@ void ThumbThread<DBFS>::AbortDevice(int devId, const QString &action)
     QMutexLocker locker(&m_mutex);
     RemoveTasks(m_requestQ, devId);
     RemoveTasks(m_backgroundQ, devId);
-    if (isRunning())
-        // Wait until current task is complete - it may be using the device
-        m_taskDone.wait(&m_mutex, 3000);
+    if (m_backgroundDone && !m_backgroundActive)
+        Broadcast(true);
+
+    // Wait until current tasks are complete - they may be using the device
+    QElapsedTimer timer;
+    timer.start();
+    while (m_active && timer.elapsed() < 3000)
+        m_taskDone.wait(&m_mutex, 3000 - timer.elapsed());
 }
 
 
@@ -125,37 +169,61 @@ void ThumbThread<DBFS>::RemoveTasks(ThumbQueue &queue, int devId)
 /*!
  \brief  Handles thumbnail requests by priority
  \details Repeatedly processes next request from highest priority queue until all
-  queues are empty, then quits. For Create requests an event is broadcast once the
-  thumbnail exists. Dirs are only deleted if empty
+  queues are empty, then quits. Run by every worker, so requests are processed
+  concurrently but still started in priority order. For Create requests an event
+  is broadcast once the thumbnail exists. Dirs are only deleted if empty
 */
 template <class DBFS>
-void ThumbThread<DBFS>::run()
+void ThumbThread<DBFS>::Process()
 {
-    RunProlog();
-
-    setPriority(QThread::LowestPriority);
+    bool working = false, background = false;
 
     while (true)
     {
-        // Signal previous task is complete (its files have been closed)
-        m_taskDone.wakeAll();
-
-        // Do all we can to run in background
-        QThread::yieldCurrentThread();
-
         // process next highest-priority task
         TaskPtr task;
         {
             QMutexLocker locker(&m_mutex);
+
+            // Signal previous task is complete (its files have been closed)
+            if (working)
+            {
+                --m_active;
+                if (background)
+                {
+                    --m_backgroundActive;
+                    ++m_backgroundDone;
+                    Broadcast(false);
+                }
+                m_taskDone.wakeAll();
+            }
+
             if (!m_requestQ.isEmpty())
+            {
                 task = m_requestQ.take(m_requestQ.constBegin().key());
+                background = false;
+            }
             else if (m_doBackground && !m_backgroundQ.isEmpty())
+            {
                 task = m_backgroundQ.take(m_backgroundQ.constBegin().key());
+                background = true;
+                if (!m_backgroundDone && !m_backgroundActive)
+                    m_rateTimer.start();
+                ++m_backgroundActive;
+            }
             else
+            {
                 // quit when both queues exhausted
-                break;
+                --m_running;
+                return;
+            }
+            working = true;
+            ++m_active;
         }
 
+        // Do all we can to run in background
+        QThread::yieldCurrentThread();
+
         // Shouldn't receive empty requests
         if (task->m_images.isEmpty())
             continue;
@@ -233,8 +301,44 @@ void ThumbThread<DBFS>::run()
             LOG(VB_GENERAL, LOG_ERR,
                 QString("Unknown task %1").arg(task->m_action));
     }
+}
+
+
+/*!
+ \brief Notify listeners of thumbnail progress
+ \details Background thumbnails are reported like a scan, with the number
+ done and the total since the background queue was last empty, followed by
+ the rate in thumbnails per second.
+ \note Queue mutex must be held before calling this
+ \param finished If false, updates are throttled
+*/
+template <class DBFS>
+void ThumbThread<DBFS>::Broadcast(bool finished)
+{
+    int total = m_backgroundDone + m_backgroundActive + m_backgroundQ.size();
+    finished |= (m_backgroundDone >= total);
+    if (!finished && m_bcastTimer.isValid() && m_bcastTimer.elapsed() < 1000)
+        return;
+
+    qint64 ms = m_rateTimer.elapsed();
+    double rate = ms ? m_backgroundDone * 1000.0 / ms : 0.0;
+
+    // (count == total) signals end of background thumbnails
+    QStringList status;
+    status << QString("%1%2").arg(gCoreContext->IsBackend()).arg(m_name)
+           << QString::number(finished ? total : m_backgroundDone)
+           << QString::number(total)
+           << QString::number(rate, 'f', 1);
+
+    m_dbfs.Notify("IMAGE_SCAN_STATUS", status);
+
+    LOG(VB_FILE, LOG_INFO, QString("%1: %2 of %3 thumbnails, %4/sec")
+        .arg(m_name).arg(m_backgroundDone).arg(total).arg(rate, 0, 'f', 1));
 
-    RunEpilog();
+    if (m_backgroundDone >= total)
+        m_backgroundDone = 0;
+
+    m_bcastTimer.start();
 }
 
 
@@ -266,11 +370,26 @@ QString ThumbThread<DBFS>::CreateThumbnail(ImagePtrK im, int thumbPriority)
     QImage image;
     if (im->m_type == kImageFile)
     {
-        if (!image.load(imagePath))
-            return QString("Failed to open image %1").arg(imagePath);
+        QImageReader reader(imagePath);
+        QSize size = reader.size();
 
         // Resize to optimise load/display time by FE's
-        image = image.scaled(QSize(240,180), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        if (size.isValid() && reader.format() == "jpeg")
+        {
+            // The JPEG decoder scales in the DCT domain, so the full size
+            // photo is never decoded
+            reader.setScaledSize(size.scaled(kThumbSize, Qt::KeepAspectRatio));
+            if (!reader.read(&image))
+                return QString("Failed to open image %1").arg(imagePath);
+        }
+        else
+        {
+            if (!reader.read(&image))
+                return QString("Failed to open image %1").arg(imagePath);
+
+            image = MythImage::SmoothScaled(image, kThumbSize,
+                                            Qt::KeepAspectRatio);
+        }
     }
     else if (im->m_type == kVideoFile)
     {
@@ -333,8 +452,8 @@ void ThumbThread<DBFS>::PauseBackground(bool pause)
     m_doBackground = !pause;
 
     // restart if not already running
-    if (m_doBackground && !this->isRunning())
-        this->start();
+    if (m_doBackground)
+        StartWorkers();
 }
 
 
@@ -344,7 +463,11 @@ void ThumbThread<DBFS>::PauseBackground(bool pause)
 template <class DBFS>
 ImageThumb<DBFS>::ImageThumb(DBFS *const dbfs)
     : m_dbfs(*dbfs),
-      m_imageThread(new ThumbThread<DBFS>("ImageThumbs", dbfs)),
+      m_imageThread(new ThumbThread<DBFS>(
+                        "ImageThumbs", dbfs,
+                        gCoreContext->GetNumSetting(
+                            "GalleryThumbnailThreads",
+                            QThread::idealThreadCount()))),
       m_videoThread(new ThumbThread<DBFS>("VideoThumbs", dbfs))
 {}
 
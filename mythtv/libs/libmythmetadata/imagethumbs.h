@@ -1,10 +1,10 @@
 //! \file
 //! \brief Creates and manages thumbnails
-//! \details Uses two worker threads to process thumbnail requests that are queued
+//! \details Uses two worker queues to process thumbnail requests that are queued
 //! from the scanner and UI.
-//! One thread generates picture thumbs; the other video thumbs, which are delegated
-//! to previewgenerator and time-consuming.
-//! Both background threads are low-priority to avoid recording issues.
+//! One generates picture thumbs with a thread per core; the other video thumbs,
+//! which are delegated to previewgenerator and time-consuming, with one thread.
+//! All background threads are low-priority to avoid recording issues.
 //! Requests are handled by client-assigned priority so that UI display requests
 //! are serviced before background scanner requests.
 //! When images are removed, their thumbnails are also deleted (thumbnail cache is
@@ -14,6 +14,7 @@
 #ifndef IMAGETHUMBS_H
 #define IMAGETHUMBS_H
 
+#include <QElapsedTimer>
 #include <QMap>
 #include <QMutex>
 #include <QWaitCondition>
@@ -78,12 +79,12 @@ public:
 typedef QSharedPointer<ThumbTask> TaskPtr;
 
 
-//! A generator worker thread
+//! A generator queue, worked through by one or more threads
 template <class DBFS>
-class ThumbThread : public MThread
+class ThumbThread
 {
 public:
-    ThumbThread(const QString &name, DBFS *const dbfs);
+    ThumbThread(const QString &name, DBFS *const dbfs, int threads = 1);
     ~ThumbThread();
 
     void cancel();
@@ -91,24 +92,53 @@ public:
     void AbortDevice(int devId, const QString &action);
     void PauseBackground(bool pause);
 
-protected:
-    void run();
-
 private:
     Q_DISABLE_COPY(ThumbThread)
 
+    //! A thread taking tasks from the queues until they are empty
+    class Worker : public MThread
+    {
+    public:
+        Worker(const QString &name, ThumbThread &queue)
+            : MThread(name), m_queue(queue) {}
+        ~Worker() { wait(); }
+
+    protected:
+        void run()
+        {
+            RunProlog();
+            setPriority(QThread::LowestPriority);
+            m_queue.Process();
+            RunEpilog();
+        }
+
+    private:
+        ThumbThread &m_queue;
+    };
+
     //! A priority queue where 0 is highest priority
     typedef QMultiMap<int, TaskPtr> ThumbQueue;
 
+    void Process();
+    void StartWorkers();
+    void Broadcast(bool finished);
     QString CreateThumbnail(ImagePtrK im, int thumbPriority);
     static void RemoveTasks(ThumbQueue &queue, int devId);
 
+    QString m_name;             //!< Thread name, also the progress id
     DBFS &m_dbfs;               //!< Database/filesystem adapter
     QWaitCondition m_taskDone;  //! Synchronises completed tasks
+    QList<Worker*> m_workers;   //!< Threads working through the queues
 
     ThumbQueue m_requestQ;   //!< Priority queue of requests
     ThumbQueue m_backgroundQ;   //!< Priority queue of background tasks
     bool m_doBackground;       //!< Whether to process background tasks
+    int m_running;             //!< Number of workers taking tasks
+    int m_active;              //!< Number of tasks being processed
+    int m_backgroundActive;    //!< Number of background tasks being processed
+    int m_backgroundDone;      //!< Background tasks done since queue was empty
+    QElapsedTimer m_rateTimer; //!< Time since background queue was empty
+    QElapsedTimer m_bcastTimer; //!< Time since last progress event
     QMutex m_mutex;            //!< Queue protection
 };
 
@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////
+// Program Name: jobInfo.h
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef JOBINFO_H_
+#define JOBINFO_H_
+
+#include <QString>
+#include <QDateTime>
+
+#include "serviceexp.h"
+#include "datacontracthelper.h"
+
+namespace DTC
+{
+
+/////////////////////////////////////////////////////////////////////////////
+
+class SERVICE_PUBLIC JobInfo : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO( "version"    , "1.0" );
+
+    Q_PROPERTY( int             Id               READ Id                WRITE setId               )
+    Q_PROPERTY( QString         Type             READ Type              WRITE setType             )
+    Q_PROPERTY( QString         Status           READ Status            WRITE setStatus           )
+    Q_PROPERTY( uint            ChanId           READ ChanId            WRITE setChanId           )
+    Q_PROPERTY( QDateTime       StartTime        READ StartTime         WRITE setStartTime        )
+    Q_PROPERTY( int             Rank             READ Rank              WRITE setRank             )
+    Q_PROPERTY( int             ExpectedSecs     READ ExpectedSecs      WRITE setExpectedSecs     )
+    Q_PROPERTY( double          CPU              READ CPU               WRITE setCPU              )
+    Q_PROPERTY( double          ReadRate         READ ReadRate          WRITE setReadRate         )
+    Q_PROPERTY( double          WriteRate        READ WriteRate         WRITE setWriteRate        )
+    Q_PROPERTY( bool            Throttled        READ Throttled         WRITE setThrottled        )
+
+    PROPERTYIMP    ( int        , Id               )
+    PROPERTYIMP    ( QString    , Type             )
+    PROPERTYIMP    ( QString    , Status           )
+    PROPERTYIMP    ( uint       , ChanId           )
+    PROPERTYIMP    ( QDateTime  , StartTime        )
+    PROPERTYIMP    ( int        , Rank             )
+    PROPERTYIMP    ( int        , ExpectedSecs     )
+    PROPERTYIMP    ( double     , CPU              )
+    PROPERTYIMP    ( double     , ReadRate         )
+    PROPERTYIMP    ( double     , WriteRate        )
+    PROPERTYIMP    ( bool       , Throttled        )
+
+    public:
+
+        static inline void InitializeCustomTypes();
+
+        JobInfo(QObject *parent = 0)
+            : QObject            ( parent ),
+              m_Id               ( 0      ),
+              m_ChanId           ( 0      ),
+              m_Rank             ( 0      ),
+              m_ExpectedSecs     ( 0      ),
+              m_CPU              ( 0.0    ),
+              m_ReadRate         ( 0.0    ),
+              m_WriteRate        ( 0.0    ),
+              m_Throttled        ( false  )
+        {
+        }
+
+        JobInfo( const JobInfo &src )
+        {
+            Copy( src );
+        }
+
+        void Copy( const JobInfo &src )
+        {
+            m_Id                = src.m_Id                ;
+            m_Type              = src.m_Type              ;
+            m_Status            = src.m_Status            ;
+            m_ChanId            = src.m_ChanId            ;
+            m_StartTime         = src.m_StartTime         ;
+            m_Rank              = src.m_Rank              ;
+            m_ExpectedSecs      = src.m_ExpectedSecs      ;
+            m_CPU               = src.m_CPU               ;
+            m_ReadRate          = src.m_ReadRate          ;
+            m_WriteRate         = src.m_WriteRate         ;
+            m_Throttled         = src.m_Throttled         ;
+        }
+};
+
+} // namespace DTC
+
+Q_DECLARE_METATYPE( DTC::JobInfo  )
+Q_DECLARE_METATYPE( DTC::JobInfo* )
+
+namespace DTC
+{
+inline void JobInfo::InitializeCustomTypes()
+{
+    qRegisterMetaType< JobInfo   >();
+    qRegisterMetaType< JobInfo*  >();
+}
+}
+
+#endif
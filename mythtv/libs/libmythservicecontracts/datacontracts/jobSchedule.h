@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////
+// Program Name: jobSchedule.h
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef JOBSCHEDULE_H_
+#define JOBSCHEDULE_H_
+
+#include <QVariantList>
+#include <QDateTime>
+#include <QString>
+
+#include "serviceexp.h"
+#include "datacontracthelper.h"
+
+#include "jobInfo.h"
+
+namespace DTC
+{
+
+class SERVICE_PUBLIC JobSchedule : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO( "version", "1.0" );
+
+    // Q_CLASSINFO Used to augment Metadata for properties.
+    // See datacontracthelper.h for details
+
+    Q_CLASSINFO( "Jobs", "type=DTC::JobInfo");
+
+    Q_PROPERTY( QString      HostName           READ HostName           WRITE setHostName           )
+    Q_PROPERTY( QDateTime    AsOf               READ AsOf               WRITE setAsOf               )
+    Q_PROPERTY( bool         Throttled          READ Throttled          WRITE setThrottled          )
+    Q_PROPERTY( QString      Reason             READ Reason             WRITE setReason             )
+    Q_PROPERTY( double       CPULoad            READ CPULoad            WRITE setCPULoad            )
+    Q_PROPERTY( double       WriteLatency       READ WriteLatency       WRITE setWriteLatency       )
+    Q_PROPERTY( uint         RecordingsStarting READ RecordingsStarting WRITE setRecordingsStarting )
+    Q_PROPERTY( int          MaxJobs            READ MaxJobs            WRITE setMaxJobs            )
+
+    Q_PROPERTY( QVariantList Jobs READ Jobs DESIGNABLE true )
+
+    PROPERTYIMP       ( QString     , HostName           )
+    PROPERTYIMP       ( QDateTime   , AsOf               )
+    PROPERTYIMP       ( bool        , Throttled          )
+    PROPERTYIMP       ( QString     , Reason             )
+    PROPERTYIMP       ( double      , CPULoad            )
+    PROPERTYIMP       ( double      , WriteLatency       )
+    PROPERTYIMP       ( uint        , RecordingsStarting )
+    PROPERTYIMP       ( int         , MaxJobs            )
+
+    PROPERTYIMP_RO_REF( QVariantList, Jobs )
+
+    public:
+
+        static inline void InitializeCustomTypes();
+
+        JobSchedule(QObject *parent = 0)
+            : QObject              ( parent ),
+              m_Throttled          ( false  ),
+              m_CPULoad            ( 0.0    ),
+              m_WriteLatency       ( 0.0    ),
+              m_RecordingsStarting ( 0      ),
+              m_MaxJobs            ( 0      )
+        {
+        }
+
+        JobSchedule( const JobSchedule &src )
+        {
+            Copy( src );
+        }
+
+        void Copy( const JobSchedule &src )
+        {
+            m_HostName           = src.m_HostName           ;
+            m_AsOf               = src.m_AsOf               ;
+            m_Throttled          = src.m_Throttled          ;
+            m_Reason             = src.m_Reason             ;
+            m_CPULoad            = src.m_CPULoad            ;
+            m_WriteLatency       = src.m_WriteLatency       ;
+            m_RecordingsStarting = src.m_RecordingsStarting ;
+            m_MaxJobs            = src.m_MaxJobs            ;
+
+            CopyListContents< JobInfo >( this, m_Jobs, src.m_Jobs );
+        }
+
+        JobInfo *AddNewJobInfo()
+        {
+            // We must make sure the object added to the QVariantList has
+            // a parent of 'this'
+
+            JobInfo *pObject = new JobInfo( this );
+            m_Jobs.append( QVariant::fromValue<QObject *>( pObject ));
+
+            return pObject;
+        }
+
+};
+
+} // namespace DTC
+
+Q_DECLARE_METATYPE( DTC::JobSchedule  )
+Q_DECLARE_METATYPE( DTC::JobSchedule* )
+
+namespace DTC
+{
+inline void JobSchedule::InitializeCustomTypes()
+{
+    qRegisterMetaType< JobSchedule   >();
+    qRegisterMetaType< JobSchedule*  >();
+
+    JobInfo::InitializeCustomTypes();
+}
+}
+
+#endif
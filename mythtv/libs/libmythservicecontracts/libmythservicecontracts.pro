@@ -48,6 +48,7 @@ HEADERS += datacontracts/artworkInfoList.h       datacontracts/frontendStatus.h
 HEADERS += datacontracts/frontendActionList.h
 HEADERS += datacontracts/liveStreamInfo.h        datacontracts/liveStreamInfoList.h
 HEADERS += datacontracts/titleInfo.h             datacontracts/titleInfoList.h
+HEADERS += datacontracts/jobInfo.h               datacontracts/jobSchedule.h
 HEADERS += datacontracts/labelValue.h
 HEADERS += datacontracts/logMessage.h            datacontracts/logMessageList.h
 HEADERS += datacontracts/imageMetadataInfoList.h datacontracts/imageMetadataInfo.h
@@ -103,6 +104,7 @@ incDatacontracts.files += datacontracts/artworkInfo.h         datacontracts/artw
 incDatacontracts.files += datacontracts/frontendStatus.h      datacontracts/frontendActionList.h
 incDatacontracts.files += datacontracts/liveStreamInfo.h      datacontracts/liveStreamInfoList.h
 incDatacontracts.files += datacontracts/titleInfo.h           datacontracts/titleInfoList.h
+incDatacontracts.files += datacontracts/jobInfo.h             datacontracts/jobSchedule.h
 incDatacontracts.files += datacontracts/labelValue.h
 incDatacontracts.files += datacontracts/logMessage.h          datacontracts/logMessageList.h
 incDatacontracts.files += datacontracts/imageMetadataInfoList.h datacontracts/imageMetadataInfo.h
@@ -22,6 +22,7 @@
 #include "datacontracts/recRuleFilter.h"
 #include "datacontracts/recRuleFilterList.h"
 #include "datacontracts/titleInfoList.h"
+#include "datacontracts/jobSchedule.h"
 #include "datacontracts/input.h"
 #include "datacontracts/inputList.h"
 #include "datacontracts/cutList.h"
@@ -45,7 +46,7 @@
 class SERVICE_PUBLIC DvrServices : public Service  //, public QScriptable ???
 {
     Q_OBJECT
-    Q_CLASSINFO( "version"    , "6.2" );
+    Q_CLASSINFO( "version"    , "6.3" );
     Q_CLASSINFO( "RemoveRecorded_Method",                       "POST" )
     Q_CLASSINFO( "DeleteRecording_Method",                      "POST" )
     Q_CLASSINFO( "UnDeleteRecording",                           "POST" )
@@ -71,6 +72,7 @@ class SERVICE_PUBLIC DvrServices : public Service  //, public QScriptable ???
             DTC::InputList::InitializeCustomTypes();
             DTC::RecRuleList::InitializeCustomTypes();
             DTC::TitleInfoList::InitializeCustomTypes();
+            DTC::JobSchedule::InitializeCustomTypes();
             DTC::RecRuleFilterList::InitializeCustomTypes();
             DTC::CutList::InitializeCustomTypes();
         }
@@ -159,6 +161,10 @@ class SERVICE_PUBLIC DvrServices : public Service  //, public QScriptable ???
 
         virtual DTC::TitleInfoList* GetTitleInfoList     ( ) = 0;
 
+        // Job Queue
+
+        virtual DTC::JobSchedule*  GetJobSchedule        ( ) = 0;
+
         // Recording Rules
 
         virtual uint               AddRecordSchedule     ( QString   Title,
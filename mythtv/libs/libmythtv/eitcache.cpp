@@ -6,57 +6,74 @@
  */
 
 #include <QDateTime>
+#include <QDataStream>
+#include <QFile>
+#include <QDir>
 
 #include "eitcache.h"
 #include "mythcontext.h"
 #include "mythdb.h"
 #include "mythlogging.h"
 #include "mythdate.h"
+#include "mythdirs.h"
 
 #define LOC QString("EITCache: ")
 
 // Highest version number. version is 5bits
 const uint EITCache::kVersionMax = 31;
 
+// Snapshot file identification, "EITC" and the layout version
+static const quint32 kSnapshotMagic   = 0x45495443;
+static const quint32 kSnapshotVersion = 1;
+
 EITCache::EITCache()
-    : accessCnt(0), hitCnt(0), tblChgCnt(0), verChgCnt(0), endChgCnt(0),
-      entryCnt(0), pruneCnt(0), prunedHitCnt(0), futureHitCnt(0), wrongChannelHitCnt(0)
+    : snapshotLoaded(false)
 {
     // 24 hours ago
-    lastPruneTime = MythDate::current().toUTC().toTime_t() - 86400;
+    lastPruneTime.fetchAndStoreRelaxed(
+        MythDate::current().toUTC().toTime_t() - 86400);
 }
 
 EITCache::~EITCache()
 {
     WriteToDB();
+
+    for (uint i = 0; i < kShardCount; ++i)
+        qDeleteAll(shards[i].channelMap);
+    qDeleteAll(snapshotMap);
 }
 
 void EITCache::ResetStatistics(void)
 {
-    accessCnt = 0;
-    hitCnt    = 0;
-    tblChgCnt = 0;
-    verChgCnt = 0;
-    endChgCnt = 0;
-    entryCnt  = 0;
-    pruneCnt  = 0;
-    prunedHitCnt = 0;
-    futureHitCnt = 0;
-    wrongChannelHitCnt = 0;
+    accessCnt.fetchAndStoreRelaxed(0);
+    hitCnt.fetchAndStoreRelaxed(0);
+    tblChgCnt.fetchAndStoreRelaxed(0);
+    verChgCnt.fetchAndStoreRelaxed(0);
+    endChgCnt.fetchAndStoreRelaxed(0);
+    entryCnt.fetchAndStoreRelaxed(0);
+    pruneCnt.fetchAndStoreRelaxed(0);
+    prunedHitCnt.fetchAndStoreRelaxed(0);
+    futureHitCnt.fetchAndStoreRelaxed(0);
+    wrongChannelHitCnt.fetchAndStoreRelaxed(0);
 }
 
 QString EITCache::GetStatistics(void) const
 {
-    QMutexLocker locker(&eventMapLock);
+    uint access = accessCnt.loadAcquire();
+    uint hits   = hitCnt.loadAcquire();
+    uint pruned = prunedHitCnt.loadAcquire();
+    uint future = futureHitCnt.loadAcquire();
+    uint wrong  = wrongChannelHitCnt.loadAcquire();
     return QString(
         "EITCache::statistics: Accesses: %1, Hits: %2, "
         "Table Upgrades %3, New Versions: %4, New Endtimes: %5, Entries: %6, "
         "Pruned Entries: %7, Pruned Hits: %8, Future Hits: %9, Wrong Channel Hits %10, "
         "Hit Ratio %11.")
-        .arg(accessCnt).arg(hitCnt).arg(tblChgCnt).arg(verChgCnt).arg(endChgCnt)
-        .arg(entryCnt).arg(pruneCnt).arg(prunedHitCnt).arg(futureHitCnt)
-        .arg(wrongChannelHitCnt)
-        .arg((hitCnt+prunedHitCnt+futureHitCnt+wrongChannelHitCnt)/(double)accessCnt);
+        .arg(access).arg(hits).arg(tblChgCnt.loadAcquire())
+        .arg(verChgCnt.loadAcquire()).arg(endChgCnt.loadAcquire())
+        .arg(entryCnt.loadAcquire()).arg(pruneCnt.loadAcquire())
+        .arg(pruned).arg(future).arg(wrong)
+        .arg((hits+pruned+future+wrong)/(double)access);
 }
 
 static inline uint64_t construct_sig(uint tableid, uint version,
@@ -86,6 +103,33 @@ static inline bool modified(uint64_t sig)
     return sig >> 63;
 }
 
+uint EITEventTable::Prune(uint endtime)
+{
+    uint removed = 0;
+    for (uint i = 0; i < capacity(); ++i)
+    {
+        if (m_sigs[i] && extract_endtime(m_sigs[i]) <= endtime)
+            removed++;
+    }
+    if (!removed)
+        return 0;
+
+    std::vector<uint32_t> keys;
+    std::vector<uint64_t> sigs;
+    keys.swap(m_keys);
+    sigs.swap(m_sigs);
+    uint capacity = kMinCapacity;
+    while ((m_size - removed) * 2 > capacity)
+        capacity *= 2;
+    Allocate(capacity);
+    for (uint i = 0; i < sigs.size(); ++i)
+    {
+        if (sigs[i] && extract_endtime(sigs[i]) > endtime)
+            insert(keys[i], sigs[i]);
+    }
+    return removed;
+}
+
 static void replace_in_db(QStringList &value_clauses,
                           uint chanid, uint eventid, uint64_t sig)
 {
@@ -204,11 +248,37 @@ static void unlock_channel(uint chanid, uint updated)
 }
 
 
-event_map_t * EITCache::LoadChannel(uint chanid)
+/** \fn EITCache::LoadChannel(uint chanid)
+ *  \brief Locks chanid for this backend and loads its entries, from the
+ *         snapshot if it has them and from the database otherwise.
+ *
+ *  Called with the shard lock of chanid held.
+ */
+EITEventTable * EITCache::LoadChannel(uint chanid)
 {
-    if (!lock_channel(chanid, lastPruneTime))
+    uint pruneTime = lastPruneTime.loadAcquire();
+    if (!lock_channel(chanid, pruneTime))
         return NULL;
 
+    LoadSnapshot();
+
+    EITEventTable *eventMap = NULL;
+    {
+        QMutexLocker locker(&snapshotLock);
+        eventMap = snapshotMap.take(chanid);
+    }
+
+    if (eventMap)
+    {
+        eventMap->Prune(pruneTime);
+        if (eventMap->size())
+            LOG(VB_EIT, LOG_INFO, LOC +
+                QString("Loaded %1 entries for channel %2 from snapshot")
+                    .arg(eventMap->size()).arg(chanid));
+        entryCnt.fetchAndAddRelaxed(eventMap->size());
+        return eventMap;
+    }
+
     MSqlQuery query(MSqlQuery::InitCon());
 
     QString qstr =
@@ -220,7 +290,7 @@ event_map_t * EITCache::LoadChannel(uint chanid)
 
     query.prepare(qstr);
     query.bindValue(":CHANID",   chanid);
-    query.bindValue(":ENDTIME",  lastPruneTime);
+    query.bindValue(":ENDTIME",  pruneTime);
     query.bindValue(":STATUS",   EITDATA);
 
     if (!query.exec() || !query.isActive())
@@ -229,7 +299,7 @@ event_map_t * EITCache::LoadChannel(uint chanid)
         return NULL;
     }
 
-    event_map_t * eventMap = new event_map_t();
+    eventMap = new EITEventTable();
 
     while (query.next())
     {
@@ -238,48 +308,43 @@ event_map_t * EITCache::LoadChannel(uint chanid)
         uint version = query.value(2).toUInt();
         uint endtime = query.value(3).toUInt();
 
-        (*eventMap)[eventid] = construct_sig(tableid, version, endtime, false);
+        eventMap->insert(eventid,
+                         construct_sig(tableid, version, endtime, false));
     }
 
     if (eventMap->size())
         LOG(VB_EIT, LOG_INFO, LOC + QString("Loaded %1 entries for channel %2")
                 .arg(eventMap->size()).arg(chanid));
 
-    entryCnt += eventMap->size();
+    entryCnt.fetchAndAddRelaxed(eventMap->size());
     return eventMap;
 }
 
-bool EITCache::WriteChannelToDB(QStringList &value_clauses, uint chanid)
+bool EITCache::WriteChannelToDB(key_map_t &channelMap,
+                                QStringList &value_clauses, uint chanid)
 {
-    event_map_t * eventMap = channelMap[chanid];
+    EITEventTable * eventMap = channelMap[chanid];
 
     if (!eventMap)
         return false;
 
+    uint pruneTime = lastPruneTime.loadAcquire();
     uint size    = eventMap->size();
     uint updated = 0;
-    uint removed = 0;
 
-    event_map_t::iterator it = eventMap->begin();
-    while (it != eventMap->end())
+    for (uint i = 0; i < eventMap->capacity(); ++i)
     {
-        if (extract_endtime(*it) > lastPruneTime)
+        uint64_t &sig = eventMap->sig(i);
+        if (sig && modified(sig) && extract_endtime(sig) > pruneTime)
         {
-            if (modified(*it))
-            {
-                replace_in_db(value_clauses, chanid, it.key(), *it);
-                updated++;
-                *it &= ~(uint64_t)0 >> 1; // mark as synced
-            }
-            ++it;
-        }
-        else
-        {
-            // Event is too old; remove from eit cache in memory
-            it = eventMap->erase(it);
-            removed++;
+            replace_in_db(value_clauses, chanid, eventMap->eventid(i), sig);
+            updated++;
+            sig &= ~(uint64_t)0 >> 1; // mark as synced
         }
     }
+
+    // Events which are too old are removed from eit cache in memory
+    uint removed = eventMap->Prune(pruneTime);
     unlock_channel(chanid, updated);
 
     if (updated)
@@ -290,85 +355,301 @@ bool EITCache::WriteChannelToDB(QStringList &value_clauses, uint chanid)
         LOG(VB_EIT, LOG_INFO, LOC + QString("Removed %1 old entries of %2 "
                                       "for channel %3 from cache.")
                 .arg(removed).arg(size).arg(chanid));
-    pruneCnt += removed;
+    pruneCnt.fetchAndAddRelaxed(removed);
 
     return true;
 }
 
 void EITCache::WriteToDB(void)
 {
-    QMutexLocker locker(&eventMapLock);
-
     QStringList value_clauses;
-    key_map_t::iterator it = channelMap.begin();
-    while (it != channelMap.end())
+    for (uint i = 0; i < kShardCount; ++i)
     {
-        if (!WriteChannelToDB(value_clauses, it.key()))
-            it = channelMap.erase(it);
-        else
-            ++it;
+        QMutexLocker locker(&shards[i].lock);
+        key_map_t &channelMap = shards[i].channelMap;
+        key_map_t::iterator it = channelMap.begin();
+        while (it != channelMap.end())
+        {
+            if (!WriteChannelToDB(channelMap, value_clauses, it.key()))
+                it = channelMap.erase(it);
+            else
+                ++it;
+        }
     }
 
-    if(value_clauses.isEmpty())
+    if (!value_clauses.isEmpty())
     {
-        return;
+        MSqlQuery query(MSqlQuery::InitCon());
+        query.prepare(QString("REPLACE INTO eit_cache "
+                              "(chanid, eventid, tableid, version, endtime) "
+                              "VALUES %1").arg(value_clauses.join(",")));
+        if (!query.exec())
+        {
+            MythDB::DBError("Error updating eitcache", query);
+        }
     }
 
+    WriteSnapshot();
+}
+
+QString EITCache::SnapshotFilename(void)
+{
+    return GetConfDir() + "/cache/eitcache.bin";
+}
+
+/** \fn EITCache::LoadSnapshot(void)
+ *  \brief Reads the snapshot file written by WriteSnapshot() the first
+ *         time it is called.
+ *
+ *  A snapshot which is missing, unreadable or in an unknown layout is
+ *  ignored and the channels are loaded from the database instead.  So
+ *  are channels whose entries no longer match the eit_cache table, as
+ *  after "mythutil --cleareit" or when a video source is deleted.
+ */
+void EITCache::LoadSnapshot(void)
+{
+    QMutexLocker locker(&snapshotLock);
+    if (snapshotLoaded)
+        return;
+    snapshotLoaded = true;
+
+    uint pruneTime = lastPruneTime.loadAcquire();
+    if (!ReadSnapshot(SnapshotFilename(), pruneTime) || snapshotMap.empty())
+        return;
+
     MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare(QString("REPLACE INTO eit_cache "
-                          "(chanid, eventid, tableid, version, endtime) "
-                          "VALUES %1").arg(value_clauses.join(",")));
+    query.prepare("SELECT chanid, COUNT(*) "
+                  "FROM eit_cache "
+                  "WHERE endtime > :ENDTIME AND "
+                  "      status  = :STATUS "
+                  "GROUP BY chanid");
+    query.bindValue(":ENDTIME", pruneTime);
+    query.bindValue(":STATUS",  EITDATA);
+
+    QMap<uint, uint> dbCounts;
     if (!query.exec())
+        MythDB::DBError("Error checking eitcache snapshot", query);
+    while (query.next())
+        dbCounts[query.value(0).toUInt()] = query.value(1).toUInt();
+
+    CheckSnapshot(dbCounts);
+}
+
+/** \fn EITCache::ReadSnapshot(const QString&, uint)
+ *  \brief Reads the entries ending after pruneTime from a snapshot file
+ *         into snapshotMap.
+ *
+ *  Called with snapshotLock held.
+ *  \return false if the file is missing or in an unknown layout
+ */
+bool EITCache::ReadSnapshot(const QString &filename, uint pruneTime)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic, version, channels;
+    stream >> magic >> version >> channels;
+    if (stream.status() != QDataStream::Ok ||
+        magic != kSnapshotMagic || version != kSnapshotVersion)
+    {
+        LOG(VB_EIT, LOG_INFO, LOC + "Ignoring unknown snapshot " +
+            file.fileName());
+        return false;
+    }
+
+    uint entries = 0;
+    for (quint32 i = 0; i < channels; ++i)
     {
-        MythDB::DBError("Error updating eitcache", query);
+        quint32 chanid, count;
+        stream >> chanid >> count;
+        EITEventTable *eventMap = new EITEventTable();
+        for (quint32 j = 0; j < count && stream.status() == QDataStream::Ok;
+             ++j)
+        {
+            quint32 eventid;
+            quint64 sig;
+            stream >> eventid >> sig;
+            sig &= ~(uint64_t)0 >> 1;
+            if (extract_endtime(sig) > pruneTime)
+                eventMap->insert(eventid, sig);
+        }
+
+        if (stream.status() != QDataStream::Ok)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC + "Truncated snapshot " +
+                file.fileName() + ", loading remaining channels from the "
+                "database.");
+            delete eventMap;
+            break;
+        }
+
+        entries += eventMap->size();
+        delete snapshotMap.value(chanid);
+        snapshotMap[chanid] = eventMap;
+    }
+
+    LOG(VB_EIT, LOG_INFO, LOC + QString("Read %1 entries for %2 channels "
+                                        "from snapshot")
+            .arg(entries).arg(snapshotMap.size()));
+    return true;
+}
+
+/** \fn EITCache::CheckSnapshot(const QMap<uint,uint>&)
+ *  \brief Drops the snapshot channels whose number of entries differs
+ *         from the number of rows in the eit_cache table, dbCounts.
+ *
+ *  WriteSnapshot() runs after every entry was written to the table, so
+ *  the counts only differ when the table was changed behind our back.
+ *  Called with snapshotLock held.
+ */
+void EITCache::CheckSnapshot(const QMap<uint, uint> &dbCounts)
+{
+    uint dropped = 0;
+    key_map_t::iterator it = snapshotMap.begin();
+    while (it != snapshotMap.end())
+    {
+        if ((*it)->size() == dbCounts.value(it.key(), 0))
+        {
+            ++it;
+            continue;
+        }
+
+        delete *it;
+        it = snapshotMap.erase(it);
+        dropped++;
+    }
+
+    if (dropped)
+        LOG(VB_EIT, LOG_INFO, LOC + QString("%1 channels changed in the "
+                                            "database since the snapshot")
+                .arg(dropped));
+}
+
+/** \fn EITCache::WriteSnapshot(void)
+ *  \brief Writes all entries to the snapshot file, replacing it.
+ *
+ *  Channels still waiting in the snapshot for LoadChannel() are written
+ *  too, so a backend which does not scan every channel each run keeps
+ *  them.
+ */
+void EITCache::WriteSnapshot(void)
+{
+    QByteArray body;
+    QDataStream stream(&body, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_8);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 channels = 0;
+    for (uint i = 0; i <= kShardCount; ++i)
+    {
+        // The last pass writes the channels not loaded from the snapshot
+        QMutexLocker locker((i < kShardCount) ? &shards[i].lock :
+                            &snapshotLock);
+        const key_map_t &channelMap = (i < kShardCount) ?
+            shards[i].channelMap : snapshotMap;
+        key_map_t::const_iterator it = channelMap.begin();
+        for (; it != channelMap.end(); ++it)
+        {
+            const EITEventTable *eventMap = *it;
+            if (!eventMap || !eventMap->size())
+                continue;
+
+            stream << (quint32)it.key() << (quint32)eventMap->size();
+            // Old entries are dropped when the snapshot is read
+            for (uint j = 0; j < eventMap->capacity(); ++j)
+            {
+                if (eventMap->sig(j))
+                    stream << (quint32)eventMap->eventid(j)
+                           << (quint64)eventMap->sig(j);
+            }
+            channels++;
+        }
+    }
+
+    QString filename = SnapshotFilename();
+    QDir().mkpath(filename.section('/', 0, -2));
+
+    // Write to a temporary file first so a crash leaves the old snapshot
+    QFile file(filename + ".tmp");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to write snapshot " +
+            file.fileName() + ENO);
+        return;
+    }
+
+    QDataStream header(&file);
+    header.setVersion(QDataStream::Qt_4_8);
+    header.setByteOrder(QDataStream::LittleEndian);
+    header << kSnapshotMagic << kSnapshotVersion << channels;
+    bool ok = (header.status() == QDataStream::Ok) &&
+        (file.write(body) == body.size());
+    file.close();
+
+    if (ok)
+    {
+        QFile::remove(filename);
+        ok = file.rename(filename);
+    }
+    if (!ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to write snapshot " +
+            filename);
+        file.remove();
     }
 }
 
 bool EITCache::IsNewEIT(uint chanid,  uint tableid,   uint version,
                         uint eventid, uint endtime)
 {
-    accessCnt++;
+    uint count = accessCnt.fetchAndAddRelaxed(1) + 1;
 
-    if (accessCnt % 500000 == 50000)
+    if (count % 500000 == 50000)
     {
         LOG(VB_EIT, LOG_INFO, GetStatistics());
         WriteToDB();
     }
 
     // don't re-add pruned entries
-    if (endtime < lastPruneTime)
+    uint pruneTime = lastPruneTime.loadAcquire();
+    if (endtime < pruneTime)
     {
-        prunedHitCnt++;
+        prunedHitCnt.ref();
         return false;
     }
 
     // validity check, reject events with endtime over 7 weeks in the future
-    if (endtime > lastPruneTime + 50 * 86400)
+    if (endtime > pruneTime + 50 * 86400)
     {
-        futureHitCnt++;
+        futureHitCnt.ref();
         return false;
     }
 
-    QMutexLocker locker(&eventMapLock);
-    if (!channelMap.contains(chanid))
-    {
-        channelMap[chanid] = LoadChannel(chanid);
-    }
+    Shard &shard = GetShard(chanid);
+    QMutexLocker locker(&shard.lock);
+    key_map_t::iterator cit = shard.channelMap.find(chanid);
+    if (cit == shard.channelMap.end())
+        cit = shard.channelMap.insert(chanid, LoadChannel(chanid));
 
-    if (!channelMap[chanid])
+    EITEventTable * eventMap = *cit;
+    if (!eventMap)
     {
-        wrongChannelHitCnt++;
+        wrongChannelHitCnt.ref();
         return false;
     }
 
-    event_map_t * eventMap = channelMap[chanid];
-    event_map_t::iterator it = eventMap->find(eventid);
-    if (it != eventMap->end())
+    uint64_t *it = eventMap->find(eventid);
+    if (it)
     {
         if (extract_table_id(*it) > tableid)
         {
             // EIT from lower (ie. better) table number
-            tblChgCnt++;
+            tblChgCnt.ref();
         }
         else if ((extract_table_id(*it) == tableid) &&
                  ((extract_version(*it) < version) ||
@@ -376,23 +657,23 @@ bool EITCache::IsNewEIT(uint chanid,  uint tableid,   uint version,
                    version < kVersionMax)))
         {
             // EIT updated version on current table
-            verChgCnt++;
+            verChgCnt.ref();
         }
         else if (extract_endtime(*it) != endtime)
         {
             // Endtime (starttime + duration) changed
-            endChgCnt++;
+            endChgCnt.ref();
         }
         else
         {
             // EIT data previously seen
-            hitCnt++;
+            hitCnt.ref();
             return false;
         }
     }
 
     eventMap->insert(eventid, construct_sig(tableid, version, endtime, true));
-    entryCnt++;
+    entryCnt.ref();
 
     return true;
 }
@@ -411,7 +692,7 @@ uint EITCache::PruneOldEntries(uint timestamp)
             tmptime.toString(Qt::ISODate));
     }
 
-    lastPruneTime  = timestamp;
+    lastPruneTime.fetchAndStoreOrdered(timestamp);
 
     // Write all modified entries to DB and start with a clean cache
     WriteToDB();
@@ -7,20 +7,126 @@
 #define _EIT_CACHE_H
 
 #include <stdint.h>
+#include <vector>
 
 // Qt headers
 #include <QString>
 #include <QMutex>
 #include <QMap>
+#include <QAtomicInt>
 
 // MythTV headers
 #include "mythtvexp.h"
 
-typedef QMap<uint, uint64_t> event_map_t;
-typedef QMap<uint, event_map_t*> key_map_t;
+/** \class EITEventTable
+ *  \brief Open addressing hash table of event signatures by event id.
+ *
+ *  This takes 12 bytes per slot instead of the 40 odd of a QMap node,
+ *  and a lookup is normally a single cache line.  A signature of 0 marks
+ *  an empty slot, which is safe since a valid signature always has a non
+ *  zero endtime.
+ */
+class EITEventTable
+{
+  public:
+    EITEventTable() : m_size(0) { Allocate(kMinCapacity); }
+
+    uint size(void) const { return m_size; }
+    uint capacity(void) const { return m_sigs.size(); }
+    uint eventid(uint slot) const { return m_keys[slot]; }
+    uint64_t &sig(uint slot) { return m_sigs[slot]; }
+    uint64_t sig(uint slot) const { return m_sigs[slot]; }
+
+    /// \brief Returns the signature of eventid, or NULL if it is unknown.
+    uint64_t *find(uint eventid)
+    {
+        uint mask = capacity() - 1;
+        for (uint i = Hash(eventid) & mask; m_sigs[i]; i = (i + 1) & mask)
+        {
+            if (m_keys[i] == eventid)
+                return &m_sigs[i];
+        }
+        return NULL;
+    }
+
+    /// \brief Adds eventid or replaces its signature.
+    void insert(uint eventid, uint64_t sig)
+    {
+        uint64_t *old = find(eventid);
+        if (old)
+        {
+            *old = sig;
+            return;
+        }
+
+        // Keep the load factor below 3/4 so probe sequences stay short
+        if ((m_size + 1) * 4 > capacity() * 3)
+            Rehash(capacity() * 2);
+
+        uint mask = capacity() - 1;
+        uint i = Hash(eventid) & mask;
+        while (m_sigs[i])
+            i = (i + 1) & mask;
+        m_keys[i] = eventid;
+        m_sigs[i] = sig;
+        m_size++;
+    }
+
+    /// \brief Removes all events ending at or before endtime.
+    /// \return number of events removed
+    uint Prune(uint endtime);
+
+  private:
+    static const uint kMinCapacity = 64;
+
+    static uint Hash(uint eventid)
+    {
+        // Fibonacci hashing, event ids are often sequential
+        return (eventid * 2654435761U) >> 7;
+    }
+
+    void Allocate(uint capacity)
+    {
+        m_keys.assign(capacity, 0);
+        m_sigs.assign(capacity, 0);
+        m_size = 0;
+    }
+
+    void Rehash(uint capacity)
+    {
+        std::vector<uint32_t> keys;
+        std::vector<uint64_t> sigs;
+        keys.swap(m_keys);
+        sigs.swap(m_sigs);
+        Allocate(capacity);
+        for (uint i = 0; i < sigs.size(); ++i)
+        {
+            if (sigs[i])
+                insert(keys[i], sigs[i]);
+        }
+    }
+
+    std::vector<uint32_t> m_keys;
+    std::vector<uint64_t> m_sigs;
+    uint                  m_size;
+};
 
+typedef QMap<uint, EITEventTable*> key_map_t;
+
+/** \class EITCache
+ *  \brief Remembers which EIT events were seen, so that unchanged events
+ *         repeated in every carousel cycle are not parsed again.
+ *
+ *  Channels are spread over kShardCount shards by chanid, each with its
+ *  own lock, so tuners scanning different channels do not wait for each
+ *  other.  The cache is written to a snapshot file alongside the
+ *  eit_cache table and channels found in the snapshot are loaded from
+ *  it instead of the database.
+ */
 class EITCache
 {
+    friend class TestEITCache;
+
   public:
     EITCache();
    ~EITCache();
@@ -35,26 +141,44 @@ class EITCache
     QString GetStatistics(void) const;
 
   private:
-    event_map_t * LoadChannel(uint chanid);
-    bool WriteChannelToDB(QStringList &value_clauses, uint chanid);
-
-    // event key cache
-    key_map_t   channelMap;
-
-    mutable QMutex eventMapLock;
-    uint            lastPruneTime;
+    class Shard
+    {
+      public:
+        QMutex     lock;
+        key_map_t  channelMap;
+    };
+
+    Shard &GetShard(uint chanid) { return shards[chanid % kShardCount]; }
+    EITEventTable * LoadChannel(uint chanid);
+    bool WriteChannelToDB(key_map_t &channelMap, QStringList &value_clauses,
+                          uint chanid);
+    void LoadSnapshot(void);
+    bool ReadSnapshot(const QString &filename, uint pruneTime);
+    void CheckSnapshot(const QMap<uint, uint> &dbCounts);
+    void WriteSnapshot(void);
+    static QString SnapshotFilename(void);
+
+    static const uint kShardCount = 16;
+    Shard           shards[kShardCount];
+
+    // snapshot entries not yet claimed by LoadChannel()
+    QMutex          snapshotLock;
+    key_map_t       snapshotMap;
+    bool            snapshotLoaded;
+
+    QAtomicInt      lastPruneTime;
 
     // statistics
-    uint        accessCnt;
-    uint        hitCnt;
-    uint        tblChgCnt;
-    uint        verChgCnt;
-    uint        endChgCnt;
-    uint        entryCnt;
-    uint        pruneCnt;
-    uint        prunedHitCnt;
-    uint        futureHitCnt;
-    uint        wrongChannelHitCnt;
+    QAtomicInt  accessCnt;
+    QAtomicInt  hitCnt;
+    QAtomicInt  tblChgCnt;
+    QAtomicInt  verChgCnt;
+    QAtomicInt  endChgCnt;
+    QAtomicInt  entryCnt;
+    QAtomicInt  pruneCnt;
+    QAtomicInt  prunedHitCnt;
+    QAtomicInt  futureHitCnt;
+    QAtomicInt  wrongChannelHitCnt;
 
     static const uint kVersionMax;
 
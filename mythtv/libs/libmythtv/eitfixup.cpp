@@ -1,6 +1,9 @@
 // C++ headers
 #include <algorithm>
 
+// Qt headers
+#include <QElapsedTimer>
+
 // MythTV headers
 #include "eitfixup.h"
 #include "programinfo.h" // for CategoryType
@@ -46,7 +49,16 @@ const QString shortContext =
 
 
 EITFixUp::EITFixUp()
-    : m_bellYear("[\\(]{1}[0-9]{4}[\\)]{1}"),
+    : m_ukKeyThen(0), m_ukKeyNew(0), m_ukKeyBBC34(0), m_ukKeyRpt(0),
+      m_ukKeyAllNew(0), m_ukKeyAlsoInHD(0), m_ukKeyPart(0), m_ukKeyPt(0),
+      m_ukKeyStarring(0),
+      m_nlKeyStereo(0), m_nlKeyWide(0), m_nlKeyRepeat(0), m_nlKeyTxt(0),
+      m_nlKeyHD(0), m_nlKeySub(0), m_nlKeyQuote(0), m_nlKeyActors(0),
+      m_nlKeyPres(0), m_nlKeyUit(0), m_nlKeyVan(0), m_nlKeyParen(0),
+      m_dkKeyParen(0), m_dkKeyColon(0), m_dkKeyDash(0), m_dkKeySeason(0),
+      m_dkKeyYear(0), m_dkKeyFeatures(0), m_dkKeyDirector(0),
+      m_dkKeyActors(0), m_dkKeyFra(0), m_prefilter(true),
+      m_bellYear("[\\(]{1}[0-9]{4}[\\)]{1}"),
       m_bellActors("\\set\\s|,"),
       m_bellPPVTitleAllDayHD("\\s*\\(All Day\\, HD\\)\\s*$"),
       m_bellPPVTitleAllDay("\\s*\\(All Day.*\\)\\s*$"),
@@ -242,6 +254,147 @@ EITFixUp::EITFixUp()
       m_grCategSpecial("(?:\\W)?(αφι[εέ]ρωμα)(?:\\W)?",Qt::CaseInsensitive),
       m_unitymediaImdbrating("\\s*IMDb Rating: (\\d\\.\\d) /10$")
 {
+    // Each UK expression which runs on every event needs at least one of
+    // these, so a single scan of the title and description tells which
+    // of them are worth trying.  The scan ignores case, which is a
+    // superset for the case sensitive expressions.
+    m_ukKeyThen     = m_ukKeywords.add("60 Seconds.");
+    m_ukKeyNew      = m_ukKeywords.add("New");
+    m_ukKeyBBC34    = m_ukKeywords.add(" on BBC ");
+    m_ukKeyRpt      = m_ukKeywords.add("[Rpt");
+    m_ukKeyAllNew   = m_ukKeywords.add("All New To 4Music!");
+    m_ukKeyAlsoInHD = m_ukKeywords.add("Also in HD.");
+    m_ukKeyPart     = m_ukKeywords.add("Part");
+    m_ukKeyPt       = m_ukKeywords.add("Pt");
+    m_ukKeyStarring = m_ukKeywords.add("tarring ");
+    m_ukKeywords.build();
+
+    // The same for the Dutch expressions, on the title or on the
+    // subtitle and description together
+    m_nlKeyStereo   = m_nlKeywords.add("stereo");
+    m_nlKeyWide     = m_nlKeywords.add("breedbeeld");
+    m_nlKeyRepeat   = m_nlKeywords.add("herh");
+    m_nlKeyTxt      = m_nlKeywords.add("txt");
+    m_nlKeyHD       = m_nlKeywords.add("HD");
+    m_nlKeySub      = m_nlKeywords.add("Afl.:");
+    m_nlKeyQuote    = m_nlKeywords.add("\"");
+    m_nlKeyActors   = m_nlKeywords.add("Met:");
+    m_nlKeyPres     = m_nlKeywords.add("Presentatie:");
+    m_nlKeyUit      = m_nlKeywords.add("uit");
+    m_nlKeyVan      = m_nlKeywords.add("van");
+    m_nlKeyParen    = m_nlKeywords.add("(");
+    m_nlKeywords.build();
+
+    // And the Danish ones
+    m_dkKeyParen    = m_dkKeywords.add("(");
+    m_dkKeyColon    = m_dkKeywords.add(": ");
+    m_dkKeyDash     = m_dkKeywords.add(" - ");
+    m_dkKeySeason   = m_dkKeywords.add("S\xE6son ");
+    m_dkKeyYear     = m_dkKeywords.add("- \xE5r ");
+    m_dkKeyFeatures = m_dkKeywords.add("Features:");
+    m_dkKeyDirector = m_dkKeywords.add("Instr");
+    m_dkKeyActors   = m_dkKeywords.add("Medv");
+    m_dkKeyFra      = m_dkKeywords.add(" fra ");
+    m_dkKeywords.build();
+}
+
+/** \class FixupTimer
+ *  \brief Counts and times one fixup on one event for EITFixUp::LogStats().
+ */
+class FixupTimer
+{
+  public:
+    FixupTimer(const EITFixUp *fixup, FixupValue type, const DBEventEIT &event)
+        : m_stats(fixup->m_stats[EITFixUp::StatsIndex(type)]),
+          m_event(event),
+          m_enabled(VERBOSE_LEVEL_CHECK(VB_EIT, LOG_INFO))
+    {
+        // Nobody will see the stats, so don't pay for them
+        if (!m_enabled)
+            return;
+        m_title       = event.title;
+        m_subtitle    = event.subtitle;
+        m_description = event.description;
+        m_timer.start();
+    }
+
+    ~FixupTimer()
+    {
+        if (!m_enabled)
+            return;
+        m_stats.nsecs += m_timer.nsecsElapsed();
+        m_stats.events++;
+        if (m_event.title != m_title || m_event.subtitle != m_subtitle ||
+            m_event.description != m_description)
+            m_stats.changed++;
+    }
+
+  private:
+    EITFixUp::FixupStats &m_stats;
+    const DBEventEIT     &m_event;
+    bool                  m_enabled;
+    QString               m_title;
+    QString               m_subtitle;
+    QString               m_description;
+    QElapsedTimer         m_timer;
+};
+
+uint EITFixUp::StatsIndex(FixupValue fixup)
+{
+    uint index = 0;
+    while (index + 1 < kStatsSize && !(fixup & 1))
+    {
+        fixup >>= 1;
+        index++;
+    }
+    return index;
+}
+
+void EITFixUp::LogStats(void) const
+{
+    static const struct { FixupValue type; const char *name; } names[] =
+    {
+        { kFixHTML,            "HTML"            },
+        { kFixBell,            "Bell"            },
+        { kFixDish,            "Dish"            },
+        { kFixUK,              "UK"              },
+        { kFixPBS,             "PBS"             },
+        { kFixComHem,          "ComHem"          },
+        { kFixAUStar,          "AUStar"          },
+        { kFixAUDescription,   "AUDescription"   },
+        { kFixAUFreeview,      "AUFreeview"      },
+        { kFixAUNine,          "AUNine"          },
+        { kFixAUSeven,         "AUSeven"         },
+        { kFixMCA,             "MCA"             },
+        { kFixRTL,             "RTL"             },
+        { kFixP7S1,            "PRO7"            },
+        { kFixATV,             "ATV"             },
+        { kFixDisneyChannel,   "DisneyChannel"   },
+        { kFixFI,              "FI"              },
+        { kFixPremiere,        "Premiere"        },
+        { kFixNL,              "NL"              },
+        { kFixNO,              "NO"              },
+        { kFixNRK_DVBT,        "NRK_DVBT"        },
+        { kFixDK,              "DK"              },
+        { kFixCategory,        "Category"        },
+        { kFixGreekSubtitle,   "GreekSubtitle"   },
+        { kFixGreekEIT,        "GreekEIT"        },
+        { kFixGreekCategories, "GreekCategories" },
+        { kFixUnitymedia,      "Unitymedia"      },
+    };
+
+    for (uint i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+    {
+        const FixupStats &stats = m_stats[StatsIndex(names[i].type)];
+        if (!stats.events)
+            continue;
+        LOG(VB_EIT, LOG_INFO,
+            QString("EITFixUp: %1 ran on %2 events, changed %3, "
+                    "prefilter skipped %4 rules, %5 usec per event")
+                .arg(names[i].name).arg(stats.events).arg(stats.changed)
+                .arg(stats.skipped)
+                .arg(stats.nsecs / 1000.0 / stats.events, 0, 'f', 1));
+    }
 }
 
 void EITFixUp::Fix(DBEventEIT &event) const
@@ -259,88 +412,169 @@ void EITFixUp::Fix(DBEventEIT &event) const
     }
 
     if (kFixHTML & event.fixup)
+    {
+        FixupTimer timer(this, kFixHTML, event);
         FixStripHTML(event);
+    }
 
     if (kFixHDTV & event.fixup)
         event.videoProps |= VID_HDTV;
 
     if (kFixBell & event.fixup)
+    {
+        FixupTimer timer(this, kFixBell, event);
         FixBellExpressVu(event);
+    }
 
     if (kFixDish & event.fixup)
+    {
+        FixupTimer timer(this, kFixDish, event);
         FixBellExpressVu(event);
+    }
 
     if (kFixUK & event.fixup)
+    {
+        FixupTimer timer(this, kFixUK, event);
         FixUK(event);
+    }
 
     if (kFixPBS & event.fixup)
+    {
+        FixupTimer timer(this, kFixPBS, event);
         FixPBS(event);
+    }
 
     if (kFixComHem & event.fixup)
+    {
+        FixupTimer timer(this, kFixComHem, event);
         FixComHem(event, kFixSubtitle & event.fixup);
+    }
 
     if (kFixAUStar & event.fixup)
+    {
+        FixupTimer timer(this, kFixAUStar, event);
         FixAUStar(event);
+    }
 
     if (kFixAUDescription & event.fixup)
+    {
+        FixupTimer timer(this, kFixAUDescription, event);
         FixAUDescription(event);
+    }
 
     if (kFixAUFreeview & event.fixup)
+    {
+        FixupTimer timer(this, kFixAUFreeview, event);
         FixAUFreeview(event);
+    }
 
     if (kFixAUNine & event.fixup)
+    {
+        FixupTimer timer(this, kFixAUNine, event);
         FixAUNine(event);
+    }
 
     if (kFixAUSeven & event.fixup)
+    {
+        FixupTimer timer(this, kFixAUSeven, event);
         FixAUSeven(event);
+    }
 
     if (kFixMCA & event.fixup)
+    {
+        FixupTimer timer(this, kFixMCA, event);
         FixMCA(event);
+    }
 
     if (kFixRTL & event.fixup)
+    {
+        FixupTimer timer(this, kFixRTL, event);
         FixRTL(event);
+    }
 
     if (kFixP7S1 & event.fixup)
+    {
+        FixupTimer timer(this, kFixP7S1, event);
         FixPRO7(event);
+    }
 
     if (kFixATV & event.fixup)
+    {
+        FixupTimer timer(this, kFixATV, event);
         FixATV(event);
+    }
 
     if (kFixDisneyChannel & event.fixup)
+    {
+        FixupTimer timer(this, kFixDisneyChannel, event);
         FixDisneyChannel(event);
+    }
 
     if (kFixFI & event.fixup)
+    {
+        FixupTimer timer(this, kFixFI, event);
         FixFI(event);
+    }
 
     if (kFixPremiere & event.fixup)
+    {
+        FixupTimer timer(this, kFixPremiere, event);
         FixPremiere(event);
+    }
 
     if (kFixNL & event.fixup)
+    {
+        FixupTimer timer(this, kFixNL, event);
         FixNL(event);
+    }
 
     if (kFixNO & event.fixup)
+    {
+        FixupTimer timer(this, kFixNO, event);
         FixNO(event);
+    }
 
     if (kFixNRK_DVBT & event.fixup)
+    {
+        FixupTimer timer(this, kFixNRK_DVBT, event);
         FixNRK_DVBT(event);
+    }
 
     if (kFixDK & event.fixup)
+    {
+        FixupTimer timer(this, kFixDK, event);
         FixDK(event);
+    }
 
     if (kFixCategory & event.fixup)
+    {
+        FixupTimer timer(this, kFixCategory, event);
         FixCategory(event);
+    }
 
     if (kFixGreekSubtitle & event.fixup)
+    {
+        FixupTimer timer(this, kFixGreekSubtitle, event);
         FixGreekSubtitle(event);
+    }
 
     if (kFixGreekEIT & event.fixup)
+    {
+        FixupTimer timer(this, kFixGreekEIT, event);
         FixGreekEIT(event);
+    }
 
     if (kFixGreekCategories & event.fixup)
+    {
+        FixupTimer timer(this, kFixGreekCategories, event);
         FixGreekCategories(event);
+    }
 
     if (kFixUnitymedia & event.fixup)
+    {
+        FixupTimer timer(this, kFixUnitymedia, event);
         FixUnitymedia(event);
+    }
 
     if (event.fixup)
     {
@@ -845,26 +1079,51 @@ void EITFixUp::FixUK(DBEventEIT &event) const
 
     bool isMovie = event.category.startsWith("Movie",Qt::CaseInsensitive) ||
                    event.category.startsWith("Film",Qt::CaseInsensitive);
+
+    // Only try the expressions whose literals are present
+    uint skipped = 0;
+    quint64 keys = ScanUK(event);
+
     // BBC three case (could add another record here ?)
-    event.description = event.description.remove(m_ukThen);
-    event.description = event.description.remove(m_ukNew);
-    event.title = event.title.remove(m_ukNewTitle);
+    if (keys & m_ukKeyThen)
+        RemoveUK(event.description, m_ukThen, event, keys);
+    else
+        skipped++;
+    if (keys & m_ukKeyNew)
+    {
+        RemoveUK(event.description, m_ukNew, event, keys);
+        RemoveUK(event.title, m_ukNewTitle, event, keys);
+    }
+    else
+        skipped += 2;
 
     // Removal of Class TV, CBBC and CBeebies etc..
     event.title = event.title.remove(m_ukTitleRemove);
     event.description = event.description.remove(m_ukDescriptionRemove);
 
     // Removal of BBC FOUR and BBC THREE
-    event.description = event.description.remove(m_ukBBC34);
+    if (keys & m_ukKeyBBC34)
+        RemoveUK(event.description, m_ukBBC34, event, keys);
+    else
+        skipped++;
 
     // BBC 7 [Rpt of ...] case.
-    event.description = event.description.remove(m_ukBBC7rpt);
+    if (keys & m_ukKeyRpt)
+        RemoveUK(event.description, m_ukBBC7rpt, event, keys);
+    else
+        skipped++;
 
     // "All New To 4Music!
-    event.description = event.description.remove(m_ukAllNew);
+    if (keys & m_ukKeyAllNew)
+        RemoveUK(event.description, m_ukAllNew, event, keys);
+    else
+        skipped++;
 
     // Removal of 'Also in HD' text
- 	event.description = event.description.remove(m_ukAlsoInHD);
+    if (keys & m_ukKeyAlsoInHD)
+        RemoveUK(event.description, m_ukAlsoInHD, event, keys);
+    else
+        skipped++;
 
     // Remove [AD,S] etc.
     bool    ccMatched = false;
@@ -960,8 +1219,12 @@ void EITFixUp::FixUK(DBEventEIT &event) const
 
     // Multi-part episodes, or films (e.g. ITV film split by news)
     // Matches Part 1, Pt 1/2, Part 1 of 2 etc.
+    // The removals above can join text up into a new keyword
+    keys = ScanUK(event);
     QRegExp tmpPart = m_ukPart;
-    if ((position1 = tmpPart.indexIn(event.title)) != -1)
+    if (!(keys & (m_ukKeyPart | m_ukKeyPt)))
+        skipped++;
+    else if ((position1 = tmpPart.indexIn(event.title)) != -1)
     {
         event.partnumber = tmpPart.cap(1).toUInt();
         event.parttotal  = tmpPart.cap(2).toUInt();
@@ -988,11 +1251,14 @@ void EITFixUp::FixUK(DBEventEIT &event) const
             // Retain a single colon (subtitle separator) if we remove any
             QString sub = tmpPart.cap(0).contains(":") ? ":" : "";
             event.description = event.description.replace(tmpPart.cap(0), sub);
+            keys = ScanUK(event);
         }
     }
 
     QRegExp tmpStarring = m_ukStarring;
-    if (tmpStarring.indexIn(event.description) != -1)
+    if (!(keys & m_ukKeyStarring))
+        skipped++;
+    else if (tmpStarring.indexIn(event.description) != -1)
     {
         // if we match this we've captured 2 actors and an (optional) airdate
         event.AddPerson(DBPerson::kActor, tmpStarring.cap(1));
@@ -1132,6 +1398,43 @@ void EITFixUp::FixUK(DBEventEIT &event) const
         event.description=event.subtitle;
         event.subtitle=QString::null;
     }
+
+    m_stats[StatsIndex(kFixUK)].skipped += skipped;
+}
+
+/** \fn EITFixUp::ScanUK(const DBEventEIT&) const
+ *  \brief Returns the UK keywords found in the title and description,
+ *         or all of them if the prefilter is off.
+ */
+quint64 EITFixUp::ScanUK(const DBEventEIT &event) const
+{
+    return Scan(m_ukKeywords, event.title) |
+           Scan(m_ukKeywords, event.description);
+}
+
+/** \fn EITFixUp::Scan(const KeywordScanner&,const QString&) const
+ *  \brief Returns the keywords found in str, or all of them if the
+ *         prefilter is off.
+ */
+quint64 EITFixUp::Scan(const KeywordScanner &keywords,
+                       const QString &str) const
+{
+    if (!m_prefilter)
+        return ~0ULL;
+    return keywords.scan(str);
+}
+
+/** \fn EITFixUp::RemoveUK(QString&,const QRegExp&,const DBEventEIT&,quint64&) const
+ *  \brief Removes the matches of a UK expression from str, scanning for
+ *         keywords again if anything was removed.
+ */
+void EITFixUp::RemoveUK(QString &str, const QRegExp &re,
+                        const DBEventEIT &event, quint64 &keys) const
+{
+    int length = str.length();
+    str.remove(re);
+    if (str.length() != length)
+        keys = ScanUK(event);
 }
 
 /** \fn EITFixUp::FixPBS(DBEventEIT&) const
@@ -2083,59 +2386,87 @@ void EITFixUp::FixNL(DBEventEIT &event) const
         event.categoryType = ProgramInfo::kCategorySeries;
     }
 
+    // Only try the expressions whose literals are present.  Anything
+    // replaced can join the text up into a new keyword, so it is
+    // scanned again after each change.
+    uint skipped = 0;
+    quint64 keys = Scan(m_nlKeywords, fullinfo);
+    quint64 titleKeys = Scan(m_nlKeywords, event.title);
+
     // Get stereo info
-    if (fullinfo.indexOf(m_Stereo) != -1)
+    if (!(keys & m_nlKeyStereo))
+        skipped++;
+    else if (fullinfo.indexOf(m_Stereo) != -1)
     {
         event.audioProps |= AUD_STEREO;
         fullinfo = fullinfo.replace(m_Stereo, ".");
+        keys = Scan(m_nlKeywords, fullinfo);
     }
 
     //Get widescreen info
-    if (fullinfo.indexOf(m_nlWide) != -1)
+    if (!(keys & m_nlKeyWide))
+        skipped++;
+    else if (fullinfo.indexOf(m_nlWide) != -1)
     {
         fullinfo = fullinfo.replace("breedbeeld", ".");
+        keys = Scan(m_nlKeywords, fullinfo);
     }
 
     // Get repeat info
-    if (fullinfo.indexOf(m_nlRepeat) != -1)
+    if (!(keys & m_nlKeyRepeat))
+        skipped++;
+    else if (fullinfo.indexOf(m_nlRepeat) != -1)
     {
         fullinfo = fullinfo.replace("herh.", ".");
+        keys = Scan(m_nlKeywords, fullinfo);
     }
 
     // Get teletext subtitle info
-    if (fullinfo.indexOf(m_nlTxt) != -1)
+    if (!(keys & m_nlKeyTxt))
+        skipped++;
+    else if (fullinfo.indexOf(m_nlTxt) != -1)
     {
         event.subtitleType |= SUB_NORMAL;
         fullinfo = fullinfo.replace("txt", ".");
+        keys = Scan(m_nlKeywords, fullinfo);
     }
 
     // Get HDTV information
-    if (event.title.indexOf(m_nlHD) != -1)
+    if (!(titleKeys & m_nlKeyHD))
+        skipped++;
+    else if (event.title.indexOf(m_nlHD) != -1)
     {
         event.videoProps |= VID_HDTV;
         event.title = event.title.replace(m_nlHD, "");
+        titleKeys = Scan(m_nlKeywords, event.title);
     }
 
     // Try to make subtitle from Afl.:
     QRegExp tmpSub = m_nlSub;
     QString tmpSubString;
-    if (tmpSub.indexIn(fullinfo) != -1)
+    if (!(keys & m_nlKeySub))
+        skipped++;
+    else if (tmpSub.indexIn(fullinfo) != -1)
     {
         tmpSubString = tmpSub.cap(0);
         tmpSubString = tmpSubString.right(tmpSubString.length() - 7);
         event.subtitle = tmpSubString.left(tmpSubString.length() -1);
         fullinfo = fullinfo.replace(tmpSub.cap(0), "");
+        keys = Scan(m_nlKeywords, fullinfo);
     }
 
     // Try to make subtitle from " "
     QRegExp tmpSub2 = m_nlSub2;
     //QString tmpSubString2;
-    if (tmpSub2.indexIn(fullinfo) != -1)
+    if (!(keys & m_nlKeyQuote))
+        skipped++;
+    else if (tmpSub2.indexIn(fullinfo) != -1)
     {
         tmpSubString = tmpSub2.cap(0);
         tmpSubString = tmpSubString.right(tmpSubString.length() - 2);
         event.subtitle = tmpSubString.left(tmpSubString.length() -1);
         fullinfo = fullinfo.replace(tmpSub2.cap(0), "");
+        keys = Scan(m_nlKeywords, fullinfo);
     }
 
 
@@ -2148,12 +2479,15 @@ void EITFixUp::FixNL(DBEventEIT &event) const
     {
         event.subtitle = event.title.mid(position + 1);
         event.title = event.title.left(position);
+        titleKeys = Scan(m_nlKeywords, event.title);
     }
 
 
     // Get the actors
     QRegExp tmpActors = m_nlActors;
-    if (tmpActors.indexIn(fullinfo) != -1)
+    if (!(keys & m_nlKeyActors))
+        skipped++;
+    else if (tmpActors.indexIn(fullinfo) != -1)
     {
         QString tmpActorsString = tmpActors.cap(0);
         tmpActorsString = tmpActorsString.right(tmpActorsString.length() - 6);
@@ -2164,11 +2498,14 @@ void EITFixUp::FixNL(DBEventEIT &event) const
         for (; it != actors.end(); ++it)
             event.AddPerson(DBPerson::kActor, *it);
         fullinfo = fullinfo.replace(tmpActors.cap(0), "");
+        keys = Scan(m_nlKeywords, fullinfo);
     }
 
     // Try to find presenter
     QRegExp tmpPres = m_nlPres;
-    if (tmpPres.indexIn(fullinfo) != -1)
+    if (!(keys & m_nlKeyPres))
+        skipped++;
+    else if (tmpPres.indexIn(fullinfo) != -1)
     {
         QString tmpPresString = tmpPres.cap(0);
         tmpPresString = tmpPresString.right(tmpPresString.length() - 14);
@@ -2179,12 +2516,15 @@ void EITFixUp::FixNL(DBEventEIT &event) const
         for (; it != host.end(); ++it)
             event.AddPerson(DBPerson::kPresenter, *it);
         fullinfo = fullinfo.replace(tmpPres.cap(0), "");
+        keys = Scan(m_nlKeywords, fullinfo);
     }
 
     // Try to find year
     QRegExp tmpYear1 = m_nlYear1;
     QRegExp tmpYear2 = m_nlYear2;
-    if (tmpYear1.indexIn(fullinfo) != -1)
+    if (!(keys & m_nlKeyUit))
+        skipped++;
+    else if (tmpYear1.indexIn(fullinfo) != -1)
     {
         bool ok;
         uint y = tmpYear1.cap(0).toUInt(&ok);
@@ -2192,7 +2532,9 @@ void EITFixUp::FixNL(DBEventEIT &event) const
             event.originalairdate = QDate(y, 1, 1);
     }
 
-    if (tmpYear2.indexIn(fullinfo) != -1)
+    if (!(keys & m_nlKeyParen))
+        skipped++;
+    else if (tmpYear2.indexIn(fullinfo) != -1)
     {
         bool ok;
         uint y = tmpYear2.cap(2).toUInt(&ok);
@@ -2203,14 +2545,18 @@ void EITFixUp::FixNL(DBEventEIT &event) const
     // Try to find director
     QRegExp tmpDirector = m_nlDirector;
     QString tmpDirectorString;
-    if (fullinfo.indexOf(m_nlDirector) != -1)
+    if (!(keys & m_nlKeyVan))
+        skipped++;
+    else if (fullinfo.indexOf(m_nlDirector) != -1)
     {
         tmpDirectorString = tmpDirector.cap(0);
         event.AddPerson(DBPerson::kDirector, tmpDirectorString);
     }
 
     // Strip leftovers
-    if (fullinfo.indexOf(m_nlRub) != -1)
+    if (!(keys & m_nlKeyParen))
+        skipped++;
+    else if (fullinfo.indexOf(m_nlRub) != -1)
     {
         fullinfo = fullinfo.replace(m_nlRub, "");
     }
@@ -2222,7 +2568,9 @@ void EITFixUp::FixNL(DBEventEIT &event) const
     }
 
     // Remove omroep from title
-    if (event.title.indexOf(m_nlOmroep) != -1)
+    if (!(titleKeys & m_nlKeyParen))
+        skipped++;
+    else if (event.title.indexOf(m_nlOmroep) != -1)
     {
         event.title = event.title.replace(m_nlOmroep, "");
     }
@@ -2234,6 +2582,7 @@ void EITFixUp::FixNL(DBEventEIT &event) const
     event.title       = event.title.trimmed();
     event.subtitle    = event.subtitle.trimmed();
 
+    m_stats[StatsIndex(kFixNL)].skipped += skipped;
 }
 
 void EITFixUp::FixCategory(DBEventEIT &event) const
@@ -2340,31 +2689,42 @@ void EITFixUp::FixDK(DBEventEIT &event) const
     int        episode = -1;
     int        season = -1;
     QRegExp    tmpRegEx;
+
+    // Only try the expressions whose literals are present, scanning
+    // again whenever a removal could have joined up a new keyword
+    uint skipped = 0;
+    quint64 titleKeys = Scan(m_dkKeywords, event.title);
+    quint64 keys = Scan(m_dkKeywords, event.description);
+
     // Title search
     // episode and part/part total
     tmpRegEx = m_dkEpisode;
-    position = event.title.indexOf(tmpRegEx);
-    if (position != -1)
+    if (!(titleKeys & m_dkKeyParen))
+        skipped++;
+    else if ((position = event.title.indexOf(tmpRegEx)) != -1)
     {
       episode = tmpRegEx.cap(1).toInt();
       event.partnumber = tmpRegEx.cap(1).toInt();
       event.title = event.title.replace(tmpRegEx, "");
+      titleKeys = Scan(m_dkKeywords, event.title);
     }
 
     tmpRegEx = m_dkPart;
-    position = event.title.indexOf(tmpRegEx);
-    if (position != -1)
+    if (!(titleKeys & m_dkKeyParen))
+        skipped++;
+    else if ((position = event.title.indexOf(tmpRegEx)) != -1)
     {
       episode = tmpRegEx.cap(1).toInt();
       event.partnumber = tmpRegEx.cap(1).toInt();
       event.parttotal = tmpRegEx.cap(2).toInt();
       event.title = event.title.replace(tmpRegEx, "");
+      titleKeys = Scan(m_dkKeywords, event.title);
     }
 
     // subtitle delimiters
     tmpRegEx = m_dkSubtitle1;
-    position = event.title.indexOf(tmpRegEx);
-    if (position != -1)
+    if ((titleKeys & m_dkKeyColon) &&
+        (position = event.title.indexOf(tmpRegEx)) != -1)
     {
       event.title = tmpRegEx.cap(1);
       event.subtitle = tmpRegEx.cap(2);
@@ -2372,7 +2732,9 @@ void EITFixUp::FixDK(DBEventEIT &event) const
     else
     {
         tmpRegEx = m_dkSubtitle2;
-        if(event.title.indexOf(tmpRegEx) != -1)
+        if (!(titleKeys & m_dkKeyDash))
+            skipped++;
+        else if(event.title.indexOf(tmpRegEx) != -1)
         {
             event.title = tmpRegEx.cap(1);
             event.subtitle = tmpRegEx.cap(2);
@@ -2382,15 +2744,17 @@ void EITFixUp::FixDK(DBEventEIT &event) const
     // Season (Sæson [:digit:]+.) => episode = season episode number
     // or year (- år [:digit:]+(\\)|:) ) => episode = total episode number
     tmpRegEx = m_dkSeason1;
-    position = event.description.indexOf(tmpRegEx);
-    if (position != -1)
+    if ((keys & m_dkKeySeason) &&
+        (position = event.description.indexOf(tmpRegEx)) != -1)
     {
       season = tmpRegEx.cap(1).toInt();
     }
     else
     {
         tmpRegEx = m_dkSeason2;
-        if(event.description.indexOf(tmpRegEx) !=  -1)
+        if (!(keys & m_dkKeyYear))
+            skipped++;
+        else if(event.description.indexOf(tmpRegEx) !=  -1)
         {
             season = tmpRegEx.cap(1).toInt();
         }
@@ -2404,11 +2768,13 @@ void EITFixUp::FixDK(DBEventEIT &event) const
 
     //Feature:
     tmpRegEx = m_dkFeatures;
-    position = event.description.indexOf(tmpRegEx);
-    if (position != -1)
+    if (!(keys & m_dkKeyFeatures))
+        skipped++;
+    else if ((position = event.description.indexOf(tmpRegEx)) != -1)
     {
         QString features = tmpRegEx.cap(1);
         event.description = event.description.replace(tmpRegEx, "");
+        keys = Scan(m_dkKeywords, event.description);
         // 16:9
         if (features.indexOf(m_dkWidescreen) !=  -1)
             event.videoProps |= VID_WIDESCREEN;
@@ -2473,8 +2839,9 @@ void EITFixUp::FixDK(DBEventEIT &event) const
     // Find actors and director in description
     tmpRegEx = m_dkDirector;
     bool directorPresent = false;
-    position = event.description.indexOf(tmpRegEx);
-    if (position != -1)
+    if (!(keys & m_dkKeyDirector))
+        skipped++;
+    else if ((position = event.description.indexOf(tmpRegEx)) != -1)
     {
         QString tmpDirectorsString = tmpRegEx.cap(1);
         const QStringList directors =
@@ -2491,8 +2858,9 @@ void EITFixUp::FixDK(DBEventEIT &event) const
     }
 
     tmpRegEx = m_dkActors;
-    position = event.description.indexOf(tmpRegEx);
-    if (position != -1)
+    if (!(keys & m_dkKeyActors))
+        skipped++;
+    else if ((position = event.description.indexOf(tmpRegEx)) != -1)
     {
         QString tmpActorsString = tmpRegEx.cap(1);
         if (directorPresent)
@@ -2510,8 +2878,9 @@ void EITFixUp::FixDK(DBEventEIT &event) const
     }
     //find year
     tmpRegEx = m_dkYear;
-    position = event.description.indexOf(tmpRegEx);
-    if (position != -1)
+    if (!(keys & m_dkKeyFra))
+        skipped++;
+    else if ((position = event.description.indexOf(tmpRegEx)) != -1)
     {
         bool ok;
         uint y = tmpRegEx.cap(1).toUInt(&ok);
@@ -2522,6 +2891,8 @@ void EITFixUp::FixDK(DBEventEIT &event) const
     event.description = event.description.trimmed();
     event.title       = event.title.trimmed();
     event.subtitle    = event.subtitle.trimmed();
+
+    m_stats[StatsIndex(kFixDK)].skipped += skipped;
 }
 
 /** \fn EITFixUp::FixStripHTML(DBEventEIT&) const
@@ -8,6 +8,7 @@
 #include <QRegExp>
 
 #include "programdata.h"
+#include "keywordscanner.h"
 
 typedef QMap<uint,uint> QMap_uint_t;
 
@@ -78,6 +79,14 @@ class EITFixUp
 
     void Fix(DBEventEIT &event) const;
 
+    /// \brief Logs how often each fixup ran, changed an event, had
+    ///        rules skipped by the keyword prefilter and how long it took.
+    void LogStats(void) const;
+
+    /// \brief Turns the keyword prefilter in front of the regular
+    ///        expressions on or off.  It is on by default.
+    void SetPrefilter(bool enable) { m_prefilter = enable; }
+
     /** Corrects starttime to the multiple of a minute. 
      *  Used for providers who fail to handle leap seconds timely. Changes the
      *  starttime not more than 3 seconds. Sshould only be used if the
@@ -95,6 +104,10 @@ class EITFixUp
     void FixBellExpressVu(DBEventEIT &event) const; // Canada DVB-S
     void SetUKSubtitle(DBEventEIT &event) const;
     void FixUK(DBEventEIT &event) const;            // UK DVB-T
+    quint64 ScanUK(const DBEventEIT &event) const;
+    quint64 Scan(const KeywordScanner &keywords, const QString &str) const;
+    void RemoveUK(QString &str, const QRegExp &re,
+                  const DBEventEIT &event, quint64 &keys) const;
     void FixPBS(DBEventEIT &event) const;           // USA ATSC
     void FixComHem(DBEventEIT &event,
                    bool parse_subtitle) const;      // Sweden DVB-C
@@ -123,6 +136,62 @@ class EITFixUp
 
     static QString AddDVBEITAuthority(uint chanid, const QString &id);
 
+    /// Counters for one fixup, only updated from Fix()
+    class FixupStats
+    {
+      public:
+        FixupStats() : events(0), changed(0), skipped(0), nsecs(0) {}
+        uint64_t events;  ///< events the fixup was run on
+        uint64_t changed; ///< events whose title, subtitle or description changed
+        uint64_t skipped; ///< rules not run because the prefilter ruled them out
+        int64_t  nsecs;   ///< time spent in the fixup
+    };
+    friend class FixupTimer;
+    static const uint kStatsSize = 64;
+    static uint StatsIndex(FixupValue fixup);
+    mutable FixupStats m_stats[kStatsSize];
+
+    /// Literals one of the UK regular expressions needs to match
+    KeywordScanner m_ukKeywords;
+    quint64 m_ukKeyThen;
+    quint64 m_ukKeyNew;
+    quint64 m_ukKeyBBC34;
+    quint64 m_ukKeyRpt;
+    quint64 m_ukKeyAllNew;
+    quint64 m_ukKeyAlsoInHD;
+    quint64 m_ukKeyPart;
+    quint64 m_ukKeyPt;
+    quint64 m_ukKeyStarring;
+
+    /// Literals one of the Dutch regular expressions needs to match
+    KeywordScanner m_nlKeywords;
+    quint64 m_nlKeyStereo;
+    quint64 m_nlKeyWide;
+    quint64 m_nlKeyRepeat;
+    quint64 m_nlKeyTxt;
+    quint64 m_nlKeyHD;
+    quint64 m_nlKeySub;
+    quint64 m_nlKeyQuote;
+    quint64 m_nlKeyActors;
+    quint64 m_nlKeyPres;
+    quint64 m_nlKeyUit;
+    quint64 m_nlKeyVan;
+    quint64 m_nlKeyParen;
+
+    /// Literals one of the Danish regular expressions needs to match
+    KeywordScanner m_dkKeywords;
+    quint64 m_dkKeyParen;
+    quint64 m_dkKeyColon;
+    quint64 m_dkKeyDash;
+    quint64 m_dkKeySeason;
+    quint64 m_dkKeyYear;
+    quint64 m_dkKeyFeatures;
+    quint64 m_dkKeyDirector;
+    quint64 m_dkKeyActors;
+    quint64 m_dkKeyFra;
+
+    bool    m_prefilter;
+
     const QRegExp m_bellYear;
     const QRegExp m_bellActors;
     const QRegExp m_bellPPVTitleAllDayHD;
@@ -49,6 +49,7 @@ EITHelper::~EITHelper()
     while (db_events.size())
         delete db_events.dequeue();
 
+    eitfixup->LogStats();
     delete eitfixup;
 }
 
@@ -7,6 +7,10 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <poll.h>
+#endif
 
 #include <QFileInfo>
 #include <QDir>
@@ -585,6 +589,127 @@ int FileRingBuffer::safe_read(RemoteFile *rf, void *data, uint sz)
     return ret;
 }
 
+bool FileRingBuffer::IsSendDirectAllowed(void) const
+{
+#ifdef __linux__
+    // sendfile() needs a regular local file, and the read-ahead thread
+    // must not be moving the file position around underneath it.
+    struct stat sb;
+    return !remotefile && (fd2 >= 0) && !writemode && !startreadahead &&
+        (fstat(fd2, &sb) == 0) && S_ISREG(sb.st_mode);
+#else
+    return false;
+#endif
+}
+
+/** \fn FileRingBuffer::safe_send(int, uint)
+ *  \brief Sends data from the file to a socket with sendfile(2), so
+ *         it never has to be copied into user space.
+ *
+ *   Like the read-ahead thread this waits up to 10 seconds for a file
+ *   that is still being recorded to grow when we are at its end.
+ *
+ *  \param fd  File descriptor of the (non-blocking) socket
+ *  \param sz  Number of bytes to send
+ *  \return Returns number of bytes sent, or -1 if sendfile(2) is not
+ *          supported for these descriptors.
+ */
+int FileRingBuffer::safe_send(int fd, uint sz)
+{
+#ifdef __linux__
+    static const int kSendTimeout = 10000;
+
+    if (fd2 < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+                "Invalid file descriptor in 'safe_send()'");
+        return 0;
+    }
+
+    if (stopreads)
+        return 0;
+
+    unsigned tot = 0;
+    unsigned errcnt = 0;
+    MythTimer t(MythTimer::kStartRunning);
+    struct stat sb;
+
+    while ((tot < sz) && !stopreads)
+    {
+        uint tosend = sz - tot;
+
+        if (fstat(fd2, &sb) == 0)
+        {
+            long long pos = lseek64(fd2, 0, SEEK_CUR);
+            if (pos >= sb.st_size)
+            {
+                // Return what we have, or wait a little bit if the
+                // file is still open for writing (60ms same wait as
+                // typical safe_read)
+                if (tot > 0 || oldfile || (t.elapsed() > kSendTimeout) ||
+                    !gCoreContext->IsRegisteredFileForWrite(filename))
+                {
+                    LOG(VB_FILE, LOG_DEBUG, LOC + "not sending, reached EOF");
+                    break;
+                }
+                usleep(60000);
+                continue;
+            }
+            tosend = min(sb.st_size - pos, (long long)tosend);
+        }
+
+        ssize_t ret = sendfile(fd, fd2, NULL, tosend);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            if (errno == EAGAIN)
+            {
+                // socket buffer is full, wait for the other end
+                struct pollfd pfd;
+                pfd.fd      = fd;
+                pfd.events  = POLLOUT;
+                pfd.revents = 0;
+                if ((t.elapsed() < kSendTimeout) && (poll(&pfd, 1, 100) >= 0))
+                    continue;
+
+                LOG(VB_GENERAL, LOG_ERR, LOC +
+                    "Timed out waiting for socket in 'safe_send()'");
+                break;
+            }
+
+            if ((errno == EINVAL || errno == ENOSYS) && !tot)
+                return -1;
+
+            LOG(VB_GENERAL, LOG_ERR,
+                LOC + "File I/O problem in 'safe_send()'" + ENO);
+
+            errcnt++;
+            numfailures++;
+            if (errcnt == 3)
+                break;
+            continue;
+        }
+        else if (ret == 0)
+        {
+            // file was truncated under us
+            break;
+        }
+
+        tot += ret;
+        t.restart();
+
+        if (oldfile)
+            break;
+    }
+
+    return tot;
+#else
+    return RingBuffer::safe_send(fd, sz);
+#endif
+}
+
 long long FileRingBuffer::GetReadPosition(void) const
 {
     poslock.lockForRead();
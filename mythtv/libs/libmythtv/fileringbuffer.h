@@ -15,6 +15,7 @@ class MTV_PUBLIC FileRingBuffer : public RingBuffer
     // Gets
     virtual bool      IsOpen(void)          const;
     virtual long long GetReadPosition(void) const;
+    virtual bool      IsSendDirectAllowed(void) const;
 
     // General Commands
     virtual bool OpenFile(const QString &lfilename,
@@ -37,6 +38,7 @@ class MTV_PUBLIC FileRingBuffer : public RingBuffer
     }
     int safe_read(int fd, void *data, uint sz);
     int safe_read(RemoteFile *rf, void *data, uint sz);
+    virtual int safe_send(int fd, uint sz);
     virtual long long GetRealFileSizeInternal(void) const;
     virtual long long SeekInternal(long long pos, int whence);
 };
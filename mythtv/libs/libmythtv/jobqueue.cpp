@@ -18,6 +18,7 @@ using namespace std;
 
 #include "exitcodes.h"
 #include "jobqueue.h"
+#include "jobscheduler.h"
 #include "programinfo.h"
 #include "mythcorecontext.h"
 #include "mythdate.h"
@@ -51,7 +52,8 @@ JobQueue::JobQueue(bool master) :
     runningJobsLock(new QMutex(QMutex::Recursive)),
     isMaster(master),
     queueThread(new MThread("JobQueue", this)),
-    processQueue(false)
+    processQueue(false),
+    m_scheduler(new JobScheduler())
 {
     jobQueueCPU = gCoreContext->GetNumSetting("JobQueueCPU", 0);
 
@@ -82,6 +84,7 @@ JobQueue::~JobQueue(void)
     gCoreContext->removeListener(this);
 
     delete runningJobsLock;
+    delete m_scheduler;
 }
 
 void JobQueue::customEvent(QEvent *e)
@@ -145,6 +148,71 @@ void JobQueue::customEvent(QEvent *e)
                 runningJobsLock->unlock();
             }
         }
+        else if (message.startsWith("SYSTEM_EVENT REC_"))
+        {
+            HandleRecordingEvent(message);
+        }
+    }
+}
+
+/** \brief Tells the scheduler about recordings starting on this host
+ *
+ *  REC_PENDING is sent shortly before a recording starts, REC_STARTED and
+ *  REC_STARTED_WRITING as it starts and REC_FINISHED when it ends.
+ */
+void JobQueue::HandleRecordingEvent(const QString &message)
+{
+    // SYSTEM_EVENT REC_PENDING SECS 60 CARDID 1 CHANID 1001 STARTTIME ...
+    QStringList tokens = message.simplified().split(" ",
+                                                    QString::SkipEmptyParts);
+    if (tokens.size() < 2)
+        return;
+
+    QString event = tokens[1];
+    if ((event != "REC_PENDING") && (event != "REC_STARTED") &&
+        (event != "REC_STARTED_WRITING") && (event != "REC_FINISHED"))
+        return;
+
+    uint cardid = 0;
+    QString chanid;
+    QString starttime;
+    for (int i = 2; i + 1 < tokens.size(); i++)
+    {
+        if (tokens[i] == "CARDID")
+            cardid = tokens[i + 1].toUInt();
+        else if (tokens[i] == "CHANID")
+            chanid = tokens[i + 1];
+        else if (tokens[i] == "STARTTIME")
+            starttime = tokens[i + 1];
+    }
+
+    if (!cardid || chanid.isEmpty())
+        return;
+
+    // Only recordings made by this host compete with its jobs
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT hostname FROM capturecard WHERE cardid = :CARDID");
+    query.bindValue(":CARDID", cardid);
+    if (!query.exec() || !query.next())
+        return;
+    if (query.value(0).toString() != m_hostname)
+        return;
+
+    QString key = chanid + "_" + starttime;
+    if (event == "REC_FINISHED")
+    {
+        m_scheduler->RecordingFinished(key);
+    }
+    else
+    {
+        LOG(VB_JOBQUEUE, LOG_INFO, LOC +
+            QString("Recording on card %1 starting (%2), throttling jobs")
+                .arg(cardid).arg(event));
+        m_scheduler->RecordingPending(key);
+
+        // Pause running jobs now rather than at the next check
+        QMutexLocker locker(&queueThreadCondLock);
+        queueThreadCond.wakeAll();
     }
 }
 
@@ -182,6 +250,9 @@ void JobQueue::ProcessQueue(void)
     bool atMax = false;
     bool inTimeWindow = true;
     bool startedJobAlready = false;
+    bool canStart = true;
+    QString deferReason;
+    QList<int> order;
     QMap<int, RunningJobInfo>::Iterator rjiter;
 
     QMutexLocker locker(&queueThreadCondLock);
@@ -207,8 +278,13 @@ void JobQueue::ProcessQueue(void)
         }
         runningJobsLock->unlock();
 
+        m_scheduler->LoadSettings();
+        ThrottleJobs();
+        canStart = m_scheduler->CanStartJob(deferReason);
+
         jobsRunning = 0;
         GetJobsInQueue(jobs);
+        order = m_scheduler->Rank(jobs);
 
         if (jobs.size())
         {
@@ -251,9 +327,9 @@ void JobQueue::ProcessQueue(void)
             }
 
 
-            for ( int x = 0;
-                 (x < jobs.size()) && (jobsRunning < maxJobs); x++)
+            for (int i = 0; (i < order.size()) && (jobsRunning < maxJobs); i++)
             {
+                int x = order[i];
                 jobID = jobs[x].id;
                 cmds = jobs[x].cmds;
                 //flags = jobs[x].flags;
@@ -340,7 +416,17 @@ void JobQueue::ProcessQueue(void)
 
                         runningJobsLock->lock();
                         if (runningJobs.contains(jobID))
+                        {
                             runningJobs[jobID].flag = JOB_STOP;
+
+                            // A paused process can't see it's being stopped
+                            if (m_scheduler->IsThrottled(jobID))
+                            {
+                                JobScheduler::SignalJob(
+                                    runningJobs[jobID].pid, false);
+                                m_scheduler->SetThrottled(jobID, false);
+                            }
+                        }
                         runningJobsLock->unlock();
 
                         // ChangeJobCmds(m_db, jobID, JOB_RUN);
@@ -435,6 +521,15 @@ void JobQueue::ProcessQueue(void)
                 if (startedJobAlready)
                     continue;
 
+                if (inTimeWindow && !canStart)
+                {
+                    message = QString("Deferring '%1' job for %2, %3.")
+                                      .arg(JobText(jobs[x].type)).arg(logInfo)
+                                      .arg(deferReason);
+                    LOG(VB_JOBQUEUE, LOG_INFO, LOC + message);
+                    continue;
+                }
+
                 if ((inTimeWindow) &&
                     (hostname.isEmpty()) &&
                     (!ChangeJobHost(jobID, m_hostname)))
@@ -462,11 +557,39 @@ void JobQueue::ProcessQueue(void)
                 LOG(VB_JOBQUEUE, LOG_INFO, LOC + message);
 
                 ProcessJob(jobs[x]);
+                m_scheduler->JobStarted(jobID);
 
                 startedJobAlready = true;
             }
         }
 
+        JobScheduleInfo info;
+        info.hostname = m_hostname;
+        info.maxJobs = maxJobs;
+        info.reason = deferReason;
+        info.throttled = !canStart;
+        for (int i = 0; i < order.size(); i++)
+        {
+            const JobQueueEntry &job = jobs[order[i]];
+            if ((job.status & JOB_DONE) ||
+                (!job.hostname.isEmpty() && job.hostname != m_hostname))
+                continue;
+
+            JobScheduleEntry entry;
+            entry.id = job.id;
+            entry.type = job.type;
+            entry.status = job.status;
+            entry.chanid = job.chanid;
+            entry.recstartts = job.recstartts;
+            entry.expectedSecs =
+                m_scheduler->ExpectedSecs(job.type, job.filesize);
+            entry.usage = m_scheduler->GetJobUsage(job.id);
+            if (job.status == JOB_QUEUED)
+                entry.rank = info.jobs.size() + 1;
+            info.jobs.append(entry);
+        }
+        m_scheduler->SetScheduleInfo(info);
+
         if (QCoreApplication::applicationName() == MYTH_APPNAME_MYTHJOBQUEUE)
         {
             if (jobsRunning > 0)
@@ -1278,7 +1401,7 @@ int JobQueue::GetJobsInQueue(QMap<int, JobQueueEntry> &jobs, int findJobs)
 
     query.prepare("SELECT j.id, j.chanid, j.starttime, j.inserttime, j.type, "
                       "j.cmds, j.flags, j.status, j.statustime, j.hostname, "
-                      "j.args, j.comment, r.endtime, j.schedruntime "
+                      "j.args, j.comment, r.endtime, j.schedruntime, r.filesize "
                   "FROM jobqueue j "
                   "LEFT JOIN recorded r "
                   "  ON j.chanid = r.chanid AND j.starttime = r.starttime "
@@ -1366,6 +1489,7 @@ int JobQueue::GetJobsInQueue(QMap<int, JobQueueEntry> &jobs, int findJobs)
         thisJob.hostname = query.value(9).toString();
         thisJob.args = query.value(10).toString();
         thisJob.comment = query.value(11).toString();
+        thisJob.filesize = query.value(14).toLongLong();
 
         if ((thisJob.type & JOB_USERJOB) &&
             (UserJobTypeToIndex(thisJob.type) == 0))
@@ -1696,6 +1820,9 @@ void JobQueue::ProcessJob(JobQueueEntry job)
     jInfo.desc    = GetJobDescription(job.type);
     jInfo.command = GetJobCommand(jobID, job.type, pginfo);
     jInfo.pginfo  = pginfo;
+    jInfo.pid     = 0;
+    jInfo.filesize = job.filesize;
+    jInfo.started = MythDate::current();
 
     runningJobs[jobID] = jInfo;
 
@@ -1822,6 +1949,12 @@ void JobQueue::RemoveRunningJob(int id)
 
     if (runningJobs.contains(id))
     {
+        const RunningJobInfo &jInfo = runningJobs[id];
+        qint64 msecs = jInfo.started.msecsTo(MythDate::current());
+        m_scheduler->JobFinished(
+            id, jInfo.type,
+            (GetJobStatus(id) == JOB_FINISHED) ? jInfo.filesize : 0, msecs);
+
         ProgramInfo *pginfo = runningJobs[id].pginfo;
         if (pginfo)
         {
@@ -1835,6 +1968,84 @@ void JobQueue::RemoveRunningJob(int id)
     runningJobsLock->unlock();
 }
 
+/** \brief Runs a job's command, noting its process id for the scheduler
+ *  \return exit code of the command, as myth_system() would
+ */
+uint JobQueue::RunJobCommand(int id, const QString &command, uint flags)
+{
+    flags |= kMSRunShell | kMSAutoCleanup;
+    MythSystemLegacy *ms = new MythSystemLegacy(command, flags);
+    ms->Run();
+
+    runningJobsLock->lock();
+    if (runningJobs.contains(id))
+        runningJobs[id].pid = ms->GetPid();
+    runningJobsLock->unlock();
+
+    uint result = ms->Wait(0);
+    delete ms;
+
+    runningJobsLock->lock();
+    if (runningJobs.contains(id))
+        runningJobs[id].pid = 0;
+    runningJobsLock->unlock();
+
+    // A job paused by the scheduler must not be left paused
+    m_scheduler->SetThrottled(id, false);
+
+    return result;
+}
+
+/// Samples load and pauses or resumes running jobs as the scheduler says
+void JobQueue::ThrottleJobs(void)
+{
+    QMap<int, qint64> pids;
+    runningJobsLock->lock();
+    QMap<int, RunningJobInfo>::const_iterator it = runningJobs.begin();
+    for (; it != runningJobs.end(); ++it)
+    {
+        if (it->pid > 0)
+            pids[it.key()] = it->pid;
+    }
+    runningJobsLock->unlock();
+
+    m_scheduler->Sample(pids);
+
+    QList<int> pause, resume;
+    QString reason;
+    m_scheduler->Throttle(pause, resume, reason);
+
+    foreach (int jobID, pause)
+    {
+        if (!pids.contains(jobID) ||
+            !JobScheduler::SignalJob(pids[jobID], true))
+            continue;
+
+        LOG(VB_JOBQUEUE, LOG_INFO, LOC +
+            QString("Pausing job ID %1, %2").arg(jobID).arg(reason));
+        m_scheduler->SetThrottled(jobID, true);
+        ChangeJobStatus(jobID, JOB_PAUSED,
+                        tr("Paused while %1").arg(reason));
+    }
+
+    foreach (int jobID, resume)
+    {
+        m_scheduler->SetThrottled(jobID, false);
+        if (!pids.contains(jobID))
+            continue;
+
+        LOG(VB_JOBQUEUE, LOG_INFO, LOC + QString("Resuming job ID %1")
+            .arg(jobID));
+        JobScheduler::SignalJob(pids[jobID], false);
+        ChangeJobStatus(jobID, JOB_RUNNING);
+    }
+}
+
+JobScheduleInfo JobQueue::GetScheduleInfo(void) const
+{
+    return m_scheduler->GetScheduleInfo();
+}
+
 QString JobQueue::PrettyPrint(off_t bytes)
 {
     // Pretty print "bytes" as KB, MB, GB, TB, etc., subject to the desired
@@ -1994,7 +2205,7 @@ void JobQueue::DoTranscodeThread(int jobID)
                                            .arg(command));
 
         GetMythDB()->GetDBManager()->CloseDatabases();
-        uint result = myth_system(command);
+        uint result = RunJobCommand(jobID, command);
         int status = GetJobStatus(jobID);
 
         if ((result == GENERIC_EXIT_DAEMONIZING_ERROR) ||
@@ -2169,7 +2380,7 @@ void JobQueue::DoMetadataLookupThread(int jobID)
             .arg(command));
 
     GetMythDB()->GetDBManager()->CloseDatabases();
-    retVal = myth_system(command);
+    retVal = RunJobCommand(jobID, command);
     int priority = LOG_NOTICE;
     QString comment;
 
@@ -2306,7 +2517,7 @@ void JobQueue::DoFlagCommercialsThread(int jobID)
             .arg(command));
 
     GetMythDB()->GetDBManager()->CloseDatabases();
-    breaksFound = myth_system(command, kMSLowExitVal);
+    breaksFound = RunJobCommand(jobID, command, kMSLowExitVal);
     int priority = LOG_NOTICE;
     QString comment;
 
@@ -2424,7 +2635,7 @@ void JobQueue::DoUserJobThread(int jobID)
     LOG(VB_JOBQUEUE, LOG_INFO, LOC + QString("Running command: '%1'")
                                        .arg(command));
     GetMythDB()->GetDBManager()->CloseDatabases();
-    uint result = myth_system(command);
+    uint result = RunJobCommand(jobID, command);
 
     if ((result == GENERIC_EXIT_DAEMONIZING_ERROR) ||
         (result == GENERIC_EXIT_CMD_NOT_FOUND))
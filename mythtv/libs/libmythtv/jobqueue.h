@@ -100,6 +100,7 @@ typedef struct jobqueueentry {
     QString hostname;
     QString args;
     QString comment;
+    qint64 filesize;
 } JobQueueEntry;
 
 typedef struct runningjobinfo {
@@ -109,9 +110,14 @@ typedef struct runningjobinfo {
     QString      desc;
     QString      command;
     ProgramInfo *pginfo;
+    qint64       pid;      ///< process id of the running command, or 0
+    qint64       filesize; ///< size of the recording when the job started
+    QDateTime    started;
 } RunningJobInfo;
 
 class JobQueue;
+class JobScheduler;
+class JobScheduleInfo;
 
 class MTV_PUBLIC JobQueue : public QObject, public QRunnable
 {
@@ -199,6 +205,8 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
                                       { RecoverQueue(true); }
     static void CleanupOldJobsInQueue();
 
+    JobScheduleInfo GetScheduleInfo(void) const;
+
   private:
     typedef struct jobthreadstruct
     {
@@ -220,6 +228,9 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
     QString GetJobDescription(int jobType);
     QString GetJobCommand(int id, int jobType, ProgramInfo *tmpInfo);
     void RemoveRunningJob(int id);
+    uint RunJobCommand(int id, const QString &command, uint flags = 0);
+    void ThrottleJobs(void);
+    void HandleRecordingEvent(const QString &message);
 
     static QString PrettyPrint(off_t bytes);
 
@@ -254,6 +265,8 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
     QWaitCondition queueThreadCond;
     QMutex queueThreadCondLock;
     bool processQueue;
+
+    JobScheduler *m_scheduler;
 };
 
 #endif
@@ -0,0 +1,663 @@
+// C headers
+#include <signal.h>
+#include <unistd.h>
+
+// C++ headers
+#include <algorithm>
+using namespace std;
+
+// Qt headers
+#include <QStringList>
+#include <QFile>
+#include <QDir>
+
+// MythTV headers
+#include "jobscheduler.h"
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythdate.h"
+
+#define LOC QString("JobScheduler: ")
+
+/// Seconds after the last event of a recording that it counts as starting
+static const int kRecordingSettleSecs = 180;
+
+/// Seconds after a job is started before another may start
+static const int kStartSpacingSecs = 30;
+
+/// Seconds a job may stay paused, however loaded the system is
+static const int kMaxPauseSecs = 600;
+
+/// Expected run time of a job for a recording of unknown size
+static const int kDefaultJobSecs = 300;
+
+/// Expected run time of a metadata lookup, which doesn't read the recording
+static const int kMetadataJobSecs = 30;
+
+/// Fewer disk writes in a sample than this don't give a useful latency
+static const quint64 kMinWrites = 20;
+
+static QByteArray read_proc_file(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    // procfs files report a size of 0, so read until EOF
+    return file.readAll();
+}
+
+/// Bytes/sec a job is expected to process until some have finished
+static double default_byte_rate(int jobType)
+{
+    if (jobType == JOB_TRANSCODE)
+        return 2.0 * 1024 * 1024;
+    return 8.0 * 1024 * 1024;
+}
+
+/// ppid and CPU ticks of every process
+typedef QMap<qint64, QPair<qint64, quint64> > ProcessMap;
+
+static ProcessMap read_processes(void)
+{
+    ProcessMap procs;
+#ifdef __linux__
+    QStringList pids = QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    foreach (const QString &name, pids)
+    {
+        bool ok;
+        qint64 pid = name.toLongLong(&ok);
+        if (!ok)
+            continue;
+
+        qint64 ppid;
+        quint64 ticks;
+        if (JobScheduler::ParseProcStat(
+                read_proc_file(QString("/proc/%1/stat").arg(pid)), ppid, ticks))
+            procs[pid] = qMakePair(ppid, ticks);
+    }
+#endif
+    return procs;
+}
+
+static QList<qint64> descendants(const ProcessMap &procs, qint64 pid)
+{
+    QList<qint64> tree;
+    if (pid <= 0 || !procs.contains(pid))
+        return tree;
+
+    tree << pid;
+    // Parents are visited before their children, so one pass of the
+    // growing list finds the whole tree
+    for (int i = 0; i < tree.size(); ++i)
+    {
+        ProcessMap::const_iterator it = procs.begin();
+        for (; it != procs.end(); ++it)
+        {
+            if (it.value().first == tree[i])
+                tree << it.key();
+        }
+    }
+    return tree;
+}
+
+JobScheduler::JobScheduler() :
+    m_enabled(false), m_maxCPULoad(90.0), m_maxWriteLatency(150.0),
+    m_cpuLoad(0.0), m_writeLatency(0.0), m_cpuBusy(0), m_cpuTotal(0)
+{
+}
+
+/// Reads the limits, which may be changed while the queue runs
+void JobScheduler::LoadSettings(void)
+{
+    bool enabled = gCoreContext->GetNumSetting("JobQueueThrottle", 0);
+    double maxCPU = gCoreContext->GetNumSetting("JobQueueMaxCPULoad", 90);
+    double maxLatency =
+        gCoreContext->GetNumSetting("JobQueueMaxWriteLatency", 150);
+
+    QMutexLocker locker(&m_lock);
+    m_enabled         = enabled;
+    m_maxCPULoad      = maxCPU;
+    m_maxWriteLatency = maxLatency;
+}
+
+/** \brief Notes that a local recording is about to start or has just started
+ *  \param key chanid_starttime of the recording
+ */
+void JobScheduler::RecordingPending(const QString &key)
+{
+    QMutexLocker locker(&m_lock);
+    m_recordings[key] = MythDate::current();
+}
+
+/// Notes that a recording has finished, so is no longer starting
+void JobScheduler::RecordingFinished(const QString &key)
+{
+    QMutexLocker locker(&m_lock);
+    m_recordings.remove(key);
+}
+
+uint JobScheduler::RecordingsStarting(void)
+{
+    QMutexLocker locker(&m_lock);
+    PruneRecordings();
+    return m_recordings.size();
+}
+
+/// \note Caller must hold m_lock
+void JobScheduler::PruneRecordings(void)
+{
+    QDateTime settled = MythDate::current().addSecs(-kRecordingSettleSecs);
+    QMap<QString, QDateTime>::iterator it = m_recordings.begin();
+    while (it != m_recordings.end())
+    {
+        if (*it < settled)
+            it = m_recordings.erase(it);
+        else
+            ++it;
+    }
+}
+
+/** \brief Samples system load and the resource usage of running jobs
+ *  \param jobPids process id of each running job's command
+ */
+void JobScheduler::Sample(const QMap<int, qint64> &jobPids)
+{
+#ifdef __linux__
+    quint64 busy = 0, total = 0;
+    bool haveCPU = ParseCPUStat(read_proc_file("/proc/stat"), busy, total);
+
+    QMap<QString, QPair<quint64, quint64> > disks;
+    ParseDiskStats(read_proc_file("/proc/diskstats"), disks);
+
+    // Sum CPU & disk use over each job's process tree, as user jobs are
+    // run through a shell and may start processes of their own
+    ProcessMap procs = read_processes();
+    QMap<int, JobSample> samples;
+    QMap<int, qint64>::const_iterator jt = jobPids.begin();
+    for (; jt != jobPids.end(); ++jt)
+    {
+        JobSample &sample = samples[jt.key()];
+        foreach (qint64 pid, descendants(procs, *jt))
+        {
+            quint64 readBytes = 0, writeBytes = 0;
+            ParseProcIO(read_proc_file(QString("/proc/%1/io").arg(pid)),
+                        readBytes, writeBytes);
+            sample.ticks      += procs[pid].second;
+            sample.readBytes  += readBytes;
+            sample.writeBytes += writeBytes;
+        }
+    }
+
+    static const double ticksPerSec = sysconf(_SC_CLK_TCK);
+
+    QMutexLocker locker(&m_lock);
+
+    double secs = m_sampleTimer.isValid() ?
+        m_sampleTimer.restart() / 1000.0 : 0.0;
+    if (!m_sampleTimer.isValid())
+        m_sampleTimer.start();
+
+    if (haveCPU && m_cpuTotal && total > m_cpuTotal)
+        m_cpuLoad = 100.0 * (busy - m_cpuBusy) / (total - m_cpuTotal);
+    if (haveCPU)
+    {
+        m_cpuBusy  = busy;
+        m_cpuTotal = total;
+    }
+
+    m_writeLatency = WriteLatency(m_disks, disks);
+    m_disks = disks;
+
+    QMap<int, JobUsage> usage;
+    QMap<int, JobSample>::const_iterator st = samples.begin();
+    for (; st != samples.end(); ++st)
+    {
+        JobUsage &use = usage[st.key()];
+        use.throttled = m_throttled.contains(st.key());
+
+        // Processes that exited take their counts with them
+        if (secs > 0.0 && m_jobSamples.contains(st.key()))
+        {
+            const JobSample &prev = m_jobSamples[st.key()];
+            if (st->ticks > prev.ticks)
+                use.cpu = (st->ticks - prev.ticks) / ticksPerSec / secs;
+            if (st->readBytes > prev.readBytes)
+                use.readRate = (st->readBytes - prev.readBytes) / secs;
+            if (st->writeBytes > prev.writeBytes)
+                use.writeRate = (st->writeBytes - prev.writeBytes) / secs;
+        }
+    }
+    m_jobSamples = samples;
+    m_jobUsage   = usage;
+
+    LOG(VB_JOBQUEUE, LOG_INFO, LOC +
+        QString("CPU load %1%, disk write latency %2 ms, %3 job(s) sampled")
+        .arg(m_cpuLoad, 0, 'f', 0).arg(m_writeLatency, 0, 'f', 1)
+        .arg(samples.size()));
+#else
+    (void) jobPids;
+#endif
+}
+
+JobUsage JobScheduler::GetJobUsage(int jobID) const
+{
+    QMutexLocker locker(&m_lock);
+    JobUsage usage = m_jobUsage.value(jobID);
+    usage.throttled = m_throttled.contains(jobID);
+    return usage;
+}
+
+/** \brief Checks whether a new job may be started now
+ *  \param[out] reason why not
+ */
+bool JobScheduler::CanStartJob(QString &reason)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (!m_enabled)
+        return true;
+
+    PruneRecordings();
+
+    if (!m_recordings.isEmpty())
+        reason = QString("%1 recording(s) starting").arg(m_recordings.size());
+    else if (!m_throttled.isEmpty())
+        reason = QString("%1 job(s) paused").arg(m_throttled.size());
+    else if (m_writeLatency > m_maxWriteLatency)
+        reason = QString("disk write latency is %1 ms")
+            .arg(m_writeLatency, 0, 'f', 0);
+    else if (m_cpuLoad > m_maxCPULoad)
+        reason = QString("CPU load is %1%").arg(m_cpuLoad, 0, 'f', 0);
+    else if (m_lastStart.isValid() &&
+             m_lastStart.elapsed() < kStartSpacingSecs * 1000)
+        reason = "waiting for the last job started to settle";
+    else
+        return true;
+
+    return false;
+}
+
+void JobScheduler::JobStarted(int /*jobID*/)
+{
+    QMutexLocker locker(&m_lock);
+    m_lastStart.start();
+}
+
+/** \brief Forgets a job and learns its processing rate
+ *  \param jobID   job
+ *  \param jobType type of job
+ *  \param filesize size of its recording, 0 if none
+ *  \param msecs   time taken
+ */
+void JobScheduler::JobFinished(int jobID, int jobType,
+                               qint64 filesize, qint64 msecs)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_jobSamples.remove(jobID);
+    m_jobUsage.remove(jobID);
+    m_throttled.remove(jobID);
+    m_pauseExpired.remove(jobID);
+
+    // Ignore jobs that failed straight away
+    if (filesize <= 0 || msecs < 10000)
+        return;
+
+    double rate = filesize * 1000.0 / msecs;
+    if (m_byteRates.contains(jobType))
+        m_byteRates[jobType] = 0.7 * m_byteRates[jobType] + 0.3 * rate;
+    else
+        m_byteRates[jobType] = rate;
+
+    LOG(VB_JOBQUEUE, LOG_INFO, LOC +
+        QString("'%1' jobs process %2 MB/s")
+        .arg(JobQueue::JobText(jobType))
+        .arg(m_byteRates[jobType] / (1024 * 1024), 0, 'f', 1));
+}
+
+/** \brief Decides which running jobs to pause or resume
+ *  \param[out] pause  jobs to pause
+ *  \param[out] resume jobs to resume
+ *  \param[out] reason why jobs are throttled, empty if they are not
+ */
+void JobScheduler::Throttle(QList<int> &pause, QList<int> &resume,
+                            QString &reason)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (!m_enabled)
+    {
+        resume = m_throttled.keys();
+        return;
+    }
+
+    PruneRecordings();
+
+    // However loaded the system stays, a paused job gets to finish
+    QDateTime now = MythDate::current();
+    QMap<int, QDateTime>::const_iterator pit = m_throttled.begin();
+    for (; pit != m_throttled.end(); ++pit)
+    {
+        if (pit->secsTo(now) >= kMaxPauseSecs)
+        {
+            resume << pit.key();
+            m_pauseExpired.insert(pit.key());
+        }
+    }
+    if (!resume.isEmpty())
+    {
+        reason = QString("resuming %1 job(s) paused for %2 minutes")
+            .arg(resume.size()).arg(kMaxPauseSecs / 60);
+        return;
+    }
+
+    if (!m_recordings.isEmpty())
+    {
+        // Starting a recording is when a busy system loses data, so pause
+        // everything until it has settled
+        reason = QString("%1 recording(s) starting").arg(m_recordings.size());
+        QMap<int, JobUsage>::const_iterator it = m_jobUsage.begin();
+        for (; it != m_jobUsage.end(); ++it)
+        {
+            if (!m_throttled.contains(it.key()) &&
+                !m_pauseExpired.contains(it.key()))
+                pause << it.key();
+        }
+        return;
+    }
+
+    if (m_writeLatency > m_maxWriteLatency)
+    {
+        reason = QString("disk write latency is %1 ms")
+            .arg(m_writeLatency, 0, 'f', 0);
+
+        // Pause the job doing the most I/O
+        int heaviest = 0;
+        double heaviestRate = -1.0;
+        QMap<int, JobUsage>::const_iterator it = m_jobUsage.begin();
+        for (; it != m_jobUsage.end(); ++it)
+        {
+            double rate = it->readRate + it->writeRate;
+            if (!m_throttled.contains(it.key()) &&
+                !m_pauseExpired.contains(it.key()) && rate > heaviestRate)
+            {
+                heaviest     = it.key();
+                heaviestRate = rate;
+            }
+        }
+        if (heaviest)
+            pause << heaviest;
+        return;
+    }
+
+    if (m_throttled.isEmpty())
+        return;
+
+    if (m_writeLatency <= m_maxWriteLatency)
+    {
+        // Resume one at a time, as they all add to the load
+        resume << m_throttled.begin().key();
+        reason = QString("resuming %1 paused job(s)").arg(m_throttled.size());
+    }
+    else
+    {
+        reason = QString("waiting for disk write latency of %1 ms to fall")
+            .arg(m_writeLatency, 0, 'f', 0);
+    }
+}
+
+void JobScheduler::SetThrottled(int jobID, bool throttled)
+{
+    QMutexLocker locker(&m_lock);
+    if (throttled)
+    {
+        if (!m_throttled.contains(jobID))
+            m_throttled[jobID] = MythDate::current();
+    }
+    else
+        m_throttled.remove(jobID);
+}
+
+bool JobScheduler::IsThrottled(int jobID) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_throttled.contains(jobID);
+}
+
+/// Lower values are started first
+int JobScheduler::TypePriority(int jobType)
+{
+    switch (jobType)
+    {
+        // Quick, and wanted when the recording is watched
+        case JOB_COMMFLAG:
+        case JOB_METADATA:
+            return 0;
+        // Slow, and may wait for a cut list
+        case JOB_TRANSCODE:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+int JobScheduler::ExpectedSecs(int jobType, qint64 filesize) const
+{
+    if (jobType == JOB_METADATA)
+        return kMetadataJobSecs;
+    if (filesize <= 0)
+        return kDefaultJobSecs;
+
+    QMutexLocker locker(&m_lock);
+    double rate = m_byteRates.value(jobType, default_byte_rate(jobType));
+    return (int)(filesize / rate);
+}
+
+/// Ranking of a queued job
+class JobRank
+{
+  public:
+    JobRank(int _priority, int _secs, int _key) :
+        priority(_priority), secs(_secs), key(_key) {}
+
+    bool operator<(const JobRank &other) const
+    {
+        if (priority != other.priority)
+            return priority < other.priority;
+        if (secs != other.secs)
+            return secs < other.secs;
+        return key < other.key;
+    }
+
+    int priority;
+    int secs;
+    int key;
+};
+
+/** \brief Orders jobs for ProcessQueue()
+ *  \details Jobs that are not queued come first, so that their commands
+ *  are handled and they block later jobs for the same recording. Queued
+ *  jobs follow by type priority, then shortest expected run time first.
+ *  \return keys of \p jobs in processing order
+ */
+QList<int> JobScheduler::Rank(const QMap<int, JobQueueEntry> &jobs) const
+{
+    QList<int> order;
+    vector<JobRank> queued;
+
+    QMap<int, JobQueueEntry>::const_iterator it = jobs.begin();
+    for (; it != jobs.end(); ++it)
+    {
+        if (it->status != JOB_QUEUED)
+            order << it.key();
+        else
+            queued.push_back(JobRank(TypePriority(it->type),
+                                     ExpectedSecs(it->type, it->filesize),
+                                     it.key()));
+    }
+
+    stable_sort(queued.begin(), queued.end());
+    for (size_t i = 0; i < queued.size(); ++i)
+        order << queued[i].key;
+
+    return order;
+}
+
+void JobScheduler::SetScheduleInfo(const JobScheduleInfo &info)
+{
+    QMutexLocker locker(&m_lock);
+    m_info                    = info;
+    m_info.cpuLoad            = m_cpuLoad;
+    m_info.writeLatency       = m_writeLatency;
+    m_info.recordingsStarting = m_recordings.size();
+    m_info.updated            = MythDate::current();
+}
+
+JobScheduleInfo JobScheduler::GetScheduleInfo(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_info;
+}
+
+/// \return pid and all its descendants, parents first
+QList<qint64> JobScheduler::ProcessTree(qint64 pid)
+{
+    return descendants(read_processes(), pid);
+}
+
+/** \brief Pauses or resumes every process of a job
+ *  \return true if any process was signalled
+ */
+bool JobScheduler::SignalJob(qint64 pid, bool stop)
+{
+#ifndef _WIN32
+    QList<qint64> tree = ProcessTree(pid);
+    foreach (qint64 proc, tree)
+        kill(proc, stop ? SIGSTOP : SIGCONT);
+    return !tree.isEmpty();
+#else
+    (void) pid;
+    (void) stop;
+    return false;
+#endif
+}
+
+/** \brief Parses the total CPU line of /proc/stat
+ *  \param[out] busy  ticks spent not idle
+ *  \param[out] total all ticks
+ */
+bool JobScheduler::ParseCPUStat(const QByteArray &stat,
+                                quint64 &busy, quint64 &total)
+{
+    int eol = stat.indexOf('\n');
+    QList<QByteArray> fields = stat.left(eol < 0 ? stat.size() : eol)
+        .simplified().split(' ');
+
+    // cpu user nice system idle iowait irq softirq steal ...
+    if (fields.size() < 5 || fields[0] != "cpu")
+        return false;
+
+    total = 0;
+    for (int i = 1; i < fields.size() && i <= 8; ++i)
+        total += fields[i].toULongLong();
+
+    quint64 idle = fields[4].toULongLong();
+    if (fields.size() > 5)
+        idle += fields[5].toULongLong(); // iowait
+
+    busy = total - idle;
+    return true;
+}
+
+/** \brief Parses /proc/diskstats
+ *  \param[out] disks Map<device name, (writes completed, ms spent writing)>
+ */
+void JobScheduler::ParseDiskStats(
+    const QByteArray &diskstats,
+    QMap<QString, QPair<quint64, quint64> > &disks)
+{
+    disks.clear();
+
+    QList<QByteArray> lines = diskstats.split('\n');
+    foreach (const QByteArray &line, lines)
+    {
+        // major minor name reads merged sectors ms writes merged sectors ms
+        QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.size() < 11)
+            continue;
+
+        QString name = fields[2];
+        if (name.startsWith("loop") || name.startsWith("ram"))
+            continue;
+
+        disks[name] = qMakePair(fields[7].toULongLong(),
+                                fields[10].toULongLong());
+    }
+}
+
+/** \brief Average ms per write on the worst disk between two samples
+ *  \details Disks with too few writes in between are ignored.
+ */
+double JobScheduler::WriteLatency(
+    const QMap<QString, QPair<quint64, quint64> > &before,
+    const QMap<QString, QPair<quint64, quint64> > &after)
+{
+    double worst = 0.0;
+
+    QMap<QString, QPair<quint64, quint64> >::const_iterator it = after.begin();
+    for (; it != after.end(); ++it)
+    {
+        if (!before.contains(it.key()))
+            continue;
+
+        const QPair<quint64, quint64> &prev = before[it.key()];
+        if (it->first < prev.first + kMinWrites || it->second < prev.second)
+            continue;
+
+        double latency = (double)(it->second - prev.second) /
+                         (it->first - prev.first);
+        worst = max(worst, latency);
+    }
+
+    return worst;
+}
+
+/** \brief Parses /proc/<pid>/stat
+ *  \param[out] ppid  parent process id
+ *  \param[out] ticks user + system CPU ticks
+ */
+bool JobScheduler::ParseProcStat(const QByteArray &stat,
+                                 qint64 &ppid, quint64 &ticks)
+{
+    // The command name may contain spaces & brackets, so skip past the last
+    int end = stat.lastIndexOf(')');
+    if (end < 0)
+        return false;
+
+    // state ppid pgrp session tty tpgid flags minflt cminflt majflt
+    // cmajflt utime stime ...
+    QList<QByteArray> fields = stat.mid(end + 1).simplified().split(' ');
+    if (fields.size() < 13)
+        return false;
+
+    ppid  = fields[1].toLongLong();
+    ticks = fields[11].toULongLong() + fields[12].toULongLong();
+    return true;
+}
+
+/** \brief Parses /proc/<pid>/io
+ *  \param[out] readBytes  bytes read from disk
+ *  \param[out] writeBytes bytes written to disk
+ */
+void JobScheduler::ParseProcIO(const QByteArray &io,
+                               quint64 &readBytes, quint64 &writeBytes)
+{
+    QList<QByteArray> lines = io.split('\n');
+    foreach (const QByteArray &line, lines)
+    {
+        if (line.startsWith("read_bytes:"))
+            readBytes = line.mid(11).trimmed().toULongLong();
+        else if (line.startsWith("write_bytes:"))
+            writeBytes = line.mid(12).trimmed().toULongLong();
+    }
+}
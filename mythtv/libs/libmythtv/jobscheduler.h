@@ -0,0 +1,179 @@
+// -*- Mode: c++ -*-
+#ifndef _JOB_SCHEDULER_H_
+#define _JOB_SCHEDULER_H_
+
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QMutex>
+#include <QList>
+#include <QMap>
+#include <QSet>
+
+#include "mythtvexp.h"
+#include "jobqueue.h"
+
+/// Resource usage of a running job, summed over its processes
+class MTV_PUBLIC JobUsage
+{
+  public:
+    JobUsage() : cpu(0.0), readRate(0.0), writeRate(0.0), throttled(false) {}
+
+    double cpu;       ///< cores in use, 1.0 is one busy core
+    double readRate;  ///< bytes/sec read from disk
+    double writeRate; ///< bytes/sec written to disk
+    bool   throttled; ///< paused by the scheduler
+};
+
+/// A job as seen by the scheduler, for the Services API
+class MTV_PUBLIC JobScheduleEntry
+{
+  public:
+    JobScheduleEntry() :
+        id(0), type(JOB_NONE), status(JOB_UNKNOWN), chanid(0),
+        rank(0), expectedSecs(0) {}
+
+    int       id;
+    int       type;
+    int       status;
+    uint      chanid;
+    QDateTime recstartts;
+    int       rank;         ///< start order of queued jobs, 0 once started
+    int       expectedSecs; ///< expected run time
+    JobUsage  usage;
+};
+
+/// Load and job state of one host's JobQueue, for the Services API
+class MTV_PUBLIC JobScheduleInfo
+{
+  public:
+    JobScheduleInfo() :
+        throttled(false), cpuLoad(0.0), writeLatency(0.0),
+        recordingsStarting(0), maxJobs(0) {}
+
+    QString   hostname;
+    bool      throttled;          ///< jobs are paused or may not start
+    QString   reason;             ///< why jobs are throttled
+    double    cpuLoad;            ///< percentage of all cores busy
+    double    writeLatency;       ///< ms per disk write, worst disk
+    uint      recordingsStarting; ///< local recordings starting
+    int       maxJobs;            ///< JobQueueMaxSimultaneousJobs
+    QDateTime updated;            ///< time of the last sample
+    QList<JobScheduleEntry> jobs;
+};
+
+/** \class JobScheduler
+ *  \brief Decides when the JobQueue may start, pause and resume jobs.
+ *
+ *  Each pass of JobQueue::ProcessQueue() calls Sample(), which reads CPU
+ *  and disk load and the CPU and disk use of every running job's process
+ *  tree from /proc. Recordings starting on this host are learnt from the
+ *  REC_PENDING, REC_STARTED and REC_FINISHED system events.
+ *
+ *  New jobs are only started when no recording is starting, CPU load and
+ *  disk write latency are below their limits and no job is paused by the
+ *  scheduler. Queued jobs are ranked by job type and then by their
+ *  expected run time, learnt from jobs that have finished.
+ *
+ *  While a recording starts every job is paused. While disk write latency
+ *  is too high the job doing the most disk I/O is paused, one per pass.
+ *  Paused jobs are resumed one per pass once the load is back under the
+ *  limits. A job paused for ten minutes is resumed regardless and is not
+ *  paused again, so neither it nor the jobs waiting to start behind it
+ *  are held up indefinitely.
+ *  Jobs are paused with SIGSTOP, which works for every kind of job, so
+ *  pausing is not supported on Windows.
+ *
+ *  All of this is off unless the JobQueueThrottle setting is set.
+ */
+class MTV_PUBLIC JobScheduler
+{
+    friend class TestJobScheduler;
+
+  public:
+    JobScheduler();
+
+    void LoadSettings(void);
+
+    void RecordingPending(const QString &key);
+    void RecordingFinished(const QString &key);
+    uint RecordingsStarting(void);
+
+    void Sample(const QMap<int, qint64> &jobPids);
+    JobUsage GetJobUsage(int jobID) const;
+
+    bool CanStartJob(QString &reason);
+    void JobStarted(int jobID);
+    void JobFinished(int jobID, int jobType, qint64 filesize, qint64 msecs);
+
+    void Throttle(QList<int> &pause, QList<int> &resume, QString &reason);
+    void SetThrottled(int jobID, bool throttled);
+    bool IsThrottled(int jobID) const;
+
+    QList<int> Rank(const QMap<int, JobQueueEntry> &jobs) const;
+    int ExpectedSecs(int jobType, qint64 filesize) const;
+
+    void SetScheduleInfo(const JobScheduleInfo &info);
+    JobScheduleInfo GetScheduleInfo(void) const;
+
+    static int TypePriority(int jobType);
+    static QList<qint64> ProcessTree(qint64 pid);
+    static bool SignalJob(qint64 pid, bool stop);
+
+    // /proc parsers, public for the unit tests
+    static bool ParseCPUStat(const QByteArray &stat,
+                             quint64 &busy, quint64 &total);
+    static void ParseDiskStats(const QByteArray &diskstats,
+                               QMap<QString, QPair<quint64, quint64> > &disks);
+    static double WriteLatency(
+        const QMap<QString, QPair<quint64, quint64> > &before,
+        const QMap<QString, QPair<quint64, quint64> > &after);
+    static bool ParseProcStat(const QByteArray &stat,
+                              qint64 &ppid, quint64 &ticks);
+    static void ParseProcIO(const QByteArray &io,
+                            quint64 &readBytes, quint64 &writeBytes);
+
+  private:
+    /// CPU ticks and disk bytes of a job at the last sample
+    class JobSample
+    {
+      public:
+        JobSample() : ticks(0), readBytes(0), writeBytes(0) {}
+        quint64 ticks;
+        quint64 readBytes;
+        quint64 writeBytes;
+    };
+
+    void PruneRecordings(void);
+
+    mutable QMutex m_lock;
+
+    // Settings
+    bool   m_enabled;
+    double m_maxCPULoad;      ///< percent
+    double m_maxWriteLatency; ///< ms
+
+    // Load at the last sample
+    double m_cpuLoad;
+    double m_writeLatency;
+    quint64 m_cpuBusy;
+    quint64 m_cpuTotal;
+    QMap<QString, QPair<quint64, quint64> > m_disks;
+    QElapsedTimer m_sampleTimer;
+
+    QMap<int, JobSample> m_jobSamples;
+    QMap<int, JobUsage>  m_jobUsage;
+    QMap<int, QDateTime> m_throttled;    ///< paused jobs, and since when
+    QSet<int>            m_pauseExpired; ///< jobs not to pause again
+
+    /// Recordings starting, Map<chanid_starttime, time of last event>
+    QMap<QString, QDateTime> m_recordings;
+
+    QElapsedTimer m_lastStart;      ///< time since a job was started
+    QMap<int, double> m_byteRates;  ///< learnt bytes/sec by job type
+
+    JobScheduleInfo m_info;
+};
+
+#endif // _JOB_SCHEDULER_H_
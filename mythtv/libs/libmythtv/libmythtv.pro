@@ -118,7 +118,7 @@ HEADERS += recordinginfo.h
 HEADERS += dbcheck.h
 HEADERS += videodbcheck.h
 HEADERS += tvremoteutil.h           tv.h
-HEADERS += jobqueue.h
+HEADERS += jobqueue.h               jobscheduler.h
 HEADERS += filtermanager.h          recordingprofile.h
 HEADERS += remoteencoder.h          videosource.h
 HEADERS += cardutil.h               sourceutil.h
@@ -148,7 +148,7 @@ SOURCES += recordinginfo.cpp
 SOURCES += dbcheck.cpp
 SOURCES += videodbcheck.cpp
 SOURCES += tvremoteutil.cpp         tv.cpp
-SOURCES += jobqueue.cpp
+SOURCES += jobqueue.cpp             jobscheduler.cpp
 SOURCES += filtermanager.cpp        recordingprofile.cpp
 SOURCES += remoteencoder.cpp        videosource.cpp
 SOURCES += cardutil.cpp             sourceutil.cpp
@@ -193,6 +193,7 @@ SOURCES += teletextdecoder.cpp      teletextreader.cpp vbilut.cpp
 
 # MPEG parsing stuff
 HEADERS += mpeg/tspacket.h          mpeg/pespacket.h
+HEADERS += mpeg/tsheaderbatch.h
 HEADERS += mpeg/mpegtables.h        mpeg/atsctables.h
 HEADERS += mpeg/dvbtables.h         mpeg/premieretables.h
 HEADERS += mpeg/sctetables.h
@@ -206,9 +207,11 @@ HEADERS += mpeg/atsc_huffman.h
 HEADERS += mpeg/freesat_huffman.h   mpeg/freesat_tables.h
 HEADERS += mpeg/iso6937tables.h
 HEADERS += mpeg/tsstats.h           mpeg/streamlisteners.h
-HEADERS += mpeg/H264Parser.h
+HEADERS += mpeg/H264Parser.h        mpeg/HEVCParser.h
+HEADERS += mpeg/startcodescanner.h
 
 SOURCES += mpeg/tspacket.cpp        mpeg/pespacket.cpp
+SOURCES += mpeg/tsheaderbatch.cpp
 SOURCES += mpeg/mpegtables.cpp      mpeg/atsctables.cpp
 SOURCES += mpeg/dvbtables.cpp       mpeg/premieretables.cpp
 SOURCES += mpeg/sctetables.cpp
@@ -221,7 +224,8 @@ SOURCES += mpeg/dishdescriptors.cpp mpeg/premieredescriptors.cpp
 SOURCES += mpeg/atsc_huffman.cpp
 SOURCES += mpeg/freesat_huffman.cpp
 SOURCES += mpeg/iso6937tables.cpp
-SOURCES += mpeg/H264Parser.cpp
+SOURCES += mpeg/H264Parser.cpp      mpeg/HEVCParser.cpp
+SOURCES += mpeg/startcodescanner.cpp
 
 # Channels, and the multiplexes that transmit them
 HEADERS += frequencies.h            frequencytables.h
@@ -690,6 +694,7 @@ using_backend {
 
     HEADERS += recorders/rtp/udppacket.h
     HEADERS += recorders/rtp/udppacketbuffer.h
+    HEADERS += recorders/rtp/udpbatchreader.h
     HEADERS += recorders/rtp/packetbuffer.h
     HEADERS += recorders/rtp/rtppacketbuffer.h
     HEADERS += recorders/rtp/rtpdatapacket.h
@@ -705,6 +710,7 @@ using_backend {
 
     SOURCES += recorders/rtp/packetbuffer.cpp
     SOURCES += recorders/rtp/rtppacketbuffer.cpp
+    SOURCES += recorders/rtp/udpbatchreader.cpp
 
     # Support for HTTP TS streams
     HEADERS += recorders/httptsstreamhandler.h
@@ -1,5 +1,6 @@
 // MythTV headers
 #include "H264Parser.h"
+#include "startcodescanner.h"
 #include <iostream>
 #include "mythlogging.h"
 #include "recorders/dtvrecorder.h" // for FrameRate
@@ -11,6 +12,7 @@ extern "C" {
 }
 
 #include <cmath>
+#include <string.h>
 #include <strings.h>
 
 static const float eps = 1E-5;
@@ -355,6 +357,20 @@ bool H264Parser::fillRBSP(const uint8_t *byteP, uint32_t byte_count,
     /* Fill rbsp while we have data */
     while (byte_count)
     {
+        /* Runs without a zero byte can't hold an emulation prevention
+         * byte, copy them in one go */
+        if (consecutive_zeros == 0 && *byteP != 0)
+        {
+            const uint8_t *zeroP = static_cast<const uint8_t*>(
+                memchr(byteP, 0, byte_count));
+            uint32_t run = zeroP ? zeroP - byteP : byte_count;
+            memcpy(rbsp_buffer + rbsp_index, byteP, run);
+            rbsp_index += run;
+            byteP      += run;
+            byte_count -= run;
+            continue;
+        }
+
         /* Copy the byte into the rbsp, unless it
          * is the 0x03 in a 0x000003 */
         if (consecutive_zeros < 2 || *byteP != 0x03)
@@ -412,8 +428,7 @@ uint32_t H264Parser::addBytes(const uint8_t  *bytes,
 
     while (startP < bytes + byte_count && !on_frame)
     {
-        endP = avpriv_find_start_code(startP,
-                                  bytes + byte_count, &sync_accumulator);
+        endP = find_start_code(startP, bytes + byte_count, &sync_accumulator);
 
         found_start_code = ((sync_accumulator & 0xffffff00) == 0x00000100);
 
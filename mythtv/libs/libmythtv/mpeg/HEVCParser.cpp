@@ -0,0 +1,668 @@
+// MythTV headers
+#include "HEVCParser.h"
+#include "startcodescanner.h"
+#include "mythlogging.h"
+#include "recorders/dtvrecorder.h" // for FrameRate
+
+// copied from libavutil/internal.h
+extern "C" {
+#include "libavutil/common.h" // for AV_GCC_VERSION_AT_LEAST()
+}
+#ifndef av_alias
+#if HAVE_ATTRIBUTE_MAY_ALIAS && (!defined(__ICC) || __ICC > 1110) && AV_GCC_VERSION_AT_LEAST(3,3)
+#   define av_alias __attribute__((may_alias))
+#else
+#   define av_alias
+#endif
+#endif
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavcodec/get_bits.h"
+#include "libavcodec/golomb.h"
+}
+
+#include <cmath>
+#include <string.h>
+
+static const float eps = 1E-5;
+
+/*
+  Most of the comments below were cut&paste from ITU-T Rec. H.265
+  as found here:  http://www.itu.int/rec/T-REC-H.265
+
+  * access unit: A set of NAL units that are associated with each
+  other according to a specified classification rule, are consecutive
+  in decoding order, and contain exactly one coded picture.
+
+  * intra random access point (IRAP) picture: A coded picture for
+  which each VCL NAL unit has nal_unit_type in the range of BLA_W_LP
+  to RSV_IRAP_VCL23, inclusive. Decoding can start at any IRAP
+  picture, they are the H.265 keyframes.
+
+  Unlike H.264 the NAL unit header is two bytes long and each slice
+  segment header starts with first_slice_segment_in_pic_flag, so the
+  start of a new picture can be found from the first byte of the
+  slice segment without decoding any parameter sets.
+*/
+
+HEVCParser::HEVCParser(void)
+{
+    Reset();
+}
+
+void HEVCParser::Reset(void)
+{
+    state_changed = false;
+    seen_sps = false;
+    SPS_offset = 0;
+
+    sync_accumulator = 0xffffffff;
+    AU_pending = false;
+    resetRBSP();
+
+    nal_unit_type = UNKNOWN;
+
+    chroma_format_idc = 1;
+    separate_colour_plane_flag = 0;
+    pic_width = pic_height = 0;
+    conf_win_left_offset = conf_win_right_offset = 0;
+    conf_win_top_offset = conf_win_bottom_offset = 0;
+    log2_max_pic_order_cnt_lsb = 4;
+    aspect_ratio_idc = 0;
+    sar_width = sar_height = 0;
+    field_seq_flag = false;
+    second_field = false;
+    unitsInTick = timeScale = 0;
+
+    pkt_offset = AU_offset = frame_start_offset = keyframe_start_offset = 0;
+    on_frame = on_key_frame = false;
+}
+
+/*
+  7.4.2.4.4 Order of NAL units and coded pictures and their
+  association to access units: the first of any of these NAL units
+  after the last VCL NAL unit of a picture starts a new access unit.
+*/
+bool HEVCParser::NALstartsAU(uint8_t nal_type)
+{
+    return (nal_type >= VPS_NUT && nal_type <= AUD_NUT) ||
+        nal_type == PREFIX_SEI_NUT ||
+        (nal_type >= 41 && nal_type <= 44) ||
+        (nal_type >= 48 && nal_type <= 55);
+}
+
+void HEVCParser::resetRBSP(void)
+{
+    rbsp_index = 0;
+    consecutive_zeros = 0;
+    rbsp_truncated = false;
+    have_unfinished_NAL = false;
+}
+
+void HEVCParser::fillRBSP(const uint8_t *byteP, uint32_t byte_count,
+                          bool found_start_code)
+{
+    /* Slices are only needed up to the first byte of the slice
+     * segment header, parameter sets need the whole NAL */
+    const uint32_t limit = NALisVCL(nal_unit_type) ?
+        2 : (uint32_t)MAX_PARAMETER_SET_SIZE;
+
+    while (byte_count && rbsp_index < limit)
+    {
+        /* Copy the byte into the rbsp, unless it
+         * is the 0x03 in a 0x000003 */
+        if (consecutive_zeros < 2 || *byteP != 0x03)
+            rbsp_buffer[rbsp_index++] = *byteP;
+
+        if (*byteP == 0)
+            ++consecutive_zeros;
+        else
+            consecutive_zeros = 0;
+
+        ++byteP;
+        --byte_count;
+    }
+
+    if (byte_count)
+    {
+        rbsp_truncated = true;
+    }
+    else if (found_start_code)
+    {
+        /* The next start code and the first byte of the next NAL
+         * header are in the rbsp, move back to the end of the
+         * actual rbsp data. */
+        if (rbsp_index >= 4)
+        {
+            rbsp_index -= 4;
+            while (rbsp_index > 0 && rbsp_buffer[rbsp_index-1] == 0)
+                --rbsp_index;
+        }
+        else
+            rbsp_index = 0;
+    }
+
+    /* Stick some 0xff on the end for get_bits to run into */
+    memset(&rbsp_buffer[rbsp_index], 0xff, FF_INPUT_BUFFER_PADDING_SIZE);
+}
+
+uint32_t HEVCParser::addBytes(const uint8_t  *bytes,
+                              const uint32_t  byte_count,
+                              const uint64_t  stream_offset)
+{
+    const uint8_t *startP = bytes;
+    const uint8_t *endP;
+    bool           found_start_code;
+
+    state_changed = false;
+    on_frame      = false;
+    on_key_frame  = false;
+
+    while (startP < bytes + byte_count && !on_frame)
+    {
+        endP = find_start_code(startP, bytes + byte_count, &sync_accumulator);
+
+        found_start_code = ((sync_accumulator & 0xffffff00) == 0x00000100);
+
+        /* Between startP and endP we potentially have some more
+         * bytes of a NAL that we've been parsing (plus some bytes of
+         * start code)
+         */
+        if (have_unfinished_NAL)
+        {
+            fillRBSP(startP, endP - startP, found_start_code);
+            processRBSP(found_start_code); /* Call may set have_unfinished_NAL
+                                            * to false */
+        }
+
+        /* Dealt with everything up to endP */
+        startP = endP;
+
+        if (!found_start_code)
+            continue;
+
+        if (have_unfinished_NAL)
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                "HEVCParser::addBytes: Found new start "
+                "code, but previous NAL is incomplete!");
+        }
+
+        /* Prepare for accepting the new NAL */
+        resetRBSP();
+
+        /* If we find the start of an AU somewhere from here
+         * to the next start code, the offset to associate with
+         * it is the one passed in to this call, not any of the
+         * subsequent calls.
+         */
+        pkt_offset = stream_offset;
+
+        /*
+          nal_unit_header( ) {
+            forbidden_zero_bit     f(1)
+            nal_unit_type          u(6)
+            nuh_layer_id           u(6)
+            nuh_temporal_id_plus1  u(3)
+          }
+        */
+        if (sync_accumulator & 0x80)
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                "HEVCParser::addBytes: malformed NAL units");
+            nal_unit_type = UNKNOWN;
+            continue;
+        }
+
+        nal_unit_type = (sync_accumulator >> 1) & 0x3f;
+
+        if (NALisVCL(nal_unit_type) || nal_unit_type == SPS_NUT)
+        {
+            /* This is a NAL we need to parse. We may have the body
+             * of it in the part of the stream past to us this call,
+             * or we may get the rest in subsequent calls to addBytes.
+             */
+            have_unfinished_NAL = true;
+        }
+        else if (NALstartsAU(nal_unit_type))
+        {
+            set_AU_pending();
+        }
+    }
+
+    return startP - bytes;
+}
+
+void HEVCParser::processRBSP(bool rbsp_complete)
+{
+    if (nal_unit_type == SPS_NUT)
+    {
+        /* Best wait until we have the whole thing */
+        if (!rbsp_complete)
+            return;
+
+        have_unfinished_NAL = false;
+        set_AU_pending();
+
+        if (rbsp_index < 2)
+            return;
+
+        if (rbsp_truncated)
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("HEVCParser::processRBSP: SPS larger than %1 bytes")
+                .arg(MAX_PARAMETER_SET_SIZE));
+            return;
+        }
+
+        if (!seen_sps)
+            SPS_offset = pkt_offset;
+
+        GetBitContext gb;
+        /* skip the second byte of the NAL unit header */
+        init_get_bits(&gb, rbsp_buffer + 1, 8 * (rbsp_index - 1));
+        decode_SPS(&gb);
+        return;
+    }
+
+    /* VCL NAL unit, we need the second NAL header
+     * byte and the first byte of the slice segment */
+    if (rbsp_index < 2)
+    {
+        if (rbsp_complete)
+            have_unfinished_NAL = false;
+        return;
+    }
+
+    have_unfinished_NAL = false;
+
+    /* first_slice_segment_in_pic_flag */
+    if (!(rbsp_buffer[1] & 0x80))
+        return;
+
+    /* A picture without any of the NAL units that start an
+     * access unit in front of it starts one on its own. */
+    set_AU_pending();
+    AU_pending = false;
+
+    const bool keyframe = NALisIRAP(nal_unit_type);
+
+    if (field_seq_flag)
+        second_field = keyframe ? false : !second_field;
+
+    state_changed = seen_sps;
+
+    on_frame = true;
+    frame_start_offset = AU_offset;
+
+    if (keyframe)
+    {
+        on_key_frame = true;
+        keyframe_start_offset = AU_offset;
+    }
+}
+
+/*
+  7.3.2.2 Sequence parameter set RBSP syntax
+*/
+void HEVCParser::decode_SPS(GetBitContext *gb)
+{
+    get_bits(gb, 4); // sps_video_parameter_set_id
+    uint max_sub_layers_minus1 = get_bits(gb, 3);
+    get_bits1(gb); // sps_temporal_id_nesting_flag
+
+    profile_tier_level(gb, max_sub_layers_minus1);
+
+    get_ue_golomb(gb); // sps_seq_parameter_set_id
+
+    chroma_format_idc = get_ue_golomb(gb);
+    if (chroma_format_idc == 3)
+        separate_colour_plane_flag = get_bits1(gb);
+    else
+        separate_colour_plane_flag = 0;
+
+    pic_width  = get_ue_golomb_long(gb); // pic_width_in_luma_samples
+    pic_height = get_ue_golomb_long(gb); // pic_height_in_luma_samples
+
+    if (get_bits1(gb)) // conformance_window_flag
+    {
+        conf_win_left_offset   = get_ue_golomb_long(gb);
+        conf_win_right_offset  = get_ue_golomb_long(gb);
+        conf_win_top_offset    = get_ue_golomb_long(gb);
+        conf_win_bottom_offset = get_ue_golomb_long(gb);
+    }
+    else
+    {
+        conf_win_left_offset = conf_win_right_offset = 0;
+        conf_win_top_offset = conf_win_bottom_offset = 0;
+    }
+
+    get_ue_golomb(gb); // bit_depth_luma_minus8
+    get_ue_golomb(gb); // bit_depth_chroma_minus8
+    log2_max_pic_order_cnt_lsb = get_ue_golomb(gb) + 4;
+    if (log2_max_pic_order_cnt_lsb > 16)
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("HEVCParser::decode_SPS: "
+            "log2_max_pic_order_cnt_lsb %1 out of range")
+            .arg(log2_max_pic_order_cnt_lsb));
+        return;
+    }
+
+    bool sub_layer_ordering_info_present_flag = get_bits1(gb);
+    for (uint i = (sub_layer_ordering_info_present_flag ?
+                   0 : max_sub_layers_minus1);
+         i <= max_sub_layers_minus1; ++i)
+    {
+        get_ue_golomb_long(gb); // sps_max_dec_pic_buffering_minus1
+        get_ue_golomb_long(gb); // sps_max_num_reorder_pics
+        get_ue_golomb_long(gb); // sps_max_latency_increase_plus1
+    }
+
+    get_ue_golomb(gb); // log2_min_luma_coding_block_size_minus3
+    get_ue_golomb(gb); // log2_diff_max_min_luma_coding_block_size
+    get_ue_golomb(gb); // log2_min_luma_transform_block_size_minus2
+    get_ue_golomb(gb); // log2_diff_max_min_luma_transform_block_size
+    get_ue_golomb(gb); // max_transform_hierarchy_depth_inter
+    get_ue_golomb(gb); // max_transform_hierarchy_depth_intra
+
+    if (get_bits1(gb)) // scaling_list_enabled_flag
+    {
+        if (get_bits1(gb)) // sps_scaling_list_data_present_flag
+            scaling_list_data(gb);
+    }
+
+    get_bits1(gb); // amp_enabled_flag
+    get_bits1(gb); // sample_adaptive_offset_enabled_flag
+
+    if (get_bits1(gb)) // pcm_enabled_flag
+    {
+        get_bits(gb, 4); // pcm_sample_bit_depth_luma_minus1
+        get_bits(gb, 4); // pcm_sample_bit_depth_chroma_minus1
+        get_ue_golomb(gb); // log2_min_pcm_luma_coding_block_size_minus3
+        get_ue_golomb(gb); // log2_diff_max_min_pcm_luma_coding_block_size
+        get_bits1(gb); // pcm_loop_filter_disabled_flag
+    }
+
+    uint num_short_term_ref_pic_sets = get_ue_golomb(gb);
+    if (num_short_term_ref_pic_sets > MAX_SHORT_TERM_REF_PIC_SETS)
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("HEVCParser::decode_SPS: "
+            "num_short_term_ref_pic_sets %1 out of range")
+            .arg(num_short_term_ref_pic_sets));
+        return;
+    }
+
+    uint num_delta_pocs[MAX_SHORT_TERM_REF_PIC_SETS];
+    for (uint i = 0; i < num_short_term_ref_pic_sets; ++i)
+    {
+        if (!st_ref_pic_set(gb, i, num_delta_pocs))
+            return;
+    }
+
+    if (get_bits1(gb)) // long_term_ref_pics_present_flag
+    {
+        uint num_long_term_ref_pics_sps = get_ue_golomb(gb);
+        for (uint i = 0; i < num_long_term_ref_pics_sps; ++i)
+        {
+            get_bits(gb, log2_max_pic_order_cnt_lsb); // lt_ref_pic_poc_lsb_sps
+            get_bits1(gb); // used_by_curr_pic_lt_sps_flag
+        }
+    }
+
+    get_bits1(gb); // sps_temporal_mvp_enabled_flag
+    get_bits1(gb); // strong_intra_smoothing_enabled_flag
+
+    aspect_ratio_idc = 0;
+    sar_width = sar_height = 0;
+    field_seq_flag = false;
+    unitsInTick = timeScale = 0;
+
+    if (get_bits1(gb)) // vui_parameters_present_flag
+        vui_parameters(gb);
+
+    seen_sps = true;
+}
+
+/*
+  7.3.3 Profile, tier and level syntax
+*/
+void HEVCParser::profile_tier_level(GetBitContext *gb,
+                                    uint max_sub_layers_minus1)
+{
+    /* general_profile_space, general_tier_flag, general_profile_idc,
+     * general_profile_compatibility_flag[32], the four source and
+     * constraint flags, 43 reserved bits, general_inbld_flag and
+     * general_level_idc */
+    skip_bits_long(gb, 8 + 32 + 4 + 43 + 1 + 8);
+
+    bool sub_layer_profile_present_flag[8];
+    bool sub_layer_level_present_flag[8];
+    for (uint i = 0; i < max_sub_layers_minus1; ++i)
+    {
+        sub_layer_profile_present_flag[i] = get_bits1(gb);
+        sub_layer_level_present_flag[i]   = get_bits1(gb);
+    }
+
+    if (max_sub_layers_minus1 > 0)
+    {
+        for (uint i = max_sub_layers_minus1; i < 8; ++i)
+            get_bits(gb, 2); // reserved_zero_2bits
+    }
+
+    for (uint i = 0; i < max_sub_layers_minus1; ++i)
+    {
+        if (sub_layer_profile_present_flag[i])
+            skip_bits_long(gb, 8 + 32 + 4 + 43 + 1);
+        if (sub_layer_level_present_flag[i])
+            get_bits(gb, 8); // sub_layer_level_idc
+    }
+}
+
+/*
+  7.3.4 Scaling list data syntax
+*/
+void HEVCParser::scaling_list_data(GetBitContext *gb)
+{
+    for (uint sizeId = 0; sizeId < 4; ++sizeId)
+    {
+        for (uint matrixId = 0; matrixId < 6;
+             matrixId += (sizeId == 3) ? 3 : 1)
+        {
+            if (!get_bits1(gb)) // scaling_list_pred_mode_flag
+            {
+                get_ue_golomb_long(gb); // scaling_list_pred_matrix_id_delta
+                continue;
+            }
+
+            uint coefNum = 1 << (4 + (sizeId << 1));
+            if (coefNum > 64)
+                coefNum = 64;
+            if (sizeId > 1)
+                get_se_golomb(gb); // scaling_list_dc_coef_minus8
+            for (uint i = 0; i < coefNum; ++i)
+                get_se_golomb(gb); // scaling_list_delta_coef
+        }
+    }
+}
+
+/*
+  7.3.7 Short-term reference picture set syntax
+
+  Only the number of delta POCs of each set is kept, later sets may
+  be predicted from the one before them.
+*/
+bool HEVCParser::st_ref_pic_set(GetBitContext *gb, uint idx,
+                                uint *num_delta_pocs)
+{
+    bool inter_ref_pic_set_prediction_flag = false;
+    if (idx != 0)
+        inter_ref_pic_set_prediction_flag = get_bits1(gb);
+
+    if (inter_ref_pic_set_prediction_flag)
+    {
+        get_bits1(gb); // delta_rps_sign
+        get_ue_golomb_long(gb); // abs_delta_rps_minus1
+
+        uint count = 0;
+        for (uint j = 0; j <= num_delta_pocs[idx - 1]; ++j)
+        {
+            bool used_by_curr_pic_flag = get_bits1(gb);
+            bool use_delta_flag = true;
+            if (!used_by_curr_pic_flag)
+                use_delta_flag = get_bits1(gb);
+            if (used_by_curr_pic_flag || use_delta_flag)
+                ++count;
+        }
+        num_delta_pocs[idx] = count;
+        return true;
+    }
+
+    uint num_negative_pics = get_ue_golomb_long(gb);
+    uint num_positive_pics = get_ue_golomb_long(gb);
+    if (num_negative_pics > 16 || num_positive_pics > 16)
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("HEVCParser::st_ref_pic_set: "
+            "%1 negative and %2 positive pictures is out of range")
+            .arg(num_negative_pics).arg(num_positive_pics));
+        return false;
+    }
+
+    for (uint i = 0; i < num_negative_pics + num_positive_pics; ++i)
+    {
+        get_ue_golomb_long(gb); // delta_poc_sX_minus1
+        get_bits1(gb); // used_by_curr_pic_sX_flag
+    }
+    num_delta_pocs[idx] = num_negative_pics + num_positive_pics;
+    return true;
+}
+
+/*
+  E.2.1 VUI parameters syntax, up to the timing information
+*/
+void HEVCParser::vui_parameters(GetBitContext *gb)
+{
+    if (get_bits1(gb)) //aspect_ratio_info_present_flag
+    {
+        aspect_ratio_idc = get_bits(gb, 8);
+        if (aspect_ratio_idc == EXTENDED_SAR)
+        {
+            sar_width  = get_bits(gb, 16);
+            sar_height = get_bits(gb, 16);
+        }
+    }
+
+    if (get_bits1(gb)) //overscan_info_present_flag
+        get_bits1(gb); //overscan_appropriate_flag
+
+    if (get_bits1(gb)) //video_signal_type_present_flag
+    {
+        get_bits(gb, 3); //video_format
+        get_bits1(gb);   //video_full_range_flag
+        if (get_bits1(gb)) // colour_description_present_flag
+        {
+            get_bits(gb, 8); // colour_primaries
+            get_bits(gb, 8); // transfer_characteristics
+            get_bits(gb, 8); // matrix_coeffs
+        }
+    }
+
+    if (get_bits1(gb)) //chroma_loc_info_present_flag
+    {
+        get_ue_golomb(gb); //chroma_sample_loc_type_top_field ue(v)
+        get_ue_golomb(gb); //chroma_sample_loc_type_bottom_field ue(v)
+    }
+
+    get_bits1(gb); // neutral_chroma_indication_flag
+    field_seq_flag = get_bits1(gb);
+    get_bits1(gb); // frame_field_info_present_flag
+
+    if (get_bits1(gb)) // default_display_window_flag
+    {
+        get_ue_golomb_long(gb); // def_disp_win_left_offset
+        get_ue_golomb_long(gb); // def_disp_win_right_offset
+        get_ue_golomb_long(gb); // def_disp_win_top_offset
+        get_ue_golomb_long(gb); // def_disp_win_bottom_offset
+    }
+
+    if (get_bits1(gb)) // vui_timing_info_present_flag
+    {
+        unitsInTick = get_bits_long(gb, 32); // vui_num_units_in_tick
+        timeScale = get_bits_long(gb, 32);   // vui_time_scale
+    }
+}
+
+void HEVCParser::getFrameRate(FrameRate &result) const
+{
+    /* Unlike H.264 a tick is a whole picture, with field_seq_flag
+     * set that is a field. */
+    if (unitsInTick == 0)
+        result = FrameRate(0);
+    else if (field_seq_flag)
+    {
+        if (timeScale & 0x1)
+            result = FrameRate(timeScale, unitsInTick * 2);
+        else
+            result = FrameRate(timeScale / 2, unitsInTick);
+    }
+    else
+        result = FrameRate(timeScale, unitsInTick);
+}
+
+uint HEVCParser::aspectRatio(void) const
+{
+    // Table E-1 sample aspect ratios, same as H.264
+    static const uint8_t sar[17][2] =
+    {
+        {  0,  0 }, {  1,  1 }, { 12, 11 }, { 10, 11 }, { 16, 11 },
+        { 40, 33 }, { 24, 11 }, { 20, 11 }, { 32, 11 }, { 80, 33 },
+        { 18, 11 }, { 15, 11 }, { 64, 33 }, {160, 99 }, {  4,  3 },
+        {  3,  2 }, {  2,  1 },
+    };
+
+    double aspect = 0.0;
+
+    if (pictureHeightCropped())
+        aspect = pictureWidthCropped() / (double)pictureHeightCropped();
+
+    if (aspect_ratio_idc == EXTENDED_SAR)
+    {
+        if (sar_height)
+            aspect *= sar_width / (double)sar_height;
+        else
+            aspect = 0.0;
+    }
+    else if (aspect_ratio_idc > 0 && aspect_ratio_idc <= 16)
+    {
+        aspect *= sar[aspect_ratio_idc][0] /
+            (double)sar[aspect_ratio_idc][1];
+    }
+
+    if (aspect == 0.0)
+        return 0;
+    if (fabs(aspect - 1.3333333333333333) < eps)
+        return 2;
+    if (fabs(aspect - 1.7777777777777777) < eps)
+        return 3;
+    if (fabs(aspect - 2.21) < eps)
+        return 4;
+
+    return aspect * 1000000;
+}
+
+// Table 6-1, conformance window offsets are in chroma samples
+uint HEVCParser::pictureWidthCropped(void) const
+{
+    uint ChromaArrayType = separate_colour_plane_flag ? 0 : chroma_format_idc;
+    uint SubWidthC = (ChromaArrayType == 1 || ChromaArrayType == 2) ? 2 : 1;
+    uint crop = SubWidthC * (conf_win_left_offset + conf_win_right_offset);
+    return crop < pic_width ? pic_width - crop : pic_width;
+}
+
+uint HEVCParser::pictureHeightCropped(void) const
+{
+    uint ChromaArrayType = separate_colour_plane_flag ? 0 : chroma_format_idc;
+    uint SubHeightC = (ChromaArrayType == 1) ? 2 : 1;
+    uint crop = SubHeightC * (conf_win_top_offset + conf_win_bottom_offset);
+    return crop < pic_height ? pic_height - crop : pic_height;
+}
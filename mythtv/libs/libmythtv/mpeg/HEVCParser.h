@@ -0,0 +1,198 @@
+// -*- Mode: c++ -*-
+/*******************************************************************
+ * HEVCParser
+ *
+ * Distributed as part of MythTV (www.mythtv.org)
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ********************************************************************/
+
+#ifndef HEVCPARSER_H
+#define HEVCPARSER_H
+
+#include <stdint.h>
+#include "compat.h" // for uint on Darwin, MinGW
+
+class FrameRate;
+struct GetBitContext;
+
+/** \class HEVCParser
+ *  \brief Finds access units and keyframes in an H.265 elementary stream.
+ *
+ *  This offers the subset of the H264Parser interface the recorders
+ *  use for keyframe detection. Only the first bytes of each slice
+ *  segment and the SPS are looked at, everything else is skipped by
+ *  the start code scanner.
+ */
+class HEVCParser
+{
+  public:
+    enum {
+        MAX_PARAMETER_SET_SIZE = 4096,
+        MAX_SHORT_TERM_REF_PIC_SETS = 64
+    };
+
+    // ITU-T Rec. H.265 table 7-1
+    enum NAL_unit_type {
+        TRAIL_N         = 0,   // 0 - 31 are VCL NAL units
+        TRAIL_R         = 1,
+        TSA_N           = 2,
+        TSA_R           = 3,
+        STSA_N          = 4,
+        STSA_R          = 5,
+        RADL_N          = 6,
+        RADL_R          = 7,
+        RASL_N          = 8,
+        RASL_R          = 9,
+        BLA_W_LP        = 16,  // 16 - 23 are IRAP pictures
+        BLA_W_RADL      = 17,
+        BLA_N_LP        = 18,
+        IDR_W_RADL      = 19,
+        IDR_N_LP        = 20,
+        CRA_NUT         = 21,
+        RSV_IRAP_23     = 23,
+        RSV_VCL31       = 31,
+        VPS_NUT         = 32,
+        SPS_NUT         = 33,
+        PPS_NUT         = 34,
+        AUD_NUT         = 35,
+        EOS_NUT         = 36,
+        EOB_NUT         = 37,
+        FD_NUT          = 38,
+        PREFIX_SEI_NUT  = 39,
+        SUFFIX_SEI_NUT  = 40,
+        UNKNOWN         = 64
+    };
+
+    enum frame_type {
+        FRAME = 'F',
+        FIELD_TOP = 'T',
+        FIELD_BOTTOM = 'B'
+    };
+
+    HEVCParser(void);
+
+    uint32_t addBytes(const uint8_t  *bytes,
+                      const uint32_t  byte_count,
+                      const uint64_t  stream_offset);
+    void Reset(void);
+
+    bool stateChanged(void) const { return state_changed; }
+
+    uint8_t lastNALtype(void) const { return nal_unit_type; }
+
+    /// With field_seq_flag set each field is coded as its own picture,
+    /// the second field of each pair is reported as FIELD_BOTTOM.
+    frame_type FieldType(void) const
+        {
+            if (!field_seq_flag)
+                return FRAME;
+            return second_field ? FIELD_BOTTOM : FIELD_TOP;
+        }
+
+    bool onFrameStart(void) const { return on_frame; }
+    bool onKeyFrameStart(void) const { return on_key_frame; }
+
+    uint pictureWidth(void) const { return pic_width; }
+    uint pictureHeight(void) const { return pic_height; }
+    uint pictureWidthCropped(void) const;
+    uint pictureHeightCropped(void) const;
+
+    /** \brief Computes aspect ratio from picture size and sample aspect ratio
+     */
+    uint aspectRatio(void) const;
+    void getFrameRate(FrameRate &result) const;
+
+    uint64_t frameAUstreamOffset(void) const {return frame_start_offset;}
+    uint64_t keyframeAUstreamOffset(void) const {return keyframe_start_offset;}
+    uint64_t SPSstreamOffset(void) const {return SPS_offset;}
+
+    static bool NALisVCL(uint8_t nal_type)
+        {
+            return nal_type <= RSV_VCL31;
+        }
+
+    /// Intra random access points, every one of these can be used
+    /// as a seek point.
+    static bool NALisIRAP(uint8_t nal_type)
+        {
+            return nal_type >= BLA_W_LP && nal_type <= RSV_IRAP_23;
+        }
+
+    uint32_t GetTimeScale(void) const { return timeScale; }
+
+    uint32_t GetUnitsInTick(void) const { return unitsInTick; }
+
+    void reset_SPS(void) { seen_sps = false; }
+    bool seen_SPS(void) const { return seen_sps; }
+
+  private:
+    enum constants {EXTENDED_SAR = 255};
+
+    inline void set_AU_pending(void)
+        {
+            if (!AU_pending)
+            {
+                AU_pending = true;
+                AU_offset = pkt_offset;
+            }
+        }
+
+    static bool NALstartsAU(uint8_t nal_type);
+
+    void resetRBSP(void);
+    void fillRBSP(const uint8_t *byteP, uint32_t byte_count,
+                  bool found_start_code);
+    void processRBSP(bool rbsp_complete);
+    void decode_SPS(GetBitContext *gb);
+    void profile_tier_level(GetBitContext *gb, uint max_sub_layers_minus1);
+    void scaling_list_data(GetBitContext *gb);
+    bool st_ref_pic_set(GetBitContext *gb, uint idx, uint *num_delta_pocs);
+    void vui_parameters(GetBitContext *gb);
+
+    bool       AU_pending;
+    bool       state_changed;
+    bool       seen_sps;
+
+    uint32_t   sync_accumulator;
+    uint8_t    rbsp_buffer[MAX_PARAMETER_SET_SIZE + 64];
+    uint32_t   rbsp_index;
+    uint32_t   consecutive_zeros;
+    bool       rbsp_truncated;
+    bool       have_unfinished_NAL;
+
+    uint8_t    nal_unit_type;
+
+    uint8_t    chroma_format_idc;
+    uint8_t    separate_colour_plane_flag;
+    uint       pic_width, pic_height;
+    uint       conf_win_left_offset;
+    uint       conf_win_right_offset;
+    uint       conf_win_top_offset;
+    uint       conf_win_bottom_offset;
+    uint       log2_max_pic_order_cnt_lsb;
+    uint8_t    aspect_ratio_idc;
+    uint       sar_width, sar_height;
+    bool       field_seq_flag;
+    bool       second_field;
+    uint32_t   unitsInTick, timeScale;
+
+    uint64_t   pkt_offset, AU_offset, frame_start_offset, keyframe_start_offset;
+    uint64_t   SPS_offset;
+    bool       on_frame, on_key_frame;
+};
+
+#endif /* HEVCPARSER_H */
@@ -71,7 +71,7 @@ MPEGStreamData::MPEGStreamData(int desiredProgram, int cardnum,
       _si_time_offset_cnt(0),
       _si_time_offset_indx(0),
       _eit_helper(NULL), _eit_rate(0.0f),
-      _listening_disabled(false),
+      _pid_version(0), _listening_disabled(false),
       _encryption_lock(QMutex::Recursive), _listener_lock(QMutex::Recursive),
       _cache_tables(cacheTables), _cache_lock(QMutex::Recursive),
       // Single program stuff
@@ -193,6 +193,7 @@ void MPEGStreamData::Reset(int desiredProgram)
     _pids_notlistening.clear();
     _pids_writing.clear();
     _pids_audio.clear();
+    _pid_version++;
 
     _pid_video_single_program = _pid_pmt_single_program = 0xffffffff;
 
@@ -649,6 +650,7 @@ bool MPEGStreamData::CreatePMTSingleProgram(const ProgramMapTable &pmt)
 
     _pids_writing.clear();
     _pid_video_single_program = !videoPIDs.empty() ? videoPIDs[0] : 0xffffffff;
+    _pid_version++;
     for (uint i = 1; i < videoPIDs.size(); i++)
         AddWritingPID(videoPIDs[i]);
 
@@ -1033,21 +1035,22 @@ int MPEGStreamData::ProcessData(const unsigned char *buffer, int len)
             pos = newpos;
         }
 
-        const TSPacket *pkt = reinterpret_cast<const TSPacket*>(&buffer[pos]);
-        pos += TSPacket::kSize; // Advance to next TS packet
+        // Decode the headers of the whole run of in sync packets
+        pos += _ts_batch.Parse(&buffer[pos], len - pos);
         resync = false;
-        if (!ProcessTSPacket(*pkt))
+
+        bool ok = true;
+        for (uint i = 0; i < _ts_batch.Size(); ++i)
+            ok = ProcessTSPacket(*_ts_batch.Packet(i));
+
+        if (!ok && (pos + int(TSPacket::kSize) <= len) &&
+            (buffer[pos] != SYNC_BYTE))
         {
-            if (pos + int(TSPacket::kSize) > len)
-                continue;
-            if (buffer[pos] != SYNC_BYTE)
-            {
-                // if ProcessTSPacket fails, and we don't appear to be
-                // in sync on the next packet, then resync. Otherwise
-                // just process the next packet normally.
-                pos -= TSPacket::kSize;
-                resync = true;
-            }
+            // if ProcessTSPacket fails, and we don't appear to be
+            // in sync on the next packet, then resync. Otherwise
+            // just process the next packet normally.
+            pos -= TSPacket::kSize;
+            resync = true;
         }
     }
 
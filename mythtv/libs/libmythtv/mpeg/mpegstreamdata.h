@@ -14,6 +14,7 @@ using namespace std;
 #include <QMap>
 
 #include "tspacket.h"
+#include "tsheaderbatch.h"
 #include "mythtimer.h"
 #include "streamlisteners.h"
 #include "eitscanner.h"
@@ -129,21 +130,24 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     // Listening
     virtual void AddListeningPID(
         uint pid, PIDPriority priority = kPIDPriorityNormal)
-        { _pids_listening[pid] = priority; }
+        { _pids_listening[pid] = priority; _pid_version++; }
     virtual void AddNotListeningPID(uint pid)
         { _pids_notlistening[pid] = kPIDPriorityNormal; }
     virtual void AddWritingPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { _pids_writing[pid] = priority; }
+        { _pids_writing[pid] = priority; _pid_version++; }
     virtual void AddAudioPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { _pids_audio[pid] = priority; }
+        { _pids_audio[pid] = priority; _pid_version++; }
 
-    virtual void RemoveListeningPID(uint pid) { _pids_listening.remove(pid);  }
+    virtual void RemoveListeningPID(uint pid)
+        { _pids_listening.remove(pid); _pid_version++; }
     virtual void RemoveNotListeningPID(uint pid)
         { _pids_notlistening.remove(pid); }
-    virtual void RemoveWritingPID(uint pid) { _pids_writing.remove(pid);    }
-    virtual void RemoveAudioPID(uint pid)   { _pids_audio.remove(pid);      }
+    virtual void RemoveWritingPID(uint pid)
+        { _pids_writing.remove(pid); _pid_version++; }
+    virtual void RemoveAudioPID(uint pid)
+        { _pids_audio.remove(pid); _pid_version++; }
 
     virtual bool IsListeningPID(uint pid) const;
     virtual bool IsNotListeningPID(uint pid) const;
@@ -160,6 +164,14 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
         { return _pids_writing; }
 
     uint GetPIDs(pid_map_t&) const;
+    /// \brief Incremented whenever the set of PIDs returned by GetPIDs()
+    ///        may have changed, lets a shared demux cache its PID tables.
+    uint PIDVersion(void) const { return _pid_version; }
+    /// \brief Returns true if this stream is fed to PS listeners, these
+    ///        need the raw buffer rather than individual TS packets.
+    bool HasPSListeners(void) const { return !_ps_listeners.empty(); }
+
+    static int ResyncStream(const unsigned char *buffer, int curr_pos, int len);
 
     // PID Priorities
     PIDPriority GetPIDPriority(uint pid) const;
@@ -346,8 +358,6 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     void ProcessPMT(const ProgramMapTable *pmt);
     void ProcessEncryptedPacket(const TSPacket&);
 
-    static int ResyncStream(const unsigned char *buffer, int curr_pos, int len);
-
     void UpdateTimeOffset(uint64_t si_utc_time);
 
     // Caching
@@ -377,6 +387,7 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     pid_map_t                 _pids_notlistening;
     pid_map_t                 _pids_writing;
     pid_map_t                 _pids_audio;
+    volatile uint             _pid_version;
     bool                      _listening_disabled;
 
     // Encryption monitoring
@@ -406,6 +417,9 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     // PSIP construction
     pid_psip_map_t            _partial_psip_packet_cache;
 
+    // Packet headers of the buffer being processed by ProcessData()
+    TSHeaderBatch             _ts_batch;
+
     // Caching
     bool                             _cache_tables;
     mutable QMutex                   _cache_lock;
@@ -13,10 +13,14 @@ extern "C" {
 }
 
 #include <vector>
-#include <map>
 
 using namespace std;
 
+#include <QAtomicPointer>
+#include <QAtomicInt>
+#include <QThreadStorage>
+#include <QMutex>
+
 // return true if complete or broken
 bool PESPacket::AddTSPacket(const TSPacket* packet, bool &broken)
 {
@@ -211,143 +215,308 @@ float SequenceHeader::aspect(bool mpeg1) const
 /////////////////////////////////////////////////////////////////////////
 // Memory allocator to avoid malloc global lock and waste less memory. //
 /////////////////////////////////////////////////////////////////////////
+//
+// Each thread allocates from its own pool of 188 and 4096 byte blocks so
+// recorder threads never contend for a lock. Every block is preceded by
+// a small header pointing at the slab it was carved from, which makes the
+// ownership check in pes_free() O(1). Free blocks are kept on a free list
+// threaded through the block payloads. Blocks freed by a thread other
+// than the one which allocated them are pushed onto a lock-free stack
+// which the owning thread drains on its next allocation.
 
 #ifndef USING_VALGRIND
-static vector<unsigned char*> mem188;
-static vector<unsigned char*> free188;
-static map<unsigned char*, bool> alloc188;
+class PESSlabPool;
+
+class PESSlab
+{
+  public:
+    PESSlabPool *pool;
+    uint         size_class;
+    PESSlab     *next;
+};
+
+class PESBlockHeader
+{
+  public:
+    PESSlab     *slab;  ///< NULL if the block came directly from malloc
+    uint64_t     pad;   ///< keeps the payload 16 byte aligned
+};
+
+class PESFreeBlock
+{
+  public:
+    PESFreeBlock *next;
+};
 
-static vector<unsigned char*> mem4096;
-static vector<unsigned char*> free4096;
-static map<unsigned char*, bool> alloc4096;
+#define PES_SIZE_CLASSES 2
+static const uint kBlockSize[PES_SIZE_CLASSES]  = { 188, 4096 };
+static const uint kSlabBlocks[PES_SIZE_CLASSES] = { 512, 128 };
 
-#define BLOCKS188 512
-static unsigned char* get_188_block()
+static inline uint block_stride(uint size_class)
 {
-    if (free188.empty())
+    return sizeof(PESBlockHeader) +
+        ((kBlockSize[size_class] + 15) & ~15);
+}
+
+static inline PESBlockHeader *block_header(unsigned char *ptr)
+{
+    return reinterpret_cast<PESBlockHeader*>(ptr) - 1;
+}
+
+class PESSlabPool
+{
+  public:
+    PESSlabPool() : m_remote_free(NULL), m_in_use_total(0),
+        m_hits(0), m_misses(0), m_high_water(0)
     {
-        mem188.push_back((unsigned char*) malloc(188 * BLOCKS188));
-        free188.reserve(BLOCKS188);
-        unsigned char* block_start = mem188.back();
-        for (uint i = 0; i < BLOCKS188; ++i)
-            free188.push_back(i*188 + block_start);
+        for (uint i = 0; i < PES_SIZE_CLASSES; ++i)
+        {
+            m_slabs[i]      = NULL;
+            m_slab_count[i] = 0;
+            m_free[i]       = NULL;
+            m_in_use[i]     = 0;
+        }
     }
 
-    unsigned char *ptr = free188.back();
-    free188.pop_back();
-    alloc188[ptr] = true;
-    return ptr;
+    unsigned char *Alloc(uint size_class);
+    /// Returns a block to the pool, only call from the owning thread.
+    void Free(PESBlockHeader *hdr);
+    /// Returns a block to the pool from any other thread.
+    void RemoteFree(PESBlockHeader *hdr);
+    void AddStats(PESAllocStats &stats) const;
+
+  private:
+    void DrainRemoteFrees(void);
+    void NewSlab(uint size_class);
+    void ReleaseSlabs(uint size_class);
+
+    PESSlab      *m_slabs[PES_SIZE_CLASSES];
+    uint          m_slab_count[PES_SIZE_CLASSES];
+    PESFreeBlock *m_free[PES_SIZE_CLASSES];
+    uint          m_in_use[PES_SIZE_CLASSES];
+
+    QAtomicPointer<PESFreeBlock> m_remote_free;
+
+    // Only written by the owning thread, read by pes_alloc_stats()
+    QAtomicInt    m_in_use_total;
+    QAtomicInt    m_hits;
+    QAtomicInt    m_misses;
+    QAtomicInt    m_high_water;
+};
+
+unsigned char *PESSlabPool::Alloc(uint size_class)
+{
+    if (!m_free[size_class] && m_remote_free.load())
+        DrainRemoteFrees();
+
+    if (m_free[size_class])
+    {
+        m_hits.ref();
+    }
+    else
+    {
+        m_misses.ref();
+        NewSlab(size_class);
+    }
+
+    PESFreeBlock *blk = m_free[size_class];
+    m_free[size_class] = blk->next;
+    m_in_use[size_class]++;
+
+    int in_use = m_in_use_total.fetchAndAddRelaxed(1) + 1;
+    if (in_use > m_high_water.load())
+        m_high_water.store(in_use);
+
+    return reinterpret_cast<unsigned char*>(blk);
 }
-#undef BLOCKS188
 
-static bool is_188_block(unsigned char* ptr)
+void PESSlabPool::Free(PESBlockHeader *hdr)
 {
-    return alloc188.find(ptr) != alloc188.end();
+    uint size_class = hdr->slab->size_class;
+    PESFreeBlock *blk = reinterpret_cast<PESFreeBlock*>(hdr + 1);
+    blk->next = m_free[size_class];
+    m_free[size_class] = blk;
+    m_in_use[size_class]--;
+    m_in_use_total.deref();
+
+    // free the allocator only if more than 1 slab was used
+    if (!m_in_use[size_class] && m_slab_count[size_class] > 1)
+        ReleaseSlabs(size_class);
 }
 
-static void return_188_block(unsigned char* ptr)
+void PESSlabPool::RemoteFree(PESBlockHeader *hdr)
 {
-    alloc188.erase(ptr);
-    free188.push_back(ptr);
-    // free the allocator only if more than 1 block was used
-    if (alloc188.empty() && mem188.size() > 1)
+    PESFreeBlock *blk = reinterpret_cast<PESFreeBlock*>(hdr + 1);
+    PESFreeBlock *head;
+    do
     {
-        vector<unsigned char*>::iterator it;
-        for (it = mem188.begin(); it != mem188.end(); ++it)
-            free(*it);
-        mem188.clear();
-        free188.clear();
-#if 0
-        LOG(VB_GENERAL, LOG_DEBUG, "freeing all 188 blocks");
-#endif
+        head = m_remote_free.load();
+        blk->next = head;
+    } while (!m_remote_free.testAndSetRelease(head, blk));
+}
+
+void PESSlabPool::DrainRemoteFrees(void)
+{
+    PESFreeBlock *blk = m_remote_free.fetchAndStoreAcquire(NULL);
+    while (blk)
+    {
+        PESFreeBlock *next = blk->next;
+        Free(block_header(reinterpret_cast<unsigned char*>(blk)));
+        blk = next;
     }
 }
 
-#define BLOCKS4096 128
-static unsigned char* get_4096_block()
+void PESSlabPool::NewSlab(uint size_class)
 {
-    if (free4096.empty())
+    uint stride = block_stride(size_class);
+    uint count  = kSlabBlocks[size_class];
+    // The slab header occupies the first stride so that the
+    // block payloads keep the alignment malloc gives us.
+    unsigned char *mem = (unsigned char*) malloc(stride * (count + 1));
+
+    PESSlab *slab    = reinterpret_cast<PESSlab*>(mem);
+    slab->pool       = this;
+    slab->size_class = size_class;
+    slab->next       = m_slabs[size_class];
+    m_slabs[size_class] = slab;
+    m_slab_count[size_class]++;
+
+    for (uint i = count; i > 0; --i)
     {
-        mem4096.push_back((unsigned char*) malloc(4096 * BLOCKS4096));
-        free4096.reserve(BLOCKS4096);
-        unsigned char* block_start = mem4096.back();
-        for (uint i = 0; i < BLOCKS4096; ++i)
-            free4096.push_back(i*4096 + block_start);
+        PESBlockHeader *hdr =
+            reinterpret_cast<PESBlockHeader*>(mem + i * stride);
+        hdr->slab = slab;
+        PESFreeBlock *blk = reinterpret_cast<PESFreeBlock*>(hdr + 1);
+        blk->next = m_free[size_class];
+        m_free[size_class] = blk;
     }
+}
 
-    unsigned char *ptr = free4096.back();
-    free4096.pop_back();
-    alloc4096[ptr] = true;
-    return ptr;
+void PESSlabPool::ReleaseSlabs(uint size_class)
+{
+    PESSlab *slab = m_slabs[size_class];
+    while (slab)
+    {
+        PESSlab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    m_slabs[size_class]      = NULL;
+    m_slab_count[size_class] = 0;
+    m_free[size_class]       = NULL;
+#if 0
+    LOG(VB_GENERAL, LOG_DEBUG, QString("freeing all %1 blocks")
+        .arg(kBlockSize[size_class]));
+#endif
 }
-#undef BLOCKS4096
 
-static bool is_4096_block(unsigned char* ptr)
+void PESSlabPool::AddStats(PESAllocStats &stats) const
 {
-    return alloc4096.find(ptr) != alloc4096.end();
+    stats.hits       += (uint) m_hits.load();
+    stats.misses     += (uint) m_misses.load();
+    stats.in_use     += (uint) m_in_use_total.load();
+    stats.high_water += (uint) m_high_water.load();
+    stats.pools++;
 }
 
-static void return_4096_block(unsigned char* ptr)
+// Pools are never deleted, since blocks may outlive the thread that
+// allocated them. When a thread exits its pool is parked and handed
+// to the next thread which needs one.
+static QMutex                pes_pools_lock;
+static vector<PESSlabPool*>  pes_pools;
+static vector<PESSlabPool*>  pes_idle_pools;
+
+class PESSlabPoolRef
 {
-    alloc4096.erase(ptr);
-    free4096.push_back(ptr);
-
-#if 0 // enable this to debug memory leaks
-        LOG(VB_GENERAL, LOG_DEBUG, QString("%1 4096 blocks remain")
-            .arg(alloc4096.size()));
-        map<unsigned char*, bool>::iterator it;
-        for (it = alloc4096.begin(); it != alloc4096.end(); ++it)
+  public:
+    PESSlabPoolRef()
+    {
+        QMutexLocker locker(&pes_pools_lock);
+        if (pes_idle_pools.empty())
         {
-            TSPacket *ts = (TSPacket*) it->first;
-            LGO(VB_GENERAL, LOG_DEBUG, QString("PES Packet: pid(0x%1)")
-                .arg(ts->PID(),0,16));
-            if (ts->PID() == 0x1ffb)
-            {
-                LOG(VB_GENERAL, LOG_DEBUG, QString(" tid(0x%1) ext(0x%2)")
-                    .arg(PSIPTable(*ts).TableID(),0,16)
-                    .arg(PSIPTable(*ts).TableIDExtension(),0,16));
-            }
+            pool = new PESSlabPool();
+            pes_pools.push_back(pool);
         }
-#endif
+        else
+        {
+            pool = pes_idle_pools.back();
+            pes_idle_pools.pop_back();
+        }
+    }
 
-    // free the allocator only if more than 1 block was used
-    if (alloc4096.empty() && mem4096.size() > 1)
+    ~PESSlabPoolRef()
     {
-        vector<unsigned char*>::iterator it;
-        for (it = mem4096.begin(); it != mem4096.end(); ++it)
-            free(*it);
-        mem4096.clear();
-        free4096.clear();
-#if 0
-        LOG(VB_GENERAL, LOG_DEBUG, "freeing all 4096 blocks");
-#endif
+        QMutexLocker locker(&pes_pools_lock);
+        pes_idle_pools.push_back(pool);
     }
-}
-#endif
 
-static QMutex pes_alloc_mutex;
+    PESSlabPool *pool;
+};
+
+static QThreadStorage<PESSlabPoolRef*> pes_thread_pool;
+
+static inline PESSlabPool *get_thread_pool(void)
+{
+    if (!pes_thread_pool.hasLocalData())
+        pes_thread_pool.setLocalData(new PESSlabPoolRef());
+    return pes_thread_pool.localData()->pool;
+}
+#endif // USING_VALGRIND
 
 unsigned char *pes_alloc(uint size)
 {
-    QMutexLocker locker(&pes_alloc_mutex);
 #ifndef USING_VALGRIND
     if (size <= 188)
-        return get_188_block();
+        return get_thread_pool()->Alloc(0);
     else if (size <= 4096)
-        return get_4096_block();
-#endif // USING_VALGRIND
+        return get_thread_pool()->Alloc(1);
+
+    PESBlockHeader *hdr = (PESBlockHeader*)
+        malloc(sizeof(PESBlockHeader) + size);
+    hdr->slab = NULL;
+    return reinterpret_cast<unsigned char*>(hdr + 1);
+#else
     return (unsigned char*) malloc(size);
+#endif // USING_VALGRIND
 }
 
 void pes_free(unsigned char *ptr)
 {
-    QMutexLocker locker(&pes_alloc_mutex);
 #ifndef USING_VALGRIND
-    if (is_188_block(ptr))
-        return_188_block(ptr);
-    else if (is_4096_block(ptr))
-        return_4096_block(ptr);
+    if (!ptr)
+        return;
+
+    PESBlockHeader *hdr = block_header(ptr);
+    if (!hdr->slab)
+    {
+        free(hdr);
+        return;
+    }
+
+    PESSlabPool *pool = get_thread_pool();
+    if (hdr->slab->pool == pool)
+        pool->Free(hdr);
     else
+        hdr->slab->pool->RemoteFree(hdr);
+#else
+    free(ptr);
+#endif // USING_VALGRIND
+}
+
+/** \fn pes_alloc_stats(void)
+ *  \brief Returns the combined counters of all the PES block pools.
+ *
+ *  A hit is an allocation served from a pool's free list, a miss is
+ *  one that required a new slab. The high water mark is the sum of
+ *  each pool's maximum number of blocks in use at once.
+ */
+PESAllocStats pes_alloc_stats(void)
+{
+    PESAllocStats stats;
+#ifndef USING_VALGRIND
+    QMutexLocker locker(&pes_pools_lock);
+    for (uint i = 0; i < pes_pools.size(); ++i)
+        pes_pools[i]->AddStats(stats);
 #endif // USING_VALGRIND
-        free(ptr);
+    return stats;
 }
@@ -17,6 +17,20 @@ using namespace std;
 MTV_PUBLIC unsigned char *pes_alloc(uint size);
 MTV_PUBLIC void pes_free(unsigned char *ptr);
 
+class MTV_PUBLIC PESAllocStats
+{
+  public:
+    PESAllocStats() :
+        hits(0), misses(0), in_use(0), high_water(0), pools(0) {}
+
+    uint64_t hits;       ///< allocations served from a free list
+    uint64_t misses;     ///< allocations which needed a new slab
+    uint64_t in_use;     ///< pooled blocks currently allocated
+    uint64_t high_water; ///< sum of the per pool in_use maximums
+    uint     pools;      ///< number of per thread pools
+};
+MTV_PUBLIC PESAllocStats pes_alloc_stats(void);
+
 /** \class PESPacket
  *  \brief Allows us to transform TS packets to PES packets, which
  *         are used to hold multimedia streams and very similar to PSIP tables.
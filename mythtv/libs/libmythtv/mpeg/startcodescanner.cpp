@@ -0,0 +1,139 @@
+// -*- Mode: c++ -*-
+
+#include "startcodescanner.h"
+
+extern "C" {
+#include "mythconfig.h"
+#include "libavutil/cpu.h"
+}
+
+#if ARCH_X86 && HAVE_SSE2 && defined(__GNUC__)
+#define USE_START_CODE_SIMD 1
+#include <immintrin.h>
+#endif
+
+static inline uint32_t read_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+#ifdef USE_START_CODE_SIMD
+/// Returns the first position at or after \p p holding a 00 00 01
+/// prefix whose following byte is before \p end, or NULL if there is
+/// none in the whole 16 byte blocks that fit. \p p is left at the
+/// first position not yet looked at.
+static const uint8_t *scan_sse2(const uint8_t *&p, const uint8_t *end)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one  = _mm_set1_epi8(1);
+
+    // 16 candidates, the last needs 3 more bytes
+    for (; p + 16 + 3 <= end; p += 16)
+    {
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2));
+
+        __m128i hit = _mm_and_si128(
+            _mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)),
+            _mm_cmpeq_epi8(b2, one));
+
+        int mask = _mm_movemask_epi8(hit);
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return NULL;
+}
+
+/// AVX2 version of scan_sse2(), 32 candidates at a time.
+__attribute__((target("avx2")))
+static const uint8_t *scan_avx2(const uint8_t *&p, const uint8_t *end)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one  = _mm256_set1_epi8(1);
+
+    for (; p + 32 + 3 <= end; p += 32)
+    {
+        __m256i b0 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p));
+        __m256i b1 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p + 1));
+        __m256i b2 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p + 2));
+
+        __m256i hit = _mm256_and_si256(
+            _mm256_and_si256(_mm256_cmpeq_epi8(b0, zero),
+                             _mm256_cmpeq_epi8(b1, zero)),
+            _mm256_cmpeq_epi8(b2, one));
+
+        uint32_t mask = _mm256_movemask_epi8(hit);
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return NULL;
+}
+
+static int start_code_cpu_flags = -1;
+
+static inline int get_cpu_flags(void)
+{
+    if (start_code_cpu_flags == -1)
+        start_code_cpu_flags = av_get_cpu_flags();
+    return start_code_cpu_flags;
+}
+#endif // USE_START_CODE_SIMD
+
+const uint8_t *find_start_code(const uint8_t *p, const uint8_t *end,
+                               uint32_t *state, bool useSIMD)
+{
+    if (p >= end)
+        return end;
+
+    // Start codes which began in the previous buffer
+    for (int i = 0; i < 3; i++)
+    {
+        uint32_t tmp = *state << 8;
+        *state = tmp + *(p++);
+        if (tmp == 0x100 || p == end)
+            return p;
+    }
+
+    // Everything from here on lies entirely within [p - 3, end)
+    const uint8_t *q = p - 3;
+
+#ifdef USE_START_CODE_SIMD
+    if (useSIMD)
+    {
+        int flags = get_cpu_flags();
+        const uint8_t *found = NULL;
+        if (flags & AV_CPU_FLAG_AVX2)
+            found = scan_avx2(q, end);
+        if (!found && (flags & AV_CPU_FLAG_SSE2))
+            found = scan_sse2(q, end);
+        if (found)
+        {
+            *state = read_be32(found);
+            return found + 4;
+        }
+    }
+#else
+    (void) useSIMD;
+#endif // USE_START_CODE_SIMD
+
+    // Scalar tail, the same skipping search FFmpeg uses
+    for (p = q + 3; p < end;)
+    {
+        if      (p[-1] > 1      ) p += 3;
+        else if (p[-2]          ) p += 2;
+        else if (p[-3]|(p[-1]-1)) p++;
+        else
+        {
+            p++;
+            *state = read_be32(p - 4);
+            return p;
+        }
+    }
+
+    *state = read_be32(end - 4);
+    return end;
+}
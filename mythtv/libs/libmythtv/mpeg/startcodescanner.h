@@ -0,0 +1,27 @@
+// -*- Mode: c++ -*-
+#ifndef _START_CODE_SCANNER_H_
+#define _START_CODE_SCANNER_H_
+
+#include <stdint.h>
+
+#include "mythtvexp.h"
+
+/** \fn find_start_code(const uint8_t*, const uint8_t*, uint32_t*, bool)
+ *  \brief Finds the next 00 00 01 xx start code in [p, end).
+ *
+ *  This is a drop in replacement for avpriv_find_start_code(), with
+ *  the same contract: \p state holds the last four bytes seen and is
+ *  carried between calls so start codes split across buffers are
+ *  found. On success the returned pointer is just past the byte
+ *  following the start code prefix and \p state is 0x000001xx,
+ *  otherwise \p end is returned.
+ *
+ *  Whole payloads are scanned 16 or 32 bytes at a time with SSE2 or
+ *  AVX2 when the CPU supports it, so NAL unit bodies are skipped
+ *  without looking at every byte in turn.
+ */
+MTV_PUBLIC const uint8_t *find_start_code(
+    const uint8_t *p, const uint8_t *end, uint32_t *state,
+    bool useSIMD = true);
+
+#endif // _START_CODE_SCANNER_H_
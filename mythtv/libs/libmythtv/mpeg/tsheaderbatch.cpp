@@ -0,0 +1,230 @@
+// -*- Mode: c++ -*-
+
+#include <string.h>
+
+#include "tsheaderbatch.h"
+
+extern "C" {
+#include "mythconfig.h"
+#include "libavutil/cpu.h"
+}
+
+#if ARCH_X86 && HAVE_SSE2 && defined(__GNUC__)
+#define USE_TS_BATCH_SIMD 1
+#include <immintrin.h>
+#endif
+
+// The four header bytes read as a little endian 32 bit word:
+//   bits  0- 7  sync byte
+//   bit  15     transport_error_indicator
+//   bit  14     payload_unit_start_indicator
+//   bits  8-12  PID (high), bits 16-23 PID (low)
+//   bits 24-27  continuity_counter
+//   bits 28-29  adaptation_field_control
+//   bit  31     scrambled
+
+static inline uint32_t read_header(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t decode_pid(uint32_t w)
+{
+    return (w & 0x1f00) | ((w >> 16) & 0xff);
+}
+
+static inline uint32_t decode_info(uint32_t w)
+{
+    uint32_t flags = ((w >> 15) & 0x01) | ((w >> 13) & 0x02) |
+                     ((w >> 29) & 0x04) | ((w >> 25) & 0x18);
+    return decode_pid(w) | (flags << 16) | (((w >> 24) & 0xf) << 24);
+}
+
+#ifdef USE_TS_BATCH_SIMD
+static inline uint32_t load32(const unsigned char *p)
+{
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+/// Decodes whole groups of 4 packets, stops at the first group
+/// which is not entirely in sync. \return packets decoded.
+static uint parse_sse2(const unsigned char *buf, uint count,
+                       uint16_t *pids, uint32_t *info)
+{
+    const __m128i sync  = _mm_set1_epi32(SYNC_BYTE);
+    const __m128i m_ff  = _mm_set1_epi32(0xff);
+    const __m128i m_pid = _mm_set1_epi32(0x1f00);
+    const __m128i m_01  = _mm_set1_epi32(0x01);
+    const __m128i m_02  = _mm_set1_epi32(0x02);
+    const __m128i m_04  = _mm_set1_epi32(0x04);
+    const __m128i m_18  = _mm_set1_epi32(0x18);
+    const __m128i m_0f  = _mm_set1_epi32(0x0f);
+
+    uint n = 0;
+    for (; n + 4 <= count; n += 4)
+    {
+        const unsigned char *p = buf + n * TSPacket::kSize;
+        __m128i w = _mm_set_epi32(load32(p + 3 * TSPacket::kSize),
+                                  load32(p + 2 * TSPacket::kSize),
+                                  load32(p + 1 * TSPacket::kSize),
+                                  load32(p));
+
+        __m128i eq = _mm_cmpeq_epi32(_mm_and_si128(w, m_ff), sync);
+        if (_mm_movemask_ps(_mm_castsi128_ps(eq)) != 0xf)
+            break;
+
+        __m128i pid = _mm_or_si128(
+            _mm_and_si128(w, m_pid),
+            _mm_and_si128(_mm_srli_epi32(w, 16), m_ff));
+        __m128i flags = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(_mm_srli_epi32(w, 15), m_01),
+                         _mm_and_si128(_mm_srli_epi32(w, 13), m_02)),
+            _mm_or_si128(_mm_and_si128(_mm_srli_epi32(w, 29), m_04),
+                         _mm_and_si128(_mm_srli_epi32(w, 25), m_18)));
+        __m128i cc = _mm_and_si128(_mm_srli_epi32(w, 24), m_0f);
+
+        __m128i res = _mm_or_si128(
+            pid, _mm_or_si128(_mm_slli_epi32(flags, 16),
+                              _mm_slli_epi32(cc, 24)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(info + n), res);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pids + n),
+                         _mm_packs_epi32(pid, pid));
+    }
+    return n;
+}
+
+/// AVX2 version of parse_sse2(), gathers the headers of 8 packets
+/// at a time.
+__attribute__((target("avx2")))
+static uint parse_avx2(const unsigned char *buf, uint count,
+                       uint16_t *pids, uint32_t *info)
+{
+    const __m256i offs  = _mm256_setr_epi32(
+        0 * 188, 1 * 188, 2 * 188, 3 * 188,
+        4 * 188, 5 * 188, 6 * 188, 7 * 188);
+    const __m256i sync  = _mm256_set1_epi32(SYNC_BYTE);
+    const __m256i m_ff  = _mm256_set1_epi32(0xff);
+    const __m256i m_pid = _mm256_set1_epi32(0x1f00);
+    const __m256i m_01  = _mm256_set1_epi32(0x01);
+    const __m256i m_02  = _mm256_set1_epi32(0x02);
+    const __m256i m_04  = _mm256_set1_epi32(0x04);
+    const __m256i m_18  = _mm256_set1_epi32(0x18);
+    const __m256i m_0f  = _mm256_set1_epi32(0x0f);
+
+    uint n = 0;
+    for (; n + 8 <= count; n += 8)
+    {
+        const unsigned char *p = buf + n * TSPacket::kSize;
+        __m256i w = _mm256_i32gather_epi32(
+            reinterpret_cast<const int*>(p), offs, 1);
+
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_and_si256(w, m_ff), sync);
+        if (_mm256_movemask_ps(_mm256_castsi256_ps(eq)) != 0xff)
+            break;
+
+        __m256i pid = _mm256_or_si256(
+            _mm256_and_si256(w, m_pid),
+            _mm256_and_si256(_mm256_srli_epi32(w, 16), m_ff));
+        __m256i flags = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_and_si256(_mm256_srli_epi32(w, 15), m_01),
+                _mm256_and_si256(_mm256_srli_epi32(w, 13), m_02)),
+            _mm256_or_si256(
+                _mm256_and_si256(_mm256_srli_epi32(w, 29), m_04),
+                _mm256_and_si256(_mm256_srli_epi32(w, 25), m_18)));
+        __m256i cc = _mm256_and_si256(_mm256_srli_epi32(w, 24), m_0f);
+
+        __m256i res = _mm256_or_si256(
+            pid, _mm256_or_si256(_mm256_slli_epi32(flags, 16),
+                                 _mm256_slli_epi32(cc, 24)));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(info + n), res);
+
+        // packs works within 128 bit lanes, put the PIDs back in order
+        __m256i packed = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(pid, pid), 0xd8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pids + n),
+                         _mm256_castsi256_si128(packed));
+    }
+    return n;
+}
+
+static int ts_batch_cpu_flags = -1;
+
+static inline int get_cpu_flags(void)
+{
+    if (ts_batch_cpu_flags == -1)
+        ts_batch_cpu_flags = av_get_cpu_flags();
+    return ts_batch_cpu_flags;
+}
+#endif // USE_TS_BATCH_SIMD
+
+uint TSHeaderBatch::Parse(const unsigned char *buffer, uint len, bool useSIMD)
+{
+    const uint max_pkts = len / TSPacket::kSize;
+
+    m_buffer = buffer;
+    m_pids.resize(max_pkts);
+    m_info.resize(max_pkts);
+
+    if (!max_pkts)
+        return 0;
+
+    uint16_t *pids = &m_pids[0];
+    uint32_t *info = &m_info[0];
+    uint n = 0;
+
+#ifdef USE_TS_BATCH_SIMD
+    if (useSIMD)
+    {
+        int flags = get_cpu_flags();
+        if (flags & AV_CPU_FLAG_AVX2)
+            n = parse_avx2(buffer, max_pkts, pids, info);
+        if (flags & AV_CPU_FLAG_SSE2)
+            n += parse_sse2(buffer + n * TSPacket::kSize, max_pkts - n,
+                            pids + n, info + n);
+    }
+#else
+    (void) useSIMD;
+#endif // USE_TS_BATCH_SIMD
+
+    // Scalar tail, also finds the exact packet that lost sync
+    for (; n < max_pkts; ++n)
+    {
+        const unsigned char *p = buffer + n * TSPacket::kSize;
+        if (p[0] != SYNC_BYTE)
+            break;
+        uint32_t w = read_header(p);
+        pids[n] = decode_pid(w);
+        info[n] = decode_info(w);
+    }
+
+    m_pids.resize(n);
+    m_info.resize(n);
+
+    return n * TSPacket::kSize;
+}
+
+uint TSHeaderBatch::CheckContinuity(unsigned char *last_cc)
+{
+    uint errors = 0;
+    for (uint i = 0; i < m_pids.size(); ++i)
+    {
+        const uint pid = m_pids[i];
+        if (pid == 0x1fff)
+            continue;
+
+        const uint cc   = m_info[i] >> 24;
+        const uint last = last_cc[pid];
+        if ((last != 0xff) && (((last + 1) & 0xf) != cc) && (last != cc))
+        {
+            m_info[i] |= kCCDiscontinuity << 16;
+            errors++;
+        }
+        last_cc[pid] = cc;
+    }
+    return errors;
+}
@@ -0,0 +1,75 @@
+// -*- Mode: c++ -*-
+#ifndef _TS_HEADER_BATCH_H_
+#define _TS_HEADER_BATCH_H_
+
+#include <stdint.h>
+
+#include <vector>
+using namespace std;
+
+#include "tspacket.h"
+#include "mythtvexp.h"
+
+/** \class TSHeaderBatch
+ *  \brief Decoded headers of a run of consecutive in sync TS packets.
+ *
+ *  Parse() validates the sync bytes of a whole run of packets and
+ *  decodes their headers into compact arrays in one pass, using
+ *  SSE2 or AVX2 when the CPU supports it. This lets the hot demux
+ *  loops look at the PID, payload start and continuity counter of
+ *  each packet without going through the TSPacket accessors.
+ *
+ *  \sa TSPacket, MPEGStreamData::ProcessData()
+ */
+class MTV_PUBLIC TSHeaderBatch
+{
+  public:
+    enum
+    {
+        kTransportError  = 0x01,
+        kPayloadStart    = 0x02,
+        kScrambled       = 0x04,
+        kHasPayload      = 0x08,
+        kHasAdaptation   = 0x10,
+        kCCDiscontinuity = 0x20, ///< set by CheckContinuity()
+    };
+
+    TSHeaderBatch() : m_buffer(NULL) {}
+
+    /// Decodes the headers of the packets at the start of \p buffer
+    /// up to the first packet without a sync byte or the end of the
+    /// buffer. \return number of bytes consumed, a multiple of 188.
+    uint Parse(const unsigned char *buffer, uint len, bool useSIMD = true);
+
+    /// Checks the continuity counters of the parsed packets against
+    /// \p last_cc, a 0x2000 entry table indexed by PID holding the last
+    /// counter seen or 0xff, and updates it. Packets which are neither
+    /// the expected next counter nor a repeat are flagged with
+    /// kCCDiscontinuity. \return number of discontinuities found.
+    uint CheckContinuity(unsigned char *last_cc);
+
+    void Clear(void) { m_buffer = NULL; m_pids.clear(); m_info.clear(); }
+    uint Size(void) const { return m_pids.size(); }
+
+    const TSPacket *Packet(uint i) const
+    {
+        return reinterpret_cast<const TSPacket*>(
+            m_buffer + i * TSPacket::kSize);
+    }
+    uint PID(uint i) const { return m_pids[i]; }
+    uint Flags(uint i) const { return (m_info[i] >> 16) & 0xff; }
+    uint ContinuityCounter(uint i) const { return m_info[i] >> 24; }
+    bool PayloadStart(uint i) const { return Flags(i) & kPayloadStart; }
+    bool TransportError(uint i) const { return Flags(i) & kTransportError; }
+
+    const uint16_t *PIDs(void) const
+        { return m_pids.empty() ? NULL : &m_pids[0]; }
+
+  private:
+    const unsigned char *m_buffer;
+    vector<uint16_t>     m_pids;
+    /// pid | flags << 16 | continuity counter << 24
+    vector<uint32_t>     m_info;
+};
+
+#endif // _TS_HEADER_BATCH_H_
@@ -47,30 +47,60 @@ static int has_sse2     = -1;
 static int has_sse3     = -1;
 static int has_ssse3    = -1;
 static int has_sse4     = -1;
+static int has_avx2     = -1;
 
 #if defined _WIN32 && !defined __MINGW32__
 //  Windows
+#include <intrin.h>
 #define cpuid    __cpuid
+#define cpuidex  __cpuidex
+
+static inline unsigned int xgetbv0(void)
+{
+    return (unsigned int)_xgetbv(0);
+}
 
 #else
-inline void cpuid(int CPUInfo[4],int InfoType)
+inline void cpuidex(int CPUInfo[4],int InfoType,int SubLeaf)
 {
-    __asm__ __volatile__ (
-    // pic requires to save ebx/rbx
 #if ARCH_X86_32
+    __asm__ __volatile__ (
+    // pic requires to save ebx
     "push       %%ebx\n"
-#endif
     "cpuid\n"
     "movl %%ebx ,%[ebx]\n"
-#if ARCH_X86_32
     "pop        %%ebx\n"
-#endif
     :"=a" (CPUInfo[0]),
     [ebx] "=r"(CPUInfo[1]),
     "=c" (CPUInfo[2]),
     "=d" (CPUInfo[3])
-    :"a" (InfoType)
+    :"a" (InfoType), "c" (SubLeaf)
+    );
+#else
+    // rbx is callee saved, so it must be an output rather than be
+    // overwritten behind the compiler's back
+    __asm__ __volatile__ (
+    "cpuid\n"
+    :"=a" (CPUInfo[0]),
+    "=b" (CPUInfo[1]),
+    "=c" (CPUInfo[2]),
+    "=d" (CPUInfo[3])
+    :"a" (InfoType), "c" (SubLeaf)
     );
+#endif
+}
+
+inline void cpuid(int CPUInfo[4],int InfoType)
+{
+    cpuidex(CPUInfo, InfoType, 0);
+}
+
+static inline unsigned int xgetbv0(void)
+{
+    unsigned int eax, edx;
+    __asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" // xgetbv
+                          : "=a" (eax), "=d" (edx) : "c" (0));
+    return eax;
 }
 #endif
 
@@ -140,6 +170,33 @@ static inline bool sse4_check()
     return has_sse4;
 }
 
+static inline bool avx2_check()
+{
+    if (has_avx2 != -1)
+    {
+        return has_avx2;
+    }
+
+    has_avx2 = 0;
+
+    int info[4];
+    cpuid(info, 0);
+    if (info[0] < 0x00000007)
+        return has_avx2;
+
+    // The OS must also save the YMM registers on a context switch
+    cpuid(info, 0x00000001);
+    bool osxsave = (info[2] & ((int)1 << 27)) != 0;
+    bool avx     = (info[2] & ((int)1 << 28)) != 0;
+    if (!osxsave || !avx || (xgetbv0() & 0x6) != 0x6)
+        return has_avx2;
+
+    cpuidex(info, 0x00000007, 0);
+    has_avx2 = (info[1] & ((int)1 << 5)) != 0;
+
+    return has_avx2;
+}
+
 static inline void SSE_splitplanes(uint8_t* dstu, int dstu_pitch,
                                    uint8_t* dstv, int dstv_pitch,
                                    const uint8_t* src, int src_pitch,
@@ -286,6 +343,24 @@ static inline void SSE_splitplanes(uint8_t* dstu, int dstu_pitch,
 }
 #endif /* ARCH_X86 */
 
+bool cpu_has_sse2(void)
+{
+#if ARCH_X86
+    return sse2_check();
+#else
+    return false;
+#endif
+}
+
+bool cpu_has_avx2(void)
+{
+#if ARCH_X86
+    return avx2_check();
+#else
+    return false;
+#endif
+}
+
 static inline void copyplane(uint8_t* dst, int dst_pitch,
                              const uint8_t* src, int src_pitch,
                              int width, int height)
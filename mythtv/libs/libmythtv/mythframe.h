@@ -90,6 +90,11 @@ private:
 void MTV_PUBLIC framecopy(VideoFrame *dst, const VideoFrame *src,
                           bool useSSE = true);
 
+/// Returns true if the CPU can run SSE2 instructions.
+bool MTV_PUBLIC cpu_has_sse2(void);
+/// Returns true if the CPU and OS can run AVX2 instructions.
+bool MTV_PUBLIC cpu_has_avx2(void);
+
 static inline void init(VideoFrame *vf, VideoFrameType _codec,
                         unsigned char *_buf, int _width, int _height, int _size,
                         const int *p = 0,
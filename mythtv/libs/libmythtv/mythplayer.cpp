@@ -4628,8 +4628,10 @@ void MythPlayer::SeekForScreenGrab(uint64_t &number, uint64_t frameNum,
         }
     }
 
+    // A preview doesn't need that exact frame, so stop at the keyframe the
+    // seektable puts nearest to it instead of decoding forward from there.
     DiscardVideoFrame(videoOutput->GetLastDecodedFrame());
-    DoJumpToFrame(number, kInaccuracyNone);
+    DoJumpToFrame(number, kInaccuracyFull);
 }
 
 /** \fn MythPlayer::GetRawVideoFrame(long long)
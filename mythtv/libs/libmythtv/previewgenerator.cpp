@@ -35,6 +35,7 @@
 #include "exitcodes.h"
 #include "mythlogging.h"
 #include "mythmiscutil.h"
+#include "mythimage.h"
 
 #define LOC QString("Preview: ")
 
@@ -207,9 +208,15 @@ bool PreviewGenerator::Run(void)
     QTime tm = QTime::currentTime();
     bool ok = false;
     QString command = GetAppBinDir() + "mythpreviewgen";
+    // Decoding in this thread saves starting mythpreviewgen, with its own
+    // database connection and settings, for every single preview. It is
+    // off by default since a crash in a decoder would then take down the
+    // whole backend or frontend rather than just mythpreviewgen.
+    bool in_process =
+        gCoreContext->GetNumSetting("PreviewGeneratorInProcess", 0);
     bool local_ok = ((IsLocal() || !!(m_mode & kForceLocal)) &&
                      (!!(m_mode & kLocal)) &&
-                     QFileInfo(command).isExecutable());
+                     (in_process || QFileInfo(command).isExecutable()));
     if (!local_ok)
     {
         if (!!(m_mode & kRemote))
@@ -231,6 +238,24 @@ bool PreviewGenerator::Run(void)
             msg = "Failed, local preview requested for remote file.";
         }
     }
+    else if (in_process)
+    {
+        ok = LocalPreviewRun();
+        if (ok)
+        {
+            msg = QString("Generated on %1 in %2 seconds, starting at %3")
+                .arg(gCoreContext->GetHostName())
+                .arg(tm.elapsed()*0.001)
+                .arg(tm.toString(Qt::ISODate));
+        }
+        else
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Run() failed to generate preview for: '%1'")
+                    .arg(m_pathname));
+            msg = "Failed to generate preview.";
+        }
+    }
     else
     {
         // This is where we fork and run mythpreviewgen to actually make preview
@@ -585,8 +610,8 @@ bool PreviewGenerator::SavePreview(const QString &filename,
     ppw = max(1.0f, ppw);
     pph = max(1.0f, pph);;
 
-    QImage small_img = img.scaled((int) ppw, (int) pph,
-        Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    QImage small_img =
+        MythImage::SmoothScaled(img, QSize((int) ppw, (int) pph));
 
     QTemporaryFile f(QFileInfo(filename).absoluteFilePath()+".XXXXXX");
     f.setAutoRemove(false);
@@ -47,7 +47,8 @@ PreviewGeneratorQueue::PreviewGeneratorQueue(
     MThread("PreviewGeneratorQueue"),
     m_mode(mode),
     m_running(0), m_maxThreads(2),
-    m_maxAttempts(maxAttempts), m_minBlockSeconds(minBlockSeconds)
+    m_maxAttempts(maxAttempts), m_minBlockSeconds(minBlockSeconds),
+    m_previewCount(0), m_previewTotalMs(0), m_previewMaxMs(0)
 {
     if (PreviewGenerator::kLocal & mode)
     {
@@ -181,6 +182,21 @@ bool PreviewGeneratorQueue::event(QEvent *e)
                 return true;
             }
 
+            if ((*it).requested.isValid())
+            {
+                qint64 ms = (*it).requested.elapsed();
+                m_previewCount++;
+                m_previewTotalMs += ms;
+                m_previewMaxMs = max(m_previewMaxMs, ms);
+                LOG(VB_PLAYBACK, LOG_INFO, LOC +
+                    QString("%1 '%2' after %3 ms, average %4 ms, "
+                            "max %5 ms over %6 previews")
+                        .arg(me->Message()).arg(*kit).arg(ms)
+                        .arg(m_previewTotalMs / m_previewCount)
+                        .arg(m_previewMaxMs).arg(m_previewCount));
+                (*it).requested.invalidate();
+            }
+
             if ((*it).gen)
                 (*it).gen->deleteLater();
             (*it).gen           = NULL;
@@ -505,6 +521,7 @@ void PreviewGeneratorQueue::SetPreviewGenerator(
             g->AttachSignals(this);
             state.gen = g;
             state.genStarted = false;
+            state.requested.start();
             if (!g->GetToken().isEmpty())
                 state.tokens.insert(g->GetToken());
         }
@@ -2,6 +2,7 @@
 #ifndef _PREVIEW_GENERATOR_QUEUE_H_
 #define _PREVIEW_GENERATOR_QUEUE_H_
 
+#include <QElapsedTimer>
 #include <QStringList>
 #include <QDateTime>
 #include <QMutex>
@@ -27,6 +28,8 @@ class PreviewGenState
     uint              lastBlockTime;
     QDateTime         blockRetryUntil;
     QSet<QString>     tokens;
+    /// started when the generator is queued, for the latency log
+    QElapsedTimer     requested;
 };
 typedef QMap<QString,PreviewGenState> PreviewMap;
 
@@ -91,6 +94,9 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
     uint                   m_maxThreads;
     uint                   m_maxAttempts;
     uint                   m_minBlockSeconds;
+    uint                   m_previewCount;
+    qint64                 m_previewTotalMs;
+    qint64                 m_previewMaxMs;
 };
 
 #endif // _PREVIEW_GENERATOR_QUEUE_H_
@@ -13,11 +13,16 @@ using namespace std;
 #include "programdata.h"
 #include "channelutil.h"
 #include "mythdb.h"
+#include "mythcorecontext.h"
+#include "mthreadpool.h"
 #include "mythlogging.h"
 #include "dvbdescriptors.h"
 
 #define LOC      QString("ProgramData: ")
 
+/// Rows written by one multi-row INSERT or REPLACE statement
+static const int kInsertBatchSize = 100;
+
 static const char *roles[] =
 {
     "",
@@ -1329,12 +1334,61 @@ void ProgramData::FixProgramList(QList<ProgInfo*> &fixlist)
     }
 }
 
+/// A channel whose listings are written by HandlePrograms()
+class ProgramDataJob
+{
+  public:
+    ProgramDataJob(uint _chanid, const QList<ProgInfo*> &_sortlist) :
+        chanid(_chanid), sortlist(_sortlist), unchanged(0), updated(0) {}
+
+    uint             chanid;
+    QList<ProgInfo*> sortlist;
+    uint             unchanged;
+    uint             updated;
+};
+
+/** \class ProgramDataWorker
+ *  \brief Writes the listings of channels from a shared job list, taking
+ *         the next unclaimed channel until none are left.
+ *
+ *  Each worker uses its own database connection, so channels are
+ *  diffed and written concurrently.
+ */
+class ProgramDataWorker : public QRunnable
+{
+  public:
+    ProgramDataWorker(vector<ProgramDataJob> &jobs, QAtomicInt &next) :
+        m_jobs(jobs), m_next(next) {}
+
+    void run(void)
+    {
+        MSqlQuery query(MSqlQuery::InitCon());
+        int i;
+        while ((i = m_next.fetchAndAddRelaxed(1)) < (int)m_jobs.size())
+        {
+            ProgramDataJob &job = m_jobs[i];
+            ProgramData::HandlePrograms(query, job.chanid, job.sortlist,
+                                        job.unchanged, job.updated);
+        }
+    }
+
+  private:
+    vector<ProgramDataJob> &m_jobs;
+    QAtomicInt             &m_next;
+};
+
+ProgramData::~ProgramData()
+{
+    delete m_pool;
+}
+
 void ProgramData::HandlePrograms(
     uint sourceid, QMap<QString, QList<ProgInfo> > &proglist)
 {
     uint unchanged = 0, updated = 0;
 
     MSqlQuery query(MSqlQuery::InitCon());
+    vector<ProgramDataJob> jobs;
 
     QMap<QString, QList<ProgInfo> >::const_iterator mapiter;
     for (mapiter = proglist.begin(); mapiter != proglist.end(); ++mapiter)
@@ -1377,35 +1431,88 @@ void ProgramData::HandlePrograms(
         FixProgramList(sortlist);
 
         for (uint i = 0; i < chanids.size(); ++i)
+            jobs.push_back(ProgramDataJob(chanids[i], sortlist));
+    }
+
+    // Channels don't share any rows, so they can be written concurrently.
+    // Most of the time goes into round trips to the database, so a few
+    // more connections than cores still helps.
+    int maxThreads = gCoreContext->GetNumSetting("MythFillDatabaseThreads", 4);
+    int threads = max(1, min(maxThreads, (int)jobs.size()));
+
+    if (threads == 1)
+    {
+        for (uint i = 0; i < jobs.size(); ++i)
         {
-            HandlePrograms(query, chanids[i], sortlist, unchanged, updated);
+            HandlePrograms(query, jobs[i].chanid, jobs[i].sortlist,
+                           jobs[i].unchanged, jobs[i].updated);
         }
     }
+    else
+    {
+        if (!m_pool)
+        {
+            m_pool = new MThreadPool("ProgramData");
+            m_pool->setMaxThreadCount(maxThreads);
+        }
+        QAtomicInt next(0);
+        for (int i = 0; i < threads; ++i)
+            m_pool->start(new ProgramDataWorker(jobs, next), "ProgramData");
+        m_pool->waitForDone();
+    }
+
+    for (uint i = 0; i < jobs.size(); ++i)
+    {
+        unchanged += jobs[i].unchanged;
+        updated   += jobs[i].updated;
+    }
 
     LOG(VB_GENERAL, LOG_INFO,
         QString("Updated programs: %1 Unchanged programs: %2")
                 .arg(updated) .arg(unchanged));
 }
 
+/** \fn ProgramData::HandlePrograms(MSqlQuery&,uint,const QList<ProgInfo*>&,uint&,uint&)
+ *  \brief Writes the listings of one channel.
+ *
+ *  The rows already in the database for the time span of the listings
+ *  are read with one query and compared in memory, and only changed
+ *  programs are written, kInsertBatchSize to a statement.
+ */
 void ProgramData::HandlePrograms(MSqlQuery             &query,
                                  uint                   chanid,
                                  const QList<ProgInfo*> &sortlist,
                                  uint &unchanged,
                                  uint &updated)
 {
+    if (sortlist.empty())
+        return;
+
+    QMap<QDateTime, ProgInfo> existing;
+    GetExistingPrograms(query, chanid, sortlist, existing);
+
+    QList<ProgInfo*> changed;
     QList<ProgInfo*>::const_iterator it = sortlist.begin();
     for (; it != sortlist.end(); ++it)
     {
-        if (IsUnchanged(query, chanid, **it))
+        QMap<QDateTime, ProgInfo>::const_iterator old =
+            existing.find((*it)->starttime);
+        if (old != existing.end() && IsUnchanged(**it, *old))
         {
             unchanged++;
             continue;
         }
+        changed.push_back(*it);
+    }
+
+    for (int i = 0; i < changed.size(); i += kInsertBatchSize)
+    {
+        QList<ProgInfo*> batch = changed.mid(i, kInsertBatchSize);
 
-        if (!DeleteOverlaps(query, chanid, **it))
+        if (!DeleteOverlaps(query, chanid, batch, existing))
             continue;
 
-        updated += (*it)->InsertDB(query, chanid);
+        updated += InsertPrograms(query, chanid, batch);
     }
 }
 
@@ -1469,114 +1576,424 @@ int ProgramData::fix_end_times(void)
     return count;
 }
 
-bool ProgramData::IsUnchanged(
-    MSqlQuery &query, uint chanid, const ProgInfo &pi)
+/// \brief Reads the programs of chanid starting within the time span of
+///        sortlist, keyed by start time.
+bool ProgramData::GetExistingPrograms(
+    MSqlQuery &query, uint chanid, const QList<ProgInfo*> &sortlist,
+    QMap<QDateTime, ProgInfo> &existing)
 {
+    QDateTime from = sortlist.front()->starttime;
+    QDateTime to   = sortlist.front()->starttime;
+    QList<ProgInfo*>::const_iterator it = sortlist.begin();
+    for (; it != sortlist.end(); ++it)
+    {
+        if ((*it)->starttime < from)
+            from = (*it)->starttime;
+        if ((*it)->starttime > to)
+            to = (*it)->starttime;
+        if ((*it)->endtime.isValid() && (*it)->endtime > to)
+            to = (*it)->endtime;
+    }
+
     query.prepare(
-        "SELECT count(*) "
+        "SELECT starttime,       endtime,       title, "
+        "       subtitle,        description,   category, "
+        "       category_type,   airdate+0,     stars, "
+        "       previouslyshown, title_pronounce, "
+        "       audioprop+0,     videoprop+0,   subtitletypes+0, "
+        "       partnumber,      parttotal,     seriesid, "
+        "       showtype,        colorcode,     syndicatedepisodenumber, "
+        "       programid,       inetref "
         "FROM program "
-        "WHERE chanid          = :CHANID     AND "
-        "      starttime       = :START      AND "
-        "      endtime         = :END        AND "
-        "      title           = :TITLE      AND "
-        "      subtitle        = :SUBTITLE   AND "
-        "      description     = :DESC       AND "
-        "      category        = :CATEGORY   AND "
-        "      category_type   = :CATEGORY_TYPE AND "
-        "      airdate         = :AIRDATE    AND "
-        "      stars >= (:STARS1 - 0.001)    AND "
-        "      stars <= (:STARS2 + 0.001)    AND "
-        "      previouslyshown = :PREVIOUSLYSHOWN AND "
-        "      title_pronounce = :TITLE_PRONOUNCE AND "
-        "      audioprop       = :AUDIOPROP  AND "
-        "      videoprop       = :VIDEOPROP  AND "
-        "      subtitletypes   = :SUBTYPES   AND "
-        "      partnumber      = :PARTNUMBER AND "
-        "      parttotal       = :PARTTOTAL  AND "
-        "      seriesid        = :SERIESID   AND "
-        "      showtype        = :SHOWTYPE   AND "
-        "      colorcode       = :COLORCODE  AND "
-        "      syndicatedepisodenumber = :SYNDICATEDEPISODENUMBER AND "
-        "      programid       = :PROGRAMID  AND "
-        "      inetref         = :INETREF");
-
-    QString cattype = myth_category_type_to_string(pi.categoryType);
-
-    query.bindValue(":CHANID",     chanid);
-    query.bindValue(":START",      pi.starttime);
-    query.bindValue(":END",        pi.endtime);
-    query.bindValue(":TITLE",      denullify(pi.title));
-    query.bindValue(":SUBTITLE",   denullify(pi.subtitle));
-    query.bindValue(":DESC",       denullify(pi.description));
-    query.bindValue(":CATEGORY",   denullify(pi.category));
-    query.bindValue(":CATEGORY_TYPE", cattype);
-    query.bindValue(":AIRDATE",    pi.airdate);
-    query.bindValue(":STARS1",     pi.stars);
-    query.bindValue(":STARS2",     pi.stars);
-    query.bindValue(":PREVIOUSLYSHOWN", pi.previouslyshown);
-    query.bindValue(":TITLE_PRONOUNCE", pi.title_pronounce);
-    query.bindValue(":AUDIOPROP",  pi.audioProps);
-    query.bindValue(":VIDEOPROP",  pi.videoProps);
-    query.bindValue(":SUBTYPES",   pi.subtitleType);
-    query.bindValue(":PARTNUMBER", pi.partnumber);
-    query.bindValue(":PARTTOTAL",  pi.parttotal);
-    query.bindValue(":SERIESID",   denullify(pi.seriesId));
-    query.bindValue(":SHOWTYPE",   pi.showtype);
-    query.bindValue(":COLORCODE",  pi.colorcode);
-    query.bindValue(":SYNDICATEDEPISODENUMBER",
-                    denullify(pi.syndicatedepisodenumber));
-    query.bindValue(":PROGRAMID",  denullify(pi.programId));
-    query.bindValue(":INETREF",    pi.inetref);
-
-    if (query.exec() && query.next())
-        return query.value(0).toUInt() > 0;
+        "WHERE chanid     = :CHANID AND "
+        "      starttime >= :FROM   AND "
+        "      starttime <= :TO");
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":FROM",   from);
+    query.bindValue(":TO",     to);
 
-    return false;
+    if (!query.exec())
+    {
+        MythDB::DBError("GetExistingPrograms", query);
+        return false;
+    }
+
+    while (query.next())
+    {
+        QDateTime starttime = MythDate::as_utc(query.value(0).toDateTime());
+        ProgInfo &pi = existing[starttime];
+        pi.starttime               = starttime;
+        pi.endtime                 =
+            MythDate::as_utc(query.value(1).toDateTime());
+        pi.title                   = query.value(2).toString();
+        pi.subtitle                = query.value(3).toString();
+        pi.description             = query.value(4).toString();
+        pi.category                = query.value(5).toString();
+        pi.categoryType            =
+            string_to_myth_category_type(query.value(6).toString());
+        pi.airdate                 = query.value(7).toUInt();
+        pi.stars                   = query.value(8).toFloat();
+        pi.previouslyshown         = query.value(9).toBool();
+        pi.title_pronounce         = query.value(10).toString();
+        pi.audioProps              = query.value(11).toUInt();
+        pi.videoProps              = query.value(12).toUInt();
+        pi.subtitleType            = query.value(13).toUInt();
+        pi.partnumber              = query.value(14).toUInt();
+        pi.parttotal               = query.value(15).toUInt();
+        pi.seriesId                = query.value(16).toString();
+        pi.showtype                = query.value(17).toString();
+        pi.colorcode               = query.value(18).toString();
+        pi.syndicatedepisodenumber = query.value(19).toString();
+        pi.programId               = query.value(20).toString();
+        pi.inetref                 = query.value(21).toString();
+    }
+
+    return true;
 }
 
+/// \brief Returns true if old, read by GetExistingPrograms(), already
+///        holds everything in pi that is compared for a listing.
+bool ProgramData::IsUnchanged(const ProgInfo &pi, const ProgInfo &old)
+{
+    return
+        pi.endtime.isValid()                           &&
+        pi.starttime       == old.starttime            &&
+        pi.endtime         == old.endtime              &&
+        denullify(pi.title)       == denullify(old.title)       &&
+        denullify(pi.subtitle)    == denullify(old.subtitle)    &&
+        denullify(pi.description) == denullify(old.description) &&
+        denullify(pi.category)    == denullify(old.category)    &&
+        pi.categoryType    == old.categoryType         &&
+        pi.airdate         == old.airdate              &&
+        qAbs(pi.stars - old.stars) <= 0.001f           &&
+        pi.previouslyshown == old.previouslyshown      &&
+        denullify(pi.title_pronounce) == denullify(old.title_pronounce) &&
+        pi.audioProps      == old.audioProps           &&
+        pi.videoProps      == old.videoProps           &&
+        pi.subtitleType    == old.subtitleType         &&
+        pi.partnumber      == old.partnumber           &&
+        pi.parttotal       == old.parttotal            &&
+        denullify(pi.seriesId)  == denullify(old.seriesId)  &&
+        denullify(pi.showtype)  == denullify(old.showtype)  &&
+        denullify(pi.colorcode) == denullify(old.colorcode) &&
+        denullify(pi.syndicatedepisodenumber) ==
+            denullify(old.syndicatedepisodenumber)     &&
+        denullify(pi.programId) == denullify(old.programId) &&
+        denullify(pi.inetref)   == denullify(old.inetref);
+}
+
+/// \brief Deletes the programs of chanid starting within any of the
+///        programs in batch, with one statement per table.
 bool ProgramData::DeleteOverlaps(
-    MSqlQuery &query, uint chanid, const ProgInfo &pi)
+    MSqlQuery &query, uint chanid, const QList<ProgInfo*> &batch,
+    const QMap<QDateTime, ProgInfo> &existing)
 {
-    if (VERBOSE_LEVEL_CHECK(VB_XMLTV, LOG_INFO))
+    QString where;
+    MSqlBindings bindings;
+    for (int i = 0; i < batch.size(); ++i)
     {
-        // Get overlaps..
-        query.prepare(
-            "SELECT title,starttime,endtime "
-            "FROM program "
-            "WHERE chanid     = :CHANID AND "
-            "      starttime >= :START AND "
-            "      starttime <  :END;");
-        query.bindValue(":CHANID", chanid);
-        query.bindValue(":START",  pi.starttime);
-        query.bindValue(":END",    pi.endtime);
+        const ProgInfo &pi = *batch[i];
+        if (!pi.endtime.isValid())
+            continue;
 
-        if (!query.exec())
-            return false;
+        if (VERBOSE_LEVEL_CHECK(VB_XMLTV, LOG_INFO))
+        {
+            QMap<QDateTime, ProgInfo>::const_iterator old =
+                existing.lowerBound(pi.starttime);
+            for (; old != existing.end() && old.key() < pi.endtime; ++old)
+            {
+                LOG(VB_XMLTV, LOG_INFO,
+                    QString("Removing existing program: %1 - %2 %3 %4")
+                    .arg(old->starttime.toString(Qt::ISODate))
+                    .arg(old->endtime.toString(Qt::ISODate))
+                    .arg(pi.channel)
+                    .arg(old->title));
+            }
+        }
+
+        QString from = QString(":FROM%1").arg(i);
+        QString to   = QString(":TO%1").arg(i);
+        if (!where.isEmpty())
+            where += " OR ";
+        where += QString("(starttime >= %1 AND starttime < %2)")
+            .arg(from).arg(to);
+        bindings[from] = pi.starttime;
+        bindings[to]   = pi.endtime;
+    }
+
+    if (where.isEmpty())
+        return true;
 
-        if (!query.next())
-            return true;
+    static const char *tables[] =
+        { "program", "programrating", "credits", "programgenres" };
 
-        do
+    bool ok = true;
+    for (uint i = 0; i < sizeof(tables) / sizeof(char *); ++i)
+    {
+        query.prepare(QString("DELETE FROM %1 "
+                              "WHERE chanid = :CHANID AND (%2)")
+                      .arg(tables[i]).arg(where));
+        query.bindValue(":CHANID", chanid);
+        query.bindValues(bindings);
+        if (!query.exec())
         {
-            LOG(VB_XMLTV, LOG_INFO,
-                QString("Removing existing program: %1 - %2 %3 %4")
-                .arg(MythDate::as_utc(query.value(1).toDateTime()).toString(Qt::ISODate))
-                .arg(MythDate::as_utc(query.value(2).toDateTime()).toString(Qt::ISODate))
-                .arg(pi.channel)
-                .arg(query.value(0).toString()));
-        } while (query.next());
+            MythDB::DBError("DeleteOverlaps", query);
+            ok = false;
+        }
     }
 
-    if (!ClearDataByChannel(chanid, pi.starttime, pi.endtime, false))
+    if (!ok)
     {
         LOG(VB_XMLTV, LOG_ERR,
-            QString("Program delete failed    : %1 - %2 %3 %4")
+            QString("Program delete failed    : %1 - %2 %3")
+                .arg(batch.front()->starttime.toString(Qt::ISODate))
+                .arg(batch.back()->endtime.toString(Qt::ISODate))
+                .arg(batch.front()->channel));
+    }
+
+    return ok;
+}
+
+/// \brief Runs "head VALUES (...), (...)" for rows, kInsertBatchSize
+///        rows to a statement, and returns the number of rows written.
+static uint insert_rows(MSqlQuery &query, const QString &head,
+                        const QList<QVariantList> &rows, const char *what)
+{
+    uint written = 0;
+    for (int first = 0; first < rows.size(); first += kInsertBatchSize)
+    {
+        int last = min(first + kInsertBatchSize, rows.size());
+
+        QString sql = head + " VALUES ";
+        for (int r = first; r < last; ++r)
+        {
+            sql += (r == first) ? "(" : ", (";
+            for (int c = 0; c < rows[r].size(); ++c)
+            {
+                sql += QString(c ? ", :V%1_%2" : ":V%1_%2")
+                    .arg(r - first).arg(c);
+            }
+            sql += ")";
+        }
+
+        query.prepare(sql);
+        for (int r = first; r < last; ++r)
+        {
+            for (int c = 0; c < rows[r].size(); ++c)
+            {
+                query.bindValue(QString(":V%1_%2").arg(r - first).arg(c),
+                                rows[r][c]);
+            }
+        }
+
+        if (!query.exec())
+        {
+            MythDB::DBError(what, query);
+            continue;
+        }
+
+        written += last - first;
+    }
+    return written;
+}
+
+/// \brief Writes the programs in batch with their ratings and credits,
+///        and returns the number of programs written.
+uint ProgramData::InsertPrograms(
+    MSqlQuery &query, uint chanid, const QList<ProgInfo*> &batch)
+{
+    QList<QVariantList> rows;
+    QList<QVariantList> ratings;
+    for (int i = 0; i < batch.size(); ++i)
+    {
+        const ProgInfo &pi = *batch[i];
+
+        LOG(VB_XMLTV, LOG_INFO,
+            QString("Inserting new program    : %1 - %2 %3 %4")
                 .arg(pi.starttime.toString(Qt::ISODate))
                 .arg(pi.endtime.toString(Qt::ISODate))
                 .arg(pi.channel)
                 .arg(pi.title));
-        return false;
+
+        QVariantList row;
+        row << chanid
+            << denullify(pi.title)
+            << denullify(pi.subtitle)
+            << denullify(pi.description)
+            << denullify(pi.category)
+            << myth_category_type_to_string(pi.categoryType)
+            << pi.starttime
+            << denullify(pi.endtime)
+            << ((pi.subtitleType & SUB_HARDHEAR) ? true : false)
+            << ((pi.audioProps   & AUD_STEREO)   ? true : false)
+            << ((pi.videoProps   & VID_HDTV)     ? true : false)
+            << ((pi.subtitleType & SUB_NORMAL)   ? true : false)
+            << pi.subtitleType
+            << pi.audioProps
+            << pi.videoProps
+            << pi.partnumber
+            << pi.parttotal
+            << denullify(pi.syndicatedepisodenumber)
+            << (pi.airdate ? QString::number(pi.airdate) : "0000")
+            << pi.originalairdate
+            << pi.listingsource
+            << denullify(pi.seriesId)
+            << denullify(pi.programId)
+            << pi.previouslyshown
+            << pi.stars
+            << pi.showtype
+            << pi.title_pronounce
+            << pi.colorcode
+            << pi.season
+            << pi.episode
+            << pi.totalepisodes
+            << pi.inetref;
+        rows.push_back(row);
+
+        QList<EventRating>::const_iterator j = pi.ratings.begin();
+        for (; j != pi.ratings.end(); ++j)
+        {
+            QVariantList rating;
+            rating << chanid << pi.starttime << (*j).system << (*j).rating;
+            ratings.push_back(rating);
+        }
     }
 
-    return true;
+    uint written = insert_rows(query,
+        "REPLACE INTO program ("
+        "  chanid,         title,          subtitle,        description, "
+        "  category,       category_type,  "
+        "  starttime,      endtime, "
+        "  closecaptioned, stereo,         hdtv,            subtitled, "
+        "  subtitletypes,  audioprop,      videoprop, "
+        "  partnumber,     parttotal, "
+        "  syndicatedepisodenumber, "
+        "  airdate,        originalairdate,listingsource, "
+        "  seriesid,       programid,      previouslyshown, "
+        "  stars,          showtype,       title_pronounce, colorcode, "
+        "  season,         episode,        totalepisodes, "
+        "  inetref )", rows, "program insert");
+
+    // A failed statement loses all of its programs, don't attach
+    // ratings and credits to rows which may not be there.
+    if (written != (uint)rows.size())
+        return written;
+
+    insert_rows(query,
+                "INSERT INTO programrating "
+                "       ( chanid, starttime, system, rating)",
+                ratings, "programrating insert");
+
+    InsertCredits(query, chanid, batch);
+
+    return written;
+}
+
+/// \brief Writes the credits of the programs in batch, looking up and
+///        adding all the people with a few statements.
+void ProgramData::InsertCredits(
+    MSqlQuery &query, uint chanid, const QList<ProgInfo*> &batch)
+{
+    QMap<QString, uint> people;
+    for (int i = 0; i < batch.size(); ++i)
+    {
+        if (!batch[i]->credits)
+            continue;
+        for (uint j = 0; j < batch[i]->credits->size(); ++j)
+            people[(*batch[i]->credits)[j].GetName()] = 0;
+    }
+
+    if (people.empty())
+        return;
+
+    GetPeople(query, people);
+
+    QList<QVariantList> rows;
+    QMap<QString, uint>::const_iterator it = people.begin();
+    for (; it != people.end(); ++it)
+    {
+        if (!*it)
+        {
+            QVariantList row;
+            row << it.key();
+            rows.push_back(row);
+        }
+    }
+
+    if (!rows.empty())
+    {
+        insert_rows(query, "INSERT IGNORE INTO people (name)",
+                    rows, "insert_person");
+        GetPeople(query, people);
+        rows.clear();
+    }
+
+    for (int i = 0; i < batch.size(); ++i)
+    {
+        const ProgInfo &pi = *batch[i];
+        if (!pi.credits)
+            continue;
+
+        for (uint j = 0; j < pi.credits->size(); ++j)
+        {
+            const DBPerson &person = (*pi.credits)[j];
+            uint personid = people.value(person.GetName());
+            if (!personid)
+            {
+                // The database collation matched this name to someone
+                // spelled differently, leave it to the database.
+                person.InsertDB(query, chanid, pi.starttime);
+                continue;
+            }
+
+            QVariantList row;
+            row << personid << chanid << pi.starttime << person.GetRole();
+            rows.push_back(row);
+        }
+    }
+
+    insert_rows(query,
+                "REPLACE INTO credits "
+                "       ( person,  chanid,  starttime,  role)",
+                rows, "insert_credits");
+}
+
+/// \brief Fills in the ids of the people in the map which don't have one.
+void ProgramData::GetPeople(MSqlQuery &query, QMap<QString, uint> &people)
+{
+    QStringList names;
+    QMap<QString, uint>::const_iterator it = people.begin();
+    for (; it != people.end(); ++it)
+    {
+        if (!*it)
+            names.push_back(it.key());
+    }
+
+    for (int first = 0; first < names.size(); first += kInsertBatchSize)
+    {
+        int last = min(first + kInsertBatchSize, names.size());
+
+        QString sql = "SELECT person, name FROM people WHERE name IN (";
+        for (int i = first; i < last; ++i)
+            sql += QString(i == first ? ":NAME%1" : ", :NAME%1").arg(i - first);
+        sql += ")";
+
+        query.prepare(sql);
+        for (int i = first; i < last; ++i)
+            query.bindValue(QString(":NAME%1").arg(i - first), names[i]);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("get_person", query);
+            continue;
+        }
+
+        while (query.next())
+        {
+            QMap<QString, uint>::iterator person =
+                people.find(query.value(1).toString());
+            if (person != people.end())
+                *person = query.value(0).toUInt();
+        }
+    }
 }
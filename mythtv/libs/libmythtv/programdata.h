@@ -21,6 +21,7 @@ using namespace std;
 #include "eithelper.h" /* for FixupValue */
 
 class MSqlQuery;
+class MThreadPool;
 
 class MTV_PUBLIC DBPerson
 {
@@ -46,6 +47,7 @@ class MTV_PUBLIC DBPerson
     DBPerson(const QString &_role, const QString &_name);
 
     QString GetRole(void) const;
+    QString GetName(void) const { return name; }
 
     uint InsertDB(MSqlQuery &query, uint chanid,
                   const QDateTime &starttime) const;
@@ -274,8 +276,11 @@ class MTV_PUBLIC ProgInfo : public DBEvent
 class MTV_PUBLIC ProgramData
 {
   public:
-    static void HandlePrograms(uint sourceid,
-                               QMap<QString, QList<ProgInfo> > &proglist);
+    ProgramData() : m_pool(NULL) {}
+   ~ProgramData();
+
+    void HandlePrograms(uint sourceid,
+                        QMap<QString, QList<ProgInfo> > &proglist);
 
     static int  fix_end_times(void);
     static bool ClearDataByChannel(
@@ -290,15 +295,30 @@ class MTV_PUBLIC ProgramData
         bool use_channel_time_offset);
 
   private:
+    Q_DISABLE_COPY(ProgramData)
+    friend class ProgramDataWorker;
+
     static void FixProgramList(QList<ProgInfo*> &fixlist);
     static void HandlePrograms(
         MSqlQuery &query, uint chanid,
         const QList<ProgInfo*> &sortlist,
         uint &unchanged, uint &updated);
-    static bool IsUnchanged(
-        MSqlQuery &query, uint chanid, const ProgInfo &pi);
+    static bool GetExistingPrograms(
+        MSqlQuery &query, uint chanid, const QList<ProgInfo*> &sortlist,
+        QMap<QDateTime, ProgInfo> &existing);
+    static bool IsUnchanged(const ProgInfo &pi, const ProgInfo &old);
     static bool DeleteOverlaps(
-        MSqlQuery &query, uint chanid, const ProgInfo &pi);
+        MSqlQuery &query, uint chanid, const QList<ProgInfo*> &batch,
+        const QMap<QDateTime, ProgInfo> &existing);
+    static uint InsertPrograms(
+        MSqlQuery &query, uint chanid, const QList<ProgInfo*> &batch);
+    static void InsertCredits(
+        MSqlQuery &query, uint chanid, const QList<ProgInfo*> &batch);
+    static void GetPeople(MSqlQuery &query, QMap<QString, uint> &people);
+
+    /// Writes channels concurrently.  It is kept for all the batches of
+    /// an import, so its threads keep their database connections.
+    MThreadPool *m_pool;
 };
 
 #endif // _PROGRAMDATA_H_
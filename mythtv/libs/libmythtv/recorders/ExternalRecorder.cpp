@@ -204,6 +204,7 @@ bool ExternalRecorder::PauseAndWait(int timeout)
 bool ExternalRecorder::StartStreaming(void)
 {
     m_h264_parser.Reset();
+    m_hevc_parser.Reset();
     _wait_for_keyframe_option = true;
     _seen_sps = false;
 
@@ -643,11 +643,9 @@ void ExternalStreamHandler::run(void)
                 xon = false;
             }
 
-            StreamDataList::const_iterator sit = _stream_data_list.begin();
-            for (; sit != _stream_data_list.end(); ++sit)
-                remainder = sit.key()->ProcessData
-                            (reinterpret_cast<const uint8_t *>
-                             (buffer.constData()), buffer.size());
+            remainder = ProcessDataForListeners
+                        (reinterpret_cast<const uint8_t *>
+                         (buffer.constData()), buffer.size());
 
             _listener_lock.unlock();
 
@@ -854,11 +852,9 @@ bool ExternalStreamHandler::StartStreaming(bool flush_buffer)
 
         if (!_stream_data_list.empty())
         {
-            StreamDataList::const_iterator sit = _stream_data_list.begin();
-            for (; sit != _stream_data_list.end(); ++sit)
-                sit.key()->ProcessData(reinterpret_cast<const uint8_t *>
-                                       (m_replay_buffer.constData()),
-                                       m_replay_buffer.size());
+            ProcessDataForListeners(reinterpret_cast<const uint8_t *>
+                                    (m_replay_buffer.constData()),
+                                    m_replay_buffer.size());
         }
         LOG(VB_RECORD, LOG_INFO, LOC + QString("Replayed %1 bytes")
             .arg(m_replay_buffer.size()));
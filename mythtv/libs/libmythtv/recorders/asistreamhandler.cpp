@@ -226,9 +226,7 @@ void ASIStreamHandler::run(void)
             continue;
         }
 
-        StreamDataList::const_iterator sit = _stream_data_list.begin();
-        for (; sit != _stream_data_list.end(); ++sit)
-            remainder = sit.key()->ProcessData(buffer, len);
+        remainder = ProcessDataForListeners(buffer, len);
 
         WriteMPTS(buffer, len - remainder);
 
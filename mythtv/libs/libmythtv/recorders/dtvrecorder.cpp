@@ -827,6 +827,80 @@ void DTVRecorder::HandleKeyframe(int64_t extra)
     positionMapLock.unlock();
 }
 
+/** \fn DTVRecorder::FindPESPayload(const TSPacket*)
+ *  \brief Syncs to the PES header of a video TS packet.
+ *
+ *  On a payload unit start this skips the PES header, so that only
+ *  elementary stream bytes are handed to the H.264/H.265 parsers.
+ *  \return offset of the first elementary stream byte in the packet,
+ *          or TSPacket::kSize if there is nothing to scan.
+ */
+uint DTVRecorder::FindPESPayload(const TSPacket *tspacket)
+{
+    uint i = tspacket->AFCOffset();
+
+    if (!tspacket->PayloadStart())
+        return _pes_synced ? i : TSPacket::kSize;
+
+    // reset PES sync state
+    _pes_synced = false;
+    _start_code = 0xffffffff;
+
+    // bounds check
+    if (i + 2 >= TSPacket::kSize)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "PES packet start code may overflow to next TS packet, "
+            "aborting keyframe search");
+        return TSPacket::kSize;
+    }
+
+    // must find the PES start code
+    if (tspacket->data()[i++] != 0x00 ||
+        tspacket->data()[i++] != 0x00 ||
+        tspacket->data()[i++] != 0x01)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "PES start code not found in TS packet with PUSI set");
+        return TSPacket::kSize;
+    }
+
+    // bounds check
+    if (i + 5 >= TSPacket::kSize)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "PES packet headers overflow to next TS packet, "
+            "aborting keyframe search");
+        return TSPacket::kSize;
+    }
+
+    // now we need to compute where the PES payload begins
+    // skip past the stream_id (+1)
+    // the next two bytes are the PES packet length (+2)
+    // after that, one byte of PES packet control bits (+1)
+    // after that, one byte of PES header flags bits (+1)
+    // and finally, one byte for the PES header length
+    const unsigned char pes_header_length = tspacket->data()[i + 5];
+
+    // bounds check
+    if ((i + 6 + pes_header_length) >= TSPacket::kSize)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "PES packet headers overflow to next TS packet, "
+            "aborting keyframe search");
+        return TSPacket::kSize;
+    }
+
+    // we now know where the PES payload is
+    _pes_synced = true;
+
+#if 0
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "PES synced");
+#endif
+
+    return i + 6 + pes_header_length;
+}
+
 /** \fn DTVRecorder::FindH264Keyframes(const TSPacket*)
  *  \brief This searches the TS packet to identify keyframes.
  *  \param TSPacket Pointer the the TS packet data.
@@ -843,14 +917,6 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
         return _first_keyframe >= 0;
     }
 
-    const bool payloadStart = tspacket->PayloadStart();
-    if (payloadStart)
-    {
-        // reset PES sync state
-        _pes_synced = false;
-        _start_code = 0xffffffff;
-    }
-
     uint aspectRatio = 0;
     uint height = 0;
     uint width = 0;
@@ -859,98 +925,149 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
     bool hasFrame = false;
     bool hasKeyFrame = false;
 
-    // scan for PES packets and H.264 NAL units
-    uint i = tspacket->AFCOffset();
-    for (; i < TSPacket::kSize; ++i)
+    // scan for H.264 NAL units, the parser skips
+    // straight from one start code to the next
+    for (uint i = FindPESPayload(tspacket); i < TSPacket::kSize; ++i)
     {
-        // special handling required when a new PES packet begins
-        if (payloadStart && !_pes_synced)
+        uint32_t bytes_used = m_h264_parser.addBytes
+                              (tspacket->data() + i, TSPacket::kSize - i,
+                               ringBuffer->GetWritePosition());
+        i += (bytes_used - 1);
+
+        if (m_h264_parser.stateChanged())
         {
-            // bounds check
-            if (i + 2 >= TSPacket::kSize)
+            if (m_h264_parser.onFrameStart() &&
+                m_h264_parser.FieldType() != H264Parser::FIELD_BOTTOM)
             {
-                LOG(VB_GENERAL, LOG_ERR, LOC +
-                    "PES packet start code may overflow to next TS packet, "
-                    "aborting keyframe search");
-                break;
-            }
+                hasKeyFrame = m_h264_parser.onKeyFrameStart();
+                hasFrame = true;
+                _seen_sps |= hasKeyFrame;
 
-            // must find the PES start code
-            if (tspacket->data()[i++] != 0x00 ||
-                tspacket->data()[i++] != 0x00 ||
-                tspacket->data()[i++] != 0x01)
-            {
-                LOG(VB_GENERAL, LOG_ERR, LOC +
-                    "PES start code not found in TS packet with PUSI set");
-                break;
+                width = m_h264_parser.pictureWidth();
+                height = m_h264_parser.pictureHeight();
+                aspectRatio = m_h264_parser.aspectRatio();
+                m_h264_parser.getFrameRate(frameRate);
             }
+        }
+    }
 
-            // bounds check
-            if (i + 5 >= TSPacket::kSize)
-            {
-                LOG(VB_GENERAL, LOG_ERR, LOC +
-                    "PES packet headers overflow to next TS packet, "
-                    "aborting keyframe search");
-                break;
-            }
+    HandleNALFrame(hasFrame, hasKeyFrame,
+                   m_h264_parser.keyframeAUstreamOffset());
 
-            // now we need to compute where the PES payload begins
-            // skip past the stream_id (+1)
-            // the next two bytes are the PES packet length (+2)
-            // after that, one byte of PES packet control bits (+1)
-            // after that, one byte of PES header flags bits (+1)
-            // and finally, one byte for the PES header length
-            const unsigned char pes_header_length = tspacket->data()[i + 5];
+    if ((aspectRatio > 0) && (aspectRatio != m_videoAspect))
+    {
+        m_videoAspect = aspectRatio;
+        AspectChange((AspectRatio)aspectRatio, _frames_written_count);
+    }
 
-            // bounds check
-            if ((i + 6 + pes_header_length) >= TSPacket::kSize)
-            {
-                LOG(VB_GENERAL, LOG_ERR, LOC +
-                    "PES packet headers overflow to next TS packet, "
-                    "aborting keyframe search");
-                break;
-            }
+    if (height && width && (height != m_videoHeight || m_videoWidth != width))
+    {
+        m_videoHeight = height;
+        m_videoWidth = width;
+        ResolutionChange(width, height, _frames_written_count);
+    }
 
-            // we now know where the PES payload is
-            // normally, we should have used 6, but use 5 because the for
-            // loop will bump i
-            i += 5 + pes_header_length;
-            _pes_synced = true;
+    if (frameRate.isNonzero() && frameRate != m_frameRate)
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("FindH264Keyframes: timescale: %1, tick: %2, framerate: %3")
+                      .arg( m_h264_parser.GetTimeScale() )
+                      .arg( m_h264_parser.GetUnitsInTick() )
+                      .arg( frameRate.toDouble() * 1000 ) );
+        m_frameRate = frameRate;
+        FrameRateChange(frameRate.toDouble() * 1000, _frames_written_count);
+    }
 
-#if 0
-            LOG(VB_RECORD, LOG_DEBUG, LOC + "PES synced");
-#endif
-            continue;
-        }
+    return _seen_sps;
+}
 
-        // ain't going nowhere if we're not PES synced
-        if (!_pes_synced)
-            break;
+/** \fn DTVRecorder::FindHEVCKeyframes(const TSPacket*)
+ *  \brief This searches the TS packet to identify H.265 keyframes.
+ *
+ *  Every IRAP picture (IDR, CRA and BLA) is treated as a keyframe.
+ *  \param TSPacket Pointer the the TS packet data.
+ *  \return Returns true if a keyframe has been found.
+ */
+bool DTVRecorder::FindHEVCKeyframes(const TSPacket *tspacket)
+{
+    if (!tspacket->HasPayload()) // no payload to scan
+        return _first_keyframe >= 0;
 
-        // scan for a NAL unit start code
+    if (!ringBuffer)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "FindHEVCKeyframes: No ringbuffer");
+        return _first_keyframe >= 0;
+    }
 
-        uint32_t bytes_used = m_h264_parser.addBytes
+    uint aspectRatio = 0;
+    uint height = 0;
+    uint width = 0;
+    FrameRate frameRate(0);
+
+    bool hasFrame = false;
+    bool hasKeyFrame = false;
+
+    for (uint i = FindPESPayload(tspacket); i < TSPacket::kSize; ++i)
+    {
+        uint32_t bytes_used = m_hevc_parser.addBytes
                               (tspacket->data() + i, TSPacket::kSize - i,
                                ringBuffer->GetWritePosition());
         i += (bytes_used - 1);
 
-        if (m_h264_parser.stateChanged())
+        if (m_hevc_parser.stateChanged())
         {
-            if (m_h264_parser.onFrameStart() &&
-                m_h264_parser.FieldType() != H264Parser::FIELD_BOTTOM)
+            if (m_hevc_parser.onFrameStart() &&
+                m_hevc_parser.FieldType() != HEVCParser::FIELD_BOTTOM)
             {
-                hasKeyFrame = m_h264_parser.onKeyFrameStart();
+                hasKeyFrame = m_hevc_parser.onKeyFrameStart();
                 hasFrame = true;
                 _seen_sps |= hasKeyFrame;
 
-                width = m_h264_parser.pictureWidth();
-                height = m_h264_parser.pictureHeight();
-                aspectRatio = m_h264_parser.aspectRatio();
-                m_h264_parser.getFrameRate(frameRate);
+                width = m_hevc_parser.pictureWidthCropped();
+                height = m_hevc_parser.pictureHeightCropped();
+                aspectRatio = m_hevc_parser.aspectRatio();
+                m_hevc_parser.getFrameRate(frameRate);
             }
         }
-    } // for (; i < TSPacket::kSize; ++i)
+    }
+
+    HandleNALFrame(hasFrame, hasKeyFrame,
+                   m_hevc_parser.keyframeAUstreamOffset());
+
+    if ((aspectRatio > 0) && (aspectRatio != m_videoAspect))
+    {
+        m_videoAspect = aspectRatio;
+        AspectChange((AspectRatio)aspectRatio, _frames_written_count);
+    }
+
+    if (height && width && (height != m_videoHeight || m_videoWidth != width))
+    {
+        m_videoHeight = height;
+        m_videoWidth = width;
+        ResolutionChange(width, height, _frames_written_count);
+    }
 
+    if (frameRate.isNonzero() && frameRate != m_frameRate)
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("FindHEVCKeyframes: timescale: %1, tick: %2, framerate: %3")
+                      .arg( m_hevc_parser.GetTimeScale() )
+                      .arg( m_hevc_parser.GetUnitsInTick() )
+                      .arg( frameRate.toDouble() * 1000 ) );
+        m_frameRate = frameRate;
+        FrameRateChange(frameRate.toDouble() * 1000, _frames_written_count);
+    }
+
+    return _seen_sps;
+}
+
+/** \fn DTVRecorder::HandleNALFrame(bool, bool, uint64_t)
+ *  \brief Counts the frames found by the H.264/H.265 parsers and adds
+ *         their keyframes to the seektable.
+ */
+void DTVRecorder::HandleNALFrame(bool hasFrame, bool hasKeyFrame,
+                                 uint64_t keyframeOffset)
+{
     // If it has been more than 511 frames since the last keyframe,
     // pretend we have one.
     if (hasFrame && !hasKeyFrame &&
@@ -958,7 +1075,7 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
     {
         hasKeyFrame = true;
         LOG(VB_RECORD, LOG_WARNING, LOC +
-            QString("FindH264Keyframes: %1 frames without a keyframe.")
+            QString("HandleNALFrame: %1 frames without a keyframe.")
             .arg(_frames_seen_count - _last_keyframe_seen));
     }
 
@@ -970,10 +1087,10 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
             .arg(ringBuffer->GetWritePosition())
             .arg(_payload_buffer.size())
             .arg(ringBuffer->GetWritePosition() + _payload_buffer.size())
-            .arg(m_h264_parser.keyframeAUstreamOffset()));
+            .arg(keyframeOffset));
 
         _last_keyframe_seen = _frames_seen_count;
-        HandleH264Keyframe();
+        HandleNALKeyframe(keyframeOffset);
     }
 
     if (hasFrame)
@@ -983,7 +1100,7 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
             .arg(ringBuffer->GetWritePosition())
             .arg(_payload_buffer.size())
             .arg(ringBuffer->GetWritePosition() + _payload_buffer.size())
-            .arg(m_h264_parser.keyframeAUstreamOffset()));
+            .arg(keyframeOffset));
 
         _buffer_packets = false;  // We now know if this is a keyframe
         _frames_seen_count++;
@@ -996,39 +1113,14 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
             _payload_buffer.clear();
         }
     }
-
-    if ((aspectRatio > 0) && (aspectRatio != m_videoAspect))
-    {
-        m_videoAspect = aspectRatio;
-        AspectChange((AspectRatio)aspectRatio, _frames_written_count);
-    }
-
-    if (height && width && (height != m_videoHeight || m_videoWidth != width))
-    {
-        m_videoHeight = height;
-        m_videoWidth = width;
-        ResolutionChange(width, height, _frames_written_count);
-    }
-
-    if (frameRate.isNonzero() && frameRate != m_frameRate)
-    {
-        LOG(VB_RECORD, LOG_INFO, LOC +
-            QString("FindH264Keyframes: timescale: %1, tick: %2, framerate: %3")
-                      .arg( m_h264_parser.GetTimeScale() )
-                      .arg( m_h264_parser.GetUnitsInTick() )
-                      .arg( frameRate.toDouble() * 1000 ) );
-        m_frameRate = frameRate;
-        FrameRateChange(frameRate.toDouble() * 1000, _frames_written_count);
-    }
-
-    return _seen_sps;
 }
 
-/** \fn DTVRecorder::HandleH264Keyframe(void)
+/** \fn DTVRecorder::HandleNALKeyframe(uint64_t)
  *  \brief This save the current frame to the position maps
  *         and handles ringbuffer switching.
+ *  \param keyframeOffset Stream offset of the keyframe's access unit.
  */
-void DTVRecorder::HandleH264Keyframe(void)
+void DTVRecorder::HandleNALKeyframe(uint64_t keyframeOffset)
 {
     // Perform ringbuffer switch if needed.
     CheckForRingBufferSwitch();
@@ -1043,7 +1135,7 @@ void DTVRecorder::HandleH264Keyframe(void)
         SendMythSystemRecEvent("REC_STARTED_WRITING", curRecording);
     }
     else
-        startpos = m_h264_parser.keyframeAUstreamOffset();
+        startpos = keyframeOffset;
 
     // Add key frame to position map
     positionMapLock.lock();
@@ -1513,6 +1605,8 @@ bool DTVRecorder::ProcessVideoTSPacket(const TSPacket &tspacket)
     // Check for keyframes and count frames
     if (streamType == StreamID::H264Video)
         FindH264Keyframes(&tspacket);
+    else if (streamType == StreamID::H265Video)
+        FindHEVCKeyframes(&tspacket);
     else if (streamType != 0)
         FindMPEG2Keyframes(&tspacket);
     else
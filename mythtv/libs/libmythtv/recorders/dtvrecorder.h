@@ -19,6 +19,7 @@ using namespace std;
 #include "streamlisteners.h"
 #include "recorderbase.h"
 #include "H264Parser.h"
+#include "HEVCParser.h"
 
 class MPEGStreamData;
 class TSPacket;
@@ -108,9 +109,13 @@ class DTVRecorder :
     // MPEG2 TS support
     bool FindMPEG2Keyframes(const TSPacket* tspacket);
 
-    // MPEG4 AVC / H.264 TS support
+    // MPEG4 AVC / H.264 and HEVC / H.265 TS support
+    uint FindPESPayload(const TSPacket* tspacket);
     bool FindH264Keyframes(const TSPacket* tspacket);
-    void HandleH264Keyframe(void);
+    bool FindHEVCKeyframes(const TSPacket* tspacket);
+    void HandleNALFrame(bool hasFrame, bool hasKeyFrame,
+                        uint64_t keyframeOffset);
+    void HandleNALKeyframe(uint64_t keyframeOffset);
 
     // MPEG2 PS support (Hauppauge PVR-x50/PVR-500)
     virtual void FindPSKeyFrames(const uint8_t *buffer, uint len);
@@ -144,10 +149,11 @@ class DTVRecorder :
     int _progressive_sequence;
     int _repeat_pict;
 
-    // H.264 support
+    // H.264 and H.265 support
     bool _pes_synced;
     bool _seen_sps;
     H264Parser m_h264_parser;
+    HEVCParser m_hevc_parser;
 
     /// Wait for the a GOP/SEQ-start before sending data
     bool _wait_for_keyframe_option;
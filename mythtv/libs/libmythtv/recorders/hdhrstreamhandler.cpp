@@ -174,9 +174,7 @@ void HDHRStreamHandler::run(void)
             continue;
         }
 
-        StreamDataList::const_iterator sit = _stream_data_list.begin();
-        for (; sit != _stream_data_list.end(); ++sit)
-            remainder = sit.key()->ProcessData(data_buffer, data_length);
+        remainder = ProcessDataForListeners(data_buffer, data_length);
 
         WriteMPTS(data_buffer, data_length - remainder);
 
@@ -183,10 +183,7 @@ void HLSStreamHandler::run(void)
 
         {
             QMutexLocker locker(&_listener_lock);
-            HLSStreamHandler::StreamDataList::const_iterator sit;
-            sit = _stream_data_list.begin();
-            for (; sit != _stream_data_list.end(); ++sit)
-                remainder = sit.key()->ProcessData(m_readbuffer, size);
+            remainder = ProcessDataForListeners(m_readbuffer, size);
         }
 
         if (remainder > 0)
@@ -210,12 +210,7 @@ void HTTPReader::WriteBytes()
     int remainder = 0;
     {
         QMutexLocker locker(&m_parent->_listener_lock);
-        HTTPTSStreamHandler::StreamDataList::const_iterator sit;
-        sit = m_parent->_stream_data_list.begin();
-        for (; sit != m_parent->_stream_data_list.end(); ++sit)
-        {
-            remainder = sit.key()->ProcessData(m_buffer, m_size);
-        }
+        remainder = m_parent->ProcessDataForListeners(m_buffer, m_size);
     }
     LOG(VB_RECORD, LOG_DEBUG, LOC + QString("WriteBytes: %1/%2 bytes remain").arg(remainder).arg(m_size));
     memcpy(m_buffer, m_buffer + (m_size - remainder), remainder);
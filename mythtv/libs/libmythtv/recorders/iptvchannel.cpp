@@ -156,6 +156,13 @@ bool IPTVChannel::IsOpen(void) const
     return ret;
 }
 
+/// Datagrams the kernel dropped on the stream handler's sockets
+uint IPTVChannel::GetDroppedPackets(void) const
+{
+    QMutexLocker locker(&m_stream_lock);
+    return m_stream_handler ? m_stream_handler->GetDroppedPackets() : 0;
+}
+
 bool IPTVChannel::Tune(const IPTVTuningData &tuning, bool scanning)
 {
     QMutexLocker locker(&m_tune_lock);
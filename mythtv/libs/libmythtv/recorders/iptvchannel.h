@@ -45,6 +45,7 @@ class IPTVChannel : QObject, public DTVChannel
     virtual QString GetDevice(void) const
         { return m_last_tuning.GetDeviceKey(); }
     IPTVStreamHandler *GetStreamHandler(void) const { return m_stream_handler; }
+    uint GetDroppedPackets(void) const;
     virtual bool IsIPTV(void) const { return true; } // DTVChannel
     virtual bool IsPIDTuningSupported(void) const { return true; }
 
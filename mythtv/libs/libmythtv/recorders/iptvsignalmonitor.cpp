@@ -1,5 +1,9 @@
 // -*- Mode: c++ -*-
 
+// C++ headers
+#include <algorithm>
+using namespace std;
+
 // MythTV headers
 #include "iptvsignalmonitor.h"
 #include "mpegstreamdata.h"
@@ -26,6 +30,8 @@ IPTVSignalMonitor::IPTVSignalMonitor(int db_cardnum,
                                      IPTVChannel *_channel,
                                      uint64_t _flags) :
     DTVSignalMonitor(db_cardnum, _channel, _flags),
+    droppedPackets(tr("Dropped Packets"), "drop",
+                   65535, false, 0, 65535, 0),
     m_streamHandlerStarted(false), m_locked(false)
 {
     LOG(VB_CHANNEL, LOG_INFO, LOC + "ctor");
@@ -59,6 +65,14 @@ void IPTVSignalMonitor::Stop(void)
     LOG(VB_CHANNEL, LOG_INFO, LOC + "Stop() -- end");
 }
 
+QStringList IPTVSignalMonitor::GetStatusList(void) const
+{
+    QStringList list = DTVSignalMonitor::GetStatusList();
+    QMutexLocker locker(&statusLock);
+    list<<droppedPackets.GetName()<<droppedPackets.GetStatus();
+    return list;
+}
+
 void IPTVSignalMonitor::SetStreamData(MPEGStreamData *data)
 {
     DTVSignalMonitor::SetStreamData(data);
@@ -91,6 +105,14 @@ void IPTVSignalMonitor::UpdateValues(void)
         m_locked = true;
     }
 
+    // Cumulative, like the DVB uncorrected block count, and clamped
+    // the same way
+    {
+        uint dropped = GetIPTVChannel()->GetDroppedPackets();
+        QMutexLocker locker(&statusLock);
+        droppedPackets.SetValue(min(dropped, 65535U));
+    }
+
     EmitStatus();
     if (IsAllGood())
         SendMessageAllGood();
@@ -18,6 +18,9 @@ class IPTVSignalMonitor : public DTVSignalMonitor
 
     void Stop(void);
 
+    // SignalMonitor
+    virtual QStringList GetStatusList(void) const;
+
     // DTVSignalMonitor
     virtual void SetStreamData(MPEGStreamData *data);
 
@@ -32,6 +35,7 @@ class IPTVSignalMonitor : public DTVSignalMonitor
     IPTVChannel *GetIPTVChannel(void);
 
   protected:
+    SignalMonitorValue droppedPackets;
     bool m_streamHandlerStarted;
     bool m_locked;
 };
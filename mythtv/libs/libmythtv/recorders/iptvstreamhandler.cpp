@@ -11,6 +11,7 @@
 #endif
 
 // Qt headers
+#include <QSocketNotifier>
 #include <QUdpSocket>
 #include <QByteArray>
 #include <QHostInfo>
@@ -19,6 +20,7 @@
 #include "iptvstreamhandler.h"
 #include "rtppacketbuffer.h"
 #include "udppacketbuffer.h"
+#include "udpbatchreader.h"
 #include "rtptsdatapacket.h"
 #include "rtpdatapacket.h"
 #include "rtpfecpacket.h"
@@ -111,7 +113,8 @@ IPTVStreamHandler::IPTVStreamHandler(const IPTVTuningData &tuning) :
     m_buffer(NULL),
     m_rtsp_rtp_port(0),
     m_rtsp_rtcp_port(0),
-    m_rtsp_ssrc(0)
+    m_rtsp_ssrc(0),
+    m_dropped_packets(0)
 {
     memset(m_sockets, 0, sizeof(m_sockets));
     memset(m_read_helpers, 0, sizeof(m_read_helpers));
@@ -180,8 +183,9 @@ void IPTVStreamHandler::run(void)
         LOG(VB_RECORD, LOG_DEBUG, LOC +
             QString("setting up url[%1]:%2").arg(i).arg(url.toString()));
 
-        // always ensure we use consecutive port numbers
-        int port = start_port ? start_port + 1 : url.port();
+        // RTSP leaves the ports to us, so use consecutive ones; SMPTE
+        // 2022-1 FEC streams come on their own ports, data + 2 and + 4
+        int port = (start_port && !url.port()) ? start_port + 1 : url.port();
         QString host = url.host();
         QHostAddress dest_addr(host);
 
@@ -223,8 +227,6 @@ void IPTVStreamHandler::run(void)
             // the requested server
             m_sender[i] = dest_addr;
         }
-        m_read_helpers[i] = new IPTVStreamHandlerReadHelper(
-            this, m_sockets[i], i);
 
         // we need to open the descriptor ourselves so we
         // can set some socket options
@@ -235,20 +237,53 @@ void IPTVStreamHandler::run(void)
                 "Unable to create socket " + ENO);
             continue;
         }
-        int buf_size = 2 * 1024 * max(tuning.GetBitrate(i)/1000, 500U);
+        // The receive buffer is all that absorbs a burst while we are
+        // busy elsewhere; with many channels recorded at once this
+        // thread can fall behind for a while. SO_RCVBUFFORCE may go
+        // past net.core.rmem_max, but needs CAP_NET_ADMIN.
+        int buf_size = 2 * 1024 * max(tuning.GetBitrate(i)/1000, 2048U);
         if (!tuning.GetBitrate(i))
-            buf_size = 2 * 1024 * 1024;
-        int err = setsockopt(fd, SOL_SOCKET, SO_RCVBUF,
-                            (char *)&buf_size, sizeof(buf_size));
+            buf_size = 8 * 1024 * 1024;
+        int err = -1;
+#ifdef SO_RCVBUFFORCE
+        err = setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE,
+                         (char *)&buf_size, sizeof(buf_size));
+#endif
+        if (err)
+        {
+            err = setsockopt(fd, SOL_SOCKET, SO_RCVBUF,
+                             (char *)&buf_size, sizeof(buf_size));
+        }
         if (err)
         {
             LOG(VB_GENERAL, LOG_INFO, LOC +
                 QString("Increasing buffer size to %1 failed")
                 .arg(buf_size) + ENO);
         }
+        else
+        {
+            int got_size = 0;
+            socklen_t len = sizeof(got_size);
+            getsockopt(fd, SOL_SOCKET, SO_RCVBUF, (char *)&got_size, &len);
+#ifdef __linux__
+            got_size /= 2; // Linux doubles it to allow for its overhead
+#endif
+            if (got_size < buf_size)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    QString("Receive buffer is %1 bytes, wanted %2; "
+                            "consider raising net.core.rmem_max")
+                    .arg(got_size).arg(buf_size));
+            }
+        }
+
+        if (UDPBatchReader::IsSupported())
+            UDPBatchReader::SetSocketOptions(fd);
 
         m_sockets[i]->setSocketDescriptor(
             fd, QAbstractSocket::UnconnectedState, QIODevice::ReadOnly);
+        m_read_helpers[i] = new IPTVStreamHandlerReadHelper(
+            this, m_sockets[i], i);
 
         // we bind to destination address if it's a multicast address, or
         // the local ones otherwise
@@ -342,72 +377,121 @@ void IPTVStreamHandler::run(void)
 IPTVStreamHandlerReadHelper::IPTVStreamHandlerReadHelper(
     IPTVStreamHandler *p, QUdpSocket *s, uint stream) :
     m_parent(p), m_socket(s), m_sender(p->m_sender[stream]),
-    m_stream(stream)
+    m_stream(stream), m_reader(NULL), m_notifier(NULL), m_dropped(0)
 {
+    if (UDPBatchReader::IsSupported())
+    {
+        // The reader works on its own descriptor for the socket, so
+        // that its notifier doesn't clash with the QUdpSocket's.
+        m_reader = new UDPBatchReader(m_socket->socketDescriptor());
+        if (m_reader->GetDescriptor() >= 0)
+        {
+            m_notifier = new QSocketNotifier(m_reader->GetDescriptor(),
+                                             QSocketNotifier::Read, this);
+            connect(m_notifier, SIGNAL(activated(int)),
+                    this,       SLOT(ReadPending()));
+            return;
+        }
+        delete m_reader;
+        m_reader = NULL;
+    }
+
     connect(m_socket, SIGNAL(readyRead()),
             this,     SLOT(ReadPending()));
 }
 
+IPTVStreamHandlerReadHelper::~IPTVStreamHandlerReadHelper()
+{
+    delete m_notifier;
+    m_notifier = NULL;
+    delete m_reader;
+    m_reader = NULL;
+}
+
 #define LOC_WH QString("IPTVSH(%1): ").arg(m_parent->_device)
 
 void IPTVStreamHandlerReadHelper::ReadPending(void)
 {
+    if (m_reader)
+    {
+        ReadBatches();
+        return;
+    }
+
     QHostAddress sender;
     quint16 senderPort;
-    bool sender_null = m_sender.isNull();
 
-    if (0 == m_stream)
+    while (m_socket->hasPendingDatagrams())
     {
-        while (m_socket->hasPendingDatagrams())
-        {
-            UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
-            QByteArray &data = packet.GetDataReference();
-            data.resize(m_socket->pendingDatagramSize());
-            m_socket->readDatagram(data.data(), data.size(),
-                                   &sender, &senderPort);
-            if (sender_null || sender == m_sender)
-            {
-                m_parent->m_buffer->PushDataPacket(packet);
-            }
-            else
-            {
-                LOG(VB_RECORD, LOG_WARNING, LOC_WH +
-                    QString("Received on socket(%1) %2 bytes from non expected "
-                            "sender:%3 (expected:%4) ignoring")
-                    .arg(m_stream).arg(data.size())
-                    .arg(sender.toString()).arg(m_sender.toString()));
-            }
-        }
+        UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
+        QByteArray &data = packet.GetDataReference();
+        data.resize(m_socket->pendingDatagramSize());
+        m_socket->readDatagram(data.data(), data.size(),
+                               &sender, &senderPort);
+        packet.SetArrivalTime(0ULL);
+        Push(packet, sender);
     }
-    else
+}
+
+/** \brief Reads the socket with UDPBatchReader, a batch per system call.
+ *
+ *  The number of batches per call is capped so one busy socket can't
+ *  starve the others in this event loop; the notifier fires again while
+ *  datagrams are pending.
+ */
+void IPTVStreamHandlerReadHelper::ReadBatches(void)
+{
+    static const uint kMaxBatches = 16;
+
+    for (uint batch = 0; batch < kMaxBatches; batch++)
     {
-        while (m_socket->hasPendingDatagrams())
+        int count = m_reader->Read(m_parent->m_buffer);
+        for (int i = 0; i < count; i++)
         {
-            UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
-            QByteArray &data = packet.GetDataReference();
-            data.resize(m_socket->pendingDatagramSize());
-            m_socket->readDatagram(data.data(), data.size(),
-                                   &sender, &senderPort);
-            if (sender_null || sender == m_sender)
-            {
-                m_parent->m_buffer->PushFECPacket(packet, m_stream - 1);
-            }
+            UDPPacket packet(m_reader->TakePacket(i));
+            if (packet.GetDataReference().isEmpty())
+                m_parent->m_buffer->FreePacket(packet);
             else
-            {
-                LOG(VB_RECORD, LOG_WARNING, LOC_WH +
-                    QString("Received on socket(%1) %2 bytes from non expected "
-                            "sender:%3 (expected:%4) ignoring")
-                    .arg(m_stream).arg(data.size())
-                    .arg(sender.toString()).arg(m_sender.toString()));
-            }
+                Push(packet, m_reader->GetSender(i));
         }
+        if (count < UDPBatchReader::kBatchSize)
+            break;
+    }
+
+    uint dropped = m_reader->GetDropped();
+    if (dropped != m_dropped)
+    {
+        m_parent->m_dropped_packets.fetchAndAddRelaxed(dropped - m_dropped);
+        m_dropped = dropped;
     }
 }
 
+void IPTVStreamHandlerReadHelper::Push(
+    const UDPPacket &packet, const QHostAddress &sender)
+{
+    if (!m_sender.isNull() && sender != m_sender)
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC_WH +
+            QString("Received on socket(%1) %2 bytes from non expected "
+                    "sender:%3 (expected:%4) ignoring")
+            .arg(m_stream).arg(packet.GetData().size())
+            .arg(sender.toString()).arg(m_sender.toString()));
+        m_parent->m_buffer->FreePacket(packet);
+        return;
+    }
+
+    if (0 == m_stream)
+        m_parent->m_buffer->PushDataPacket(packet);
+    else
+        m_parent->m_buffer->PushFECPacket(packet, m_stream - 1);
+}
+
 IPTVStreamHandlerWriteHelper::IPTVStreamHandlerWriteHelper(IPTVStreamHandler *p)
   : m_parent(p),                m_timer(0),             m_timer_rtcp(0),
     m_last_sequence_number(0),  m_last_timestamp(0),    m_previous_last_sequence_number(0),
-    m_lost(0),                  m_lost_interval(0)
+    m_lost(0),                  m_lost_interval(0),
+    m_jitter(0.0),              m_last_transit(0),      m_have_transit(false),
+    m_dropped_logged(0)
 {
 }
 
@@ -434,6 +518,16 @@ void IPTVStreamHandlerWriteHelper::timerEvent(QTimerEvent* event)
         return;
     }
 
+    uint dropped = m_parent->GetDroppedPackets();
+    if (dropped != m_dropped_logged)
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC_WH +
+            QString("Kernel dropped %1 datagrams (%2 in total), "
+                    "we are not reading the sockets fast enough")
+            .arg(dropped - m_dropped_logged).arg(dropped));
+        m_dropped_logged = dropped;
+    }
+
     if (!m_parent->m_buffer->HasAvailablePacket())
         return;
 
@@ -448,14 +542,9 @@ void IPTVStreamHandlerWriteHelper::timerEvent(QTimerEvent* event)
         {
             QMutexLocker locker(&m_parent->_listener_lock);
             QByteArray &data = packet.GetDataReference();
-            IPTVStreamHandler::StreamDataList::const_iterator sit;
-            sit = m_parent->_stream_data_list.begin();
-            for (; sit != m_parent->_stream_data_list.end(); ++sit)
-            {
-                remainder = sit.key()->ProcessData(
-                    reinterpret_cast<const unsigned char*>(data.data()),
-                    data.size());
-            }
+            remainder = m_parent->ProcessDataForListeners(
+                reinterpret_cast<const unsigned char*>(data.data()),
+                data.size());
         }
 
         if (remainder != 0)
@@ -501,20 +590,30 @@ void IPTVStreamHandlerWriteHelper::timerEvent(QTimerEvent* event)
             }
             m_last_sequence_number = seq_num;
             m_last_timestamp = ts_packet.GetTimeStamp();
+
+            uint64_t arrival = packet.GetArrivalTime();
+            if (arrival)
+            {
+                // RFC 3550 A.8, with the arrival time in the 90kHz
+                // units of MPEG-TS RTP timestamps
+                uint32_t arrival_ts = (arrival / 1000) * 9 / 100;
+                int32_t transit = arrival_ts - m_last_timestamp;
+                if (m_have_transit)
+                {
+                    int32_t d = transit - m_last_transit;
+                    m_jitter += ((d < 0 ? -d : d) - m_jitter) / 16.0;
+                }
+                m_last_transit = transit;
+                m_have_transit = true;
+            }
             LOG(VB_RECORD, LOG_DEBUG,
                 QString("Processing RTP packet(seq:%1 ts:%2)")
                 .arg(m_last_sequence_number).arg(m_last_timestamp));
 
             m_parent->_listener_lock.lock();
 
-            int remainder = 0;
-            IPTVStreamHandler::StreamDataList::const_iterator sit;
-            sit = m_parent->_stream_data_list.begin();
-            for (; sit != m_parent->_stream_data_list.end(); ++sit)
-            {
-                remainder = sit.key()->ProcessData(
-                    ts_packet.GetTSData(), ts_packet.GetTSDataSize());
-            }
+            int remainder = m_parent->ProcessDataForListeners(
+                ts_packet.GetTSData(), ts_packet.GetTSDataSize());
 
             m_parent->_listener_lock.unlock();
 
@@ -540,7 +639,8 @@ void IPTVStreamHandlerWriteHelper::SendRTCPReport(void)
     RTCPDataPacket rtcp =
         RTCPDataPacket(m_last_timestamp, m_last_timestamp + RTCP_TIMER * 1000,
                        m_last_sequence_number, m_last_sequence_number + seq_delta,
-                       m_lost, m_lost_interval, m_parent->m_rtsp_ssrc);
+                       m_lost, m_lost_interval, (uint32_t)m_jitter,
+                       m_parent->m_rtsp_ssrc);
     QByteArray buf = rtcp.GetData();
 
     LOG(VB_RECORD, LOG_DEBUG, LOC_WH +
@@ -8,6 +8,7 @@ using namespace std;
 
 #include <QHostAddress>
 #include <QUdpSocket>
+#include <QAtomicInt>
 #include <QString>
 #include <QMutex>
 #include <QMap>
@@ -24,8 +25,11 @@ using namespace std;
 class IPTVStreamHandler;
 class DTVSignalMonitor;
 class MPEGStreamData;
+class UDPBatchReader;
+class QSocketNotifier;
 class PacketBuffer;
 class IPTVChannel;
+class UDPPacket;
 
 class IPTVStreamHandlerReadHelper : QObject
 {
@@ -34,15 +38,24 @@ class IPTVStreamHandlerReadHelper : QObject
   public:
     IPTVStreamHandlerReadHelper(
         IPTVStreamHandler *p, QUdpSocket *s, uint stream);
+    ~IPTVStreamHandlerReadHelper();
 
   public slots:
     void ReadPending(void);
 
+  private:
+    void ReadBatches(void);
+    void Push(const UDPPacket &packet, const QHostAddress &sender);
+
   private:
     IPTVStreamHandler *m_parent;
     QUdpSocket *m_socket;
     QHostAddress m_sender;
     uint m_stream;
+    /// Native batched reads, where the platform supports them
+    UDPBatchReader *m_reader;
+    QSocketNotifier *m_notifier;
+    uint m_dropped;
 };
 
 class IPTVStreamHandlerWriteHelper : QObject
@@ -72,6 +85,11 @@ private:
     int m_timer, m_timer_rtcp;
     uint m_last_sequence_number, m_last_timestamp, m_previous_last_sequence_number;
     int m_lost, m_lost_interval;
+    /// RFC 3550 interarrival jitter, in RTP timestamp units
+    double m_jitter;
+    int32_t m_last_transit;
+    bool m_have_transit;
+    uint m_dropped_logged;
 };
 
 class IPTVStreamHandler : public StreamHandler
@@ -90,6 +108,10 @@ class IPTVStreamHandler : public StreamHandler
         StreamHandler::AddListener(data, false, false, output_file);
     } // StreamHandler
 
+    /// Datagrams the kernel dropped because we didn't read them in time
+    uint GetDroppedPackets(void) const
+        { return m_dropped_packets.fetchAndAddRelaxed(0); }
+
   protected:
     IPTVStreamHandler(const IPTVTuningData &tuning);
 
@@ -107,6 +129,7 @@ class IPTVStreamHandler : public StreamHandler
     ushort m_rtsp_rtp_port, m_rtsp_rtcp_port;
     uint32_t m_rtsp_ssrc;
     QHostAddress m_rtcp_dest;
+    mutable QAtomicInt m_dropped_packets;
 
     // for implementing Get & Return
     static QMutex                            s_iptvhandlers_lock;
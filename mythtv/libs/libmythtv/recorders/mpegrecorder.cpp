@@ -1316,6 +1316,7 @@ bool MpegRecorder::PauseAndWait(int timeout)
         if (driver == "hdpvr")
         {
             m_h264_parser.Reset();
+            m_hevc_parser.Reset();
             _wait_for_keyframe_option = true;
             _seen_sps = false;
             // HD-PVR will sometimes reset to defaults
@@ -1379,6 +1380,7 @@ bool MpegRecorder::StartEncoding(void)
     if (driver == "hdpvr")
     {
         m_h264_parser.Reset();
+        m_hevc_parser.Reset();
         _wait_for_keyframe_option = true;
         _seen_sps = false;
         good_res = HandleResolutionChanges();
@@ -40,17 +40,18 @@ public:
   : UDPPacket(o),
     m_timestamp(o.m_timestamp), m_last_timestamp(o.m_last_timestamp),
     m_sequence(o.m_sequence),   m_last_sequence(o.m_last_sequence),
-    m_lost(o.m_lost),           m_ssrc(o.m_ssrc)
+    m_lost(o.m_lost),           m_lost_interval(o.m_lost_interval),
+    m_jitter(o.m_jitter),       m_ssrc(o.m_ssrc)
     { }
 
     RTCPDataPacket(uint32_t timestamp, uint32_t last_timestamp,
                    uint32_t sequence, uint32_t last_sequence,
                    uint32_t m_lost, uint32_t lost_interval,
-                   uint32_t ssrc)
+                   uint32_t jitter, uint32_t ssrc)
   : m_timestamp(timestamp),     m_last_timestamp(last_timestamp),
     m_sequence(sequence),       m_last_sequence(last_sequence),
     m_lost(m_lost),             m_lost_interval(lost_interval),
-    m_ssrc(ssrc) { }
+    m_jitter(jitter),           m_ssrc(ssrc) { }
 
     QByteArray GetData(void) const
     {
@@ -115,7 +116,7 @@ public:
 
             qToBigEndian((quint32) 0, &rtcp[12]); /* 8 bits of fraction, 24 bits of total packets lost */
             qToBigEndian((quint32) 0, &rtcp[16]); /* max sequence received */
-            qToBigEndian((quint32) 0, &rtcp[20]); /* jitter */
+            qToBigEndian((quint32) m_jitter, &rtcp[20]); /* jitter */
 
             qToBigEndian((quint32) m_timestamp, &rtcp[24]); /* last SR timestamp */
             qToBigEndian((quint32) m_last_timestamp, &rtcp[28]); /* delay since last SR timestamp */
@@ -152,6 +153,7 @@ public:
 protected:
     uint32_t m_timestamp, m_last_timestamp;
     uint32_t m_sequence, m_last_sequence, m_lost, m_lost_interval;
+    uint32_t m_jitter;
     uint32_t m_ssrc;
 };
 #endif
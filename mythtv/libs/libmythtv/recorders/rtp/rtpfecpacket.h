@@ -3,21 +3,85 @@
  * Distributed as part of MythTV under GPL v2 and later.
  */
 
-#include "udppacket.h"
+#include "rtpdatapacket.h"
 
 #ifndef _RTP_FEC_PACKET_H_
 #define _RTP_FEC_PACKET_H_
 
 /** \brief RTP FEC Packet
+ *
+ *  A SMPTE 2022-1 FEC packet, an RTP packet whose payload starts with
+ *  this header:
+ *
+ *  \code
+ *   0                   1                   2                   3
+ *   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *  |      SNBase low bits          |        Length Recovery        |
+ *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *  |E| PT recovery |                    Mask                       |
+ *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *  |                          TS recovery                          |
+ *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *  |X|D|type |index|    Offset     |      NA       |SNBase ext bits|
+ *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *  \endcode
+ *
+ *  followed by the XOR of the payloads of the NA data packets it
+ *  protects, those with sequence numbers SNBase + i * Offset. Column
+ *  packets have an Offset of L and an NA of D for an L x D matrix, row
+ *  packets an Offset of 1 and an NA of L.
  */
-class RTPFECPacket : public UDPPacket
+class RTPFECPacket : public RTPDataPacket
 {
   public:
-    RTPFECPacket(const UDPPacket &o) : UDPPacket(o) { }
-    RTPFECPacket(uint64_t key) : UDPPacket(key) { }
-    RTPFECPacket(void) : UDPPacket(0ULL) { }
+    RTPFECPacket(const UDPPacket &o) : RTPDataPacket(o) { }
+    RTPFECPacket(uint64_t key) : RTPDataPacket(key) { }
+    RTPFECPacket(void) : RTPDataPacket(0ULL) { }
 
-    // TODO
+    static const uint kHeaderSize = 16;
+
+    bool IsValid(void) const
+    {
+        if (!RTPDataPacket::IsValid())
+            return false;
+        if ((uint)m_data.size() < m_off + kHeaderSize)
+            return false;
+        return GetNA() > 0 && GetOffset() > 0;
+    }
+
+    /// Low 16 bits of the first protected sequence number; 2022-1
+    /// doesn't use the extension bits with 16 bit RTP sequence numbers.
+    uint GetSNBase(void) const { return GetUInt16(0); }
+    uint GetLengthRecovery(void) const { return GetUInt16(2); }
+    uint GetPTRecovery(void) const { return GetByte(4) & 0x7f; }
+    uint GetTSRecovery(void) const
+    {
+        return ntohl(*reinterpret_cast<const uint32_t*>(
+                         m_data.data() + m_off + 8));
+    }
+    /// True for row FEC, false for column FEC
+    bool IsRow(void) const { return (GetByte(12) >> 6) & 0x1; }
+    uint GetOffset(void) const { return GetByte(13); }
+    uint GetNA(void) const { return GetByte(14); }
+
+    const unsigned char *GetFECData(void) const
+    {
+        return reinterpret_cast<const unsigned char*>(m_data.data()) +
+            m_off + kHeaderSize;
+    }
+    uint GetFECDataSize(void) const
+    {
+        return m_data.size() - m_off - kHeaderSize;
+    }
+
+  private:
+    uint GetByte(uint i) const { return (uchar) m_data[m_off + i]; }
+    uint GetUInt16(uint i) const
+    {
+        return ntohs(*reinterpret_cast<const uint16_t*>(
+                         m_data.data() + m_off + i));
+    }
 };
 
 #endif // _RTP_FEC_PACKET_H_
@@ -7,67 +7,337 @@
 #include <algorithm>
 using namespace std;
 
+#include <string.h>
+
+#include <QtEndian>
+
 #include "rtppacketbuffer.h"
 #include "rtpdatapacket.h"
 #include "rtpfecpacket.h"
+#include "mythlogging.h"
+
+#define LOC QString("RTPPacketBuffer: ")
+
+/// Must be a power of two, and more than twice the largest window
+static const uint kRingSize        = 4096;
+static const uint kRingMask        = kRingSize - 1;
+static const uint kMinWindow       = 16;
+static const uint kMaxWindow       = kRingSize / 2;
+/// Bits in an RTP packet carrying 7 TS packets, the usual payload
+static const uint kPacketBits      = (12 + 7 * 188) * 8;
+/// Assumed when the tuning data doesn't give the bitrate
+static const uint kDefaultBitrate  = 20 * 1000 * 1000;
+/// Late packets in a row after which the sender is assumed to have
+/// restarted its sequence numbers
+static const uint kResyncLate      = 64;
+/// A missing packet this close to the newest one is probably just out of
+/// order, so it isn't recovered yet. Must be a power of two.
+static const uint kReorderSlack    = 8;
+static const int  kMaxPendingFEC   = 128;
+
+RTPPacketBuffer::RTPPacketBuffer(unsigned int bitrate) :
+    PacketBuffer(bitrate),
+    m_ring(kRingSize),
+    m_next(0), m_highest(0), m_started(false), m_late(0),
+    m_window(kMinWindow), m_bitrate_window(kMinWindow),
+    m_released(0), m_recovered(0), m_lost(0)
+{
+    for (uint i = 0; i < kRingSize; i++)
+        m_ring[i].present = false;
+
+    uint rate = bitrate ? bitrate : kDefaultBitrate;
+    m_bitrate_window = (uint64_t) rate * kLatencyTarget / 1000 / kPacketBits;
+    m_bitrate_window = min(max(m_bitrate_window, kMinWindow), kMaxWindow);
+    m_window = m_bitrate_window;
+}
+
+RTPPacketBuffer::~RTPPacketBuffer()
+{
+    LOG(VB_RECORD, LOG_INFO, LOC +
+        QString("Released %1 packets, recovered %2 with FEC, lost %3")
+        .arg(m_released).arg(m_recovered).arg(m_lost));
+}
 
 void RTPPacketBuffer::PushDataPacket(const UDPPacket &udp_packet)
 {
     RTPDataPacket packet(udp_packet);
 
-    uint key = packet.GetSequenceNumber();
+    if (!packet.IsValid())
+    {
+        FreePacket(packet);
+        return;
+    }
+
+    if (!m_started)
+    {
+        m_next = m_highest = packet.GetSequenceNumber();
+        m_started = true;
+    }
 
-    bool large_was_seen_recently = m_large_sequence_number_seen_recently > 0;
-    m_large_sequence_number_seen_recently = 
-        (key > (1U<<15)) ? 500 : m_large_sequence_number_seen_recently - 1;
-    m_large_sequence_number_seen_recently =
-        max(m_large_sequence_number_seen_recently, 0);
+    int64_t seq = ExtendSequence(packet.GetSequenceNumber());
 
-    if (m_large_sequence_number_seen_recently > 0)
+    if (seq < m_next)
     {
-        if (key < 500) 
-            key += 1ULL<<16;
+        if (++m_late < kResyncLate)
+        {
+            // Released or given up on already
+            FreePacket(packet);
+            return;
+        }
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("Sequence number went back to %1, resyncing")
+            .arg(packet.GetSequenceNumber()));
+        Flush();
+        m_next = m_highest = seq;
     }
-    else if (large_was_seen_recently)
+    else if (seq >= m_next + kRingSize)
     {
-        m_current_sequence += 1ULL<<16;
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("Sequence number jumped to %1, resyncing")
+            .arg(packet.GetSequenceNumber()));
+        Flush();
+        m_next = m_highest = seq;
     }
+    m_late = 0;
 
-    key += m_current_sequence;
+    Insert(seq, packet);
 
-/*
-    LOG(VB_RECORD, LOG_DEBUG, QString("Pushing %1 as %2 (lr %3)")
-        .arg(packet.GetSequenceNumber()).arg(key)
-        .arg(m_large_sequence_number_seen_recently));
-*/
+    // Pending FEC packets waiting out kReorderSlack may be usable now
+    if (!m_pending_fec.empty() && !(seq & (kReorderSlack - 1)))
+        RecoverPending();
 
-    m_unordered_packets[key] = packet;
+    Release(m_highest - m_window + 1);
+}
+
+void RTPPacketBuffer::PushFECPacket(
+    const UDPPacket &packet, uint fec_stream_num)
+{
+    (void) fec_stream_num; // the FEC header says whether it is a row or column
 
-    // TODO pushing packets onto the ordered list should be based on
-    // the bitrate and the M+N of the FEC.. but for now...
-    const int kHighWaterMark = 500;
-    const int kLowWaterMark  = 100;
-    if (m_unordered_packets.size() > kHighWaterMark)
+    RTPFECPacket fec(packet);
+    if (!m_started || !fec.IsValid())
     {
-        while (m_unordered_packets.size() > kLowWaterMark)
+        FreePacket(packet);
+        return;
+    }
+
+    // Hold packets long enough for a column's FEC packet to arrive
+    uint needed = (2 * fec.GetNA() + 1) * fec.GetOffset();
+    if (needed > m_window && m_window < kMaxWindow)
+    {
+        m_window = min(max(needed, m_bitrate_window), kMaxWindow);
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("%1 FEC over %2 packets, holding %3 packets")
+            .arg(fec.IsRow() ? "Row" : "Column").arg(fec.GetNA())
+            .arg(m_window));
+    }
+
+    bool done;
+    if (Recover(fec, ExtendSequence(fec.GetSNBase()), done))
+        RecoverPending();
+
+    if (done)
+    {
+        FreePacket(fec);
+    }
+    else
+    {
+        m_pending_fec.push_back(fec);
+        if (m_pending_fec.size() > kMaxPendingFEC)
         {
-            QMap<uint64_t, RTPDataPacket>::iterator it =
-                m_unordered_packets.begin();
-/*
-            LOG(VB_RECORD, LOG_DEBUG, QString("Popping %1 as %2")
-                .arg((*it).GetSequenceNumber()).arg(it.key()));
-*/
-            m_available_packets.push_back(*it);
-            m_unordered_packets.erase(it);
+            FreePacket(m_pending_fec.front());
+            m_pending_fec.pop_front();
         }
     }
+
+    Release(m_highest - m_window + 1);
 }
 
-void RTPPacketBuffer::PushFECPacket(
-    const UDPPacket &packet, uint fec_stream_num)
+/// Maps a 16 bit sequence number to the extended sequence number
+/// nearest to the next one to release.
+int64_t RTPPacketBuffer::ExtendSequence(uint sequence) const
+{
+    int16_t delta = (int16_t)(sequence - (uint)(m_next & 0xffff));
+    return m_next + delta;
+}
+
+void RTPPacketBuffer::Insert(int64_t seq, const RTPDataPacket &packet)
+{
+    Slot &slot = m_ring[seq & kRingMask];
+    if (slot.present)
+    {
+        // A duplicate, or a packet we already recovered
+        FreePacket(packet);
+        return;
+    }
+    slot.packet = packet;
+    slot.present = true;
+    m_highest = max(m_highest, seq);
+}
+
+/// Releases, in order, every packet before "upto", recovering
+/// missing ones where the pending FEC packets allow it.
+void RTPPacketBuffer::Release(int64_t upto)
+{
+    while (m_next < upto)
+    {
+        Slot &slot = m_ring[m_next & kRingMask];
+
+        // A late packet may have completed a row or column
+        if (!slot.present && !m_pending_fec.empty())
+            RecoverPending();
+
+        if (slot.present)
+        {
+            m_available_packets.push_back(slot.packet);
+            slot.packet = RTPDataPacket();
+            slot.present = false;
+            m_released++;
+        }
+        else
+        {
+            m_lost++;
+        }
+        m_next++;
+    }
+}
+
+void RTPPacketBuffer::Flush(void)
 {
-    (void) fec_stream_num;
-    // TODO IMPLEMENT
-    // for now just free the packet for immediate reuse
-    FreePacket(packet);
+    Release(m_highest + 1);
+
+    while (!m_pending_fec.empty())
+    {
+        FreePacket(m_pending_fec.front());
+        m_pending_fec.pop_front();
+    }
+}
+
+/** \brief Rebuilds the one packet "fec" covers that is missing.
+ *
+ *   The payload is the XOR of the FEC payload and the payloads of the
+ *   other packets, and so are the payload length, type and timestamp.
+ *   2022-1 streams don't use CSRCs, header extensions or padding, so
+ *   the rest of the RTP header is fixed.
+ *
+ *  \param base Extended sequence number of the first packet covered
+ *  \param done Set when "fec" is of no further use
+ *  \return true if a packet was recovered
+ */
+bool RTPPacketBuffer::Recover(const RTPFECPacket &fec, int64_t base,
+                              bool &done)
+{
+    const uint offset = fec.GetOffset();
+    const uint count  = fec.GetNA();
+    const int64_t last = base + (int64_t) offset * (count - 1);
+
+    // Once a packet has been released its payload is gone
+    done = (base < m_next) || (last >= m_next + kRingSize);
+    if (done)
+        return false;
+
+    int64_t missing = -1;
+    for (uint i = 0; i < count; i++)
+    {
+        int64_t seq = base + (int64_t) offset * i;
+        if (!m_ring[seq & kRingMask].present)
+        {
+            if (missing >= 0)
+                return false;
+            missing = seq;
+        }
+    }
+    if (missing < 0)
+    {
+        done = true;
+        return false;
+    }
+    if (missing > m_highest - (int64_t) kReorderSlack)
+        return false; // give it a chance to turn up
+    done = true;
+
+    const uint size = fec.GetFECDataSize();
+    uint length    = fec.GetLengthRecovery();
+    uint type      = fec.GetPTRecovery();
+    uint timestamp = fec.GetTSRecovery();
+    uint ssrc      = 0;
+
+    UDPPacket udp(GetEmptyPacket());
+    QByteArray &data = udp.GetDataReference();
+    data.resize(12 + size);
+    unsigned char *buf = reinterpret_cast<unsigned char*>(data.data());
+    memcpy(buf + 12, fec.GetFECData(), size);
+
+    for (uint i = 0; i < count; i++)
+    {
+        int64_t seq = base + (int64_t) offset * i;
+        if (seq == missing)
+            continue;
+
+        RTPDataPacket &packet = m_ring[seq & kRingMask].packet;
+        const QByteArray &pdata = packet.GetDataReference();
+        const unsigned char *payload =
+            reinterpret_cast<const unsigned char*>(pdata.constData()) + 12;
+        uint psize = pdata.size() - 12;
+
+        length    ^= psize;
+        type      ^= packet.GetPayloadType();
+        timestamp ^= packet.GetTimeStamp();
+        ssrc       = packet.GetSynchronizationSource();
+
+        uint n = min(psize, size);
+        for (uint j = 0; j < n; j++)
+            buf[12 + j] ^= payload[j];
+    }
+
+    if (length > size)
+    {
+        LOG(VB_RECORD, LOG_DEBUG, LOC +
+            QString("FEC for %1 gives a bad length %2")
+            .arg(missing & 0xffff).arg(length));
+        FreePacket(udp);
+        return false;
+    }
+
+    data.resize(12 + length);
+    buf = reinterpret_cast<unsigned char*>(data.data());
+    buf[0] = 2 << 6;                    // RTP version
+    buf[1] = type & 0x7f;
+    qToBigEndian((quint16) missing, buf + 2);
+    qToBigEndian((quint32) timestamp, buf + 4);
+    qToBigEndian((quint32) ssrc, buf + 8);
+    udp.SetArrivalTime(0ULL);
+
+    LOG(VB_RECORD, LOG_DEBUG, LOC +
+        QString("Recovered %1 from %2 FEC")
+        .arg(missing & 0xffff).arg(fec.IsRow() ? "row" : "column"));
+
+    m_recovered++;
+    Insert(missing, RTPDataPacket(udp));
+    return true;
+}
+
+/// Retries the pending FEC packets until none of them recovers a packet.
+void RTPPacketBuffer::RecoverPending(void)
+{
+    bool recovered = true;
+    while (recovered)
+    {
+        recovered = false;
+        QList<RTPFECPacket>::iterator it = m_pending_fec.begin();
+        while (it != m_pending_fec.end())
+        {
+            bool done;
+            recovered |= Recover(*it, ExtendSequence(it->GetSNBase()), done);
+            if (done)
+            {
+                FreePacket(*it);
+                it = m_pending_fec.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
 }
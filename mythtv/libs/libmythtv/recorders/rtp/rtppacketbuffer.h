@@ -7,20 +7,34 @@
 #ifndef _RTP_PACKET_BUFFER_H_
 #define _RTP_PACKET_BUFFER_H_
 
-#include <QMap>
+#include <vector>
+using namespace std;
+
+#include <QList>
 
 #include "rtpdatapacket.h"
+#include "rtpfecpacket.h"
 #include "packetbuffer.h"
 
+/** \brief Puts RTP packets back in order, and recovers lost ones from
+ *         SMPTE 2022-1 FEC streams.
+ *
+ *  Packets are held in a ring indexed by sequence number until a
+ *  window's worth of later packets has arrived, then released in order.
+ *  The window is sized so a packet is held for kLatencyTarget ms at the
+ *  stream's bitrate, and grows to cover the FEC matrix once FEC packets
+ *  show its size, since a column's FEC packet arrives up to a matrix
+ *  after the column's first packet.
+ *
+ *  A lost packet is rebuilt as soon as a row or column FEC packet
+ *  covering it has all its other packets; each recovery may complete
+ *  another row or column.
+ */
 class RTPPacketBuffer : public PacketBuffer
 {
   public:
-    RTPPacketBuffer(unsigned int bitrate) :
-        PacketBuffer(bitrate),
-        m_large_sequence_number_seen_recently(0),
-        m_current_sequence(0ULL)
-    {
-    }
+    RTPPacketBuffer(unsigned int bitrate);
+    ~RTPPacketBuffer();
 
     /// Adds RFC 3550 RTP data packet
     virtual void PushDataPacket(const UDPPacket&);
@@ -28,12 +42,48 @@ class RTPPacketBuffer : public PacketBuffer
     /// Adds SMPTE 2022 Forward Error Correction Stream packet
     virtual void PushFECPacket(const UDPPacket&, unsigned int fec_stream_num);
 
+    /// Packets held back waiting for earlier ones
+    uint GetWindow(void) const { return m_window; }
+    uint GetRecoveredCount(void) const { return m_recovered; }
+    uint GetLostCount(void) const { return m_lost; }
+
+    /// How long a packet is held, in milliseconds, at the stream bitrate
+    static const uint kLatencyTarget = 250;
+
   private:
-    int m_large_sequence_number_seen_recently;
-    uint64_t m_current_sequence;
+    int64_t ExtendSequence(uint sequence) const;
+    void Insert(int64_t seq, const RTPDataPacket &packet);
+    void Release(int64_t upto);
+    void Flush(void);
+    bool Recover(const RTPFECPacket &fec, int64_t base, bool &done);
+    void RecoverPending(void);
+
+  private:
+    typedef struct slot
+    {
+        RTPDataPacket   packet;
+        bool            present;
+    } Slot;
+
+    /// Ring of kRingSize slots, the packet with extended sequence number
+    /// seq is in slot seq & (kRingSize - 1)
+    vector<Slot>        m_ring;
+    /// Extended sequence number of the next packet to release
+    int64_t             m_next;
+    /// Highest extended sequence number seen
+    int64_t             m_highest;
+    bool                m_started;
+    uint                m_late;
+
+    uint                m_window;
+    uint                m_bitrate_window;
+
+    /// FEC packets that cover more than one missing packet, for now
+    QList<RTPFECPacket> m_pending_fec;
 
-    /// The key is the RTP sequence number + sequence if applicable
-    QMap<uint64_t, RTPDataPacket> m_unordered_packets;
+    uint                m_released;
+    uint                m_recovered;
+    uint                m_lost;
 };
 
 #endif // _RTP_PACKET_BUFFER_H_
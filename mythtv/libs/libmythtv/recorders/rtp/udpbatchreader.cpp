@@ -0,0 +1,205 @@
+/* -*- Mode: c++ -*-
+ * UDPBatchReader
+ * Distributed as part of MythTV under GPL v2 and later.
+ */
+
+// C++ headers
+#include <algorithm>
+
+// POSIX headers
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#ifdef __linux__
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <time.h>
+#endif
+
+// MythTV headers
+#include "udpbatchreader.h"
+#include "packetbuffer.h"
+#include "mythlogging.h"
+
+#define LOC QString("UDPBatchReader(%1): ").arg(m_fd)
+
+/// Datagrams are read into packets this large to start with: an MPEG-TS
+/// over RTP datagram with an FEC header fits in an ethernet frame.
+static const int kInitialDatagramSize = 2048;
+static const int kMaxDatagramSize     = 65536;
+/// Room for a timestamp and a drop count, in uint64_t so it is aligned
+/// for cmsghdr.
+static const int kControlSize         = 8;
+
+UDPBatchReader::UDPBatchReader(int fd) :
+    m_fd(-1), m_datagram_size(kInitialDatagramSize),
+    m_dropped(0), m_packets(kBatchSize), m_taken(kBatchSize, true)
+{
+#ifdef __linux__
+    m_fd = dup(fd);
+    if (m_fd < 0)
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to duplicate socket " + ENO);
+
+    m_msgs.resize(kBatchSize);
+    m_iovecs.resize(kBatchSize);
+    m_senders.resize(kBatchSize);
+    m_control.resize(kBatchSize * kControlSize);
+#else
+    (void) fd;
+#endif
+}
+
+UDPBatchReader::~UDPBatchReader()
+{
+    if (m_fd >= 0)
+        close(m_fd);
+}
+
+bool UDPBatchReader::IsSupported(void)
+{
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+void UDPBatchReader::SetSocketOptions(int fd)
+{
+#ifdef __linux__
+    int on = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) < 0)
+    {
+        LOG(VB_RECORD, LOG_WARNING, QString("UDPBatchReader(%1): ").arg(fd) +
+            "Unable to enable receive timestamps " + ENO);
+    }
+#ifdef SO_RXQ_OVFL
+    if (setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) < 0)
+    {
+        LOG(VB_RECORD, LOG_WARNING, QString("UDPBatchReader(%1): ").arg(fd) +
+            "Unable to enable drop counts " + ENO);
+    }
+#endif
+#else
+    (void) fd;
+#endif
+}
+
+int UDPBatchReader::Read(PacketBuffer *buffer)
+{
+#ifdef __linux__
+    if (m_fd < 0)
+        return -1;
+
+    for (int i = 0; i < kBatchSize; i++)
+    {
+        if (m_taken[i])
+        {
+            m_packets[i] = buffer->GetEmptyPacket();
+            m_taken[i] = false;
+        }
+
+        // QByteArray only reallocates when growing, so once a packet
+        // has been through the ring this costs nothing
+        QByteArray &data = m_packets[i].GetDataReference();
+        data.resize(m_datagram_size);
+
+        m_iovecs[i].iov_base = data.data();
+        m_iovecs[i].iov_len  = m_datagram_size;
+
+        msghdr &hdr = m_msgs[i].msg_hdr;
+        hdr.msg_name       = &m_senders[i];
+        hdr.msg_namelen    = sizeof(sockaddr_storage);
+        hdr.msg_iov        = &m_iovecs[i];
+        hdr.msg_iovlen     = 1;
+        hdr.msg_control    = &m_control[i * kControlSize];
+        hdr.msg_controllen = kControlSize * sizeof(uint64_t);
+        hdr.msg_flags      = 0;
+        m_msgs[i].msg_len  = 0;
+    }
+
+    // MSG_TRUNC makes msg_len the datagram's real length, so we can
+    // tell when the packets are too small.
+    int count = recvmmsg(m_fd, &m_msgs[0], kBatchSize,
+                         MSG_DONTWAIT | MSG_TRUNC, NULL);
+    if (count < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return 0;
+        LOG(VB_GENERAL, LOG_ERR, LOC + "recvmmsg() failed " + ENO);
+        return -1;
+    }
+
+    int grow_to = 0;
+    for (int i = 0; i < count; i++)
+    {
+        UDPPacket &packet = m_packets[i];
+        int len = m_msgs[i].msg_len;
+        if (len > m_datagram_size)
+        {
+            grow_to = max(grow_to, len);
+            len = 0;
+        }
+        packet.GetDataReference().resize(len);
+        packet.SetArrivalTime(0ULL);
+
+        msghdr &hdr = m_msgs[i].msg_hdr;
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg;
+             cmsg = CMSG_NXTHDR(&hdr, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_SOCKET)
+                continue;
+            if (cmsg->cmsg_type == SCM_TIMESTAMPNS)
+            {
+                timespec ts;
+                memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                packet.SetArrivalTime(
+                    (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+            }
+#ifdef SO_RXQ_OVFL
+            else if (cmsg->cmsg_type == SO_RXQ_OVFL)
+            {
+                // A running total for the socket
+                uint32_t dropped;
+                memcpy(&dropped, CMSG_DATA(cmsg), sizeof(dropped));
+                m_dropped = dropped;
+            }
+#endif
+        }
+    }
+
+    if (grow_to)
+    {
+        int size = m_datagram_size;
+        while (size < grow_to && size < kMaxDatagramSize)
+            size *= 2;
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Dropped a %1 byte datagram, reading up to %2 bytes "
+                    "from now on").arg(grow_to).arg(size));
+        m_datagram_size = size;
+    }
+
+    return count;
+#else
+    (void) buffer;
+    return -1;
+#endif
+}
+
+UDPPacket UDPBatchReader::TakePacket(int i)
+{
+    m_taken[i] = true;
+    UDPPacket packet(m_packets[i]);
+    m_packets[i] = UDPPacket();
+    return packet;
+}
+
+QHostAddress UDPBatchReader::GetSender(int i) const
+{
+#ifdef __linux__
+    return QHostAddress(reinterpret_cast<const sockaddr*>(&m_senders[i]));
+#else
+    (void) i;
+    return QHostAddress();
+#endif
+}
@@ -0,0 +1,85 @@
+/* -*- Mode: c++ -*-
+ * UDPBatchReader
+ * Distributed as part of MythTV under GPL v2 and later.
+ */
+
+#ifndef _UDP_BATCH_READER_H_
+#define _UDP_BATCH_READER_H_
+
+#include <vector>
+using namespace std;
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+#include <QHostAddress>
+
+#include "udppacket.h"
+
+class PacketBuffer;
+
+/** \brief Reads a batch of datagrams from a UDP socket per system call.
+ *
+ *  On Linux recvmmsg() reads straight into a ring of UDPPackets taken
+ *  from a PacketBuffer, so no datagram is copied on its way to
+ *  PushDataPacket() or PushFECPacket(). Each packet is stamped with the
+ *  time the kernel received it, and the count of datagrams the kernel
+ *  dropped because the socket's receive buffer was full is kept.
+ *
+ *  Elsewhere IsSupported() returns false and the socket must be read
+ *  with QUdpSocket.
+ */
+class UDPBatchReader
+{
+  public:
+    /// Reads from a duplicate of "fd", so the caller keeps ownership
+    /// of "fd" and may hand it to a QUdpSocket.
+    explicit UDPBatchReader(int fd);
+    ~UDPBatchReader();
+
+    static bool IsSupported(void);
+
+    /// Asks the kernel for receive timestamps and drop counts on "fd".
+    /// Must be called before any datagram is received.
+    static void SetSocketOptions(int fd);
+
+    /// The file descriptor read from, for a QSocketNotifier.
+    int GetDescriptor(void) const { return m_fd; }
+
+    /** \brief Reads up to kBatchSize pending datagrams without blocking.
+     *
+     *   Empty packets for the ring come from "buffer", which must be
+     *   the same buffer on every call.
+     *  \return The number of datagrams read, 0 if none were pending
+     *          or -1 on error.
+     */
+    int Read(PacketBuffer *buffer);
+
+    /// Returns the i'th datagram of the last Read(). Datagrams too
+    /// large for the ring come back empty. Hand the packet to the
+    /// PacketBuffer, or FreePacket() it.
+    UDPPacket TakePacket(int i);
+    QHostAddress GetSender(int i) const;
+
+    /// Total number of datagrams the kernel dropped on this socket.
+    uint GetDropped(void) const { return m_dropped; }
+
+    static const int kBatchSize = 64;
+
+  private:
+    int                 m_fd;
+    int                 m_datagram_size;
+    uint                m_dropped;
+    vector<UDPPacket>   m_packets;
+    vector<bool>        m_taken;
+#ifdef __linux__
+    vector<mmsghdr>          m_msgs;
+    vector<iovec>            m_iovecs;
+    vector<sockaddr_storage> m_senders;
+    vector<uint64_t>         m_control;
+#endif
+};
+
+#endif // _UDP_BATCH_READER_H_
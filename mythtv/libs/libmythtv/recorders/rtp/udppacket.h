@@ -20,9 +20,10 @@
 class UDPPacket
 {
   public:
-    UDPPacket(const UDPPacket &o) : m_key(o.m_key), m_data(o.m_data) { }
-    UDPPacket(uint64_t key) : m_key(key) { }
-    UDPPacket(void) : m_key(0ULL) { }
+    UDPPacket(const UDPPacket &o) :
+        m_key(o.m_key), m_data(o.m_data), m_arrival(o.m_arrival) { }
+    UDPPacket(uint64_t key) : m_key(key), m_arrival(0ULL) { }
+    UDPPacket(void) : m_key(0ULL), m_arrival(0ULL) { }
     virtual ~UDPPacket() {}
 
     /// IsValid() must return true before any data access methods are called,
@@ -34,10 +35,16 @@ class UDPPacket
     QByteArray &GetDataReference(void) { return m_data; }
     QByteArray GetData(void) const { return m_data; }
 
+    /// Time the kernel received the datagram, in nanoseconds since the
+    /// epoch, or 0 if it isn't known.
+    uint64_t GetArrivalTime(void) const { return m_arrival; }
+    void SetArrivalTime(uint64_t nsecs) { m_arrival = nsecs; }
+
   protected:
     /// Key used to ensure we avoid extra memory allocation in m_data QByteArray
     uint64_t m_key;
     QByteArray m_data;
+    uint64_t   m_arrival;
 };
 
 #endif // _UDP_PACKET_H_
@@ -3,6 +3,7 @@
 // MythTV headers
 #include "streamhandler.h"
 #include "threadedfilewriter.h"
+#include "pespacket.h"
 
 #ifndef O_LARGEFILE
 #define O_LARGEFILE 0
@@ -26,8 +27,12 @@ StreamHandler::StreamHandler(const QString &device) :
     _open_pid_filters(0),
     _mpts_tfw(NULL),
 
-    _listener_lock(QMutex::Recursive)
+    _listener_lock(QMutex::Recursive),
+    _demux_dirty(true),
+    _demux_table(0x2000),
+    _demux_cc_errors(0)
 {
+    memset(_demux_cc, 0xff, sizeof(_demux_cc));
 }
 
 StreamHandler::~StreamHandler()
@@ -92,6 +97,7 @@ void StreamHandler::AddListener(MPEGStreamData *data,
     else
     {
         _stream_data_list[data] = output_file;
+        _demux_dirty = true;
     }
 
     _listener_lock.unlock();
@@ -128,6 +134,7 @@ void StreamHandler::RemoveListener(MPEGStreamData *data)
         if (!(*it).isEmpty())
             RemoveNamedOutputFile(*it);
         _stream_data_list.erase(it);
+        _demux_dirty = true;
     }
 
     _listener_lock.unlock();
@@ -160,6 +167,8 @@ void StreamHandler::Start(void)
         return;
 
     _eit_pids.clear();
+    _demux_cc_errors = 0;
+    memset(_demux_cc, 0xff, sizeof(_demux_cc));
 
     _error = false;
     SetRunningDesired(true);
@@ -181,6 +190,20 @@ void StreamHandler::Stop(void)
     SetRunningDesired(false);
     wait();
     LOG(VB_RECORD, LOG_DEBUG, LOC + "Stopped");
+
+    if (_demux_cc_errors)
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("%1 continuity counter discontinuities in multiplex")
+            .arg(_demux_cc_errors));
+    }
+
+    PESAllocStats stats = pes_alloc_stats();
+    LOG(VB_RECORD, LOG_DEBUG, LOC +
+        QString("PES pools: %1 hits, %2 misses, %3 in use, "
+                "%4 high water, %5 pools")
+        .arg(stats.hits).arg(stats.misses).arg(stats.in_use)
+        .arg(stats.high_water).arg(stats.pools));
 }
 
 bool StreamHandler::IsRunning(void) const
@@ -386,6 +409,199 @@ void StreamHandler::WriteMPTS(unsigned char * buffer, uint len)
     _mpts_tfw->Write(buffer, len);
 }
 
+/** \fn StreamHandler::ProcessDataForListeners(const unsigned char*,int)
+ *  \brief Shared single pass TS demux for all the listeners.
+ *
+ *  Each 188 byte packet in the buffer is synced and has its PID
+ *  decoded exactly once. A dispatch table built from the union of
+ *  the listeners' PID sets is then used to split the packets into
+ *  per listener batches, so each MPEGStreamData only sees the
+ *  packets it would not have discarded itself.
+ *
+ *  Listeners that are fed to PS listeners still get the raw buffer.
+ *
+ *  \return Number of bytes at the end of the buffer which could not
+ *          be processed and should be prepended to the next read.
+ */
+int StreamHandler::ProcessDataForListeners(
+    const unsigned char *buffer, int len)
+{
+    QMutexLocker locker(&_listener_lock);
+
+    if (_demux_dirty || !IsDemuxTableCurrent())
+        UpdateDemuxTable();
+
+    int remainder = 0;
+    for (uint i = 0; i < _demux_raw_listeners.size(); ++i)
+        remainder = _demux_raw_listeners[i]->ProcessData(buffer, len);
+
+    if (_demux_listeners.empty())
+        return remainder;
+
+    _demux_packets.clear();
+    for (uint i = 0; i < _demux_listeners.size(); ++i)
+        _demux_listeners[i]._packets.clear();
+
+    // Sync and split the buffer once for all listeners
+    int pos = 0;
+    bool resync = false;
+    remainder = -1;
+    while (pos + int(TSPacket::kSize) <= len)
+    { // while we have a whole packet left...
+        if (buffer[pos] != SYNC_BYTE || resync)
+        {
+            int newpos = MPEGStreamData::ResyncStream(buffer, pos+1, len);
+            LOG(VB_RECORD, LOG_DEBUG, LOC +
+                QString("Resyncing @ %1+1 w/len %2 -> %3")
+                .arg(pos).arg(len).arg(newpos));
+            if (newpos == -1)
+            {
+                remainder = len - pos;
+                break;
+            }
+            if (newpos == -2)
+            {
+                remainder = TSPacket::kSize;
+                break;
+            }
+            pos = newpos;
+        }
+
+        // Decode the headers of the whole run of in sync packets
+        pos += _demux_batch.Parse(&buffer[pos], len - pos);
+        resync = false;
+
+        _demux_cc_errors += _demux_batch.CheckContinuity(_demux_cc);
+
+        const uint count = _demux_batch.Size();
+        for (uint j = 0; j < count; ++j)
+        {
+            uint idx = _demux_packets.size();
+            _demux_packets.push_back(_demux_batch.Packet(j));
+
+            const vector<uint> &targets = _demux_table[_demux_batch.PID(j)];
+            for (uint i = 0; i < targets.size(); ++i)
+                _demux_listeners[targets[i]]._packets.push_back(idx);
+        }
+
+        // If a packet with a transport error is not followed by a
+        // sync byte, resync starting just after its own sync byte.
+        if (_demux_batch.TransportError(count - 1) &&
+            (pos + int(TSPacket::kSize) <= len) &&
+            (buffer[pos] != SYNC_BYTE))
+        {
+            pos -= TSPacket::kSize;
+            resync = true;
+        }
+    }
+    if (remainder < 0)
+        remainder = len - pos;
+
+    // Hand each listener its batch
+    for (uint i = 0; i < _demux_listeners.size(); ++i)
+    {
+        StreamDemuxListener &listener = _demux_listeners[i];
+        MPEGStreamData *sd = listener._data;
+        for (uint j = 0; j < listener._packets.size(); ++j)
+        {
+            uint idx = listener._packets[j];
+            sd->ProcessTSPacket(*_demux_packets[idx]);
+            if (sd->PIDVersion() != listener._pid_version)
+            {
+                // A table in this batch changed the PID set, the rest
+                // of the buffer has to be filtered against the new set.
+                ProcessNewPIDs(listener, idx + 1);
+                _demux_dirty = true;
+                break;
+            }
+        }
+    }
+
+    return remainder;
+}
+
+/** \fn StreamHandler::ProcessNewPIDs(StreamDemuxListener&,uint)
+ *  \brief Slow path for a listener whose PID set changed mid buffer.
+ *
+ *  Processes the packets of the current buffer starting at index
+ *  \p first that are on one of the listener's current PIDs.
+ */
+void StreamHandler::ProcessNewPIDs(StreamDemuxListener &listener, uint first)
+{
+    MPEGStreamData *sd = listener._data;
+    vector<bool> wanted;
+    uint version = sd->PIDVersion() + 1;
+
+    for (uint idx = first; idx < _demux_packets.size(); ++idx)
+    {
+        if (sd->PIDVersion() != version)
+        {
+            version = sd->PIDVersion();
+            pid_map_t pids;
+            sd->GetPIDs(pids);
+            wanted.assign(0x2000, false);
+            pid_map_t::const_iterator it = pids.constBegin();
+            for (; it != pids.constEnd(); ++it)
+                wanted[it.key() & 0x1fff] = true;
+        }
+
+        const TSPacket *pkt = _demux_packets[idx];
+        if (wanted[pkt->PID()])
+            sd->ProcessTSPacket(*pkt);
+    }
+}
+
+/// Returns false if any listener has changed its PID set since the
+/// dispatch table was last built.
+bool StreamHandler::IsDemuxTableCurrent(void) const
+{
+    for (uint i = 0; i < _demux_listeners.size(); ++i)
+    {
+        const StreamDemuxListener &listener = _demux_listeners[i];
+        if (listener._data->PIDVersion() != listener._pid_version)
+            return false;
+    }
+    return true;
+}
+
+/// Rebuilds the PID to listener dispatch table from the union of the
+/// listeners' PID sets. \note: The _listener_lock must be held.
+void StreamHandler::UpdateDemuxTable(void)
+{
+    for (uint i = 0; i < _demux_table_pids.size(); ++i)
+        _demux_table[_demux_table_pids[i]].clear();
+    _demux_table_pids.clear();
+    _demux_listeners.clear();
+    _demux_raw_listeners.clear();
+
+    StreamDataList::const_iterator it = _stream_data_list.begin();
+    for (; it != _stream_data_list.end(); ++it)
+    {
+        MPEGStreamData *sd = it.key();
+        if (sd->HasPSListeners())
+        {
+            _demux_raw_listeners.push_back(sd);
+            continue;
+        }
+
+        uint listener_idx = _demux_listeners.size();
+        _demux_listeners.push_back(StreamDemuxListener(sd));
+
+        pid_map_t pids;
+        sd->GetPIDs(pids);
+        pid_map_t::const_iterator pit = pids.constBegin();
+        for (; pit != pids.constEnd(); ++pit)
+        {
+            uint pid = pit.key() & 0x1fff;
+            if (_demux_table[pid].empty())
+                _demux_table_pids.push_back(pid);
+            _demux_table[pid].push_back(listener_idx);
+        }
+    }
+
+    _demux_dirty = false;
+}
+
 bool StreamHandler::AddNamedOutputFile(const QString &file)
 {
 #if !defined( USING_MINGW ) && !defined( _MSC_VER )
@@ -13,6 +13,7 @@ using namespace std;
 
 #include "DeviceReadBuffer.h" // for ReaderPausedCB
 #include "mpegstreamdata.h" // for PIDPriority
+#include "tsheaderbatch.h"
 #include "mthread.h"
 #include "mythdate.h"
 
@@ -47,6 +48,25 @@ class PIDInfo
 // iterator returning these in order of ascending pid number.
 typedef QMap<uint,PIDInfo*> PIDInfoMap;
 
+/** \brief Per listener state used by the shared TS demux.
+ *
+ *  Holds the indexes of the packets in the current buffer that are
+ *  on one of the PIDs the listener is interested in, and the PID
+ *  version of the listener when the dispatch table was built.
+ */
+class StreamDemuxListener
+{
+  public:
+    StreamDemuxListener() : _data(NULL), _pid_version(0) {;}
+    explicit StreamDemuxListener(MPEGStreamData *data) :
+        _data(data), _pid_version(data->PIDVersion()) {;}
+
+    MPEGStreamData *_data;
+    uint            _pid_version;
+    vector<uint>    _packets;
+};
+typedef vector<StreamDemuxListener> StreamDemuxListeners;
+
 // locking order
 // _pid_lock -> _listener_lock
 // _add_rm_lock -> _listener_lock
@@ -100,11 +120,20 @@ class StreamHandler : protected MThread, public DeviceReaderCB
   protected:
     /// Write out a copy of the raw MPTS
     void WriteMPTS(unsigned char * buffer, uint len);
+    /// Demultiplexes the buffer once and hands each listener only
+    /// the packets on PIDs it uses. Returns the unprocessed remainder.
+    /// \note: The _listener_lock must be held when this is called.
+    int  ProcessDataForListeners(const unsigned char *buffer, int len);
     /// At minimum this sets _running_desired, this may also send
     /// signals to anything that might be blocking the run() loop.
     /// \note: The _start_stop_lock must be held when this is called.
     void SetRunningDesired(bool desired);
 
+  private:
+    void UpdateDemuxTable(void);
+    bool IsDemuxTableCurrent(void) const;
+    void ProcessNewPIDs(StreamDemuxListener &listener, uint first);
+
   protected:
     QString           _device;
     bool              _needs_buffering;
@@ -134,6 +163,17 @@ class StreamHandler : protected MThread, public DeviceReaderCB
     typedef QMap<MPEGStreamData*,QString> StreamDataList;
     mutable QMutex    _listener_lock;
     StreamDataList    _stream_data_list;
+
+    // Shared demux, protected by _listener_lock
+    bool                    _demux_dirty;
+    StreamDemuxListeners    _demux_listeners;
+    vector<MPEGStreamData*> _demux_raw_listeners;
+    vector<vector<uint> >   _demux_table;
+    vector<uint>            _demux_table_pids;
+    vector<const TSPacket*> _demux_packets;
+    TSHeaderBatch           _demux_batch;
+    unsigned char           _demux_cc[0x1fff + 1];
+    uint                    _demux_cc_errors;
 };
 
 #endif // _STREAM_HANDLER_H_
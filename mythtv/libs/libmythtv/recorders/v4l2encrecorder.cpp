@@ -316,6 +316,7 @@ bool V4L2encRecorder::StartEncoding(void)
 {
     LOG(VB_RECORD, LOG_DEBUG, LOC + "V4L2encRecorder::StartEncoding() -- begin");
     m_h264_parser.Reset();
+    m_hevc_parser.Reset();
     _wait_for_keyframe_option = true;
     _seen_sps = false;
 
@@ -319,11 +319,9 @@ void V4L2encStreamHandler::run(void)
             continue;
         }
 
-        StreamDataList::const_iterator sit = _stream_data_list.begin();
-        for (; sit != _stream_data_list.end(); ++sit)
-            remainder = sit.key()->ProcessData
-                        (reinterpret_cast<const uint8_t *>
-                         (buffer.constData()), len);
+        remainder = ProcessDataForListeners
+                    (reinterpret_cast<const uint8_t *>
+                     (buffer.constData()), len);
 
         _listener_lock.unlock();
 
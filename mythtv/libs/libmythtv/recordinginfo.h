@@ -99,6 +99,17 @@ class MTV_PUBLIC RecordingInfo : public ProgramInfo
         desiredrecendts(endts),
         record(NULL),
         m_recordingFile(NULL)  { LoadRecordingFile(); }
+    RecordingInfo(ProgramInfoReader &in) :
+        ProgramInfo(in),
+        oldrecstatus(RecStatus::Unknown),
+        savedrecstatus(RecStatus::Unknown),
+        future(false),
+        schedorder(0),
+        mplexid(0),
+        desiredrecstartts(startts),
+        desiredrecendts(endts),
+        record(NULL),
+        m_recordingFile(NULL)  { LoadRecordingFile(); }
     /// Create RecordingInfo from 'program'+'record'+'channel' tables,
     /// used in scheduler.cpp @ ~ 3296
     RecordingInfo(
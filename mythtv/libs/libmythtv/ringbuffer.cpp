@@ -1627,6 +1627,62 @@ int RingBuffer::Read(void *buf, int count)
     return ret;
 }
 
+/** \fn RingBuffer::SendDirect(int, int)
+ *  \brief Sends data from the current read position straight to a
+ *         socket or other file descriptor, without copying it through
+ *         a user space buffer.
+ *
+ *   This may only be used when IsSendDirectAllowed() returns true,
+ *   the read position is advanced just as with Read().
+ *  \param fd    File descriptor to send the data to
+ *  \param count Number of bytes to send
+ *  \return Returns number of bytes sent, or -1 on error with errno
+ *          set. EINVAL or ENOSYS mean Read() must be used instead.
+ */
+int RingBuffer::SendDirect(int fd, int count)
+{
+    // we need a write lock so nothing can muck with the file
+    // position while the kernel is sending from it.
+    rwlock.lockForWrite();
+    if (writemode || readaheadrunning || (ignorereadpos >= 0) ||
+        !IsSendDirectAllowed())
+    {
+        rwlock.unlock();
+        errno = EINVAL;
+        return -1;
+    }
+
+    MythTimer timer;
+    timer.start();
+    int ret = safe_send(fd, count);
+    int elapsed = timer.elapsed();
+    if (ret > 0)
+    {
+        uint64_t bps = !elapsed ? 1000000001 :
+                       (uint64_t)(((float)ret * 8000.0) / (float)elapsed);
+        UpdateStorageRate(bps);
+    }
+    rwlock.unlock();
+
+    if (ret > 0)
+    {
+        poslock.lockForWrite();
+        readpos += ret;
+        poslock.unlock();
+        UpdateDecoderRate(ret);
+    }
+
+    return ret;
+}
+
+/// Sends \p sz bytes from the file to \p fd, see SendDirect().
+/// The default implementation does not support this.
+int RingBuffer::safe_send(int /*fd*/, uint /*sz*/)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
 QString RingBuffer::BitrateToString(uint64_t rate, bool hz)
 {
     QString msg;
@@ -92,6 +92,8 @@ class MTV_PUBLIC RingBuffer : protected MThread
     virtual bool IsSeekingAllowed(void) { return true;  }
     virtual bool IsBookmarkAllowed(void) { return true; }
     virtual int  BestBufferSize(void)   { return 32768; }
+    /// \brief Returns true if SendDirect() can be used on this buffer.
+    virtual bool IsSendDirectAllowed(void) const { return false; }
     static QString BitrateToString(uint64_t rate, bool hz = false);
     RingBufferType GetType() const { return type; }
 
@@ -129,6 +131,7 @@ class MTV_PUBLIC RingBuffer : protected MThread
 
     int  Read(void *buf, int count);
     int  Peek(void *buf, int count); // only works with readahead
+    int  SendDirect(int fd, int count); // only works without readahead
 
     void Reset(bool full          = false,
                bool toAdjust      = false,
@@ -178,6 +181,7 @@ class MTV_PUBLIC RingBuffer : protected MThread
     void CalcReadAheadThresh(void);
     bool PauseAndWait(void);
     virtual int safe_read(void *data, uint sz) = 0;
+    virtual int safe_send(int fd, uint sz);
 
     int ReadPriv(void *buf, int count, bool peek);
     int ReadDirect(void *buf, int count, bool peek);
@@ -0,0 +1,192 @@
+/*
+ *  Class TestEITCache
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_eitcache.h"
+
+#include <unistd.h>
+
+#include "mythdirs.h"
+#include "mythdate.h"
+
+void TestEITCache::initTestCase(void)
+{
+    m_confDir = QDir::tempPath() +
+        QString("/test_eitcache.%1").arg(getpid());
+    QVERIFY(QDir().mkpath(m_confDir));
+    setenv("MYTHCONFDIR", m_confDir.toLocal8Bit().constData(), 1);
+    InitializeMythDirs();
+    QCOMPARE(GetConfDir(), m_confDir);
+
+    m_now = MythDate::current().toTime_t();
+}
+
+void TestEITCache::cleanupTestCase(void)
+{
+    QFile::remove(EITCache::SnapshotFilename());
+    QDir().rmdir(m_confDir + "/cache");
+    QDir().rmdir(m_confDir);
+}
+
+void TestEITCache::scan(EITCache &cache) const
+{
+    EITEventTable *news = new EITEventTable();
+    for (uint i = 1; i <= 300; ++i)
+        news->insert(i, sig(0x50, i % 32, m_now + i * 60));
+    cache.GetShard(1001).channelMap[1001] = news;
+
+    // Not written to the database yet
+    EITEventTable *films = new EITEventTable();
+    for (uint i = 0; i < 10; ++i)
+        films->insert(5000 + i,
+                      sig(0x51, 3, m_now + 86400) | ((uint64_t) 1 << 63));
+    cache.GetShard(1002).channelMap[1002] = films;
+}
+
+void TestEITCache::forget(EITCache &cache)
+{
+    for (uint i = 0; i < EITCache::kShardCount; ++i)
+    {
+        qDeleteAll(cache.shards[i].channelMap);
+        cache.shards[i].channelMap.clear();
+    }
+}
+
+void TestEITCache::eventTable_test(void)
+{
+    EITEventTable table;
+    for (uint i = 0; i < 1000; ++i)
+        table.insert(i * 7, sig(0x4e, 1, 1000 + i));
+
+    QCOMPARE(table.size(), 1000U);
+    QCOMPARE(table.capacity() & (table.capacity() - 1), 0U);
+    QVERIFY(table.size() * 4 <= table.capacity() * 3);
+
+    for (uint i = 0; i < 1000; ++i)
+    {
+        uint64_t *found = table.find(i * 7);
+        QVERIFY(found);
+        QCOMPARE(*found, sig(0x4e, 1, 1000 + i));
+    }
+    QVERIFY(!table.find(1));
+    QVERIFY(!table.find(7000));
+
+    table.insert(14, sig(0x4e, 2, 1002));
+    QCOMPARE(table.size(), 1000U);
+    QCOMPARE(*table.find(14), sig(0x4e, 2, 1002));
+
+    // Ending at or before 1499
+    QCOMPARE(table.Prune(1499), 500U);
+    QCOMPARE(table.size(), 500U);
+    QVERIFY(!table.find(499 * 7));
+    QVERIFY(table.find(500 * 7));
+    QCOMPARE(table.Prune(1499), 0U);
+
+    QCOMPARE(table.Prune(2000), 500U);
+    QCOMPARE(table.size(), 0U);
+    QVERIFY(!table.find(999 * 7));
+}
+
+void TestEITCache::snapshotRoundTrip_test(void)
+{
+    {
+        EITCache cache;
+        scan(cache);
+        cache.WriteSnapshot();
+        forget(cache);
+    }
+
+    EITCache cache;
+    QVERIFY(cache.ReadSnapshot(EITCache::SnapshotFilename(), m_now));
+    QCOMPARE(cache.snapshotMap.size(), 2);
+
+    EITEventTable *news = cache.snapshotMap.value(1001);
+    QVERIFY(news);
+    QCOMPARE(news->size(), 300U);
+    for (uint i = 1; i <= 300; ++i)
+    {
+        QVERIFY(news->find(i));
+        QCOMPARE(*news->find(i), sig(0x50, i % 32, m_now + i * 60));
+    }
+
+    EITEventTable *films = cache.snapshotMap.value(1002);
+    QVERIFY(films);
+    QCOMPARE(films->size(), 10U);
+    QCOMPARE(*films->find(5009), sig(0x51, 3, m_now + 86400));
+}
+
+void TestEITCache::snapshotPrune_test(void)
+{
+    {
+        EITCache cache;
+        scan(cache);
+        cache.WriteSnapshot();
+        forget(cache);
+    }
+
+    EITCache cache;
+    QVERIFY(cache.ReadSnapshot(EITCache::SnapshotFilename(),
+                               m_now + 150 * 60));
+
+    EITEventTable *news = cache.snapshotMap.value(1001);
+    QVERIFY(news);
+    QCOMPARE(news->size(), 150U);
+    QVERIFY(!news->find(150));
+    QVERIFY(news->find(151));
+    QCOMPARE(cache.snapshotMap.value(1002)->size(), 10U);
+}
+
+void TestEITCache::snapshotCheck_test(void)
+{
+    {
+        EITCache cache;
+        scan(cache);
+        cache.WriteSnapshot();
+        forget(cache);
+    }
+
+    EITCache cache;
+    QVERIFY(cache.ReadSnapshot(EITCache::SnapshotFilename(), m_now));
+
+    QMap<uint, uint> dbCounts;
+    dbCounts[1001] = 300;
+    dbCounts[1002] = 4;
+    cache.CheckSnapshot(dbCounts);
+    QCOMPARE(cache.snapshotMap.keys(), QList<uint>() << 1001);
+
+    // The eit_cache table was emptied
+    cache.CheckSnapshot(QMap<uint, uint>());
+    QVERIFY(cache.snapshotMap.empty());
+}
+
+void TestEITCache::unknownSnapshot_test(void)
+{
+    QString filename = EITCache::SnapshotFilename();
+    QFile::remove(filename);
+
+    EITCache cache;
+    QVERIFY(!cache.ReadSnapshot(filename, m_now));
+
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("This is not a snapshot");
+    file.close();
+    QVERIFY(!cache.ReadSnapshot(filename, m_now));
+    QVERIFY(cache.snapshotMap.empty());
+}
+
+QTEST_APPLESS_MAIN(TestEITCache)
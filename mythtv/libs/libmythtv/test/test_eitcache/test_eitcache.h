@@ -0,0 +1,66 @@
+/*
+ *  Class TestEITCache
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "eitcache.h"
+
+/**
+ * The snapshot tests write to a configuration directory of their own,
+ * and never reach the database.
+ */
+class TestEITCache : public QObject
+{
+    Q_OBJECT
+
+  private:
+    static uint64_t sig(uint tableid, uint version, uint endtime)
+    {
+        return ((uint64_t) tableid << 40) | ((uint64_t) version << 32) |
+            endtime;
+    }
+
+    /// Gives cache the events of two channels, as scanned
+    void scan(EITCache &cache) const;
+
+    /// Empties cache, so its destructor has nothing to write to the
+    /// database
+    static void forget(EITCache &cache);
+
+    QString m_confDir;
+    uint    m_now;
+
+  private slots:
+    void initTestCase(void);
+
+    /** finds, replaces and prunes events, past a few rehashes */
+    void eventTable_test(void);
+
+    /** every entry of every channel comes back, marked as written */
+    void snapshotRoundTrip_test(void);
+
+    /** entries which ended by the prune time are not read */
+    void snapshotPrune_test(void);
+
+    /** a channel which changed in the database is loaded from there */
+    void snapshotCheck_test(void);
+
+    void unknownSnapshot_test(void);
+
+    void cleanupTestCase(void);
+};
@@ -751,4 +751,179 @@ void TestEITFixups::testATV()
 
 }
 
+// Title, subtitle and description of typical UK events, with some of
+// the text each of the UK expressions looks for
+static const char *ukEvents[][3] =
+{
+    { "Book of the Week", "",
+      "Girl in the Dark: Anna Lyndsey's account of finding light in the "
+      "darkness after illness changed her life. 3/5. A Descent into "
+      "Darkness: The disquieting persistence of the light." },
+    { "Hoarders", "",
+      "Fascinating series chronicling the lives of serial hoarders. Often "
+      "facing loss of their children, career, or divorce, can people with "
+      "this disorder be helped? S3, Ep1" },
+    { "New: Marvel's Agents of...", "",
+      "...S.H.I.E.L.D. Brand new series - Bouncing Back: <description> "
+      "(S3 Ep11/22)  [AD,S]" },
+    { "Law & Order: Special Victims Unit", "",
+      "Sugar: New. Police drama series about an elite sex crime  ..." },
+    { "The Film Review", "",
+      "Western starring John Wayne and Dean Martin. (1959) Also in HD." },
+    { "Storyville", "",
+      "The Lost Tapes: Part 2 of 3. Documentary. BBC FOUR on BBC TWO." },
+    { "Newsnight", "",
+      "In-depth investigation and analysis of the stories behind the day's "
+      "headlines. Then 60 Seconds." },
+    { "Heir Hunters", "",
+      "All New To 4Music! The team try to trace the relatives of a woman "
+      "who died without leaving a will. [Rpt of Mon 3.15pm]." },
+    { "Homes Under the Hammer", "",
+      "Property series. Dion Dublin and Martel Maxwell visit a flat in "
+      "Surrey and a cottage in Somerset." },
+    { "Weather for the Week Ahead", "",
+      "Detailed weather forecast." },
+};
+
+static QString credits(const DBEventEIT &event)
+{
+    QStringList names;
+    if (event.credits)
+    {
+        DBCredits::const_iterator it = event.credits->begin();
+        for (; it != event.credits->end(); ++it)
+            names << (*it).GetRole() + ':' + (*it).GetName();
+    }
+    return names.join(",");
+}
+
+/// Checks that "fix" gives the same results with and without the
+/// keyword prefilter on each of "count" title, subtitle and description
+void TestEITFixups::comparePrefilter(FixupValue fix,
+                                     const char *events[][3], uint count)
+{
+    EITFixUp fixup;
+    EITFixUp exhaustive;
+    exhaustive.SetPrefilter(false);
+
+    for (uint i = 0; i < count; ++i)
+    {
+        DBEventEIT *event = SimpleDBEventEIT(fix, events[i][0],
+                                             events[i][1], events[i][2]);
+        DBEventEIT *event2 = SimpleDBEventEIT(fix, events[i][0],
+                                              events[i][1], events[i][2]);
+        fixup.Fix(*event);
+        exhaustive.Fix(*event2);
+        PRINT_EVENT(*event);
+
+        QCOMPARE(event->title,           event2->title);
+        QCOMPARE(event->subtitle,        event2->subtitle);
+        QCOMPARE(event->description,     event2->description);
+        QCOMPARE(event->category,        event2->category);
+        QCOMPARE(event->season,          event2->season);
+        QCOMPARE(event->episode,         event2->episode);
+        QCOMPARE(event->totalepisodes,   event2->totalepisodes);
+        QCOMPARE(event->partnumber,      event2->partnumber);
+        QCOMPARE(event->parttotal,       event2->parttotal);
+        QCOMPARE(event->airdate,         event2->airdate);
+        QCOMPARE(event->originalairdate, event2->originalairdate);
+        QCOMPARE(event->previouslyshown, event2->previouslyshown);
+        QCOMPARE(event->subtitleType,    event2->subtitleType);
+        QCOMPARE(event->audioProps,      event2->audioProps);
+        QCOMPARE(event->videoProps,      event2->videoProps);
+        QCOMPARE(credits(*event),        credits(*event2));
+        delete event;
+        delete event2;
+    }
+}
+
+void TestEITFixups::testUKPrefilter()
+{
+    comparePrefilter(EITFixUp::kFixUK, ukEvents,
+                     sizeof(ukEvents) / sizeof(ukEvents[0]));
+}
+
+// Dutch events, with the text each of the NL expressions looks for
+static const char *nlEvents[][3] =
+{
+    { "Journaal HD", "",
+      "Nieuws/actualiteiten. Het laatste nieuws. stereo txt" },
+    { "Flikken Maastricht", "Afl.: De overval.",
+      " Serie/soap. Politieserie. Met: Angela Schijf, Victor Reinier "
+      "e.a. herh. breedbeeld" },
+    { "De Wereld Draait Door (VARA)", "",
+      " Presentatie: Matthijs van Nieuwkerk en Sophie Hilbrand. "
+      "Praatprogramma. (Stereo)" },
+    { "Film: Casablanca", "",
+      " \"Here's looking at you\" Film. Amerikaanse film (USA/1942) "
+      "uit 1942 van Michael Curtiz. ( - )" },
+    { "Sportjournaal", "", "Het laatste sportnieuws." },
+};
+
+void TestEITFixups::testNLPrefilter()
+{
+    comparePrefilter(EITFixUp::kFixNL, nlEvents,
+                     sizeof(nlEvents) / sizeof(nlEvents[0]));
+}
+
+// Danish events, with the text each of the DK expressions looks for
+static const char *dkEvents[][3] =
+{
+    { "Borgen (4:10)", "",
+      "Dansk dramaserie. S\xE6son 2. Medvirkende: Sidse Babett Knudsen, "
+      "Birgitte Hjort S\xF8rensen og Pilou Asb\xE6k. "
+      "Instrukt\xF8r: S\xF8ren Kragh-Jacobsen. Features: 16:9 HD 5:1 TTV" },
+    { "Matador: Skyggespil (17)", "",
+      "Dansk dramaserie fra 1978. Medv.: J\xF8rgen Buckh\xF8j. "
+      "Features: S (G)" },
+    { "Arvingerne - Den sorte enke", "",
+      "Dansk dramaserie - \xE5r 2 : Instr.: Pernille Fischer Christensen." },
+    { "TV Avisen", "", "Nyheder." },
+};
+
+void TestEITFixups::testDKPrefilter()
+{
+    comparePrefilter(EITFixUp::kFixDK, dkEvents,
+                     sizeof(dkEvents) / sizeof(dkEvents[0]));
+}
+
+void TestEITFixups::benchmarkUK_data()
+{
+    QTest::addColumn<bool>("prefilter");
+
+    QTest::newRow("Prefilter") << true;
+    QTest::newRow("Exhaustive") << false;
+}
+
+void TestEITFixups::benchmarkUK()
+{
+    QFETCH(bool, prefilter);
+
+    EITFixUp fixup;
+    fixup.SetPrefilter(prefilter);
+
+    const uint count = sizeof(ukEvents) / sizeof(ukEvents[0]);
+
+    QElapsedTimer timer;
+    timer.start();
+    uint64_t fixed = 0;
+    QBENCHMARK
+    {
+        for (uint i = 0; i < count; ++i)
+        {
+            // DBEvent has no copy constructor, so build each one afresh
+            DBEventEIT *event = SimpleDBEventEIT(EITFixUp::kFixUK,
+                                                 ukEvents[i][0],
+                                                 ukEvents[i][1],
+                                                 ukEvents[i][2]);
+            fixup.Fix(*event);
+            delete event;
+        }
+        fixed += count;
+    }
+    qint64 ns = timer.nsecsElapsed();
+    qDebug() << QString("%1 events/sec")
+        .arg(ns ? (fixed * 1000000000.0 / ns) : 0.0, 0, 'f', 0);
+}
+
 QTEST_APPLESS_MAIN(TestEITFixups)
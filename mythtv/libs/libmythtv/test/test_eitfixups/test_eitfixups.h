@@ -52,7 +52,14 @@ class TestEITFixups : public QObject
     void testUnitymedia(void);
     void testDeDisneyChannel(void);
     void testATV(void);
+    void testUKPrefilter(void);
+    void testNLPrefilter(void);
+    void testDKPrefilter(void);
+    void benchmarkUK_data(void);
+    void benchmarkUK(void);
 
   private:
     static DBEventEIT *SimpleDBEventEIT (FixupValue fix, QString title, QString subtitle, QString description);
+    static void comparePrefilter(FixupValue fix, const char *events[][3],
+                                 uint count);
 };
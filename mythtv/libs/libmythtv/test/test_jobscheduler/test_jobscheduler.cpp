@@ -0,0 +1,206 @@
+/*
+ *  Class TestJobScheduler
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_jobscheduler.h"
+
+#include "jobscheduler.h"
+#include "mythdate.h"
+
+typedef QMap<QString, QPair<quint64, quint64> > DiskMap;
+
+void TestJobScheduler::cpu_stat(void)
+{
+    QByteArray stat =
+        "cpu  100 20 30 800 50 0 0 0 0 0\n"
+        "cpu0 50 10 15 400 25 0 0 0 0 0\n"
+        "intr 12345\n";
+
+    quint64 busy = 0, total = 0;
+    QVERIFY(JobScheduler::ParseCPUStat(stat, busy, total));
+    QCOMPARE(total, (quint64)1000);
+    // idle and iowait aren't busy
+    QCOMPARE(busy, (quint64)150);
+
+    QVERIFY(!JobScheduler::ParseCPUStat("intr 12345\n", busy, total));
+    QVERIFY(!JobScheduler::ParseCPUStat("", busy, total));
+}
+
+void TestJobScheduler::disk_stats(void)
+{
+    QByteArray diskstats =
+        "   8       0 sda 1000 10 8000 500 2000 20 16000 3000 0 1500 3500\n"
+        "   8       1 sda1 900 10 7000 400 1900 20 15000 2900 0 1400 3300\n"
+        "   7       0 loop0 10 0 80 1 0 0 0 0 0 1 1\n"
+        " 259       0 nvme0n1 5 0 40 1 7 0 56\n";
+
+    DiskMap disks;
+    JobScheduler::ParseDiskStats(diskstats, disks);
+
+    QCOMPARE(disks.size(), 2);
+    QVERIFY(disks.contains("sda"));
+    QVERIFY(disks.contains("sda1"));
+    QCOMPARE(disks["sda"].first, (quint64)2000);
+    QCOMPARE(disks["sda"].second, (quint64)3000);
+}
+
+void TestJobScheduler::write_latency(void)
+{
+    DiskMap before, after;
+    before["sda"] = qMakePair((quint64)1000, (quint64)5000);
+    after ["sda"] = qMakePair((quint64)1100, (quint64)6000);
+    before["sdb"] = qMakePair((quint64)1000, (quint64)5000);
+    after ["sdb"] = qMakePair((quint64)1200, (quint64)5400);
+    // too few writes to count
+    before["sdc"] = qMakePair((quint64)1000, (quint64)5000);
+    after ["sdc"] = qMakePair((quint64)1002, (quint64)7000);
+    // new device
+    after ["sdd"] = qMakePair((quint64)100, (quint64)90000);
+
+    QCOMPARE(JobScheduler::WriteLatency(before, after), 10.0);
+    QCOMPARE(JobScheduler::WriteLatency(DiskMap(), after), 0.0);
+}
+
+void TestJobScheduler::proc_stat(void)
+{
+    QByteArray stat =
+        "4242 (my (job) x) S 4000 4242 4000 0 -1 4194560 1000 0 0 0 "
+        "150 25 0 0 20 0 1 0 100 1000000 200\n";
+
+    qint64 ppid = 0;
+    quint64 ticks = 0;
+    QVERIFY(JobScheduler::ParseProcStat(stat, ppid, ticks));
+    QCOMPARE(ppid, (qint64)4000);
+    QCOMPARE(ticks, (quint64)175);
+
+    QVERIFY(!JobScheduler::ParseProcStat("4242 (job) S 1 2", ppid, ticks));
+    QVERIFY(!JobScheduler::ParseProcStat("", ppid, ticks));
+}
+
+void TestJobScheduler::proc_io(void)
+{
+    QByteArray io =
+        "rchar: 100000\n"
+        "wchar: 200000\n"
+        "syscr: 10\n"
+        "syscw: 20\n"
+        "read_bytes: 4096\n"
+        "write_bytes: 8192\n"
+        "cancelled_write_bytes: 0\n";
+
+    quint64 readBytes = 0, writeBytes = 0;
+    JobScheduler::ParseProcIO(io, readBytes, writeBytes);
+    QCOMPARE(readBytes, (quint64)4096);
+    QCOMPARE(writeBytes, (quint64)8192);
+}
+
+static JobQueueEntry make_job(int id, int type, int status, qint64 filesize)
+{
+    JobQueueEntry job;
+    job.id       = id;
+    job.chanid   = 1000 + id;
+    job.type     = type;
+    job.cmds     = JOB_RUN;
+    job.flags    = 0;
+    job.status   = status;
+    job.filesize = filesize;
+    return job;
+}
+
+void TestJobScheduler::rank(void)
+{
+    static const qint64 kGB = 1024LL * 1024 * 1024;
+
+    QMap<int, JobQueueEntry> jobs;
+    jobs[0] = make_job(1, JOB_TRANSCODE, JOB_QUEUED,  1 * kGB);
+    jobs[1] = make_job(2, JOB_USERJOB1,  JOB_QUEUED,  2 * kGB);
+    jobs[2] = make_job(3, JOB_COMMFLAG,  JOB_QUEUED,  4 * kGB);
+    jobs[3] = make_job(4, JOB_TRANSCODE, JOB_RUNNING, 8 * kGB);
+    jobs[4] = make_job(5, JOB_COMMFLAG,  JOB_QUEUED,  1 * kGB);
+    jobs[5] = make_job(6, JOB_METADATA,  JOB_QUEUED,  0);
+
+    JobScheduler scheduler;
+    QList<int> order = scheduler.Rank(jobs);
+
+    // The running job comes first, then metadata and commflag jobs
+    // shortest first, then the user job, then the transcode
+    QList<int> expected;
+    expected << 3 << 5 << 4 << 2 << 1 << 0;
+    QCOMPARE(order, expected);
+
+    // Learnt rates change the expected run time
+    QVERIFY(scheduler.ExpectedSecs(JOB_TRANSCODE, kGB) > 60);
+    scheduler.JobFinished(1, JOB_TRANSCODE, kGB, 16384);
+    QCOMPARE(scheduler.ExpectedSecs(JOB_TRANSCODE, kGB), 16);
+}
+
+void TestJobScheduler::resume(void)
+{
+    JobScheduler scheduler;
+    scheduler.m_enabled = true;
+    scheduler.m_maxWriteLatency = 150.0;
+    scheduler.m_jobUsage[1].writeRate = 1000000.0;
+    scheduler.m_jobUsage[2].writeRate = 10.0;
+    scheduler.SetThrottled(1, true);
+
+    QList<int> pause, resume;
+    QString reason;
+
+    // Over the limit, the job that is still running gets paused too
+    scheduler.m_writeLatency = 160.0;
+    scheduler.Throttle(pause, resume, reason);
+    QCOMPARE(pause, QList<int>() << 2);
+    QVERIFY(resume.isEmpty());
+
+    // Under the limit, even if not by much, one job at a time resumes
+    pause.clear();
+    scheduler.SetThrottled(2, true);
+    scheduler.m_writeLatency = 100.0;
+    scheduler.Throttle(pause, resume, reason);
+    QVERIFY(pause.isEmpty());
+    QCOMPARE(resume.size(), 1);
+}
+
+void TestJobScheduler::max_pause(void)
+{
+    JobScheduler scheduler;
+    scheduler.m_enabled = true;
+    scheduler.m_maxWriteLatency = 150.0;
+    scheduler.m_writeLatency = 300.0;
+    scheduler.m_jobUsage[1].writeRate = 1000000.0;
+    scheduler.m_jobUsage[2].writeRate = 10.0;
+    scheduler.SetThrottled(1, true);
+
+    QString reason;
+    QVERIFY(!scheduler.CanStartJob(reason));
+
+    // Paused for too long, it resumes although the disk is still busy
+    scheduler.m_throttled[1] = MythDate::current().addSecs(-601);
+    QList<int> pause, resume;
+    scheduler.Throttle(pause, resume, reason);
+    QCOMPARE(resume, QList<int>() << 1);
+    QVERIFY(pause.isEmpty());
+    scheduler.SetThrottled(1, false);
+
+    // and isn't paused again, the lighter job is instead
+    resume.clear();
+    scheduler.Throttle(pause, resume, reason);
+    QCOMPARE(pause, QList<int>() << 2);
+    QVERIFY(resume.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(TestJobScheduler)
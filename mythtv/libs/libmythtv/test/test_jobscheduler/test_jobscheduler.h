@@ -0,0 +1,48 @@
+/*
+ *  Class TestJobScheduler
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+class TestJobScheduler: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /** total and busy ticks from the cpu line of /proc/stat */
+    void cpu_stat(void);
+
+    /** writes and write time per device from /proc/diskstats */
+    void disk_stats(void);
+
+    /** ms per write on the worst disk, ignoring idle disks */
+    void write_latency(void);
+
+    /** ppid and CPU ticks, with spaces and brackets in the name */
+    void proc_stat(void);
+
+    void proc_io(void);
+
+    /** running jobs first, then by type, then shortest first */
+    void rank(void);
+
+    /** paused jobs resume once write latency is back under the limit */
+    void resume(void);
+
+    /** a job is only paused for so long, and not paused again */
+    void max_pause(void);
+};
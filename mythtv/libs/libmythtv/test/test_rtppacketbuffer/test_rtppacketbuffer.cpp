@@ -0,0 +1,328 @@
+/*
+ *  Class TestRTPPacketBuffer
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_rtppacketbuffer.h"
+
+#include <algorithm>
+using namespace std;
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QtEndian>
+
+#include "rtppacketbuffer.h"
+#include "rtpdatapacket.h"
+
+#define PAYLOAD 1316    // 7 TS packets
+#define BITRATE (10 * 1000 * 1000)
+
+/// An RTP packet with a payload that depends on its index
+static UDPPacket rtp_packet(uint index, uint seq)
+{
+    // Every 13th packet is short, so the length has to be recovered too
+    int size = (index % 13 == 5) ? 1000 : PAYLOAD;
+
+    UDPPacket packet;
+    QByteArray &data = packet.GetDataReference();
+    data.resize(12 + size);
+    uchar *buf = reinterpret_cast<uchar*>(data.data());
+    buf[0] = 0x80;
+    buf[1] = RTPDataPacket::kPayLoadTypeTS;
+    qToBigEndian((quint16) seq, buf + 2);
+    qToBigEndian((quint32) (index * 900), buf + 4);
+    qToBigEndian((quint32) 0x4d797468, buf + 8);
+    for (int i = 0; i < size; i++)
+        buf[12 + i] = (index * 31 + i * 7) & 0xff;
+    return packet;
+}
+
+/// A SMPTE 2022-1 FEC packet over "count" packets "offset" apart
+static UDPPacket fec_packet(const QList<UDPPacket> &data, uint first,
+                            uint index, uint offset, uint count)
+{
+    int size = 0;
+    for (uint i = 0; i < count; i++)
+        size = max(size, data[index + i * offset].GetData().size() - 12);
+
+    UDPPacket packet;
+    QByteArray &fec = packet.GetDataReference();
+    fec = QByteArray(12 + 16 + size, '\0');
+    uchar *buf = reinterpret_cast<uchar*>(fec.data());
+    buf[0] = 0x80;
+    buf[1] = 96;
+
+    uint length = 0, type = 0, timestamp = 0;
+    for (uint i = 0; i < count; i++)
+    {
+        QByteArray member = data[index + i * offset].GetData();
+        const uchar *mbuf = reinterpret_cast<const uchar*>(member.constData());
+        length    ^= member.size() - 12;
+        type      ^= mbuf[1] & 0x7f;
+        timestamp ^= qFromBigEndian<quint32>(mbuf + 4);
+        for (int j = 0; j < member.size() - 12; j++)
+            buf[28 + j] ^= mbuf[12 + j];
+    }
+
+    qToBigEndian((quint16) (first + index), buf + 12);
+    qToBigEndian((quint16) length, buf + 14);
+    buf[16] = 0x80 | type;
+    qToBigEndian((quint32) timestamp, buf + 20);
+    buf[24] = (offset == 1) ? 0x40 : 0x00;
+    buf[25] = offset;
+    buf[26] = count;
+    return packet;
+}
+
+/// Builds "count" data packets starting at sequence number "first", and
+/// if "cols" is set the FEC packets for a "cols" x "rows" matrix, each
+/// queued after the last packet it covers.
+void TestRTPPacketBuffer::stream(uint count, uint first, uint cols, uint rows)
+{
+    m_data.clear();
+    m_rows.clear();
+    m_cols.clear();
+    m_order.clear();
+    m_first = first;
+
+    for (uint i = 0; i < count; i++)
+    {
+        m_data.append(rtp_packet(i, (first + i) & 0xffff));
+        m_order.append(i);
+
+        if (!cols)
+            continue;
+        if (i % cols == cols - 1)
+        {
+            m_rows.append(fec_packet(m_data, first, i + 1 - cols, 1, cols));
+            m_order.append(-1 - 2 * (m_rows.size() - 1));
+        }
+        if (i % (cols * rows) == cols * rows - 1)
+        {
+            uint base = i + 1 - cols * rows;
+            for (uint c = 0; c < cols; c++)
+            {
+                m_cols.append(fec_packet(m_data, first, base + c, cols, rows));
+                m_order.append(-2 - 2 * (m_cols.size() - 1));
+            }
+        }
+    }
+}
+
+void TestRTPPacketBuffer::push(RTPPacketBuffer &buffer, int index)
+{
+    if (index >= 0)
+        buffer.PushDataPacket(m_data[index]);
+    else if (index & 1)
+        buffer.PushFECPacket(m_rows[(-1 - index) / 2], 1);
+    else
+        buffer.PushFECPacket(m_cols[(-2 - index) / 2], 0);
+}
+
+/// Pops every available packet, returning their indices
+QList<int> TestRTPPacketBuffer::drain(RTPPacketBuffer &buffer, bool verify)
+{
+    QList<int> indices;
+    while (buffer.HasAvailablePacket())
+    {
+        UDPPacket udp = buffer.PopDataPacket();
+        RTPDataPacket packet(udp);
+        if (verify)
+        {
+            if (!packet.IsValid())
+                return QList<int>() << -1;
+            int index = (packet.GetSequenceNumber() - m_first) & 0xffff;
+            if (index >= m_data.size() ||
+                udp.GetData() != m_data[index].GetData())
+                return QList<int>() << -1 - index;
+            indices.append(index);
+        }
+        buffer.FreePacket(udp);
+    }
+    return indices;
+}
+
+void TestRTPPacketBuffer::in_order(void)
+{
+    stream(1000, 100, 0, 0);
+    RTPPacketBuffer buffer(BITRATE);
+    for (int i = 0; i < m_order.size(); i++)
+        push(buffer, m_order[i]);
+
+    QList<int> out = drain(buffer, true);
+    QCOMPARE(out.size(), 1000 - (int) buffer.GetWindow());
+    for (int i = 0; i < out.size(); i++)
+        QCOMPARE(out[i], i);
+    QCOMPARE(buffer.GetLostCount(), 0U);
+}
+
+void TestRTPPacketBuffer::reordered_data(void)
+{
+    QTest::addColumn<uint>("first");
+    QTest::addColumn<int>("distance");
+
+    QTest::newRow("adjacent") << 100U   << 1;
+    QTest::newRow("far")      << 100U   << 10;
+    QTest::newRow("wrapping") << 65500U << 3;
+}
+
+void TestRTPPacketBuffer::reordered(void)
+{
+    QFETCH(uint, first);
+    QFETCH(int, distance);
+
+    stream(1000, first, 0, 0);
+    for (int i = 0; i + distance < m_order.size(); i += 2 * distance)
+        m_order.swap(i, i + distance);
+
+    RTPPacketBuffer buffer(BITRATE);
+    for (int i = 0; i < m_order.size(); i++)
+        push(buffer, m_order[i]);
+
+    QList<int> out = drain(buffer, true);
+    QCOMPARE(out.size(), 1000 - (int) buffer.GetWindow());
+    for (int i = 0; i < out.size(); i++)
+        QCOMPARE(out[i], i);
+    QCOMPARE(buffer.GetLostCount(), 0U);
+    QCOMPARE(buffer.GetRecoveredCount(), 0U);
+}
+
+void TestRTPPacketBuffer::fec_recovery_data(void)
+{
+    QTest::addColumn<bool>("rows");
+    QTest::addColumn<bool>("columns");
+    QTest::addColumn<QString>("lost");
+    QTest::addColumn<uint>("unrecoverable");
+
+    // 5 x 4 matrices; packet i is in row i / 5 and column i % 5
+    QTest::newRow("row")         << true  << false << "7,23,61"  << 0U;
+    QTest::newRow("column")      << false << true  << "7,8,9"    << 0U;
+    QTest::newRow("two in a row") << true << false << "7,8"      << 2U;
+    QTest::newRow("both")        << true  << true  << "7,8,12,40,45" << 0U;
+    // 7 and 8 share a row, 7 and 12 a column: 12 comes back from its
+    // row, then 7 from its column, then 8 from its row
+    QTest::newRow("cascade")     << true  << true  << "7,8,12"   << 0U;
+    QTest::newRow("square")      << true  << true  << "7,8,12,13" << 4U;
+}
+
+void TestRTPPacketBuffer::fec_recovery(void)
+{
+    QFETCH(bool, rows);
+    QFETCH(bool, columns);
+    QFETCH(QString, lost);
+    QFETCH(uint, unrecoverable);
+
+    stream(400, 65500, 5, 4);
+
+    QList<int> lost_list;
+    QStringList lost_str = lost.split(",");
+    for (int i = 0; i < lost_str.size(); i++)
+        lost_list.append(lost_str[i].toInt());
+
+    RTPPacketBuffer buffer(BITRATE);
+    for (int i = 0; i < m_order.size(); i++)
+    {
+        int index = m_order[i];
+        if (lost_list.contains(index))
+            continue;
+        if (index < 0 && (index & 1) && !rows)
+            continue;
+        if (index < 0 && !(index & 1) && !columns)
+            continue;
+        push(buffer, index);
+    }
+
+    QList<int> out = drain(buffer, true);
+    QVERIFY(!out.empty());
+    QVERIFY2(out.first() >= 0, "corrupt packet released");
+    int expected = 0;
+    for (int i = 0; i < out.size(); i++, expected++)
+    {
+        while (unrecoverable && lost_list.contains(expected))
+            expected++;
+        QCOMPARE(out[i], expected);
+    }
+    QCOMPARE(buffer.GetLostCount(), unrecoverable);
+    QCOMPARE(buffer.GetRecoveredCount(), lost_list.size() - unrecoverable);
+}
+
+void TestRTPPacketBuffer::fec_window(void)
+{
+    stream(400, 0, 10, 10);
+
+    // 23 packets are 250 ms at 1 Mbps, but a 10 x 10 matrix needs more
+    RTPPacketBuffer buffer(1000 * 1000);
+    QCOMPARE(buffer.GetWindow(), 23U);
+    for (int i = 0; i < m_order.size(); i++)
+        push(buffer, m_order[i]);
+    QCOMPARE(buffer.GetWindow(), 210U);
+
+    QList<int> out = drain(buffer, true);
+    QCOMPARE(out.size(), 400 - 210);
+}
+
+void TestRTPPacketBuffer::benchmark_push_data(void)
+{
+    QTest::addColumn<uint>("cols");
+    QTest::addColumn<int>("loss");
+
+    QTest::newRow("no FEC")             << 0U  << 0;
+    QTest::newRow("10x10 FEC")          << 10U << 0;
+    QTest::newRow("10x10 FEC, 1% loss") << 10U << 100;
+}
+
+void TestRTPPacketBuffer::benchmark_push(void)
+{
+    QFETCH(uint, cols);
+    QFETCH(int, loss);
+
+    const uint count = 20000;
+    stream(count, 0, cols, cols);
+    if (loss)
+    {
+        for (int i = m_order.size() - 1; i >= 0; i -= loss)
+        {
+            if (m_order[i] >= 0)
+                m_order.removeAt(i);
+        }
+    }
+    // and a little reordering
+    for (int i = 0; i + 2 < m_order.size(); i += 50)
+        m_order.swap(i, i + 2);
+
+    QElapsedTimer timer;
+    timer.start();
+    uint64_t packets = 0;
+    uint recovered = 0;
+    QBENCHMARK
+    {
+        RTPPacketBuffer buffer(20 * 1000 * 1000);
+        for (int i = 0; i < m_order.size(); i++)
+        {
+            push(buffer, m_order[i]);
+            drain(buffer, false);
+        }
+        packets += m_order.size();
+        recovered = buffer.GetRecoveredCount();
+    }
+    qint64 ns = timer.nsecsElapsed();
+    qDebug() << QString("%1 ns/packet, recovered %2")
+        .arg(packets ? (double) ns / packets : 0.0, 0, 'f', 1)
+        .arg(recovered);
+}
+
+QTEST_APPLESS_MAIN(TestRTPPacketBuffer)
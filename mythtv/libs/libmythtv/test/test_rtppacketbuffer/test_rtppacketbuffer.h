@@ -0,0 +1,68 @@
+/*
+ *  Class TestRTPPacketBuffer
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QList>
+
+#include "udppacket.h"
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+#define MSKIP(MSG) QSKIP(MSG, SkipSingle)
+#else
+#define MSKIP(MSG) QSKIP(MSG)
+#endif
+
+class RTPPacketBuffer;
+
+class TestRTPPacketBuffer: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /** packets are released in order once a window's worth follows */
+    void in_order(void);
+
+    /** out of order packets, and sequence numbers wrapping, are sorted */
+    void reordered_data(void);
+    void reordered(void);
+
+    /** lost packets come back bit exact from row and column FEC */
+    void fec_recovery_data(void);
+    void fec_recovery(void);
+
+    /** the window grows to cover the FEC matrix */
+    void fec_window(void);
+
+    /** ns/packet to reorder a stream with and without FEC */
+    void benchmark_push_data(void);
+    void benchmark_push(void);
+
+  private:
+    void stream(uint count, uint first, uint cols, uint rows);
+    void push(RTPPacketBuffer &buffer, int index);
+    QList<int> drain(RTPPacketBuffer &buffer, bool verify);
+
+    /// Data packets, then the row and column FEC packets covering them,
+    /// and the order to push them in: data packet i is i, row FEC
+    /// packet i is -1 - 2 * i, column FEC packet i is -2 - 2 * i.
+    QList<UDPPacket> m_data;
+    QList<UDPPacket> m_rows;
+    QList<UDPPacket> m_cols;
+    QList<int>       m_order;
+    uint             m_first;
+};
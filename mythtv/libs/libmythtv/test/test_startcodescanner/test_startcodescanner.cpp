@@ -0,0 +1,367 @@
+/*
+ *  Class TestStartCodeScanner
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_startcodescanner.h"
+
+#include <QElapsedTimer>
+
+#include "startcodescanner.h"
+#include "HEVCParser.h"
+#include "recorders/dtvrecorder.h" // for FrameRate
+
+extern "C" {
+const uint8_t *avpriv_find_start_code(const uint8_t *p, const uint8_t *end,
+                                      uint32_t *state);
+}
+
+/// Random bytes with lots of 0x00 and 0x01 so that start codes,
+/// near misses and emulation prevention sequences are common.
+static QByteArray noisy_buffer(uint size, uint seed)
+{
+    QByteArray buf(size, '\0');
+    qsrand(seed);
+    for (uint i = 0; i < size; ++i)
+    {
+        int r = qrand() % 10;
+        buf[i] = (r < 4) ? 0x00 : (r < 6) ? 0x01 : (qrand() & 0xff);
+    }
+    return buf;
+}
+
+/// Writes an H.265 byte stream, see ITU-T Rec. H.265 7.3
+class BitWriter
+{
+  public:
+    BitWriter() : m_bits(0), m_count(0) {}
+
+    void Put(uint32_t value, uint n)
+    {
+        while (n--)
+        {
+            m_bits = (m_bits << 1) | ((value >> n) & 1);
+            if (++m_count == 8)
+            {
+                m_rbsp.append(char(m_bits));
+                m_bits = m_count = 0;
+            }
+        }
+    }
+
+    void UE(uint32_t value)
+    {
+        uint len = 0;
+        for (uint32_t v = value + 1; v > 1; v >>= 1)
+            ++len;
+        Put(0, len);
+        Put(value + 1, len + 1);
+    }
+
+    void SE(int32_t value)
+    {
+        UE(value > 0 ? 2 * value - 1 : -2 * value);
+    }
+
+    /// rbsp_trailing_bits() and emulation prevention
+    QByteArray NAL(uint type)
+    {
+        Put(1, 1);
+        while (m_count)
+            Put(0, 1);
+
+        QByteArray nal;
+        nal.append(char(0x00)).append(char(0x00)).append(char(0x01));
+        nal.append(char(type << 1)).append(char(0x01));
+        uint zeros = 0;
+        for (int i = 0; i < m_rbsp.size(); ++i)
+        {
+            uint8_t b = m_rbsp[i];
+            if (zeros == 2 && b <= 3)
+            {
+                nal.append(char(0x03));
+                zeros = 0;
+            }
+            nal.append(char(b));
+            zeros = b ? 0 : zeros + 1;
+        }
+        m_rbsp.clear();
+        return nal;
+    }
+
+  private:
+    QByteArray m_rbsp;
+    uint32_t   m_bits;
+    uint       m_count;
+};
+
+/// 1920x1088 coded with an 8 line conformance window, 16:9, 50 fps,
+/// using scaling lists, predicted short term reference picture sets
+/// and long term reference pictures so all of decode_SPS() is used.
+static QByteArray hevc_sps(void)
+{
+    BitWriter bw;
+    bw.Put(0, 4);            // sps_video_parameter_set_id
+    bw.Put(0, 3);            // sps_max_sub_layers_minus1
+    bw.Put(1, 1);            // sps_temporal_id_nesting_flag
+    bw.Put(1, 8);            // general profile space, tier, profile_idc
+    bw.Put(0x60000000, 32);  // general_profile_compatibility_flag
+    bw.Put(0x9, 4);          // progressive, interlaced, non packed, frame only
+    bw.Put(0, 22);           // general_reserved_zero_43bits
+    bw.Put(0, 21);
+    bw.Put(0, 1);            // general_inbld_flag
+    bw.Put(120, 8);          // general_level_idc
+    bw.UE(0);                // sps_seq_parameter_set_id
+    bw.UE(1);                // chroma_format_idc
+    bw.UE(1920);             // pic_width_in_luma_samples
+    bw.UE(1088);             // pic_height_in_luma_samples
+    bw.Put(1, 1);            // conformance_window_flag
+    bw.UE(0); bw.UE(0); bw.UE(0); bw.UE(4);
+    bw.UE(0);                // bit_depth_luma_minus8
+    bw.UE(0);                // bit_depth_chroma_minus8
+    bw.UE(4);                // log2_max_pic_order_cnt_lsb_minus4
+    bw.Put(1, 1);            // sps_sub_layer_ordering_info_present_flag
+    bw.UE(4); bw.UE(2); bw.UE(0);
+    bw.UE(0); bw.UE(3); bw.UE(0); bw.UE(3); bw.UE(1); bw.UE(1);
+    bw.Put(1, 1);            // scaling_list_enabled_flag
+    bw.Put(1, 1);            // sps_scaling_list_data_present_flag
+    for (uint sizeId = 0; sizeId < 4; ++sizeId)
+    {
+        for (uint matrixId = 0; matrixId < 6;
+             matrixId += (sizeId == 3) ? 3 : 1)
+        {
+            bool explicit_list = (matrixId == 0);
+            bw.Put(explicit_list, 1);
+            if (!explicit_list)
+            {
+                bw.UE(1);
+                continue;
+            }
+            uint coefNum = qMin(64, 1 << (4 + (sizeId << 1)));
+            if (sizeId > 1)
+                bw.SE(8);
+            for (uint i = 0; i < coefNum; ++i)
+                bw.SE((i & 1) ? -1 : 1);
+        }
+    }
+    bw.Put(1, 1);            // amp_enabled_flag
+    bw.Put(1, 1);            // sample_adaptive_offset_enabled_flag
+    bw.Put(0, 1);            // pcm_enabled_flag
+    bw.UE(2);                // num_short_term_ref_pic_sets
+    bw.UE(1); bw.UE(0);      // one negative picture
+    bw.UE(0); bw.Put(1, 1);
+    bw.Put(1, 1);            // inter_ref_pic_set_prediction_flag
+    bw.Put(0, 1); bw.UE(0);
+    bw.Put(1, 1);            // used_by_curr_pic_flag
+    bw.Put(0, 1); bw.Put(1, 1);
+    bw.Put(1, 1);            // long_term_ref_pics_present_flag
+    bw.UE(1); bw.Put(0x55, 8); bw.Put(1, 1);
+    bw.Put(1, 1);            // sps_temporal_mvp_enabled_flag
+    bw.Put(1, 1);            // strong_intra_smoothing_enabled_flag
+    bw.Put(1, 1);            // vui_parameters_present_flag
+    bw.Put(1, 1);            // aspect_ratio_info_present_flag
+    bw.Put(1, 8);            // aspect_ratio_idc 1:1
+    bw.Put(0, 1);            // overscan_info_present_flag
+    bw.Put(1, 1);            // video_signal_type_present_flag
+    bw.Put(5, 3); bw.Put(0, 1); bw.Put(1, 1);
+    bw.Put(1, 8); bw.Put(1, 8); bw.Put(1, 8);
+    bw.Put(0, 1);            // chroma_loc_info_present_flag
+    bw.Put(0, 1);            // neutral_chroma_indication_flag
+    bw.Put(0, 1);            // field_seq_flag
+    bw.Put(0, 1);            // frame_field_info_present_flag
+    bw.Put(0, 1);            // default_display_window_flag
+    bw.Put(1, 1);            // vui_timing_info_present_flag
+    bw.Put(1, 32);           // vui_num_units_in_tick
+    bw.Put(50, 32);          // vui_time_scale
+    bw.Put(0, 1);            // vui_poc_proportional_to_timing_flag
+    bw.Put(0, 1);            // vui_hrd_parameters_present_flag
+    bw.Put(0, 1);            // bitstream_restriction_flag
+    bw.Put(0, 1);            // sps_extension_present_flag
+    return bw.NAL(HEVCParser::SPS_NUT);
+}
+
+/// A slice segment of \p size bytes, 0x00 free apart from the header.
+static QByteArray hevc_slice(uint type, bool first_slice, uint size)
+{
+    BitWriter bw;
+    bw.Put(first_slice, 1);  // first_slice_segment_in_pic_flag
+    for (uint i = 0; i < size; ++i)
+        bw.Put(0x80 | (i & 0x7f), 8);
+    return bw.NAL(type);
+}
+
+static QByteArray hevc_other(uint type)
+{
+    BitWriter bw;
+    bw.Put(0x50, 8);
+    return bw.NAL(type);
+}
+
+void TestStartCodeScanner::scan_data(void)
+{
+    QTest::addColumn<bool>("SIMD");
+    QTest::newRow("SIMD") << true;
+    QTest::newRow("Pure C") << false;
+}
+
+void TestStartCodeScanner::scan(void)
+{
+    QFETCH(bool, SIMD);
+
+    for (uint seed = 1; seed <= 64; ++seed)
+    {
+        QByteArray buf = noisy_buffer(4096 + seed, seed);
+        const uint8_t *data = reinterpret_cast<const uint8_t*>(buf.constData());
+        const uint8_t *end  = data + buf.size();
+
+        // feed it in odd sized pieces, so start codes get split
+        for (uint piece = 1; piece <= 257; piece += 64)
+        {
+            uint32_t ref_state = 0xffffffff;
+            uint32_t state = 0xffffffff;
+            for (const uint8_t *p = data; p < end; p += piece)
+            {
+                const uint8_t *pend = qMin(p + piece, end);
+                const uint8_t *r = p;
+                const uint8_t *q = p;
+                do
+                {
+                    r = avpriv_find_start_code(r, pend, &ref_state);
+                    q = find_start_code(q, pend, &state, SIMD);
+                    QCOMPARE(q, r);
+                    QCOMPARE(state, ref_state);
+                } while (r < pend);
+            }
+        }
+    }
+}
+
+void TestStartCodeScanner::hevc_keyframes(void)
+{
+    QByteArray es;
+    QList<int> au_starts;
+
+    // IDR access unit with parameter sets and two slice segments
+    au_starts << es.size();
+    es += hevc_other(HEVCParser::AUD_NUT);
+    es += hevc_other(HEVCParser::VPS_NUT);
+    es += hevc_sps();
+    es += hevc_other(HEVCParser::PPS_NUT);
+    es += hevc_slice(HEVCParser::IDR_W_RADL, true, 700);
+    es += hevc_slice(HEVCParser::IDR_W_RADL, false, 300);
+    // trailing pictures, one without an access unit delimiter
+    au_starts << es.size();
+    es += hevc_other(HEVCParser::AUD_NUT);
+    es += hevc_slice(HEVCParser::TRAIL_R, true, 500);
+    au_starts << es.size();
+    es += hevc_slice(HEVCParser::TRAIL_N, true, 400);
+    // CRA access unit starting with a prefix SEI
+    au_starts << es.size();
+    es += hevc_other(HEVCParser::PREFIX_SEI_NUT);
+    es += hevc_slice(HEVCParser::CRA_NUT, true, 900);
+    es += hevc_other(HEVCParser::SUFFIX_SEI_NUT);
+    au_starts << es.size();
+    es += hevc_slice(HEVCParser::TRAIL_R, true, 200);
+
+    // Feed it like DTVRecorder::FindHEVCKeyframes() does, a TS packet
+    // payload at a time with the write position as the stream offset.
+    const uint payload = 184;
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(es.constData());
+    HEVCParser parser;
+    QList<uint64_t> frames, keyframes;
+    for (uint pos = 0; pos < (uint)es.size(); pos += payload)
+    {
+        uint len = qMin(payload, uint(es.size()) - pos);
+        for (uint i = 0; i < len; ++i)
+        {
+            i += parser.addBytes(data + pos + i, len - i, pos) - 1;
+            if (parser.stateChanged() && parser.onFrameStart())
+            {
+                frames << parser.frameAUstreamOffset();
+                if (parser.onKeyFrameStart())
+                    keyframes << parser.keyframeAUstreamOffset();
+            }
+        }
+    }
+
+    QVERIFY(parser.seen_SPS());
+    QCOMPARE(parser.pictureWidth(), 1920U);
+    QCOMPARE(parser.pictureHeight(), 1088U);
+    QCOMPARE(parser.pictureWidthCropped(), 1920U);
+    QCOMPARE(parser.pictureHeightCropped(), 1080U);
+    QCOMPARE(parser.aspectRatio(), 3U); // 16:9
+    FrameRate rate(0);
+    parser.getFrameRate(rate);
+    QCOMPARE(rate.getNum(), 50U);
+    QCOMPARE(rate.getDen(), 1U);
+
+    // an access unit belongs to the packet holding the first NAL
+    // header byte after its first start code
+    QCOMPARE(frames.size(), au_starts.size());
+    for (int i = 0; i < frames.size(); ++i)
+        QCOMPARE(frames[i], uint64_t((au_starts[i] + 3) / payload * payload));
+
+    QCOMPARE(keyframes.size(), 2);
+    QCOMPARE(keyframes[0], frames[0]);
+    QCOMPARE(keyframes[1], frames[3]);
+}
+
+void TestStartCodeScanner::benchmark_scan_data(void)
+{
+    scan_data();
+}
+
+void TestStartCodeScanner::benchmark_scan(void)
+{
+    QFETCH(bool, SIMD);
+
+    // 8 MB of slice data with a start code every 64 kB
+    QByteArray buf(8 * 1024 * 1024, '\0');
+    qsrand(42);
+    for (int i = 0; i < buf.size(); ++i)
+        buf[i] = (qrand() % 255) + 1;
+    for (int i = 0; i + 4 < buf.size(); i += 64 * 1024)
+    {
+        buf[i] = buf[i + 1] = 0x00;
+        buf[i + 2] = 0x01;
+    }
+
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(buf.constData());
+    const uint8_t *end  = data + buf.size();
+
+    QElapsedTimer timer;
+    timer.start();
+    uint64_t bytes = 0;
+    uint found = 0;
+    QBENCHMARK
+    {
+        uint32_t state = 0xffffffff;
+        const uint8_t *p = data;
+        while (p < end)
+        {
+            p = find_start_code(p, end, &state, SIMD);
+            if ((state & 0xffffff00) == 0x100)
+                ++found;
+        }
+        bytes += buf.size();
+    }
+    qint64 ns = timer.nsecsElapsed();
+    QVERIFY(found > 0);
+    qDebug() << QString("%1 MB/sec")
+        .arg(ns ? (bytes * 1000.0 / ns) : 0.0, 0, 'f', 0);
+}
+
+QTEST_APPLESS_MAIN(TestStartCodeScanner)
@@ -0,0 +1,46 @@
+/*
+ *  Class TestStartCodeScanner
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QByteArray>
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+#define MSKIP(MSG) QSKIP(MSG, SkipSingle)
+#else
+#define MSKIP(MSG) QSKIP(MSG)
+#endif
+
+class TestStartCodeScanner: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /** find_start_code() must return the same positions and state as
+     *  avpriv_find_start_code(), also across buffer boundaries */
+    void scan_data(void);
+    void scan(void);
+
+    /** frames, IRAP keyframes and their access unit offsets in a
+     *  synthetic H.265 stream, plus the SPS picture size and rate */
+    void hevc_keyframes(void);
+
+    /** bytes/sec scanning a stream with few start codes, like the
+     *  slice data of a high bitrate HD channel */
+    void benchmark_scan_data(void);
+    void benchmark_scan(void);
+};
@@ -0,0 +1,264 @@
+/*
+ *  Class TestTSHeaderBatch
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_tsheaderbatch.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+
+#include "tsheaderbatch.h"
+#include "mpegstreamdata.h"
+#include "mpegtables.h"
+
+#define PROGRAMS 8
+#define PACKETS  (64 * 1024)
+
+/// Builds a multiplex of PROGRAMS programs with a video and an audio
+/// PID each, a PAT every 1000 packets and some null packets.
+static QByteArray synthetic_mux(void)
+{
+    QByteArray ts(PACKETS * TSPacket::kSize, '\0');
+    unsigned char *buf = reinterpret_cast<unsigned char*>(ts.data());
+    unsigned char cc[0x2000];
+    memset(cc, 0, sizeof(cc));
+
+    vector<uint> pnums, pids;
+    for (uint i = 0; i < PROGRAMS; ++i)
+    {
+        pnums.push_back(i + 1);
+        pids.push_back(0x100 * (i + 1));
+    }
+    ProgramAssociationTable *pat =
+        ProgramAssociationTable::Create(1, 0, pnums, pids);
+    vector<TSPacket> patpkts;
+    pat->GetAsTSPackets(patpkts, 0);
+
+    qsrand(42);
+    for (uint i = 0; i < PACKETS; ++i)
+    {
+        unsigned char *p = buf + i * TSPacket::kSize;
+        if ((i % 1000) == 0 && !patpkts.empty())
+        {
+            memcpy(p, &patpkts[0], TSPacket::kSize);
+            continue;
+        }
+
+        uint r   = qrand();
+        uint pid = ((r % 10) == 0) ? 0x1fff :
+            0x100 * (1 + ((r >> 4) % PROGRAMS)) + 1 + ((r >> 8) & 3);
+        p[0] = SYNC_BYTE;
+        p[1] = ((pid >> 8) & 0x1f) | (((r >> 12) & 7) == 0 ? 0x40 : 0);
+        p[2] = pid & 0xff;
+        p[3] = 0x10 | (cc[pid]++ & 0xf);
+        for (uint j = 4; j < TSPacket::kSize; ++j)
+            p[j] = qrand();
+    }
+
+    delete pat;
+    return ts;
+}
+
+void TestTSHeaderBatch::initTestCase(void)
+{
+    QByteArray path = qgetenv("MYTHTV_TEST_TS");
+    if (!path.isEmpty())
+    {
+        QFile file(path);
+        if (file.open(QIODevice::ReadOnly))
+            m_ts = file.read(PACKETS * 8 * TSPacket::kSize);
+    }
+    if (m_ts.size() < (int)TSPacket::kSize)
+        m_ts = synthetic_mux();
+}
+
+void TestTSHeaderBatch::headers_data(void)
+{
+    QTest::addColumn<bool>("SIMD");
+    QTest::newRow("SIMD") << true;
+    QTest::newRow("Pure C") << false;
+}
+
+void TestTSHeaderBatch::headers(void)
+{
+    QFETCH(bool, SIMD);
+
+    QByteArray ts = synthetic_mux();
+    const unsigned char *buf =
+        reinterpret_cast<const unsigned char*>(ts.constData());
+
+    TSHeaderBatch batch;
+    uint used = batch.Parse(buf, ts.size(), SIMD);
+    QCOMPARE(used, (uint)ts.size());
+    QCOMPARE(batch.Size(), (uint)PACKETS);
+
+    for (uint i = 0; i < batch.Size(); ++i)
+    {
+        const TSPacket *pkt = batch.Packet(i);
+        QCOMPARE((const void*)pkt,
+                 (const void*)(buf + i * TSPacket::kSize));
+        QCOMPARE(batch.PID(i), pkt->PID());
+        QCOMPARE(batch.ContinuityCounter(i), pkt->ContinuityCounter());
+        QCOMPARE(batch.PayloadStart(i), pkt->PayloadStart());
+        QCOMPARE(batch.TransportError(i), pkt->TransportError());
+        QCOMPARE(bool(batch.Flags(i) & TSHeaderBatch::kScrambled),
+                 pkt->Scrambled());
+        QCOMPARE(bool(batch.Flags(i) & TSHeaderBatch::kHasPayload),
+                 pkt->HasPayload());
+        QCOMPARE(bool(batch.Flags(i) & TSHeaderBatch::kHasAdaptation),
+                 pkt->HasAdaptationField());
+    }
+}
+
+void TestTSHeaderBatch::sync_loss_data(void)
+{
+    QTest::addColumn<bool>("SIMD");
+    QTest::addColumn<uint>("bad");
+    QTest::newRow("SIMD first")    << true  << 0U;
+    QTest::newRow("SIMD 13")       << true  << 13U;
+    QTest::newRow("SIMD 1000")     << true  << 1000U;
+    QTest::newRow("Pure C first")  << false << 0U;
+    QTest::newRow("Pure C 13")     << false << 13U;
+    QTest::newRow("Pure C 1000")   << false << 1000U;
+}
+
+void TestTSHeaderBatch::sync_loss(void)
+{
+    QFETCH(bool, SIMD);
+    QFETCH(uint, bad);
+
+    QByteArray ts = synthetic_mux();
+    ts[bad * TSPacket::kSize] = 0x48;
+    // trailing partial packet must not be consumed either
+    ts.append(QByteArray(100, SYNC_BYTE));
+
+    TSHeaderBatch batch;
+    uint used = batch.Parse(
+        reinterpret_cast<const unsigned char*>(ts.constData()),
+        ts.size(), SIMD);
+    QCOMPARE(used, bad * TSPacket::kSize);
+    QCOMPARE(batch.Size(), bad);
+}
+
+void TestTSHeaderBatch::continuity(void)
+{
+    QByteArray ts = synthetic_mux();
+    unsigned char *buf = reinterpret_cast<unsigned char*>(ts.data());
+
+    // Skip a continuity counter value on PID 0x101
+    uint bumped = 0;
+    for (uint i = 100; i < PACKETS - 1000 && !bumped; ++i)
+    {
+        unsigned char *p = buf + i * TSPacket::kSize;
+        uint pid = ((p[1] << 8) | p[2]) & 0x1fff;
+        if (pid == 0x101)
+        {
+            p[3] = (p[3] & 0xf0) | ((p[3] + 1) & 0xf);
+            bumped = i;
+        }
+    }
+    QVERIFY(bumped);
+
+    TSHeaderBatch batch;
+    batch.Parse(buf, ts.size());
+
+    unsigned char last_cc[0x2000];
+    memset(last_cc, 0xff, sizeof(last_cc));
+
+    // the bumped counter breaks the sequence before and after it,
+    // the repeated PAT counters and null packets are not errors.
+    QCOMPARE(batch.CheckContinuity(last_cc), 2U);
+    QVERIFY(batch.Flags(bumped) & TSHeaderBatch::kCCDiscontinuity);
+    QVERIFY(!(batch.Flags(bumped - 1) & TSHeaderBatch::kCCDiscontinuity));
+
+    // a repeated packet is not a discontinuity
+    batch.Parse(buf, TSPacket::kSize);
+    memset(last_cc, 0xff, sizeof(last_cc));
+    QCOMPARE(batch.CheckContinuity(last_cc), 0U);
+    QCOMPARE(batch.CheckContinuity(last_cc), 0U);
+}
+
+void TestTSHeaderBatch::benchmark_parse_data(void)
+{
+    headers_data();
+}
+
+void TestTSHeaderBatch::benchmark_parse(void)
+{
+    QFETCH(bool, SIMD);
+
+    const unsigned char *buf =
+        reinterpret_cast<const unsigned char*>(m_ts.constData());
+    const uint len = m_ts.size();
+    const uint npkts = len / TSPacket::kSize;
+
+    TSHeaderBatch batch;
+    unsigned char last_cc[0x2000];
+    memset(last_cc, 0xff, sizeof(last_cc));
+
+    QElapsedTimer timer;
+    timer.start();
+    uint64_t packets = 0;
+    QBENCHMARK
+    {
+        uint pos = 0;
+        while (pos + TSPacket::kSize <= len)
+        {
+            uint used = batch.Parse(buf + pos, len - pos, SIMD);
+            batch.CheckContinuity(last_cc);
+            packets += batch.Size();
+            pos += used ? used : 1;
+        }
+    }
+    qint64 ns = timer.nsecsElapsed();
+    qDebug() << QString("%1 packets in mux, %2 packets/sec")
+        .arg(npkts).arg(ns ? (packets * 1000000000.0 / ns) : 0.0, 0, 'f', 0);
+}
+
+void TestTSHeaderBatch::benchmark_process_data(void)
+{
+    const unsigned char *buf =
+        reinterpret_cast<const unsigned char*>(m_ts.constData());
+    const int len = m_ts.size();
+
+    MPEGStreamData sd(1, -1, false);
+    // Listen to every program's PMT and write the streams of the first
+    for (uint i = 0; i < PROGRAMS; ++i)
+        sd.AddListeningPID(0x100 * (i + 1));
+    for (uint i = 1; i <= 4; ++i)
+        sd.AddWritingPID(0x100 + i);
+
+    QElapsedTimer timer;
+    timer.start();
+    uint64_t packets = 0;
+    QBENCHMARK
+    {
+        int pos = 0;
+        while (pos < len)
+        {
+            int chunk = min(len - pos, int(TSPacket::kSize * 1024));
+            int remainder = sd.ProcessData(buf + pos, chunk);
+            pos += max(chunk - remainder, 1);
+        }
+        packets += len / TSPacket::kSize;
+    }
+    qint64 ns = timer.nsecsElapsed();
+    qDebug() << QString("ProcessData: %1 packets/sec")
+        .arg(ns ? (packets * 1000000000.0 / ns) : 0.0, 0, 'f', 0);
+}
+
+QTEST_APPLESS_MAIN(TestTSHeaderBatch)
@@ -0,0 +1,56 @@
+/*
+ *  Class TestTSHeaderBatch
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QByteArray>
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+#define MSKIP(MSG) QSKIP(MSG, SkipSingle)
+#else
+#define MSKIP(MSG) QSKIP(MSG)
+#endif
+
+class TestTSHeaderBatch: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    // called at the beginning of these sets of tests
+    void initTestCase(void);
+
+    /** compare the decoded headers against the TSPacket accessors */
+    void headers_data(void);
+    void headers(void);
+
+    /** Parse() must stop at the first packet without a sync byte */
+    void sync_loss_data(void);
+    void sync_loss(void);
+
+    /** bulk continuity counter check matches DTVRecorder::CheckCC() */
+    void continuity(void);
+
+    /** Set MYTHTV_TEST_TS to the path of a captured multi-program
+     *  transport stream to benchmark with real data, otherwise a
+     *  synthetic 8 program multiplex is used. */
+    void benchmark_parse_data(void);
+    void benchmark_parse(void);
+    void benchmark_process_data(void);
+
+  private:
+    QByteArray m_ts;
+};
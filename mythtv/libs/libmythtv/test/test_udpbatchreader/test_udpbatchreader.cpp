@@ -0,0 +1,153 @@
+/*
+ *  Class TestUDPBatchReader
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_udpbatchreader.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include <QDateTime>
+
+#include "udpbatchreader.h"
+#include "udppacketbuffer.h"
+
+#define DATAGRAM 1328   // 7 TS packets and an RTP header
+
+void TestUDPBatchReader::init(void)
+{
+    m_rx = socket(AF_INET, SOCK_DGRAM, 0);
+    m_tx = socket(AF_INET, SOCK_DGRAM, 0);
+    QVERIFY(m_rx >= 0 && m_tx >= 0);
+
+    UDPBatchReader::SetSocketOptions(m_rx);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    QVERIFY(bind(m_rx, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+
+    socklen_t len = sizeof(addr);
+    QVERIFY(getsockname(m_rx, (struct sockaddr*)&addr, &len) == 0);
+    QVERIFY(::connect(m_tx, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+}
+
+void TestUDPBatchReader::cleanup(void)
+{
+    close(m_tx);
+    close(m_rx);
+}
+
+/// Sends "count" datagrams of "size" bytes, each filled with its number.
+bool TestUDPBatchReader::send(int count, int size)
+{
+    QByteArray data(size, '\0');
+    for (int i = 0; i < count; i++)
+    {
+        data.fill(i & 0xff);
+        if (::send(m_tx, data.constData(), size, 0) != size)
+            return false;
+    }
+    return true;
+}
+
+void TestUDPBatchReader::batches(void)
+{
+    if (!UDPBatchReader::IsSupported())
+        MSKIP("recvmmsg() isn't available on this platform");
+
+    const int count = UDPBatchReader::kBatchSize + 10;
+    QVERIFY(send(count, DATAGRAM));
+
+    quint64 now = QDateTime::currentMSecsSinceEpoch() * 1000000ULL;
+    UDPPacketBuffer buffer(0);
+    UDPBatchReader reader(m_rx);
+
+    QCOMPARE(reader.Read(&buffer), UDPBatchReader::kBatchSize);
+    QVERIFY(reader.GetSender(0) == QHostAddress(QHostAddress::LocalHost));
+    for (int i = 0; i < UDPBatchReader::kBatchSize; i++)
+        buffer.PushDataPacket(reader.TakePacket(i));
+    QCOMPARE(reader.Read(&buffer), 10);
+    for (int i = 0; i < 10; i++)
+        buffer.PushDataPacket(reader.TakePacket(i));
+    QCOMPARE(reader.Read(&buffer), 0);
+
+    for (int i = 0; i < count; i++)
+    {
+        UDPPacket packet = buffer.PopDataPacket();
+        QByteArray data = packet.GetData();
+        QCOMPARE(data.size(), DATAGRAM);
+        QCOMPARE((int)(uchar)data[0], i & 0xff);
+        QCOMPARE((int)(uchar)data[DATAGRAM - 1], i & 0xff);
+        // The kernel's receive time, within a minute of ours
+        QVERIFY(packet.GetArrivalTime() + 60000000000ULL > now);
+        QVERIFY(packet.GetArrivalTime() < now + 60000000000ULL);
+        buffer.FreePacket(packet);
+    }
+    QCOMPARE(reader.GetDropped(), 0U);
+}
+
+void TestUDPBatchReader::large_datagrams(void)
+{
+    if (!UDPBatchReader::IsSupported())
+        MSKIP("recvmmsg() isn't available on this platform");
+
+    UDPPacketBuffer buffer(0);
+    UDPBatchReader reader(m_rx);
+
+    QVERIFY(send(1, 9000));
+    QCOMPARE(reader.Read(&buffer), 1);
+    QVERIFY(reader.TakePacket(0).GetData().isEmpty());
+
+    QVERIFY(send(1, 9000));
+    QCOMPARE(reader.Read(&buffer), 1);
+    QCOMPARE(reader.TakePacket(0).GetData().size(), 9000);
+}
+
+void TestUDPBatchReader::drops(void)
+{
+    if (!UDPBatchReader::IsSupported())
+        MSKIP("recvmmsg() isn't available on this platform");
+
+    // The kernel rounds this up to its minimum, a few datagrams' worth
+    int size = 4096;
+    setsockopt(m_rx, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+    const int count = 200;
+    QVERIFY(send(count, DATAGRAM));
+
+    UDPPacketBuffer buffer(0);
+    UDPBatchReader reader(m_rx);
+    int received = 0, read;
+    while ((read = reader.Read(&buffer)) > 0)
+    {
+        for (int i = 0; i < read; i++)
+            buffer.FreePacket(reader.TakePacket(i));
+        received += read;
+    }
+    QVERIFY(received < count);
+
+    // The drop count rides on the next datagram queued after the drops
+    QVERIFY(send(1, DATAGRAM));
+    QCOMPARE(reader.Read(&buffer), 1);
+    QCOMPARE(reader.GetDropped(), (uint)(count - received));
+}
+
+QTEST_APPLESS_MAIN(TestUDPBatchReader)
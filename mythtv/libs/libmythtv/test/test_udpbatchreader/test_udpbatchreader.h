@@ -0,0 +1,50 @@
+/*
+ *  Class TestUDPBatchReader
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+#define MSKIP(MSG) QSKIP(MSG, SkipSingle)
+#else
+#define MSKIP(MSG) QSKIP(MSG)
+#endif
+
+class TestUDPBatchReader: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    // called before each test, opens a loopback socket pair
+    void init(void);
+    void cleanup(void);
+
+    /** datagrams come back whole, in order, stamped and from the sender */
+    void batches(void);
+
+    /** a datagram too large for the ring is dropped, later ones fit */
+    void large_datagrams(void);
+
+    /** datagrams overflowing the receive buffer are counted */
+    void drops(void);
+
+  private:
+    bool send(int count, int size);
+
+    int m_rx;
+    int m_tx;
+};
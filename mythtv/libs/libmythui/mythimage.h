@@ -32,6 +32,8 @@ class MUI_PUBLIC MythImage : public QImage, public ReferenceCounter
 {
   public:
     static QImage ApplyExifOrientation(QImage &image, int orientation);
+    static QImage SmoothScaled(const QImage &image, const QSize &size,
+                               Qt::AspectRatioMode mode = Qt::IgnoreAspectRatio);
 
     /// Creates a reference counted image, call DecrRef() to delete.
     MythImage(MythPainter *parent, const char *name = "MythImage");
@@ -835,10 +835,12 @@ void AutoExpire::PrintExpireList(QString expHost)
     ClearExpireList(expireList);
 }
 
-/** \fn AutoExpire::GetAllExpiring(QStringList&)
+/** \fn AutoExpire::GetAllExpiring(QStringList&, uint)
  *  \brief Gets the full list of programs that can expire in expiration order
+ *  \param binary Packs the programs with a ProgramInfoWriter of this
+ *                version, if it isn't 0
  */
-void AutoExpire::GetAllExpiring(QStringList &strList)
+void AutoExpire::GetAllExpiring(QStringList &strList, uint binary)
 {
     QMutexLocker lockit(&instance_lock);
     pginfolist_t expireList;
@@ -851,11 +853,7 @@ void AutoExpire::GetAllExpiring(QStringList &strList)
     FillDBOrdered(expireList, gCoreContext->GetNumSetting("AutoExpireMethod",
                   emOldestFirst));
 
-    strList << QString::number(expireList.size());
-
-    pginfolist_t::iterator it = expireList.begin();
-    for (; it != expireList.end(); ++it)
-        (*it)->ToStringList(strList);
+    ProgramListToStringList(expireList, strList, binary);
 
     ClearExpireList(expireList);
 }
@@ -75,7 +75,7 @@ class AutoExpire : public QObject
 
     uint64_t GetDesiredSpace(int fsID) const;
 
-    void GetAllExpiring(QStringList &strList);
+    void GetAllExpiring(QStringList &strList, uint binary = 0);
     void GetAllExpiring(pginfolist_t &list);
     void ClearExpireList(pginfolist_t &expireList, bool deleteProg = true);
 
@@ -1,3 +1,5 @@
+#include <cerrno>
+
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QFileInfo>
@@ -9,14 +11,45 @@
 #include "programinfo.h"
 #include "mythlogging.h"
 
+/// Returns true if \p filename is a plain local file which
+/// can be sent with RingBuffer::SendDirect().
+static bool can_send_direct(const QString &filename)
+{
+#ifdef __linux__
+    if (filename.contains("://"))
+        return false;
+    return QFileInfo(filename).isFile();
+#else
+    (void) filename;
+    return false;
+#endif
+}
+
 FileTransfer::FileTransfer(QString &filename, MythSocket *remote,
                            bool usereadahead, int timeout_ms) :
     ReferenceCounter(QString("FileTransfer:%1").arg(filename)),
     readthreadlive(true), readsLocked(false),
-    rbuffer(RingBuffer::Create(filename, false, usereadahead, timeout_ms, true)),
+    rbuffer(NULL),
     sock(remote), ateof(false), lock(QMutex::NonRecursive),
-    writemode(false)
+    writemode(false), senddirect(can_send_direct(filename)),
+    sockbuffered(true), bytesSent(0), bytesSentDirect(0), blocksSent(0),
+    sendTimeNS(0), openTimer(MythTimer::kStartRunning)
 {
+    // The kernel reads ahead for sendfile(), the read-ahead thread
+    // would only copy the data once more.
+    rbuffer = RingBuffer::Create(filename, false, usereadahead && !senddirect,
+                                 timeout_ms, true);
+    if (senddirect && !rbuffer->IsSendDirectAllowed())
+    {
+        senddirect = false;
+        if (usereadahead)
+        {
+            delete rbuffer;
+            rbuffer = RingBuffer::Create(filename, false, true,
+                                         timeout_ms, true);
+        }
+    }
+
     pginfo = new ProgramInfo(filename);
     pginfo->MarkAsInUse(true, kFileTransferInUseID);
     rbuffer->Start();
@@ -27,7 +60,9 @@ FileTransfer::FileTransfer(QString &filename, MythSocket *remote, bool write) :
     readthreadlive(true), readsLocked(false),
     rbuffer(RingBuffer::Create(filename, write)),
     sock(remote), ateof(false), lock(QMutex::NonRecursive),
-    writemode(write)
+    writemode(write), senddirect(false), sockbuffered(true),
+    bytesSent(0), bytesSentDirect(0), blocksSent(0), sendTimeNS(0),
+    openTimer(MythTimer::kStartRunning)
 {
     pginfo = new ProgramInfo(filename);
     pginfo->MarkAsInUse(true, kFileTransferInUseID);
@@ -41,6 +76,9 @@ FileTransfer::~FileTransfer()
 {
     Stop();
 
+    if (!writemode)
+        LogStats();
+
     if (sock) // FileTransfer becomes responsible for deleting the socket
         sock->DecrRef();
 
@@ -130,6 +168,30 @@ int FileTransfer::RequestBlock(int size)
     while (readsLocked)
         readsUnlockedCond.wait(&lock, 100 /*ms*/);
 
+    MythTimer t(MythTimer::kStartRunning);
+
+    if (senddirect)
+    {
+        tot = SendBlockDirect(size);
+        if (senddirect)
+        {
+            if (tot > 0)
+            {
+                bytesSent += tot;
+                bytesSentDirect += tot;
+                blocksSent++;
+                sendTimeNS += t.nsecsElapsed();
+            }
+
+            if (pginfo)
+                pginfo->UpdateInUseMark();
+
+            return tot;
+        }
+        // SendDirect() isn't supported, copy the data instead
+        tot = 0;
+    }
+
     requestBuffer.resize(max((size_t)max(size,0) + 128, requestBuffer.size()));
     char *buf = &requestBuffer[0];
     while (tot < size && !rbuffer->GetStopReads() && readthreadlive)
@@ -141,6 +203,7 @@ int FileTransfer::RequestBlock(int size)
         if (rbuffer->GetStopReads() || ret <= 0)
             break;
 
+        sockbuffered = true;
         if (sock->Write(buf, (uint)ret) != ret)
         {
             tot = -1;
@@ -152,12 +215,62 @@ int FileTransfer::RequestBlock(int size)
             break; // we hit eof
     }
 
+    if (tot > 0)
+    {
+        bytesSent += tot;
+        blocksSent++;
+        sendTimeNS += t.nsecsElapsed();
+    }
+
     if (pginfo)
         pginfo->UpdateInUseMark();
 
     return (ret < 0) ? -1 : tot;
 }
 
+/** \brief Sends a block straight from the file to the socket.
+ *
+ *  Clears senddirect and returns 0 if RingBuffer::SendDirect() is not
+ *  supported here, the caller then needs to copy the block instead.
+ *  Must be called with lock held.
+ */
+int FileTransfer::SendBlockDirect(int size)
+{
+    if (sockbuffered)
+    {
+        // Anything still buffered by Qt must be sent before the file data
+        if (!sock->WaitForBytesWritten(MythSocket::kLongTimeout))
+            return -1;
+        sockbuffered = false;
+    }
+
+    int fd = sock->GetSocketDescriptor();
+    int tot = 0;
+    while (tot < size && !rbuffer->GetStopReads() && readthreadlive)
+    {
+        int request = size - tot;
+
+        int ret = rbuffer->SendDirect(fd, request);
+        if (ret < 0)
+        {
+            if (!tot && (errno == EINVAL || errno == ENOSYS))
+            {
+                LOG(VB_FILE, LOG_INFO, QString("Can not use sendfile() for "
+                    "%1, copying instead").arg(rbuffer->GetFilename()));
+                senddirect = false;
+                return 0;
+            }
+            return -1;
+        }
+
+        tot += ret;
+        if (ret < request)
+            break; // we hit eof
+    }
+
+    return tot;
+}
+
 int FileTransfer::WriteBlock(int size)
 {
     if (!writemode || !rbuffer)
@@ -277,4 +390,40 @@ void FileTransfer::SetTimeout(bool fast)
     rbuffer->SetOldFile(fast);
 }
 
+/** \brief Returns the throughput counters of this transfer.
+ *
+ *  These are the bytes sent, the bytes of those sent with sendfile(),
+ *  the number of blocks sent, the milliseconds spent sending them and
+ *  the milliseconds since the transfer was opened.
+ */
+QStringList FileTransfer::GetStats(void)
+{
+    QMutexLocker locker(&lock);
+
+    QStringList stats;
+    stats << QString::number(bytesSent)
+          << QString::number(bytesSentDirect)
+          << QString::number(blocksSent)
+          << QString::number(sendTimeNS / 1000000)
+          << QString::number(openTimer.elapsed());
+    return stats;
+}
+
+/// Logs the bytes and blocks this transfer sent, with -v file
+void FileTransfer::LogStats(void)
+{
+    QMutexLocker locker(&lock);
+
+    if (!blocksSent)
+        return;
+
+    double secs = sendTimeNS * 1e-9;
+    LOG(VB_FILE, LOG_INFO, QString("FileTransfer(%1): sent %2 bytes "
+                                   "(%3 with sendfile) in %4 blocks, "
+                                   "%5 MB/s while sending")
+        .arg(rbuffer ? rbuffer->GetFilename() : QString())
+        .arg(bytesSent).arg(bytesSentDirect).arg(blocksSent)
+        .arg((secs > 0) ? bytesSent / secs / (1024 * 1024) : 0.0, 0, 'f', 1));
+}
+
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
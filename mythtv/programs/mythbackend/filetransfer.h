@@ -11,9 +11,11 @@ using namespace std;
 // Qt headers
 #include <QMutex>
 #include <QWaitCondition>
+#include <QStringList>
 
 // MythTV headers
 #include "referencecounter.h"
+#include "mythtimer.h"
 
 class ProgramInfo;
 class RingBuffer;
@@ -48,9 +50,14 @@ class FileTransfer : public ReferenceCounter
 
     void SetTimeout(bool fast);
 
+    QStringList GetStats(void);
+
   private:
    ~FileTransfer();
 
+    int SendBlockDirect(int size);
+    void LogStats(void);
+
     volatile bool  readthreadlive;
     bool           readsLocked;
     QWaitCondition readsUnlockedCond;
@@ -65,6 +72,18 @@ class FileTransfer : public ReferenceCounter
     QMutex lock;
 
     bool writemode;
+
+    /// true while blocks are sent with RingBuffer::SendDirect()
+    bool senddirect;
+    /// true when the socket may hold data not yet handed to the OS
+    bool sockbuffered;
+
+    // Throughput counters, protected by lock
+    uint64_t  bytesSent;
+    uint64_t  bytesSentDirect;
+    uint64_t  blocksSent;
+    int64_t   sendTimeNS;
+    MythTimer openTimer;
 };
 
 #endif
@@ -39,6 +39,7 @@ using namespace std;
 #include <QNetworkInterface>
 #include <QNetworkProxy>
 #include <QHostAddress>
+#include <QThreadStorage>
 
 #include "previewgeneratorqueue.h"
 #include "mythmiscutil.h"
@@ -165,6 +166,73 @@ class ProcessRequestRunnable : public QRunnable
     MythSocket *m_sock;
 };
 
+/** \brief Collects the replies of a request in a QUERY_BATCH.
+ *
+ *  While one of these exists, SendResponse() on the same thread
+ *  adds replies to its socket to it instead of sending them.
+ */
+class ResponseRoute
+{
+  public:
+    explicit ResponseRoute(MythSocket *sock);
+    ~ResponseRoute();
+
+    static ResponseRoute *Current(void);
+
+    MythSocket    *m_sock;
+    QStringList    m_collected;
+
+  private:
+    ResponseRoute *m_prev;
+};
+
+struct ResponseRouteRef
+{
+    ResponseRoute *route;
+};
+
+static QThreadStorage<ResponseRouteRef*> response_route;
+
+ResponseRoute::ResponseRoute(MythSocket *sock) :
+    m_sock(sock), m_prev(NULL)
+{
+    if (!response_route.hasLocalData())
+    {
+        ResponseRouteRef *ref = new ResponseRouteRef;
+        ref->route = NULL;
+        response_route.setLocalData(ref);
+    }
+    m_prev = response_route.localData()->route;
+    response_route.localData()->route = this;
+}
+
+ResponseRoute::~ResponseRoute()
+{
+    response_route.localData()->route = m_prev;
+}
+
+ResponseRoute *ResponseRoute::Current(void)
+{
+    if (!response_route.hasLocalData())
+        return NULL;
+    return response_route.localData()->route;
+}
+
+/** \brief Removes the trailing "BINARY" \e version tokens a client adds
+ *         to ask for a programinfo list packed by a ProgramInfoWriter.
+ *  \return The version to reply with, 0 for the stringlist form
+ */
+static uint take_binary_option(QStringList &tokens)
+{
+    int count = tokens.size();
+    if (count < 3 || tokens[count - 2] != "BINARY")
+        return 0;
+
+    uint version = ProgramInfoBinaryVersion(tokens[count - 1]);
+    tokens.erase(tokens.end() - 2, tokens.end());
+    return version;
+}
+
 class FreeSpaceUpdater : public QRunnable
 {
   public:
@@ -527,6 +595,23 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     pbs->IncrRef();
     sockListLock.unlock();
 
+    ProcessCommand(pbs, listline);
+
+    pbs->DecrRef();
+}
+
+void MainServer::ProcessCommand(PlaybackSock *pbs, QStringList &listline)
+{
+    MythSocket *sock = pbs->getSocket();
+    QStringList tokens = listline[0].simplified()
+        .split(' ', QString::SkipEmptyParts);
+    if (tokens.empty())
+    {
+        SendErrorResponse(pbs, "Empty request");
+        return;
+    }
+    QString command = tokens[0];
+
     if (command == "QUERY_FILETRANSFER")
     {
         if (tokens.size() != 2)
@@ -536,10 +621,23 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     }
     else if (command == "QUERY_RECORDINGS")
     {
+        uint binary = take_binary_option(tokens);
         if (tokens.size() != 2)
             SendErrorResponse(pbs, "Bad QUERY_RECORDINGS query");
         else
-            HandleQueryRecordings(tokens[1], pbs);
+            HandleQueryRecordings(tokens[1], pbs, binary);
+    }
+    else if (command == "QUERY_RECORDING_CHANGES")
+    {
+        uint binary = take_binary_option(tokens);
+        if (tokens.size() < 2)
+            SendErrorResponse(pbs, "Bad QUERY_RECORDING_CHANGES query");
+        else
+            HandleQueryRecordingChanges(tokens, pbs, binary);
+    }
+    else if (command == "QUERY_BATCH")
+    {
+        HandleBatchQuery(listline, pbs);
     }
     else if (command == "QUERY_RECORDING")
     {
@@ -662,12 +760,14 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     }
     else if (command == "QUERY_GETALLPENDING")
     {
+        uint binary = take_binary_option(tokens);
         if (tokens.size() == 1)
-            HandleGetPendingRecordings(pbs);
+            HandleGetPendingRecordings(pbs, "", -1, binary);
         else if (tokens.size() == 2)
-            HandleGetPendingRecordings(pbs, tokens[1]);
+            HandleGetPendingRecordings(pbs, tokens[1], -1, binary);
         else
-            HandleGetPendingRecordings(pbs, tokens[1], tokens[2].toInt());
+            HandleGetPendingRecordings(pbs, tokens[1], tokens[2].toInt(),
+                                       binary);
     }
     else if (command == "QUERY_GETALLSCHEDULED")
     {
@@ -679,7 +779,7 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     }
     else if (command == "QUERY_GETEXPIRING")
     {
-        HandleGetExpiringRecordings(pbs);
+        HandleGetExpiringRecordings(pbs, take_binary_option(tokens));
     }
     else if (command == "QUERY_SG_GETFILELIST")
     {
@@ -1088,8 +1188,6 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
 
         SendResponse(pbssock, strlist);
     }
-
-    pbs->DecrRef();
 }
 
 void MainServer::customEvent(QEvent *e)
@@ -1997,6 +2095,57 @@ void MainServer::HandleDone(MythSocket *socket)
     socket->DisconnectFromHost();
 }
 
+/**
+ * \addtogroup myth_network_protocol
+ * \par        QUERY_BATCH [\e count \e request]...
+ * Runs several requests in one round trip, e.g. the
+ * QUERY_RECORDING_CHANGES and QUERY_FREE_SPACE_LIST the frontend's
+ * recordings screen needs when it opens, or a QUERY_REMOTEENCODER
+ * GET_STATE for each tuner in its status screen. Each
+ * \e request is preceded by its number of stringlist items \e count.
+ * The reply holds the reply to each request in the same order, each
+ * preceded by its number of items. Requests which don't reply have a
+ * count of 0. QUERY_BATCH requests can not be batched.
+ */
+void MainServer::HandleBatchQuery(QStringList &slist, PlaybackSock *pbs)
+{
+    MythSocket *pbssock = pbs->getSocket();
+
+    QList<QStringList> requests;
+    for (int i = 1; i < slist.size();)
+    {
+        bool ok;
+        int count = slist[i].toInt(&ok);
+        if (!ok || count < 1 || i + 1 + count > slist.size())
+        {
+            SendErrorResponse(pbs, "Bad QUERY_BATCH request");
+            return;
+        }
+        requests.push_back(slist.mid(i + 1, count));
+        i += 1 + count;
+    }
+
+    QStringList retlist;
+    QList<QStringList>::iterator it = requests.begin();
+    for (; it != requests.end(); ++it)
+    {
+        QString command = (*it)[0].simplified().section(' ', 0, 0);
+        ResponseRoute route(pbssock);
+        if (command == "QUERY_BATCH")
+        {
+            SendErrorResponse(pbs, QString("Can not batch %1").arg(command));
+        }
+        else
+        {
+            ProcessCommand(pbs, *it);
+        }
+        retlist << QString::number(route.m_collected.size())
+                << route.m_collected;
+    }
+
+    SendResponse(pbssock, retlist);
+}
+
 void MainServer::SendErrorResponse(PlaybackSock *pbs, const QString &error)
 {
     SendErrorResponse(pbs->getSocket(), error);
@@ -2030,7 +2179,12 @@ void MainServer::SendResponse(MythSocket *socket, QStringList &commands)
         sockListLock.unlock();
     }
 
-    if (do_write)
+    ResponseRoute *route = ResponseRoute::Current();
+    if (do_write && route && route->m_sock == socket)
+    {
+        route->m_collected << commands;
+    }
+    else if (do_write)
     {
         socket->WriteStringList(commands);
     }
@@ -2044,16 +2198,24 @@ void MainServer::SendResponse(MythSocket *socket, QStringList &commands)
 
 /**
  * \addtogroup myth_network_protocol
- * \par        QUERY_RECORDINGS \e type
+ * \par        QUERY_RECORDINGS \e type [BINARY \e version]
  * The \e type parameter can be either "Recording", "Unsorted", "Ascending",
  * or "Descending".
  * Returns programinfo (title, subtitle, description, category, chanid,
  * channum, callsign, channel.name, fileURL, \e et \e cetera)
+ *
+ * \par        BINARY \e version
+ * QUERY_RECORDINGS, QUERY_RECORDING_CHANGES, QUERY_GETALLPENDING and
+ * QUERY_GETEXPIRING take these as their last two tokens from clients
+ * that can read the programinfo list packed by a ProgramInfoWriter of
+ * \e version or older. The number of programs is then followed by the
+ * version used and one item holding the packed list, in place of the
+ * programinfos.
  */
-void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs)
+void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs,
+                                       uint binary)
 {
     MythSocket *pbssock = pbs->getSocket();
-    QString playbackhost = pbs->getHostname();
 
     QMap<QString,ProgramInfo*> recMap;
     if (m_sched)
@@ -2080,7 +2242,160 @@ void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs)
     for (; mit != recMap.end(); mit = recMap.erase(mit))
         delete *mit;
 
-    QStringList outputlist(QString::number(destination.size()));
+    SetRecordingPathnames(destination, pbs);
+
+    QStringList outputlist;
+    ProgramListToStringList(destination, outputlist, binary);
+
+    SendResponse(pbssock, outputlist);
+}
+
+/**
+ * \addtogroup myth_network_protocol
+ * \par        QUERY_RECORDING_CHANGES \e since [\e recordedid]... [BINARY \e version]
+ * Returns the recordings changed since \e since, a token from an earlier
+ * reply, or all of them if it is 0. A change to the channel, recording
+ * rule or program details of any recording sends all of them. The
+ * reply is the new token, the
+ * number of recordings followed by the recordedid of each, so a client
+ * can drop those deleted, then the number of changed recordings
+ * followed by their programinfos.
+ * Recordings being recorded, in use or being flagged are always sent,
+ * as are the \e recordedid given, which should be those the client
+ * last saw in that state.
+ */
+void MainServer::HandleQueryRecordingChanges(QStringList &slist,
+                                             PlaybackSock *pbs, uint binary)
+{
+    MythSocket *pbssock = pbs->getSocket();
+
+    // The token is the database's clock, which also sets the
+    // lastmodified column whenever a recorded row changes, and a
+    // checksum of what comes from the tables joined to it, which
+    // don't keep track of when they change.
+    MSqlQuery query(MSqlQuery::InitCon());
+    if (!query.exec("SELECT UNIX_TIMESTAMP(NOW())") || !query.next())
+    {
+        MythDB::DBError("HandleQueryRecordingChanges", query);
+        SendErrorResponse(pbs, "Unable to query recording changes");
+        return;
+    }
+    uint now = query.value(0).toUInt();
+
+    if (!query.exec(
+            "SELECT BIT_XOR(CRC32(CONCAT_WS(',', "
+            "    r.recordedid, c.chanid, c.channum, c.callsign, c.name, "
+            "    c.outputfilters, c.commmethod, p.chanid, p.airdate+0, "
+            "    p.audioprop+0, p.videoprop+0, p.subtitletypes+0, "
+            "    p.syndicatedepisodenumber, p.partnumber, p.parttotal, "
+            "    p.season, p.episode, p.totalepisodes, p.category_type, "
+            "    rec.recordid, rec.dupin, rec.dupmethod))) "
+            "FROM recorded AS r "
+            "LEFT JOIN channel AS c "
+            "ON (r.chanid    = c.chanid) "
+            "LEFT JOIN recordedprogram AS p "
+            "ON (r.chanid    = p.chanid AND "
+            "    r.progstart = p.starttime) "
+            "LEFT JOIN record AS rec "
+            "ON (r.recordid = rec.recordid)") || !query.next())
+    {
+        MythDB::DBError("HandleQueryRecordingChanges", query);
+        SendErrorResponse(pbs, "Unable to query recording changes");
+        return;
+    }
+    QString joined = QString::number(query.value(0).toULongLong(), 16);
+
+    uint since = slist[1].section('-', 0, 0).toUInt();
+    if (since > now)
+        since = 0; // the clock went back, so send everything
+    if (since && slist[1].section('-', 1) != joined)
+    {
+        LOG(VB_NETWORK, LOG_INFO, LOC + "A channel, recording rule or "
+            "program the recordings use changed, sending all of them");
+        since = 0;
+    }
+
+    QStringList ids;
+    if (!query.exec("SELECT recordedid FROM recorded"))
+    {
+        MythDB::DBError("HandleQueryRecordingChanges", query);
+        SendErrorResponse(pbs, "Unable to query recording changes");
+        return;
+    }
+    while (query.next())
+        ids << query.value(0).toString();
+
+    QMap<QString,ProgramInfo*> recMap;
+    if (m_sched)
+        recMap = m_sched->GetRecording();
+
+    QMap<QString,uint32_t> inUseMap = ProgramInfo::QueryInUseMap();
+    QMap<QString,bool> isJobRunning =
+        ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
+
+    QString where;
+    MSqlBindings bindings;
+    if (since)
+    {
+        QStringList terms("r.lastmodified >= FROM_UNIXTIME(:SINCE)");
+        bindings[":SINCE"] = since;
+
+        QStringList wanted;
+        for (int i = 2; i < slist.size(); ++i)
+        {
+            uint recordedid = slist[i].toUInt();
+            if (recordedid)
+                wanted << QString::number(recordedid);
+        }
+        if (!wanted.empty())
+            terms << QString("r.recordedid IN (%1)").arg(wanted.join(","));
+
+        // Their status comes from these maps, not the recorded table
+        QStringList keys = recMap.keys() + inUseMap.keys() +
+            isJobRunning.keys();
+        keys.removeDuplicates();
+        for (int i = 0; i < keys.size(); ++i)
+        {
+            uint chanid;
+            QDateTime recstartts;
+            if (!ProgramInfo::ExtractKey(keys[i], chanid, recstartts))
+                continue;
+            terms << QString("(r.chanid = :CHANID%1 AND "
+                             " r.starttime = :STARTTIME%1)").arg(i);
+            bindings[QString(":CHANID%1").arg(i)] = chanid;
+            bindings[QString(":STARTTIME%1").arg(i)] = recstartts;
+        }
+
+        where = terms.join(" OR ");
+    }
+
+    ProgramList destination;
+    LoadFromRecorded(destination, where, bindings,
+                     inUseMap, isJobRunning, recMap);
+
+    QMap<QString,ProgramInfo*>::iterator mit = recMap.begin();
+    for (; mit != recMap.end(); mit = recMap.erase(mit))
+        delete *mit;
+
+    SetRecordingPathnames(destination, pbs);
+
+    LOG(VB_NETWORK, LOG_INFO, LOC +
+        QString("Sending %1 of %2 recordings changed since %3")
+        .arg(destination.size()).arg(ids.size()).arg(since));
+
+    QStringList outputlist(QString("%1-%2").arg(now).arg(joined));
+    outputlist << QString::number(ids.size()) << ids;
+    ProgramListToStringList(destination, outputlist, binary);
+
+    SendResponse(pbssock, outputlist);
+}
+
+/// Points each recording at the backend that can play it, and fills
+/// in file sizes missing from the database.
+void MainServer::SetRecordingPathnames(ProgramList &destination,
+                                       PlaybackSock *pbs)
+{
+    QString playbackhost = pbs->getHostname();
     QMap<QString, QString> backendPortMap;
     QString ip   = gCoreContext->GetBackendServerIP();
     int port = gCoreContext->GetBackendServerPort();
@@ -2167,11 +2482,7 @@ void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs)
 
         if (slave)
             slave->DecrRef();
-
-        proginfo->ToStringList(outputlist);
     }
-
-    SendResponse(pbssock, outputlist);
 }
 
 /**
@@ -3575,7 +3886,8 @@ void MainServer::HandleQueryGuideDataThrough(PlaybackSock *pbs)
 }
 
 void MainServer::HandleGetPendingRecordings(PlaybackSock *pbs,
-                                            QString tmptable, int recordid)
+                                            QString tmptable, int recordid,
+                                            uint binary)
 {
     MythSocket *pbssock = pbs->getSocket();
 
@@ -3584,13 +3896,13 @@ void MainServer::HandleGetPendingRecordings(PlaybackSock *pbs,
     if (m_sched)
     {
         if (tmptable.isEmpty())
-            m_sched->GetAllPending(strList);
+            m_sched->GetAllPending(strList, binary);
         else
         {
             Scheduler *sched = new Scheduler(false, encoderList,
                                              tmptable, m_sched);
             sched->FillRecordListFromDB(recordid);
-            sched->GetAllPending(strList);
+            sched->GetAllPending(strList, binary);
             delete sched;
 
             if (recordid > 0)
@@ -3621,7 +3933,7 @@ void MainServer::HandleGetPendingRecordings(PlaybackSock *pbs,
     else
     {
         strList << QString::number(0);
-        strList << QString::number(0);
+        ProgramListToStringList(ProgramList(), strList, binary);
     }
 
     SendResponse(pbssock, strList);
@@ -3659,16 +3971,16 @@ void MainServer::HandleGetConflictingRecordings(QStringList &slist,
     SendResponse(pbssock, strlist);
 }
 
-void MainServer::HandleGetExpiringRecordings(PlaybackSock *pbs)
+void MainServer::HandleGetExpiringRecordings(PlaybackSock *pbs, uint binary)
 {
     MythSocket *pbssock = pbs->getSocket();
 
     QStringList strList;
 
     if (m_expirer)
-        m_expirer->GetAllExpiring(strList);
+        m_expirer->GetAllExpiring(strList, binary);
     else
-        strList << QString::number(0);
+        ProgramListToStringList(ProgramList(), strList, binary);
 
     SendResponse(pbssock, strList);
 }
@@ -6847,6 +7159,14 @@ void MainServer::HandleMusicSaveLyrics(const QStringList& slist, PlaybackSock* p
         SendResponse(pbssock, strlist);
 }
 
+/**
+ * \addtogroup myth_network_protocol
+ * \par        QUERY_FILETRANSFER \e id REQUEST_STATS
+ * Returns the bytes sent by this transfer, the bytes of those sent with
+ * sendfile(), the number of blocks sent, the milliseconds spent sending
+ * them and the milliseconds since the transfer was opened.
+ * Since protocol version 91.
+ */
 void MainServer::HandleFileTransferQuery(QStringList &slist,
                                          QStringList &commands,
                                          PlaybackSock *pbs)
@@ -6932,6 +7252,12 @@ void MainServer::HandleFileTransferQuery(QStringList &slist,
         retlist << QString::number(ft->GetFileSize());
         retlist << QString::number(!gCoreContext->IsRegisteredFileForWrite(ft->GetFileName()));
     }
+    else if (command == "REQUEST_STATS")
+    {
+        // bytes sent, bytes sent with sendfile(), blocks sent,
+        // ms spent sending and ms since the transfer was opened
+        retlist << ft->GetStats();
+    }
     else
     {
         LOG(VB_GENERAL, LOG_ERR, LOC +
@@ -156,6 +156,8 @@ class MainServer : public QObject, public MythSocketCBs
   private:
 
     void ProcessRequestWork(MythSocket *sock);
+    void ProcessCommand(PlaybackSock *pbs, QStringList &listline);
+    void HandleBatchQuery(QStringList &slist, PlaybackSock *pbs);
     void HandleAnnounce(QStringList &slist, QStringList commands,
                         MythSocket *socket);
     void HandleDone(MythSocket *socket);
@@ -168,7 +170,11 @@ class MainServer : public QObject, public MythSocketCBs
     bool HandleDeleteFile(QStringList &slist, PlaybackSock *pbs);
     bool HandleDeleteFile(QString filename, QString storagegroup,
                           PlaybackSock *pbs = NULL);
-    void HandleQueryRecordings(QString type, PlaybackSock *pbs);
+    void HandleQueryRecordings(QString type, PlaybackSock *pbs,
+                               uint binary);
+    void HandleQueryRecordingChanges(QStringList &slist, PlaybackSock *pbs,
+                                     uint binary);
+    void SetRecordingPathnames(ProgramList &destination, PlaybackSock *pbs);
     void HandleQueryRecording(QStringList &slist, PlaybackSock *pbs);
     void HandleStopRecording(QStringList &slist, PlaybackSock *pbs);
     void DoHandleStopRecording(RecordingInfo &recinfo, PlaybackSock *pbs);
@@ -193,10 +199,11 @@ class MainServer : public QObject, public MythSocketCBs
     void HandleQueryFindFile(QStringList &slist, PlaybackSock *pbs);
     void HandleQueryFileHash(QStringList &slist, PlaybackSock *pbs);
     void HandleQueryGuideDataThrough(PlaybackSock *pbs);
-    void HandleGetPendingRecordings(PlaybackSock *pbs, QString table = "", int recordid=-1);
+    void HandleGetPendingRecordings(PlaybackSock *pbs, QString table = "", int recordid=-1,
+                                    uint binary = 0);
     void HandleGetScheduledRecordings(PlaybackSock *pbs);
     void HandleGetConflictingRecordings(QStringList &slist, PlaybackSock *pbs);
-    void HandleGetExpiringRecordings(PlaybackSock *pbs);
+    void HandleGetExpiringRecordings(PlaybackSock *pbs, uint binary = 0);
     void HandleSGGetFileList(QStringList &sList, PlaybackSock *pbs);
     void HandleSGFileQuery(QStringList &sList, PlaybackSock *pbs);
     void HandleGetFreeInputInfo(PlaybackSock *pbs, uint excluded_input);
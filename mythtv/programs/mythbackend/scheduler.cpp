@@ -70,7 +70,12 @@ Scheduler::Scheduler(bool runthread, QMap<int, EncoderLink *> *tvList,
     m_isShuttingDown(false),
     error(0),
     livetvTime(QDateTime()),
-    m_openEnd(openEndNever)
+    m_openEnd(openEndNever),
+    m_incremental(false),
+    m_checkIncremental(false),
+    m_incrementalPass(false),
+    m_fullReschedule(true),
+    m_conflictQueries(0)
 {
     char *debug = getenv("DEBUG_CONFLICTS");
     debugConflicts = (debug != NULL);
@@ -140,6 +145,14 @@ Scheduler::~Scheduler()
         conflictlists.pop_back();
     }
 
+    while (!conflictindexes.empty())
+    {
+        delete conflictindexes.back();
+        conflictindexes.pop_back();
+    }
+
+    ClearNewRecordRows(m_newRecordCache);
+
     locker.unlock();
     wait();
 }
@@ -452,14 +465,14 @@ bool Scheduler::FillRecordList(void)
     LOG(VB_SCHEDULE, LOG_INFO, "PruneOverlaps...");
     PruneOverlaps();
 
-    LOG(VB_SCHEDULE, LOG_INFO, "Sort by priority...");
-    SORT_RECLIST(worklist, comp_priority);
-    LOG(VB_SCHEDULE, LOG_INFO, "BuildListMaps...");
-    BuildListMaps();
-    LOG(VB_SCHEDULE, LOG_INFO, "SchedNewRecords...");
-    SchedNewRecords();
+    PlaceWorkList();
+
     LOG(VB_SCHEDULE, LOG_INFO, "SchedLiveTV...");
-    SchedLiveTV();
+    if (SchedLiveTV())
+    {
+        // The moves made for LiveTV aren't part of the saved placement
+        m_lastPlacement.clear();
+    }
     LOG(VB_SCHEDULE, LOG_INFO, "ClearListMaps...");
     ClearListMaps();
 
@@ -1025,17 +1038,518 @@ void Scheduler::BuildListMaps(void)
             QString("Ignored %1 entries for invalid input %2")
             .arg(badinputs[it.value()]).arg(it.key()));
     }
+
+    BuildConflictIndexes();
+}
+
+void Scheduler::BuildConflictIndexes(void)
+{
+    for (uint i = 0; i < conflictlists.size(); ++i)
+    {
+        RecIndex *index = conflictindexes[i];
+        index->clear();
+        RecIter it = conflictlists[i]->begin();
+        for (; it != conflictlists[i]->end(); ++it)
+        {
+            index->insert((*it)->GetRecordingStartTime().toTime_t(),
+                          (*it)->GetRecordingEndTime().toTime_t(), *it);
+        }
+        index->build();
+    }
 }
 
 void Scheduler::ClearListMaps(void)
 {
     for (uint i = 0; i < conflictlists.size(); ++i)
         conflictlists[i]->clear();
+    for (uint i = 0; i < conflictindexes.size(); ++i)
+        conflictindexes[i]->clear();
     titlelistmap.clear();
     recordidlistmap.clear();
     cache_is_same_program.clear();
 }
 
+static inline bool InListMaps(const RecordingInfo *p)
+{
+    return (p->GetRecordingStatus() == RecStatus::Recording ||
+            p->GetRecordingStatus() == RecStatus::Tuning ||
+            p->GetRecordingStatus() == RecStatus::Failing ||
+            p->GetRecordingStatus() == RecStatus::WillRecord ||
+            p->GetRecordingStatus() == RecStatus::Unknown);
+}
+
+// Everything about a recording that SchedNewRecords() looks at.  If
+// none of it changed for all of the recordings in a placement group,
+// the group gets placed the same way as last time.
+static QString placement_key(const RecordingInfo *p)
+{
+    QStringList key;
+    key << QString::number(p->GetRecordingRuleID())
+        << QString::number(p->GetParentRecordingRuleID())
+        << QString::number(p->GetRecordingRuleType())
+        << QString::number(p->GetFindID())
+        << QString::number(p->GetDuplicateCheckMethod())
+        << QString::number(p->GetCategoryType())
+        << QString::number(p->GetChanID())
+        << p->GetChannelSchedulingID()
+        << QString::number(p->GetInputID())
+        << QString::number(p->mplexid)
+        << QString::number(p->GetScheduledStartTime().toTime_t())
+        << QString::number(p->GetRecordingStartTime().toTime_t())
+        << QString::number(p->GetRecordingEndTime().toTime_t())
+        << p->GetTitle()
+        << p->GetSubtitle()
+        << p->GetDescription()
+        << p->GetProgramID()
+        << QString::number(p->GetRecordingPriority())
+        << QString::number(p->GetRecordingPriority2())
+        << QString::number(p->schedorder)
+        << QString::number(p->GetRecordingStatus())
+        << QString::number(p->IsReactivated());
+    return key.join(QChar(0x1f));
+}
+
+// SchedNewFirstPass() tries these showings of a program together
+static bool same_first_pass(const RecordingInfo *a, const RecordingInfo *b)
+{
+    return (a->GetRecordingPriority() == b->GetRecordingPriority() &&
+            a->GetRecordingPriority2() == b->GetRecordingPriority2() &&
+            a->GetRecordingStartTime() == b->GetRecordingStartTime() &&
+            a->GetRecordingRuleID() == b->GetRecordingRuleID() &&
+            a->GetTitle() == b->GetTitle() &&
+            a->GetProgramID() == b->GetProgramID() &&
+            a->GetSubtitle() == b->GetSubtitle() &&
+            a->GetDescription() == b->GetDescription());
+}
+
+static int find_group(vector<int> &group, int i)
+{
+    while (group[i] != i)
+    {
+        group[i] = group[group[i]];
+        i = group[i];
+    }
+    return i;
+}
+
+static void join_groups(vector<int> &group, int i, int j)
+{
+    i = find_group(group, i);
+    j = find_group(group, j);
+    if (i < j)
+        group[j] = i;
+    else if (j < i)
+        group[i] = j;
+}
+
+/** \fn Scheduler::FindPlacementGroups(vector<int>&,vector<QString>&) const
+ *  \brief Splits the worklist into groups which SchedNewRecords() places
+ *         independently of each other.
+ *
+ *  SchedNewRecords() only ever looks at other showings through the
+ *  list maps: showings with the same title or rule, and recordings
+ *  on the same conflict list.  On a conflict list only those which
+ *  overlap or touch can matter, so each run of overlapping recordings
+ *  is a group of its own.
+ *
+ *  \param group Set to the lowest worklist index in the group of each
+ *               entry, or -1 for entries not placed at all.
+ *  \param keys  Set to the placement_key() of each placed entry.
+ */
+void Scheduler::FindPlacementGroups(vector<int> &group,
+                                    vector<QString> &keys) const
+{
+    group.assign(worklist.size(), -1);
+    keys.assign(worklist.size(), QString());
+
+    QHash<QString, int> titles;
+    QHash<uint, int> recordids;
+    QMap<const RecList*, vector<int> > lists;
+
+    for (uint i = 0; i < worklist.size(); ++i)
+    {
+        const RecordingInfo *p = worklist[i];
+        const RecList *conflictlist = conflictlistmap.value(p->GetInputID());
+        if (!InListMaps(p) || !conflictlist)
+            continue;
+
+        group[i] = i;
+        keys[i] = placement_key(p);
+        lists[conflictlist].push_back(i);
+
+        QString title = p->GetTitle().toLower();
+        if (titles.contains(title))
+            join_groups(group, i, titles[title]);
+        else
+            titles[title] = i;
+
+        if (recordids.contains(p->GetRecordingRuleID()))
+            join_groups(group, i, recordids[p->GetRecordingRuleID()]);
+        else
+            recordids[p->GetRecordingRuleID()] = i;
+    }
+
+    // Overrides also mark the showings of their parent rule
+    for (uint i = 0; i < worklist.size(); ++i)
+    {
+        const RecordingInfo *p = worklist[i];
+        if (group[i] >= 0 &&
+            p->GetRecordingRuleType() == kOverrideRecord && p->GetFindID() &&
+            recordids.contains(p->GetParentRecordingRuleID()))
+        {
+            join_groups(group, i, recordids[p->GetParentRecordingRuleID()]);
+        }
+    }
+
+    QMap<const RecList*, vector<int> >::iterator lit = lists.begin();
+    for (; lit != lists.end(); ++lit)
+    {
+        vector<int> &items = *lit;
+        multimap<QDateTime, int> bystart;
+        for (uint j = 0; j < items.size(); ++j)
+        {
+            bystart.insert(make_pair(
+                worklist[items[j]]->GetRecordingStartTime(), items[j]));
+        }
+
+        int first = -1;
+        QDateTime lastend;
+        multimap<QDateTime, int>::const_iterator it = bystart.begin();
+        for (; it != bystart.end(); ++it)
+        {
+            const RecordingInfo *p = worklist[it->second];
+            if (first >= 0 && p->GetRecordingStartTime() <= lastend)
+            {
+                join_groups(group, it->second, first);
+                if (p->GetRecordingEndTime() > lastend)
+                    lastend = p->GetRecordingEndTime();
+            }
+            else
+            {
+                first = it->second;
+                lastend = p->GetRecordingEndTime();
+            }
+        }
+    }
+
+    for (uint i = 0; i < worklist.size(); ++i)
+    {
+        if (group[i] >= 0)
+            group[i] = find_group(group, i);
+    }
+}
+
+/** \fn Scheduler::SchedChangedGroups(const vector<int>&,const vector<QString>&)
+ *  \brief Places only the groups that changed since the last pass.
+ *
+ *  A group keeps its last placement when all of its entries are
+ *  unchanged and were placed together, without anything else, last
+ *  time.  Entries starting between the last pass and now change how
+ *  they are sorted and whether they may move, so their groups are
+ *  always placed again.  The remaining groups are placed by
+ *  SchedNewRecords() on a worklist holding just them, with the list
+ *  maps built for that worklist.
+ *
+ *  \return false if the whole worklist has to be placed instead,
+ *          nothing has been changed then.
+ */
+bool Scheduler::SchedChangedGroups(const vector<int> &group,
+                                   const vector<QString> &keys)
+{
+    if (m_lastPlacement.empty())
+        return false;
+
+    OpenEndType openEnd =
+        (OpenEndType)gCoreContext->GetNumSetting("SchedOpenEnd", openEndNever);
+    if (openEnd != m_openEnd)
+        return false;
+
+    QDateTime mintime = m_lastPlacementTime.addSecs(-60);
+    QDateTime maxtime = MythDate::current().addSecs(60);
+
+    // Map each group to its group in the last pass, or -1
+    QHash<int, int> lastgroup;
+    QHash<int, int> groupsize;
+    QSet<QString> seen;
+    for (uint i = 0; i < worklist.size(); ++i)
+    {
+        if (group[i] < 0)
+            continue;
+
+        const RecordingInfo *p = worklist[i];
+        int last = -1;
+        QHash<QString, PlacedRecording>::const_iterator it =
+            m_lastPlacement.find(keys[i]);
+        if (it != m_lastPlacement.end() && !seen.contains(keys[i]) &&
+            (p->GetRecordingStartTime() < mintime ||
+             p->GetRecordingStartTime() > maxtime))
+        {
+            last = (*it).group;
+        }
+        seen.insert(keys[i]);
+
+        ++groupsize[group[i]];
+        QHash<int, int>::iterator lit = lastgroup.find(group[i]);
+        if (lit == lastgroup.end())
+            lastgroup.insert(group[i], last);
+        else if (*lit != last)
+            *lit = -1;
+    }
+
+    QHash<int, int>::iterator lit = lastgroup.begin();
+    for (; lit != lastgroup.end(); ++lit)
+    {
+        if (*lit >= 0 && m_lastGroupSize.value(*lit) != groupsize[lit.key()])
+            *lit = -1;
+    }
+
+    // Make sure leaving out the unchanged groups doesn't change how
+    // SchedNewRecords() walks through the rest.
+    uint recording = 0;
+    while (recording < worklist.size() &&
+           (worklist[recording]->GetRecordingStatus() ==
+            RecStatus::Recording ||
+            worklist[recording]->GetRecordingStatus() == RecStatus::Tuning))
+        ++recording;
+
+    vector<uint> changed;
+    uint reused = 0;
+    for (uint i = 0; i < worklist.size(); ++i)
+    {
+        if (group[i] < 0)
+            continue;
+        if (lastgroup[group[i]] >= 0)
+        {
+            ++reused;
+            continue;
+        }
+
+        const RecordingInfo *p = worklist[i];
+        if (changed.empty() || changed.back() < recording)
+        {
+            if ((p->GetRecordingStatus() == RecStatus::Recording ||
+                 p->GetRecordingStatus() == RecStatus::Tuning) &&
+                i >= recording)
+            {
+                LOG(VB_SCHEDULE, LOG_INFO, "Recording order changed, "
+                    "placing all groups");
+                return false;
+            }
+        }
+        if (!changed.empty() && same_first_pass(worklist[changed.back()], p))
+        {
+            for (uint j = changed.back() + 1; j < i; ++j)
+            {
+                if (!same_first_pass(worklist[j], p))
+                {
+                    LOG(VB_SCHEDULE, LOG_INFO, "Showings split up, "
+                        "placing all groups");
+                    return false;
+                }
+            }
+        }
+        changed.push_back(i);
+    }
+
+    LOG(VB_SCHEDULE, LOG_INFO,
+        QString("Placing %1 changed entries, keeping %2 in %3 groups")
+        .arg(changed.size()).arg(reused)
+        .arg(lastgroup.size()));
+
+    RecList all;
+    all.swap(worklist);
+
+    livetvTime = MythDate::current().addSecs(3600);
+    for (uint i = 0; i < all.size(); ++i)
+    {
+        if (group[i] < 0 || lastgroup[group[i]] < 0)
+            continue;
+        const PlacedRecording &placed = m_lastPlacement[keys[i]];
+        all[i]->SetRecordingStatus(placed.status);
+        if (placed.livetv)
+            UpdateLiveTVTime(all[i]);
+    }
+    QDateTime reusedLiveTV = livetvTime;
+
+    for (uint i = 0; i < changed.size(); ++i)
+        worklist.push_back(all[changed[i]]);
+
+    LOG(VB_SCHEDULE, LOG_INFO, "BuildListMaps...");
+    BuildListMaps();
+    LOG(VB_SCHEDULE, LOG_INFO, "SchedNewRecords...");
+    SchedNewRecords();
+    ClearListMaps();
+
+    if (reusedLiveTV < livetvTime)
+        livetvTime = reusedLiveTV;
+
+    worklist.swap(all);
+
+    // Rebuild the list maps as BuildListMaps() would have before the
+    // placement, for SchedLiveTV().
+    for (uint i = 0; i < worklist.size(); ++i)
+    {
+        if (group[i] < 0)
+            continue;
+        RecordingInfo *p = worklist[i];
+        conflictlistmap[p->GetInputID()]->push_back(p);
+        titlelistmap[p->GetTitle().toLower()].push_back(p);
+        recordidlistmap[p->GetRecordingRuleID()].push_back(p);
+    }
+    BuildConflictIndexes();
+
+    return true;
+}
+
+/** \fn Scheduler::PlaceWorkList(void)
+ *  \brief Sorts the worklist by priority and places it, leaving the
+ *         list maps built for SchedLiveTV().
+ *
+ *  On an incremental pass only the groups which changed are placed.
+ *  With SchedIncrementalCheck set the whole worklist is then placed
+ *  again, as a full pass would, and any difference is logged.
+ *
+ *  \return the number of entries placed differently by the check
+ */
+uint Scheduler::PlaceWorkList(void)
+{
+    LOG(VB_SCHEDULE, LOG_INFO, "Sort by priority...");
+    SORT_RECLIST(worklist, comp_priority);
+
+    vector<int> group;
+    vector<QString> keys;
+    if (m_incremental)
+    {
+        LOG(VB_SCHEDULE, LOG_INFO, "FindPlacementGroups...");
+        FindPlacementGroups(group, keys);
+    }
+
+    vector<RecStatus::Type> unplaced;
+    if (m_incrementalPass && m_checkIncremental)
+    {
+        unplaced.reserve(worklist.size());
+        for (uint i = 0; i < worklist.size(); ++i)
+            unplaced.push_back(worklist[i]->GetRecordingStatus());
+    }
+
+    uint differences = 0;
+    m_livetvPlaced.clear();
+    if (!m_incrementalPass || !SchedChangedGroups(group, keys))
+    {
+        LOG(VB_SCHEDULE, LOG_INFO, "BuildListMaps...");
+        BuildListMaps();
+        LOG(VB_SCHEDULE, LOG_INFO, "SchedNewRecords...");
+        SchedNewRecords();
+    }
+    else if (m_checkIncremental)
+    {
+        differences = CheckIncrementalPlacement(unplaced);
+    }
+
+    if (m_incremental)
+        SavePlacement(group, keys);
+    m_livetvPlaced.clear();
+
+    return differences;
+}
+
+/** \fn Scheduler::CheckIncrementalPlacement(const vector<RecStatus::Type>&)
+ *  \brief Places the whole worklist again after SchedChangedGroups()
+ *         and logs every entry a full pass places differently.
+ *
+ *  The placement of the full pass is the one kept.
+ *
+ *  \param unplaced The status of each worklist entry before placement.
+ *  \return the number of entries placed differently
+ */
+uint Scheduler::CheckIncrementalPlacement(
+    const vector<RecStatus::Type> &unplaced)
+{
+    vector<RecStatus::Type> placed;
+    placed.reserve(worklist.size());
+    for (uint i = 0; i < worklist.size(); ++i)
+    {
+        placed.push_back(worklist[i]->GetRecordingStatus());
+        worklist[i]->SetRecordingStatus(unplaced[i]);
+    }
+    QDateTime placedLiveTV = livetvTime;
+
+    ClearListMaps();
+    m_livetvPlaced.clear();
+    LOG(VB_SCHEDULE, LOG_INFO, "BuildListMaps...");
+    BuildListMaps();
+    LOG(VB_SCHEDULE, LOG_INFO, "SchedNewRecords...");
+    SchedNewRecords();
+
+    uint differences = 0;
+    for (uint i = 0; i < worklist.size(); ++i)
+    {
+        const RecordingInfo *p = worklist[i];
+        if (p->GetRecordingStatus() == placed[i])
+            continue;
+
+        ++differences;
+        LOG(VB_GENERAL, LOG_WARNING, LOC_WARN +
+            QString("Incremental pass placed '%1' on %2 at %3 as %4, "
+                    "a full pass as %5")
+            .arg(p->toString(ProgramInfo::kTitleSubtitle, " - ", ""))
+            .arg(p->GetChannelSchedulingID())
+            .arg(p->GetRecordingStartTime().toString(Qt::ISODate))
+            .arg(RecStatus::toString(placed[i], p->GetRecordingRuleType()))
+            .arg(RecStatus::toString(p->GetRecordingStatus(),
+                                     p->GetRecordingRuleType())));
+    }
+
+    if (placedLiveTV != livetvTime)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC_WARN +
+            QString("Incremental pass avoids LiveTV until %1, "
+                    "a full pass until %2")
+            .arg(placedLiveTV.toString(Qt::ISODate))
+            .arg(livetvTime.toString(Qt::ISODate)));
+    }
+
+    if (differences)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC_ERR +
+            QString("Incremental pass placed %1 entries differently")
+            .arg(differences));
+    }
+    else
+    {
+        LOG(VB_SCHEDULE, LOG_INFO, "Incremental placement matches a full pass");
+    }
+
+    return differences;
+}
+
+/// Remembers the placement of this pass for SchedChangedGroups()
+void Scheduler::SavePlacement(const vector<int> &group,
+                              const vector<QString> &keys)
+{
+    m_lastPlacement.clear();
+    m_lastGroupSize.clear();
+    m_lastPlacementTime = schedTime;
+
+    for (uint i = 0; i < worklist.size(); ++i)
+    {
+        if (group[i] < 0)
+            continue;
+
+        PlacedRecording placed;
+        placed.group = group[i];
+        placed.status = worklist[i]->GetRecordingStatus();
+        placed.livetv = m_livetvPlaced.contains(worklist[i]);
+
+        // Entries which can't be told apart can't be reused
+        if (m_lastPlacement.contains(keys[i]))
+            placed.group = -1;
+
+        m_lastPlacement[keys[i]] = placed;
+        ++m_lastGroupSize[group[i]];
+    }
+}
+
 bool Scheduler::IsSameProgram(
     const RecordingInfo *a, const RecordingInfo *b) const
 {
@@ -1152,19 +1666,46 @@ bool Scheduler::FindNextConflict(
     return false;
 }
 
+/** \fn Scheduler::GetOverlapping(const RecordingInfo*,RecList&) const
+ *  \brief Replaces overlapping with the entries of the conflict list of p
+ *         which overlap or touch p, in conflict list order.
+ *
+ *  FindNextConflict() skips everything else without looking further,
+ *  so walking just these finds the same conflicts and affinity as
+ *  walking the whole conflict list.  Callers reuse overlapping, so
+ *  that this doesn't allocate once it has grown.
+ */
+void Scheduler::GetOverlapping(const RecordingInfo *p,
+                               RecList &overlapping) const
+{
+    overlapping.clear();
+    ++m_conflictQueries;
+
+    const RecIndex *index = conflictindexmap.value(p->GetInputID());
+    if (!index)
+        return;
+    index->intersecting(p->GetRecordingStartTime().toTime_t(),
+                        p->GetRecordingEndTime().toTime_t(),
+                        m_overlapMatches);
+    for (uint i = 0; i < m_overlapMatches.size(); ++i)
+        overlapping.push_back(m_overlapMatches[i].second);
+}
+
 const RecordingInfo *Scheduler::FindConflict(
     const RecordingInfo        *p,
     OpenEndType openend,
     uint *affinity,
     bool checkAll) const
 {
-    RecList &conflictlist = *conflictlistmap[p->GetInputID()];
-    RecConstIter k = conflictlist.begin();
-    if (FindNextConflict(conflictlist, p, k, openend, affinity))
+    // FindNextConflict() doesn't query conflicts itself, so nothing
+    // else uses m_overlapList while this walks it
+    GetOverlapping(p, m_overlapList);
+    RecConstIter k = m_overlapList.begin();
+    if (FindNextConflict(m_overlapList, p, k, openend, affinity))
     {
         RecordingInfo *firstConflict = *k;
         while (checkAll &&
-               FindNextConflict(conflictlist, p, ++k, openend, affinity))
+               FindNextConflict(m_overlapList, p, ++k, openend, affinity))
             ;
         return firstConflict;
     }
@@ -1338,8 +1879,7 @@ bool Scheduler::TryAnotherShowing(RecordingInfo *p, bool samePriority,
 
         best->SetRecordingStatus(RecStatus::WillRecord);
         MarkOtherShowings(best);
-        if (best->GetRecordingStartTime() < livetvTime)
-            livetvTime = best->GetRecordingStartTime();
+        UpdateLiveTVTime(best);
         PrintRec(p, "    -");
         PrintRec(best, "    +");
         return true;
@@ -1486,8 +2026,7 @@ void Scheduler::SchedNewFirstPass(RecIter &i, RecIter end,
             PrintRec(best, "  +");
             best->SetRecordingStatus(RecStatus::WillRecord);
             MarkOtherShowings(best);
-            if (best->GetRecordingStartTime() < livetvTime)
-                livetvTime = best->GetRecordingStartTime();
+            UpdateLiveTVTime(best);
         }
     }
 }
@@ -1506,6 +2045,8 @@ void Scheduler::SchedNewRetryPass(RecIter i, RecIter end,
     }
     SORT_RECLIST(retry_list, comp_retry);
 
+    // Not m_overlapList, TryAnotherShowing() queries conflicts too
+    RecList conflictlist;
     i = retry_list.begin();
     for ( ; i != retry_list.end(); ++i)
     {
@@ -1526,7 +2067,7 @@ void Scheduler::SchedNewRetryPass(RecIter i, RecIter end,
 
         // Try to move each conflict.  Restore the old status if we
         // can't.
-        RecList &conflictlist = *conflictlistmap[p->GetInputID()];
+        GetOverlapping(p, conflictlist);
         RecConstIter k = conflictlist.begin();
         for ( ; FindNextConflict(conflictlist, p, k); ++k)
         {
@@ -1539,13 +2080,20 @@ void Scheduler::SchedNewRetryPass(RecIter i, RecIter end,
 
         if (!livetv && p->GetRecordingStatus() == RecStatus::WillRecord)
         {
-            if (p->GetRecordingStartTime() < livetvTime)
-                livetvTime = p->GetRecordingStartTime();
+            UpdateLiveTVTime(p);
             PrintRec(p, "  +");
         }
     }
 }
 
+void Scheduler::UpdateLiveTVTime(const RecordingInfo *p)
+{
+    if (p->GetRecordingStartTime() < livetvTime)
+        livetvTime = p->GetRecordingStartTime();
+    if (m_incremental)
+        m_livetvPlaced.insert(p);
+}
+
 void Scheduler::PruneRedundants(void)
 {
     RecordingInfo *lastp = NULL;
@@ -1792,18 +2340,23 @@ RecStatus::Type Scheduler::GetRecStatus(const ProgramInfo &pginfo)
 }
 
 void Scheduler::GetAllPending(QStringList &strList) const
+{
+    GetAllPending(strList, 0);
+}
+
+/// Serializes the pending list as GetAllPending(QStringList&) does, but
+/// packed by a ProgramInfoWriter of version "binary" if that isn't 0.
+void Scheduler::GetAllPending(QStringList &strList, uint binary) const
 {
     RecList retlist;
     bool hasconflicts = GetAllPending(retlist);
 
     strList << QString::number(hasconflicts);
-    strList << QString::number(retlist.size());
+    ProgramListToStringList(retlist, strList, binary);
 
     while (!retlist.empty())
     {
-        RecordingInfo *p = retlist.front();
-        p->ToStringList(strList);
-        delete p;
+        delete retlist.front();
         retlist.pop_front();
     }
 }
@@ -2237,6 +2790,96 @@ void Scheduler::ResetDuplicates(uint recordid, uint findid,
     }
  }
 
+/// Marks the rules with matches on the given source or multiplex as
+/// changed, both those matching now and those that did before.
+void Scheduler::MarkDirtyMatches(uint sourceid, uint mplexid)
+{
+    MSqlQuery query(dbConn);
+    QString sql = "SELECT DISTINCT recordmatch.recordid "
+                  "FROM recordmatch, channel "
+                  "WHERE recordmatch.chanid = channel.chanid";
+    if (sourceid)
+        sql += " AND channel.sourceid = :SOURCEID";
+    if (mplexid)
+        sql += " AND channel.mplexid = :MPLEXID";
+    query.prepare(sql);
+    if (sourceid)
+        query.bindValue(":SOURCEID", sourceid);
+    if (mplexid)
+        query.bindValue(":MPLEXID", mplexid);
+    if (!query.exec())
+    {
+        MythDB::DBError("MarkDirtyMatches", query);
+        m_fullReschedule = true;
+        return;
+    }
+    while (query.next())
+        m_dirtyRecordIds.insert(query.value(0).toUInt());
+
+    NewRecordMap::const_iterator it = m_newRecordCache.begin();
+    for (; it != m_newRecordCache.end(); ++it)
+    {
+        for (uint i = 0; i < (*it).size(); ++i)
+        {
+            const RecordingInfo *p = (*it)[i].p;
+            if ((!sourceid || p->GetSourceID() == sourceid) &&
+                (!mplexid || p->mplexid == mplexid))
+            {
+                m_dirtyRecordIds.insert(it.key());
+                break;
+            }
+        }
+    }
+}
+
+/// Marks the rules with matches UpdateDuplicates() is about to check
+/// as changed.
+void Scheduler::MarkDirtyDuplicates(void)
+{
+    MSqlQuery query(dbConn);
+    query.prepare("SELECT DISTINCT recordmatch.recordid "
+                  "FROM recordmatch "
+                  "INNER JOIN program p "
+                  "ON ( recordmatch.chanid    = p.chanid    AND "
+                  "     recordmatch.starttime = p.starttime AND "
+                  "     recordmatch.manualid  = p.manualid ) "
+                  "WHERE p.endtime >= (NOW() - INTERVAL 480 MINUTE) "
+                  "      AND recordmatch.oldrecduplicate = -1");
+    if (!query.exec())
+    {
+        MythDB::DBError("MarkDirtyDuplicates", query);
+        m_fullReschedule = true;
+        return;
+    }
+    while (query.next())
+        m_dirtyRecordIds.insert(query.value(0).toUInt());
+}
+
+static QString history_key(const RecordingInfo *p)
+{
+    return p->GetChannelSchedulingID() + QChar(0x1f) +
+        QString::number(p->GetScheduledStartTime().toTime_t()) +
+        QChar(0x1f) + p->GetTitle().toLower();
+}
+
+/// Marks the rules matching programs whose oldrecorded entry was just
+/// written as changed, their rows carry the old status.
+void Scheduler::MarkDirtyHistory(const QSet<QString> &history)
+{
+    NewRecordMap::const_iterator it = m_newRecordCache.begin();
+    for (; it != m_newRecordCache.end(); ++it)
+    {
+        for (uint i = 0; i < (*it).size(); ++i)
+        {
+            if (history.contains(history_key((*it)[i].p)))
+            {
+                m_dirtyRecordIds.insert(it.key());
+                break;
+            }
+        }
+    }
+}
+
 bool Scheduler::HandleReschedule(void)
 {
     // We might have been inactive for a long time, so make
@@ -2251,6 +2894,18 @@ bool Scheduler::HandleReschedule(void)
     bool deleteFuture = false;
     bool runCheck = false;
 
+    // Off until incremental passes have been seen to match full ones in
+    // the field, SchedIncrementalCheck shows where they don't
+    m_incremental = gCoreContext->GetNumSetting("SchedIncremental", 0);
+    m_checkIncremental = m_incremental &&
+        gCoreContext->GetNumSetting("SchedIncrementalCheck", 0);
+    if (!m_incremental)
+    {
+        ClearNewRecordRows(m_newRecordCache);
+        m_dirtyRecordIds.clear();
+        m_lastPlacement.clear();
+    }
+
     while (HaveQueuedRequests())
     {
         QStringList request = reschedQueue.dequeue();
@@ -2283,9 +2938,15 @@ bool Scheduler::HandleReschedule(void)
             QDateTime maxstarttime = MythDate::fromString(tokens[4]);
             deleteFuture = true;
             runCheck = true;
+            if (recordid)
+                m_dirtyRecordIds.insert(recordid);
+            else if (!sourceid && !mplexid)
+                m_fullReschedule = true;
             schedLock.unlock();
             recordmatchLock.lock();
             UpdateMatches(recordid, sourceid, mplexid, maxstarttime);
+            if (m_incremental && !recordid && (sourceid || mplexid))
+                MarkDirtyMatches(sourceid, mplexid);
             recordmatchLock.unlock();
             schedLock.lock();
         }
@@ -2346,6 +3007,8 @@ bool Scheduler::HandleReschedule(void)
     gettimeofday(&fillstart, NULL);
     if (runCheck)
     {
+        if (m_incremental)
+            MarkDirtyDuplicates();
         LOG(VB_SCHEDULE, LOG_INFO, "UpdateDuplicates...");
         UpdateDuplicates();
     }
@@ -2353,6 +3016,21 @@ bool Scheduler::HandleReschedule(void)
     checkTime = ((fillend.tv_sec - fillstart.tv_sec ) * 1000000 +
                  (fillend.tv_usec - fillstart.tv_usec)) / 1000000.0;
 
+    // Everything gets queried and placed again now and then, in case
+    // something changed behind the scheduler's back.
+    QDateTime now = MythDate::current();
+    m_incrementalPass = m_incremental && !m_fullReschedule &&
+        m_lastFullPass.isValid() && m_lastFullPass.secsTo(now) < 3600;
+    if (!m_incrementalPass)
+    {
+        m_fullReschedule = false;
+        m_lastFullPass = now;
+    }
+    LOG(VB_SCHEDULE, LOG_INFO, QString("%1 pass, %2 changed rules")
+        .arg(m_incrementalPass ? "Incremental" : "Full")
+        .arg(m_dirtyRecordIds.size()));
+
+    m_conflictQueries = 0;
     gettimeofday(&fillstart, NULL);
     bool worklistused = FillRecordList();
     gettimeofday(&fillend, NULL);
@@ -2379,10 +3057,13 @@ bool Scheduler::HandleReschedule(void)
                 (int)reclist.size(), matchTime + checkTime + placeTime,
                 matchTime, checkTime, placeTime);
     LOG(VB_GENERAL, LOG_INFO, msg);
+    LOG(VB_SCHEDULE, LOG_INFO, QString("Placement made %1 conflict queries")
+        .arg(m_conflictQueries));
 
     fsInfoCacheFillTime = MythDate::current().addSecs(-1000);
 
     // Write changed entries to oldrecorded.
+    QSet<QString> history;
     RecIter it = reclist.begin();
     for ( ; it != reclist.end(); ++it)
     {
@@ -2396,6 +3077,8 @@ bool Scheduler::HandleReschedule(void)
                 p->AddHistory(false, false, false);
             else
                 p->AddHistory(false, false, true);
+            if (m_incremental)
+                history.insert(history_key(p));
         }
         else if (p->future)
         {
@@ -2406,6 +3089,9 @@ bool Scheduler::HandleReschedule(void)
         p->future = false;
     }
 
+    if (!history.empty())
+        MarkDirtyHistory(history);
+
     gCoreContext->SendSystemEvent("SCHEDULER_RAN");
 
     return true;
@@ -4035,8 +4721,6 @@ void Scheduler::AddNewRecords(void)
     if (schedTmpRecord == "record")
         schedTmpRecord = "sched_temp_record";
 
-    struct timeval dbstart, dbend;
-
     RecList tmpList;
 
     QMap<int, bool> cardMap;
@@ -4168,6 +4852,208 @@ void Scheduler::AddNewRecords(void)
 
     pwrpri.replace("program.","p.");
     pwrpri.replace("channel.","c.");
+
+    // Without incremental scheduling the rows are only needed once,
+    // otherwise only the rules changed since the last pass are queried.
+    NewRecordMap tmpRows;
+    NewRecordMap *rows = &tmpRows;
+    if (!m_incremental)
+    {
+        if (!QueryNewRecords(pwrpri, QString(), tmpRows))
+            return;
+    }
+    else if (!m_incrementalPass || pwrpri != m_newRecordPwrPri)
+    {
+        rows = &m_newRecordCache;
+        ClearNewRecordRows(m_newRecordCache);
+        m_dirtyRecordIds.clear();
+        m_newRecordPwrPri = pwrpri;
+        if (!QueryNewRecords(pwrpri, QString(), m_newRecordCache))
+        {
+            m_fullReschedule = true;
+            return;
+        }
+    }
+    else
+    {
+        rows = &m_newRecordCache;
+        if (!m_dirtyRecordIds.empty())
+        {
+            QStringList recordids;
+            QSet<uint>::const_iterator it = m_dirtyRecordIds.begin();
+            for (; it != m_dirtyRecordIds.end(); ++it)
+            {
+                NewRecordMap::iterator rit = m_newRecordCache.find(*it);
+                if (rit != m_newRecordCache.end())
+                {
+                    ClearNewRecordRows(*rit);
+                    m_newRecordCache.erase(rit);
+                }
+                recordids << QString::number(*it);
+            }
+            m_dirtyRecordIds.clear();
+
+            LOG(VB_SCHEDULE, LOG_INFO, QString(" |-- Updating %1 rules...")
+                .arg(recordids.size()));
+            if (!QueryNewRecords(pwrpri, recordids.join(","),
+                                 m_newRecordCache))
+            {
+                m_fullReschedule = true;
+                return;
+            }
+        }
+
+        if (m_checkIncremental)
+            CheckNewRecordCache(pwrpri);
+    }
+
+    QDateTime mintime = MythDate::current().addSecs(-480 * 60);
+    RecordingInfo *lastp = NULL;
+
+    // Highest recordid first, as the query returns them
+    NewRecordMap::const_iterator rit = rows->end();
+    while (rit != rows->begin())
+    {
+        --rit;
+        for (uint n = 0; n < (*rit).size(); ++n)
+        {
+            const NewRecordRow &row = (*rit)[n];
+            const RecordingInfo *q = row.p;
+            if (q->GetScheduledEndTime() <= mintime)
+                continue;
+
+            // If this is the same program we saw in the last pass and it
+            // wasn't a viable candidate, then neither is this one so
+            // don't bother with it.  This is essentially an early call to
+            // PruneRedundants().
+            if (lastp && lastp->GetRecordingStatus() != RecStatus::Unknown
+                && lastp->GetRecordingStatus() != RecStatus::Offline
+                && lastp->GetRecordingStatus() != RecStatus::DontRecord
+                && q->GetRecordingRuleID() == lastp->GetRecordingRuleID()
+                && q->GetScheduledStartTime() == lastp->GetScheduledStartTime()
+                && q->GetTitle() == lastp->GetTitle()
+                && q->GetChannelSchedulingID() ==
+                   lastp->GetChannelSchedulingID())
+                continue;
+
+            RecordingInfo *p = new RecordingInfo(*q);
+            if (!p->future && !p->IsReactivated() &&
+                p->oldrecstatus != RecStatus::Aborted &&
+                p->oldrecstatus != RecStatus::NotListed)
+            {
+                p->SetRecordingStatus(p->oldrecstatus);
+            }
+
+            // Check to see if the program is currently recording and if
+            // the end time was changed.  Ideally, checking for a new end
+            // time should be done after PruneOverlaps, but that would
+            // complicate the list handling.  Do it here unless it becomes
+            // problematic.
+            RecIter rec = worklist.begin();
+            for ( ; rec != worklist.end(); ++rec)
+            {
+                RecordingInfo *r = *rec;
+                if (p->IsSameTitleStartTimeAndChannel(*r))
+                {
+                    if (r->GetInputID() == p->GetInputID() &&
+                        r->GetRecordingEndTime() != p->GetRecordingEndTime() &&
+                        (r->GetRecordingRuleID() == p->GetRecordingRuleID() ||
+                         p->GetRecordingRuleType() == kOverrideRecord))
+                        ChangeRecordingEnd(r, p);
+                    delete p;
+                    p = NULL;
+                    break;
+                }
+            }
+            if (p == NULL)
+                continue;
+
+            lastp = p;
+
+            if (p->GetRecordingStatus() != RecStatus::Unknown)
+            {
+                tmpList.push_back(p);
+                continue;
+            }
+
+            RecStatus::Type newrecstatus = RecStatus::Unknown;
+            // Check for RecStatus::Offline
+            if ((doRun || specsched) &&
+                (!cardMap.contains(p->GetInputID()) || !p->schedorder))
+                newrecstatus = RecStatus::Offline;
+
+            // Check for RecStatus::TooManyRecordings
+            if (checkTooMany && tooManyMap[p->GetRecordingRuleID()] &&
+                !p->IsReactivated())
+            {
+                newrecstatus = RecStatus::TooManyRecordings;
+            }
+
+            // Check for RecStatus::CurrentRecording and RecStatus::PreviousRecording
+            if (p->GetRecordingRuleType() == kDontRecord)
+                newrecstatus = RecStatus::DontRecord;
+            else if (row.findduplicate && !p->IsReactivated())
+                newrecstatus = RecStatus::PreviousRecording;
+            else if (p->GetRecordingRuleType() != kSingleRecord &&
+                     p->GetRecordingRuleType() != kOverrideRecord &&
+                     !p->IsReactivated() &&
+                     !(p->GetDuplicateCheckMethod() & kDupCheckNone))
+            {
+                const RecordingDupInType dupin = p->GetDuplicateCheckSource();
+
+                if ((dupin & kDupsNewEpi) && p->IsRepeat())
+                    newrecstatus = RecStatus::Repeat;
+
+                if ((dupin & kDupsInOldRecorded) && row.oldrecduplicate)
+                {
+                    if (row.matcholdrecstatus == RecStatus::NeverRecord)
+                        newrecstatus = RecStatus::NeverRecord;
+                    else
+                        newrecstatus = RecStatus::PreviousRecording;
+                }
+
+                if ((dupin & kDupsInRecorded) && row.recduplicate)
+                    newrecstatus = RecStatus::CurrentRecording;
+            }
+
+            if (row.inactive)
+                newrecstatus = RecStatus::Inactive;
+
+            // Mark anything that has already passed as some type of
+            // missed.  If it survives PruneOverlaps, it will get deleted
+            // or have its old status restored in PruneRedundants.
+            if (p->GetRecordingEndTime() < schedTime)
+            {
+                if (p->future)
+                    newrecstatus = RecStatus::MissedFuture;
+                else
+                    newrecstatus = RecStatus::Missed;
+            }
+
+            p->SetRecordingStatus(newrecstatus);
+
+            tmpList.push_back(p);
+        }
+    }
+
+    LOG(VB_SCHEDULE, LOG_INFO, " +-- Cleanup...");
+    RecIter tmp = tmpList.begin();
+    for ( ; tmp != tmpList.end(); ++tmp)
+        worklist.push_back(*tmp);
+}
+
+/// Runs the AddNewRecords() query for all rules, or just the given
+/// comma separated recordids, and adds the rows to \p rows.
+bool Scheduler::QueryNewRecords(const QString &pwrpri,
+                                const QString &recordids,
+                                NewRecordMap &rows)
+{
+    QString schedTmpRecord = recordTable;
+    if (schedTmpRecord == "record")
+        schedTmpRecord = "sched_temp_record";
+
+    struct timeval dbstart, dbend;
+
     QString query = QString(
         "SELECT "
         "    c.chanid,         c.sourceid,           p.starttime,       "// 0-2
@@ -4208,18 +5094,22 @@ void Scheduler::AddNewRecords(void)
         "     oldrecstatus.starttime = p.starttime AND "
         "     oldrecstatus.title     = p.title ) "
         "WHERE p.endtime > (NOW() - INTERVAL 480 MINUTE) "
+        "%1"
         "ORDER BY RECTABLE.recordid DESC, p.starttime, p.title, c.callsign, "
-        "         c.channum ");
+        "         c.channum ")
+        .arg(recordids.isEmpty() ? QString() :
+             QString("AND RECTABLE.recordid IN (%1) ").arg(recordids));
     query.replace("RECTABLE", schedTmpRecord);
 
     LOG(VB_SCHEDULE, LOG_INFO, QString(" |-- Start DB Query..."));
 
+    MSqlQuery result(dbConn);
     gettimeofday(&dbstart, NULL);
     result.prepare(query);
     if (!result.exec())
     {
         MythDB::DBError("AddNewRecords", result);
-        return;
+        return false;
     }
     gettimeofday(&dbend, NULL);
 
@@ -4229,33 +5119,14 @@ void Scheduler::AddNewRecords(void)
             .arg(((dbend.tv_sec  - dbstart.tv_sec) * 1000000 +
                   (dbend.tv_usec - dbstart.tv_usec)) / 1000000.0));
 
-    RecordingInfo *lastp = NULL;
-
     while (result.next())
     {
-        // If this is the same program we saw in the last pass and it
-        // wasn't a viable candidate, then neither is this one so
-        // don't bother with it.  This is essentially an early call to
-        // PruneRedundants().
-        uint recordid = result.value(17).toUInt();
-        QDateTime startts = MythDate::as_utc(result.value(2).toDateTime());
-        QString title = result.value(4).toString();
-        QString callsign = result.value(8).toString();
-        if (lastp && lastp->GetRecordingStatus() != RecStatus::Unknown
-            && lastp->GetRecordingStatus() != RecStatus::Offline
-            && lastp->GetRecordingStatus() != RecStatus::DontRecord
-            && recordid == lastp->GetRecordingRuleID()
-            && startts == lastp->GetScheduledStartTime()
-            && title == lastp->GetTitle()
-            && callsign == lastp->GetChannelSchedulingID())
-            continue;
-
         uint mplexid = result.value(51).toUInt();
         if (mplexid == 32767)
             mplexid = 0;
 
         RecordingInfo *p = new RecordingInfo(
-            title,
+            result.value(4).toString(),//title
             result.value(5).toString(),//subtitle
             result.value(6).toString(),//description
             0, // season
@@ -4266,7 +5137,7 @@ void Scheduler::AddNewRecords(void)
 
             result.value(0).toUInt(),//chanid
             result.value(7).toString(),//channum
-            callsign,
+            result.value(8).toString(),//callsign
             result.value(9).toString(),//channame
 
             result.value(21).toString(),//recgroup
@@ -4286,7 +5157,7 @@ void Scheduler::AddNewRecords(void)
 
             result.value(12).toInt(),//recpriority
 
-            startts,
+            MythDate::as_utc(result.value(2).toDateTime()),//startts
             MythDate::as_utc(result.value(3).toDateTime()),//endts
             MythDate::as_utc(result.value(18).toDateTime()),//recstartts
             MythDate::as_utc(result.value(19).toDateTime()),//recendts
@@ -4301,7 +5172,7 @@ void Scheduler::AddNewRecords(void)
             RecStatus::Type(result.value(37).toInt()),//oldrecstatus
             result.value(38).toInt(),//reactivate
 
-            recordid,
+            result.value(17).toUInt(),//recordid
             result.value(34).toUInt(),//parentid
             RecordingType(result.value(16).toInt()),//rectype
             RecordingDupInType(result.value(13).toInt()),//dupin
@@ -4320,111 +5191,101 @@ void Scheduler::AddNewRecords(void)
             result.value(47).toInt(),//schedorder
             mplexid);                //mplexid
 
-        if (!p->future && !p->IsReactivated() &&
-            p->oldrecstatus != RecStatus::Aborted &&
-            p->oldrecstatus != RecStatus::NotListed)
-        {
-            p->SetRecordingStatus(p->oldrecstatus);
-        }
-
         p->SetRecordingPriority2(result.value(52).toInt());
 
-        // Check to see if the program is currently recording and if
-        // the end time was changed.  Ideally, checking for a new end
-        // time should be done after PruneOverlaps, but that would
-        // complicate the list handling.  Do it here unless it becomes
-        // problematic.
-        RecIter rec = worklist.begin();
-        for ( ; rec != worklist.end(); ++rec)
-        {
-            RecordingInfo *r = *rec;
-            if (p->IsSameTitleStartTimeAndChannel(*r))
-            {
-                if (r->GetInputID() == p->GetInputID() &&
-                    r->GetRecordingEndTime() != p->GetRecordingEndTime() &&
-                    (r->GetRecordingRuleID() == p->GetRecordingRuleID() ||
-                     p->GetRecordingRuleType() == kOverrideRecord))
-                    ChangeRecordingEnd(r, p);
-                delete p;
-                p = NULL;
-                break;
-            }
-        }
-        if (p == NULL)
-            continue;
-
-        lastp = p;
-
-        if (p->GetRecordingStatus() != RecStatus::Unknown)
-        {
-            tmpList.push_back(p);
-            continue;
-        }
+        NewRecordRow row;
+        row.p = p;
+        row.oldrecduplicate = result.value(10).toInt();
+        row.recduplicate = result.value(14).toInt();
+        row.findduplicate = result.value(15).toInt();
+        row.inactive = result.value(33).toInt();
+        row.matcholdrecstatus = result.value(44).toInt();
+        rows[p->GetRecordingRuleID()].push_back(row);
+    }
 
-        RecStatus::Type newrecstatus = RecStatus::Unknown;
-        // Check for RecStatus::Offline
-        if ((doRun || specsched) &&
-            (!cardMap.contains(p->GetInputID()) || !p->schedorder))
-            newrecstatus = RecStatus::Offline;
+    return true;
+}
 
-        // Check for RecStatus::TooManyRecordings
-        if (checkTooMany && tooManyMap[p->GetRecordingRuleID()] &&
-            !p->IsReactivated())
-        {
-            newrecstatus = RecStatus::TooManyRecordings;
-        }
+/// The rows of a rule, in a form which compares equal for equal rows
+QStringList Scheduler::NewRecordKeys(const NewRecordRows &rows)
+{
+    QStringList keys;
+    for (uint i = 0; i < rows.size(); ++i)
+    {
+        const NewRecordRow &row = rows[i];
+        keys << placement_key(row.p) + QChar(0x1f) +
+            QString("%1 %2 %3 %4 %5 %6 %7")
+            .arg(row.oldrecduplicate).arg(row.recduplicate)
+            .arg(row.findduplicate).arg(row.inactive)
+            .arg(row.matcholdrecstatus).arg(row.p->oldrecstatus)
+            .arg(row.p->future);
+    }
+    keys.sort();
+    return keys;
+}
 
-        // Check for RecStatus::CurrentRecording and RecStatus::PreviousRecording
-        if (p->GetRecordingRuleType() == kDontRecord)
-            newrecstatus = RecStatus::DontRecord;
-        else if (result.value(15).toInt() && !p->IsReactivated())
-            newrecstatus = RecStatus::PreviousRecording;
-        else if (p->GetRecordingRuleType() != kSingleRecord &&
-                 p->GetRecordingRuleType() != kOverrideRecord &&
-                 !p->IsReactivated() &&
-                 !(p->GetDuplicateCheckMethod() & kDupCheckNone))
-        {
-            const RecordingDupInType dupin = p->GetDuplicateCheckSource();
+/** \fn Scheduler::CheckNewRecordCache(const QString&)
+ *  \brief Queries the AddNewRecords() rows of all rules and logs every
+ *         rule whose kept rows differ from them.
+ *
+ *  The rows from the database replace the kept ones.
+ *
+ *  \return the number of rules with differing rows
+ */
+uint Scheduler::CheckNewRecordCache(const QString &pwrpri)
+{
+    NewRecordMap rows;
+    if (!QueryNewRecords(pwrpri, QString(), rows))
+    {
+        ClearNewRecordRows(rows);
+        return 0;
+    }
 
-            if ((dupin & kDupsNewEpi) && p->IsRepeat())
-                newrecstatus = RecStatus::Repeat;
+    QSet<uint> recordids = rows.keys().toSet() +
+        m_newRecordCache.keys().toSet();
 
-            if ((dupin & kDupsInOldRecorded) && result.value(10).toInt())
-            {
-                if (result.value(44).toInt() == RecStatus::NeverRecord)
-                    newrecstatus = RecStatus::NeverRecord;
-                else
-                    newrecstatus = RecStatus::PreviousRecording;
-            }
+    uint differences = 0;
+    QSet<uint>::const_iterator it = recordids.begin();
+    for (; it != recordids.end(); ++it)
+    {
+        QStringList kept = NewRecordKeys(m_newRecordCache.value(*it));
+        QStringList queried = NewRecordKeys(rows.value(*it));
+        if (kept == queried)
+            continue;
 
-            if ((dupin & kDupsInRecorded) && result.value(14).toInt())
-                newrecstatus = RecStatus::CurrentRecording;
-        }
+        ++differences;
+        LOG(VB_GENERAL, LOG_WARNING, LOC_WARN +
+            QString("Kept rows of rule %1 differ from the database, "
+                    "%2 kept and %3 queried")
+            .arg(*it).arg(kept.size()).arg(queried.size()));
+    }
 
-        bool inactive = result.value(33).toInt();
-        if (inactive)
-            newrecstatus = RecStatus::Inactive;
+    if (differences)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC_ERR +
+            QString("Incremental pass kept outdated rows of %1 rules")
+            .arg(differences));
+    }
 
-        // Mark anything that has already passed as some type of
-        // missed.  If it survives PruneOverlaps, it will get deleted
-        // or have its old status restored in PruneRedundants.
-        if (p->GetRecordingEndTime() < schedTime)
-        {
-            if (p->future)
-                newrecstatus = RecStatus::MissedFuture;
-            else
-                newrecstatus = RecStatus::Missed;
-        }
+    ClearNewRecordRows(m_newRecordCache);
+    m_newRecordCache.swap(rows);
 
-        p->SetRecordingStatus(newrecstatus);
+    return differences;
+}
 
-        tmpList.push_back(p);
-    }
+void Scheduler::ClearNewRecordRows(NewRecordRows &rows)
+{
+    for (uint i = 0; i < rows.size(); ++i)
+        delete rows[i].p;
+    rows.clear();
+}
 
-    LOG(VB_SCHEDULE, LOG_INFO, " +-- Cleanup...");
-    RecIter tmp = tmpList.begin();
-    for ( ; tmp != tmpList.end(); ++tmp)
-        worklist.push_back(*tmp);
+void Scheduler::ClearNewRecordRows(NewRecordMap &rows)
+{
+    NewRecordMap::iterator it = rows.begin();
+    for (; it != rows.end(); ++it)
+        ClearNewRecordRows(*it);
+    rows.clear();
 }
 
 void Scheduler::AddNotListed(void) {
@@ -5294,7 +6155,8 @@ void Scheduler::FillDirectoryInfoCache(bool force)
     fsInfoCacheFillTime = MythDate::current();
 }
 
-void Scheduler::SchedLiveTV(void)
+/// Returns true if recordings were moved to avoid LiveTV sessions
+bool Scheduler::SchedLiveTV(void)
 {
     int prerollseconds = gCoreContext->GetNumSetting("RecordPreRoll", 0);
     QDateTime curtime = MythDate::current();
@@ -5303,7 +6165,7 @@ void Scheduler::SchedLiveTV(void)
     // This check needs to be longer than the related one in
     // HandleRecording().
     if (secsleft - prerollseconds > 120)
-        return;
+        return false;
 
     // Build a list of active livetv programs
     QMap<int, EncoderLink *>::Iterator enciter = m_tvList->begin();
@@ -5336,7 +6198,7 @@ void Scheduler::SchedLiveTV(void)
     }
 
     if (livetvlist.empty())
-        return;
+        return false;
 
     SchedNewRetryPass(livetvlist.begin(), livetvlist.end(), false, true);
 
@@ -5346,6 +6208,8 @@ void Scheduler::SchedLiveTV(void)
         delete p;
         livetvlist.pop_back();
     }
+
+    return true;
 }
 
 /* Determines if the system was started by the auto-wakeup process */
@@ -5446,12 +6310,14 @@ void Scheduler::CreateConflictLists(void)
         // and point each inputs list at it.
         RecList *conflictlist = new RecList();
         conflictlists.push_back(conflictlist);
+        conflictindexes.push_back(new RecIndex());
         for (sit = checkset.begin(); sit != checkset.end(); ++sit)
         {
             LOG(VB_SCHEDULE, LOG_INFO,
                 QString("Assigning input %1 to conflict set %2")
                 .arg(*sit).arg(conflictlists.size()));
             conflictlistmap[*sit] = conflictlists.back();
+            conflictindexmap[*sit] = conflictindexes.back();
         }
     }
 }
@@ -13,6 +13,7 @@ using namespace std;
 #include <QMutex>
 #include <QMap>
 #include <QSet>
+#include <QHash>
 
 // MythTV headers
 #include "filesysteminfo.h"
@@ -23,6 +24,7 @@ using namespace std;
 #include "mythscheduler.h"
 #include "mthread.h"
 #include "scheduledrecording.h"
+#include "intervalindex.h"
 
 class EncoderLink;
 class MainServer;
@@ -65,6 +67,7 @@ class Scheduler : public MThread, public MythScheduler
     bool GetAllPending(RecList &retList, int recRuleId = 0) const;
     bool GetAllPending(ProgramList &retList, int recRuleId = 0) const;
     virtual void GetAllPending(QStringList &strList) const;
+    void GetAllPending(QStringList &strList, uint binary) const;
     virtual QMap<QString,ProgramInfo*> GetRecording(void) const;
 
     enum SchedSortColumn { kSortTitle, kSortLastRecorded, kSortNextRecording,
@@ -110,6 +113,28 @@ class Scheduler : public MThread, public MythScheduler
         openEndAlways = 2
     };
 
+    /// A row of the AddNewRecords() query, before the status of the
+    /// pass is derived from it.
+    struct NewRecordRow
+    {
+        RecordingInfo *p;
+        bool oldrecduplicate;
+        bool recduplicate;
+        bool findduplicate;
+        bool inactive;
+        int  matcholdrecstatus;
+    };
+    typedef vector<NewRecordRow> NewRecordRows;
+    typedef QMap<uint, NewRecordRows> NewRecordMap;
+
+    /// What SchedNewRecords() decided for a recording last time.
+    struct PlacedRecording
+    {
+        int group;
+        RecStatus::Type status;
+        bool livetv;
+    };
+
     QString recordTable;
     QString priorityTable;
 
@@ -125,12 +150,24 @@ class Scheduler : public MThread, public MythScheduler
     void BuildWorkList(void);
     bool ClearWorkList(void);
     void AddNewRecords(void);
+    bool QueryNewRecords(const QString &pwrpri, const QString &recordids,
+                         NewRecordMap &rows);
     void AddNotListed(void);
     void BuildNewRecordsQueries(uint recordid, QStringList &from,
                                 QStringList &where, MSqlBindings &bindings);
     void PruneOverlaps(void);
     void BuildListMaps(void);
+    void BuildConflictIndexes(void);
     void ClearListMaps(void);
+    void GetOverlapping(const RecordingInfo *p, RecList &overlapping) const;
+    void FindPlacementGroups(vector<int> &group, vector<QString> &keys) const;
+    bool SchedChangedGroups(const vector<int> &group,
+                            const vector<QString> &keys);
+    void SavePlacement(const vector<int> &group,
+                       const vector<QString> &keys);
+    uint PlaceWorkList(void);
+    uint CheckIncrementalPlacement(const vector<RecStatus::Type> &unplaced);
+    uint CheckNewRecordCache(const QString &pwrpri);
 
     bool IsBusyRecording(const RecordingInfo *rcinfo);
 
@@ -156,7 +193,8 @@ class Scheduler : public MThread, public MythScheduler
                            int recpriority, int recpriority2);
     void SchedNewRetryPass(RecIter start, RecIter end,
                            bool samePriority, bool livetv = false);
-    void SchedLiveTV(void);
+    void UpdateLiveTVTime(const RecordingInfo *p);
+    bool SchedLiveTV(void);
     void PruneRedundants(void);
     void UpdateNextRecord(void);
 
@@ -184,6 +222,12 @@ class Scheduler : public MThread, public MythScheduler
                          const QString &subtitle, const QString &descrip,
                          const QString &programid);
     bool HandleReschedule(void);
+    void MarkDirtyMatches(uint sourceid, uint mplexid);
+    void MarkDirtyDuplicates(void);
+    void MarkDirtyHistory(const QSet<QString> &history);
+    static QStringList NewRecordKeys(const NewRecordRows &rows);
+    static void ClearNewRecordRows(NewRecordRows &rows);
+    static void ClearNewRecordRows(NewRecordMap &rows);
     bool HandleRunSchedulerStartup(
         int prerollseconds, int idleWaitForRecordingTime);
     void HandleWakeSlave(RecordingInfo &ri, int prerollseconds);
@@ -223,6 +267,14 @@ class Scheduler : public MThread, public MythScheduler
     RecList livetvlist;
     vector<RecList *> conflictlists;
     QMap<uint, RecList *> conflictlistmap;
+    // Recording start and end of each conflict list entry
+    typedef IntervalIndex<RecordingInfo*, uint> RecIndex;
+    vector<RecIndex *> conflictindexes;
+    QMap<uint, RecIndex *> conflictindexmap;
+    // Reused by every conflict query, so that placement doesn't allocate
+    mutable RecIndex::Matches m_overlapMatches;
+    mutable RecList m_overlapList;
+    mutable uint m_conflictQueries;
     QMap<uint, RecList> recordidlistmap;
     QMap<QString, RecList> titlelistmap;
     InputGroupMap igrp;
@@ -265,6 +317,25 @@ class Scheduler : public MThread, public MythScheduler
     typedef pair<const RecordingInfo*,const RecordingInfo*> IsSameKey;
     typedef QMap<IsSameKey,bool> IsSameCacheType;
     mutable IsSameCacheType cache_is_same_program;
+
+    // Incremental scheduling.  The AddNewRecords() rows of each rule
+    // and the placement of the last pass are kept, so a pass only has
+    // to query the rules and place the recordings that changed.
+    bool m_incremental;
+    bool m_checkIncremental;
+    bool m_incrementalPass;
+    bool m_fullReschedule;
+    QDateTime m_lastFullPass;
+    NewRecordMap m_newRecordCache;
+    QString m_newRecordPwrPri;
+    QSet<uint> m_dirtyRecordIds;
+    QHash<QString, PlacedRecording> m_lastPlacement;
+    QHash<int, int> m_lastGroupSize;
+    QDateTime m_lastPlacementTime;
+    QSet<const RecordingInfo*> m_livetvPlaced;
+
+    // for testing incremental against full passes
+    friend class TestScheduler;
 };
 
 #endif
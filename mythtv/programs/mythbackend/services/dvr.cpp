@@ -35,6 +35,8 @@
 #include "scheduler.h"
 #include "autoexpire.h"
 #include "jobqueue.h"
+#include "jobscheduler.h"
+#include "backendcontext.h"
 #include "encoderlink.h"
 #include "remoteutil.h"
 #include "mythdate.h"
@@ -688,6 +690,48 @@ DTC::TitleInfoList* Dvr::GetTitleInfoList()
 //
 /////////////////////////////////////////////////////////////////////////////
 
+DTC::JobSchedule* Dvr::GetJobSchedule()
+{
+    if (!jobqueue)
+        throw QString("This backend is not running the Job Queue.");
+
+    JobScheduleInfo info = jobqueue->GetScheduleInfo();
+
+    DTC::JobSchedule *pSchedule = new DTC::JobSchedule();
+
+    pSchedule->setHostName           ( info.hostname           );
+    pSchedule->setAsOf               ( info.updated            );
+    pSchedule->setThrottled          ( info.throttled          );
+    pSchedule->setReason             ( info.reason             );
+    pSchedule->setCPULoad            ( info.cpuLoad            );
+    pSchedule->setWriteLatency       ( info.writeLatency       );
+    pSchedule->setRecordingsStarting ( info.recordingsStarting );
+    pSchedule->setMaxJobs            ( info.maxJobs            );
+
+    foreach (const JobScheduleEntry &entry, info.jobs)
+    {
+        DTC::JobInfo *pJob = pSchedule->AddNewJobInfo();
+
+        pJob->setId           ( entry.id                         );
+        pJob->setType         ( JobQueue::JobText(entry.type)    );
+        pJob->setStatus       ( JobQueue::StatusText(entry.status) );
+        pJob->setChanId       ( entry.chanid                     );
+        pJob->setStartTime    ( entry.recstartts                 );
+        pJob->setRank         ( entry.rank                       );
+        pJob->setExpectedSecs ( entry.expectedSecs               );
+        pJob->setCPU          ( entry.usage.cpu                  );
+        pJob->setReadRate     ( entry.usage.readRate             );
+        pJob->setWriteRate    ( entry.usage.writeRate            );
+        pJob->setThrottled    ( entry.usage.throttled            );
+    }
+
+    return pSchedule;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 DTC::ProgramList* Dvr::GetUpcomingList( int  nStartIndex,
                                         int  nCount,
                                         bool bShowAll,
@@ -123,6 +123,10 @@ class Dvr : public DvrServices
 
         DTC::TitleInfoList* GetTitleInfoList  ( );
 
+        // Job Queue
+
+        DTC::JobSchedule* GetJobSchedule      ( );
+
         // Recording Rules
 
         uint              AddRecordSchedule   ( QString   Title,
@@ -417,6 +421,13 @@ class ScriptableDvr : public QObject
             )
         }
 
+        QObject* GetJobSchedule()
+        {
+            SCRIPT_CATCH_EXCEPTION( NULL,
+                return m_obj.GetJobSchedule();
+            )
+        }
+
         uint AddRecordSchedule ( DTC::RecRule *rule )
         {
             SCRIPT_CATCH_EXCEPTION( 0,
@@ -0,0 +1,283 @@
+/*
+ *  Class TestScheduler
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_scheduler.h"
+
+#include "mythcorecontext.h"
+#include "mythdate.h"
+
+void TestScheduler::initTestCase(void)
+{
+    gCoreContext = new MythCoreContext("bin_version", NULL);
+    gCoreContext->OverrideSettingForSession("SchedOpenEnd", "0");
+
+    // A day ahead, so nothing is about to start while the tests run
+    m_guideStart = MythDate::current().addDays(1);
+    m_guideStart = m_guideStart.addSecs(-(m_guideStart.toTime_t() % 3600));
+}
+
+void TestScheduler::cleanupTestCase(void)
+{
+    gCoreContext->ClearOverrideSettingForSession("SchedOpenEnd");
+}
+
+/// A status as PlaceWorkList() leaves it.  Showings it couldn't place
+/// stay Unknown until PruneRedundants() marks them as conflicts.
+QString TestScheduler::status(RecStatus::Type recstatus)
+{
+    return RecStatus::toString(recstatus, kAllRecord);
+}
+
+RecordingInfo *TestScheduler::mockShowing(const Showing &showing) const
+{
+    QDateTime start = m_guideStart.addSecs(showing.start * 60);
+    QDateTime end = start.addSecs(showing.length * 60);
+
+    return new RecordingInfo(
+        showing.title,                                 /* title */
+        QString("%1 episode").arg(showing.title),      /* subtitle */
+        QString("What happens in %1.").arg(showing.title), /* description */
+        0, 0, 0,                                       /* season, episode,
+                                                          total episodes */
+        "",                                            /* syndicated episode */
+        "Drama",                                       /* category */
+        showing.chanid,                                /* chanid */
+        QString::number(showing.chanid),               /* channum */
+        QString("CH%1").arg(showing.chanid),           /* chansign */
+        QString("Channel %1").arg(showing.chanid),     /* channame */
+        "Default",                                     /* recgroup */
+        "Default",                                     /* playgroup */
+        "backend",                                     /* hostname */
+        "Default",                                     /* storagegroup */
+        0, 0, 0,                                       /* year, part number,
+                                                          part total */
+        QString("SH%1").arg(showing.recordid),         /* series id */
+        QString("EP%1001").arg(showing.recordid),      /* program id */
+        "",                                            /* inetref */
+        ProgramInfo::kCategorySeries,                  /* cat type */
+        showing.recpriority,                           /* recpriority */
+        start, end, start, end,                        /* start, end,
+                                                          rec start, rec end */
+        0.0f,                                          /* stars */
+        QDate(),                                       /* original air date */
+        false,                                         /* repeat */
+        RecStatus::Unknown,                            /* old rec status */
+        false,                                         /* reactivate */
+        showing.recordid,                              /* record id */
+        0,                                             /* parent id */
+        kAllRecord,                                    /* rec type */
+        kDupsInAll,                                    /* dup in */
+        kDupCheckSubDesc,                              /* dup method */
+        showing.inputid,                               /* source id */
+        showing.inputid,                               /* input id */
+        0,                                             /* find id */
+        false,                                         /* comm free */
+        0, 0, 0,                                       /* subtitle type,
+                                                          video and audio
+                                                          properties */
+        false,                                         /* future */
+        1,                                             /* sched order */
+        0);                                            /* mplex id */
+}
+
+/// Gives each of inputs 1 and 2 a conflict list of its own
+void TestScheduler::addInputs(Scheduler &sched) const
+{
+    while (!sched.conflictlists.empty())
+    {
+        delete sched.conflictlists.back();
+        sched.conflictlists.pop_back();
+    }
+    while (!sched.conflictindexes.empty())
+    {
+        delete sched.conflictindexes.back();
+        sched.conflictindexes.pop_back();
+    }
+    sched.conflictlistmap.clear();
+    sched.conflictindexmap.clear();
+
+    for (uint inputid = 1; inputid <= 2; ++inputid)
+    {
+        sched.conflictlists.push_back(new RecList());
+        sched.conflictindexes.push_back(new Scheduler::RecIndex());
+        sched.conflictlistmap[inputid] = sched.conflictlists.back();
+        sched.conflictindexmap[inputid] = sched.conflictindexes.back();
+    }
+}
+
+/**
+ * Places the showings of "guide" the way FillRecordList() does after
+ * PruneOverlaps().
+ *
+ * \return the status of each showing, in the order of "guide"
+ */
+QStringList TestScheduler::place(Scheduler &sched, const Guide &guide,
+                                 bool incremental, uint *differences) const
+{
+    while (!sched.worklist.empty())
+    {
+        delete sched.worklist.back();
+        sched.worklist.pop_back();
+    }
+
+    vector<RecordingInfo *> showings;
+    for (int i = 0; i < guide.size(); ++i)
+    {
+        showings.push_back(mockShowing(guide[i]));
+        sched.worklist.push_back(showings.back());
+    }
+
+    sched.schedTime = MythDate::current();
+    sched.m_incrementalPass = incremental;
+    uint placed = sched.PlaceWorkList();
+    sched.ClearListMaps();
+    if (differences)
+        *differences = placed;
+
+    QStringList statuses;
+    for (uint i = 0; i < showings.size(); ++i)
+        statuses << status(showings[i]->GetRecordingStatus());
+    return statuses;
+}
+
+/// Places the showings of "guide" with a scheduler which never saw them
+QStringList TestScheduler::placeFull(const Guide &guide)
+{
+    Scheduler sched(false, &m_tvList);
+    addInputs(sched);
+    sched.m_incremental = false;
+    return place(sched, guide, false);
+}
+
+/**
+ * News and Drama overlap on input 1, Film and Sport on input 2 don't
+ * overlap anything.
+ */
+Guide TestScheduler::guide(void) const
+{
+    Guide list;
+    Showing news  = { 1, "News",  1001, 1,   0,  60, 0 };
+    Showing drama = { 2, "Drama", 1002, 1,  30,  60, 0 };
+    Showing film  = { 3, "Film",  2001, 2, 300, 120, 0 };
+    Showing sport = { 4, "Sport", 2002, 2, 600, 120, 0 };
+    list << news << drama << film << sport;
+    return list;
+}
+
+/**
+ * A rule's priority changes, only the showings it overlaps need
+ * placing again.
+ */
+void TestScheduler::ruleChange_test(void)
+{
+    Scheduler sched(false, &m_tvList);
+    addInputs(sched);
+    sched.m_incremental = true;
+
+    Guide showings = guide();
+    QStringList before = place(sched, showings, false);
+    QCOMPARE(before[0], status(RecStatus::WillRecord));
+    QCOMPARE(before[1], status(RecStatus::Unknown));
+
+    showings[1].recpriority = 5;
+    QStringList incremental = place(sched, showings, true);
+    QStringList full = placeFull(showings);
+
+    QCOMPARE(incremental, full);
+    QCOMPARE(full[0], status(RecStatus::Unknown));
+    QCOMPARE(full[1], status(RecStatus::WillRecord));
+    QCOMPARE(full[3], status(RecStatus::WillRecord));
+}
+
+/**
+ * The guide moves Film so it overlaps Sport, which had a group of its
+ * own until now.
+ */
+void TestScheduler::guideChange_test(void)
+{
+    Scheduler sched(false, &m_tvList);
+    addInputs(sched);
+    sched.m_incremental = true;
+
+    Guide showings = guide();
+    QStringList before = place(sched, showings, false);
+    QCOMPARE(before[2], status(RecStatus::WillRecord));
+    QCOMPARE(before[3], status(RecStatus::WillRecord));
+
+    showings[2].start = 570;
+    QStringList incremental = place(sched, showings, true);
+    QStringList full = placeFull(showings);
+
+    QCOMPARE(incremental, full);
+    QCOMPARE(full[2], status(RecStatus::WillRecord));
+    QCOMPARE(full[3], status(RecStatus::Unknown));
+    QCOMPARE(full[0], before[0]);
+}
+
+void TestScheduler::unchanged_test(void)
+{
+    Scheduler sched(false, &m_tvList);
+    addInputs(sched);
+    sched.m_incremental = true;
+    sched.m_checkIncremental = true;
+
+    Guide showings = guide();
+    QStringList before = place(sched, showings, false);
+
+    uint differences = 1;
+    QStringList after = place(sched, showings, true, &differences);
+    QCOMPARE(after, before);
+    QCOMPARE(differences, 0U);
+}
+
+/**
+ * With SchedIncrementalCheck set, a group which kept a wrong placement
+ * gets found, and placed as a full pass would.
+ */
+void TestScheduler::check_test(void)
+{
+    Scheduler sched(false, &m_tvList);
+    addInputs(sched);
+    sched.m_incremental = true;
+    sched.m_checkIncremental = true;
+
+    Guide showings = guide();
+    QStringList before = place(sched, showings, false);
+
+    // Sport's group is unchanged, so its saved placement gets reused
+    QString sport = QString::number(showings[3].recordid) + QChar(0x1f);
+    uint spoiled = 0;
+    QHash<QString, Scheduler::PlacedRecording>::iterator it =
+        sched.m_lastPlacement.begin();
+    for (; it != sched.m_lastPlacement.end(); ++it)
+    {
+        if (it.key().startsWith(sport))
+        {
+            (*it).status = RecStatus::Unknown;
+            ++spoiled;
+        }
+    }
+    QCOMPARE(spoiled, 1U);
+
+    uint differences = 0;
+    QStringList after = place(sched, showings, true, &differences);
+    QCOMPARE(differences, 1U);
+    QCOMPARE(after, before);
+}
+
+QTEST_APPLESS_MAIN(TestScheduler)
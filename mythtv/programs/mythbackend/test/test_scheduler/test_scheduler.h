@@ -0,0 +1,67 @@
+/*
+ *  Class TestScheduler
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "scheduler.h"
+
+/// A showing matched by a rule, as AddNewRecords() would find it
+struct Showing
+{
+    uint    recordid;
+    QString title;
+    uint    chanid;
+    uint    inputid;
+    int     start;    ///< minutes after the start of the guide
+    int     length;   ///< minutes
+    int     recpriority;
+};
+typedef QList<Showing> Guide;
+
+/**
+ * Places the same showings with an incremental pass, after a full one,
+ * and with a full pass alone, and checks they come out the same.  The
+ * scheduler doesn't get to see a database, the tests give it two
+ * inputs which don't share a tuner and fill in its worklist directly.
+ */
+class TestScheduler : public QObject
+{
+    Q_OBJECT
+
+  private:
+    static QString status(RecStatus::Type recstatus);
+    RecordingInfo *mockShowing(const Showing &showing) const;
+    void addInputs(Scheduler &sched) const;
+    QStringList place(Scheduler &sched, const Guide &guide,
+                      bool incremental, uint *differences = NULL) const;
+    QStringList placeFull(const Guide &guide);
+    Guide guide(void) const;
+
+    QMap<int, EncoderLink *> m_tvList;
+    QDateTime m_guideStart;
+
+  private slots:
+    void initTestCase(void);
+
+    void ruleChange_test(void);
+    void guideChange_test(void);
+    void unchanged_test(void);
+    void check_test(void);
+
+    void cleanupTestCase(void);
+};
@@ -0,0 +1,90 @@
+include ( ../../../../settings.pro )
+
+QT += network xml sql script
+contains(QT_VERSION, ^5\\.[0-9]\\..*) {
+QT += widgets
+}
+
+contains(QT_VERSION, ^4\\.[0-9]\\..*) {
+CONFIG += qtestlib
+}
+contains(QT_VERSION, ^5\\.[0-9]\\..*) {
+QT += testlib
+}
+
+TEMPLATE = app
+TARGET = test_scheduler
+DEPENDPATH += . ../..
+INCLUDEPATH += . ../.. ../../../../libs ../../../../libs/libmythtv
+INCLUDEPATH += ../../../../libs/libmyth ../../../../libs/libmythbase
+INCLUDEPATH += ../../../../libs/libmythtv/mpeg ../../../../libs/libmythui
+INCLUDEPATH += ../../../../libs/libmythupnp ../../../../libs/libmythmetadata
+INCLUDEPATH += ../../../../libs/libmythservicecontracts
+INCLUDEPATH += ../../../../libs/libmythprotoserver
+INCLUDEPATH += ../../../../external/FFmpeg
+
+LIBS += -L../../../../libs/libmythbase -lmythbase-$$LIBVERSION
+LIBS += -L../../../../libs/libmythui -lmythui-$$LIBVERSION
+LIBS += -L../../../../libs/libmythupnp -lmythupnp-$$LIBVERSION
+LIBS += -L../../../../libs/libmythservicecontracts -lmythservicecontracts-$$LIBVERSION
+LIBS += -L../../../../libs/libmythprotoserver -lmythprotoserver-$$LIBVERSION
+LIBS += -L../../../../libs/libmyth -lmyth-$$LIBVERSION
+LIBS += -L../../../../libs/libmythmetadata -lmythmetadata-$$LIBVERSION
+LIBS += -L../../../../external/FFmpeg/libswresample -lmythswresample
+LIBS += -L../../../../external/FFmpeg/libavutil -lmythavutil
+LIBS += -L../../../../external/FFmpeg/libavcodec -lmythavcodec
+LIBS += -L../../../../external/FFmpeg/libswscale -lmythswscale
+LIBS += -L../../../../external/FFmpeg/libavformat -lmythavformat
+LIBS += -L../../../../external/FFmpeg/libavfilter -lmythavfilter
+LIBS += -L../../../../external/FFmpeg/libpostproc -lmythpostproc
+using_mheg:LIBS += -L../../../../libs/libmythfreemheg -lmythfreemheg-$$LIBVERSION
+using_live:LIBS += -L../../../../libs/libmythlivemedia -lmythlivemedia-$$LIBVERSION
+using_hdhomerun:LIBS += -L../../../../external/libhdhomerun -lmythhdhomerun-$$LIBVERSION
+using_taglib: LIBS += $$CONFIG_TAGLIB_LIBS
+LIBS += -L../../../../libs/libmythtv -lmythtv-$$LIBVERSION
+
+contains(QMAKE_CXX, "g++") {
+  QMAKE_CXXFLAGS += -O0 -fprofile-arcs -ftest-coverage
+  QMAKE_LFLAGS += -fprofile-arcs
+}
+
+contains(CONFIG_MYTHLOGSERVER, "yes") {
+  LIBS += -L../../../../external/zeromq/src/.libs -lmythzmq
+  LIBS += -L../../../../external/nzmqt/src -lmythnzmqt
+  QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/zeromq/src/.libs/
+  QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/nzmqt/src/
+}
+
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/FFmpeg/libswresample
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/FFmpeg/libavutil
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/FFmpeg/libswscale
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/FFmpeg/libavformat
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/FFmpeg/libavfilter
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/FFmpeg/libavcodec
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/FFmpeg/libpostproc
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/libhdhomerun
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../libs/libmythbase
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../libs/libmyth
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../libs/libmythui
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../libs/libmythupnp
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../libs/libmythmetadata
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../libs/libmythservicecontracts
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../libs/libmythprotoserver
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../libs/libmythfreemheg
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../libs/libmythlivemedia
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../libs/libmythtv
+
+# Input
+HEADERS += test_scheduler.h
+SOURCES += test_scheduler.cpp
+
+# The scheduler, and the rest of the backend it calls into, without main()
+HEADERS += $$files(../../*.h) $$files(../../services/*.h)
+HEADERS += $$files(../../serviceHosts/*.h)
+SOURCES += $$files(../../*.cpp) $$files(../../services/*.cpp)
+SOURCES -= ../../main.cpp
+
+QMAKE_CLEAN += $(TARGET) $(TARGETA) $(TARGETD) $(TARGET0) $(TARGET1) $(TARGET2)
+QMAKE_CLEAN += ; rm -f *.gcov *.gcda *.gcno
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
@@ -24,6 +24,10 @@ using namespace std;
 #include "ClassicCommDetector.h"
 #include "ClassicLogoDetector.h"
 #include "ClassicSceneChangeDetector.h"
+#include "FramePipeline.h"
+
+// Frames the decoder may run ahead of the slowest analysis thread.
+static const unsigned int kPipelineDepth = 12;
 
 enum frameAspects {
     COMM_ASPECT_NORMAL = 0,
@@ -123,6 +127,42 @@ QString FrameInfoEntry::toString(uint64_t frame, bool verbose) const
         .arg(toStringFrameMaskValues(flagMask, verbose));
 }
 
+class ClassicSceneStage : public FramePipelineStage
+{
+  public:
+    explicit ClassicSceneStage(SceneChangeDetectorBase *detector_in)
+        : detector(detector_in) {}
+
+    QString name(void) const { return "ClassicSceneChangeDetector"; }
+
+    bool processFrame(const VideoFrame *frame, long long)
+    {
+        detector->processFrame(const_cast<VideoFrame*>(frame));
+        return true;
+    }
+
+  private:
+    SceneChangeDetectorBase *detector;
+};
+
+class ClassicFrameStage : public FramePipelineStage
+{
+  public:
+    explicit ClassicFrameStage(ClassicCommDetector *detector_in)
+        : detector(detector_in) {}
+
+    QString name(void) const { return "ClassicCommDetector"; }
+
+    bool processFrame(const VideoFrame *frame, long long frameno)
+    {
+        detector->PipelineFrame(const_cast<VideoFrame*>(frame), frameno);
+        return true;
+    }
+
+  private:
+    ClassicCommDetector *detector;
+};
+
 ClassicCommDetector::ClassicCommDetector(SkipType commDetectMethod_in,
                                          bool showProgress_in,
                                          bool fullSpeed_in,
@@ -130,7 +170,8 @@ ClassicCommDetector::ClassicCommDetector(SkipType commDetectMethod_in,
                                          const QDateTime& startedAt_in,
                                          const QDateTime& stopsAt_in,
                                          const QDateTime& recordingStartedAt_in,
-                                         const QDateTime& recordingStopsAt_in) :
+                                         const QDateTime& recordingStopsAt_in,
+                                         unsigned int threads_in) :
 
 
     commDetectMethod(commDetectMethod_in),
@@ -149,6 +190,8 @@ ClassicCommDetector::ClassicCommDetector(SkipType commDetectMethod_in,
     sceneHasChanged(false),                    stationLogoPresent(false),
     lastFrameWasBlank(false),                  lastFrameWasSceneChange(false),
     decoderFoundAspectChanges(false),          sceneChangeDetector(0),
+    threads(max(threads_in, 1U)),              pipelined(false),
+    pipelineAspect(0.0f),
     player(player_in),
     startedAt(startedAt_in),                   stopsAt(stopsAt_in),
     recordingStartedAt(recordingStartedAt_in),
@@ -273,7 +316,8 @@ void ClassicCommDetector::Init()
          sceneChangeDetector,
          SIGNAL(haveNewInformation(unsigned int,bool,float)),
          this,
-         SLOT(sceneChangeDetectorHasNewInformation(unsigned int,bool,float))
+         SLOT(sceneChangeDetectorHasNewInformation(unsigned int,bool,float)),
+         Qt::DirectConnection
     );
 
     frameIsBlank = false;
@@ -430,6 +474,9 @@ bool ClassicCommDetector::go()
 
     SetVideoParams(aspect);
 
+    FramePipeline *pipeline = StartPipeline();
+    pipelineAspect = aspect;
+
     emit breathe();
 
     player->ResetTotalDuration();
@@ -448,7 +495,7 @@ bool ClassicCommDetector::go()
         //In order to not change too many things at a time, I"m using basic
         //polling for now.
         newAspect = currentFrame->aspect;
-        if (newAspect != aspect)
+        if (!pipeline && newAspect != aspect)
         {
             SetVideoParams(aspect);
             aspect = newAspect;
@@ -462,6 +509,7 @@ bool ClassicCommDetector::go()
             if (m_bStop)
             {
                 player->DiscardVideoFrame(currentFrame);
+                StopPipeline(pipeline);
                 return false;
             }
         }
@@ -475,6 +523,12 @@ bool ClassicCommDetector::go()
             frm_dir_map_t::iterator lastIt;
             bool mapsAreIdentical = false;
 
+            if (pipeline)
+            {
+                pipeline->drain();
+                MergeSceneChanges(-1);
+            }
+
             GetCommercialBreakList(commBreakMap);
 
             if ((commBreakMap.size() == 0) &&
@@ -569,7 +623,10 @@ bool ClassicCommDetector::go()
             }
         }
 
-        ProcessFrame(currentFrame, currentFrameNumber);
+        if (pipeline)
+            pipeline->push(currentFrame, currentFrameNumber);
+        else
+            ProcessFrame(currentFrame, currentFrameNumber);
 
         if (stillRecording)
         {
@@ -604,6 +661,14 @@ bool ClassicCommDetector::go()
         player->DiscardVideoFrame(currentFrame);
     }
 
+    if (pipeline)
+    {
+        pipeline->finish();
+        MergeSceneChanges(-1);
+        pipeline->reportTime();
+        StopPipeline(pipeline);
+    }
+
     if (showProgress)
     {
         float elapsed = flagTime.elapsed() / 1000.0;
@@ -624,8 +689,91 @@ bool ClassicCommDetector::go()
     return true;
 }
 
+/**
+ * Set up worker threads for the frame analysis when more than one thread was
+ * asked for. Scene change detection keeps its own histograms, so it runs on
+ * a thread of its own when there is one to spare and its results are merged
+ * in frame order by the thread running ProcessFrame().
+ */
+FramePipeline *ClassicCommDetector::StartPipeline(void)
+{
+    pipelined = false;
+    if (threads < 2)
+        return NULL;
+
+    FramePipeline *pipeline = new FramePipeline(kPipelineDepth);
+    QList<FramePipelineStage*> frameStages;
+
+    if (commDetectMethod & COMM_DETECT_SCENE)
+    {
+        FramePipelineStage *scene = new ClassicSceneStage(sceneChangeDetector);
+        pipelineStages << scene;
+        if (threads > 2)
+            pipeline->addWorker(QList<FramePipelineStage*>() << scene);
+        else
+            frameStages << scene;
+    }
+    pipelineStages << new ClassicFrameStage(this);
+    frameStages << pipelineStages.last();
+    pipeline->addWorker(frameStages);
+
+    pipelined = true;
+    pipeline->start();
+    return pipeline;
+}
+
+void ClassicCommDetector::StopPipeline(FramePipeline *pipeline)
+{
+    delete pipeline;
+    qDeleteAll(pipelineStages);
+    pipelineStages.clear();
+    pipelined = false;
+}
+
+void ClassicCommDetector::PipelineFrame(VideoFrame *frame,
+                                        long long frame_number)
+{
+    // Same polling as go() does for the serial case, in frame order.
+    if (frame->aspect != pipelineAspect)
+    {
+        SetVideoParams(pipelineAspect);
+        pipelineAspect = frame->aspect;
+    }
+
+    ProcessFrame(frame, frame_number);
+    MergeSceneChanges(curFrameNumber);
+}
+
+void ClassicCommDetector::MergeSceneChanges(long long upTo)
+{
+    QMutexLocker locker(&sceneChangeLock);
+
+    QMap<unsigned int, SceneChange>::iterator it = pendingSceneChanges.begin();
+    while (it != pendingSceneChanges.end() &&
+           (upTo < 0 || (long long)it.key() <= upTo))
+    {
+        SetSceneChange(it.key(), it->isSceneChange, it->debugValue);
+        it = pendingSceneChanges.erase(it);
+    }
+}
+
 void ClassicCommDetector::sceneChangeDetectorHasNewInformation(
     unsigned int framenum,bool isSceneChange,float debugValue)
+{
+    if (pipelined)
+    {
+        QMutexLocker locker(&sceneChangeLock);
+        SceneChange &change = pendingSceneChanges[framenum];
+        change.isSceneChange = isSceneChange;
+        change.debugValue = debugValue;
+        return;
+    }
+
+    SetSceneChange(framenum, isSceneChange, debugValue);
+}
+
+void ClassicCommDetector::SetSceneChange(
+    unsigned int framenum, bool isSceneChange, float debugValue)
 {
     if (isSceneChange)
     {
@@ -839,7 +987,7 @@ void ClassicCommDetector::ProcessFrame(VideoFrame *frame,
     if (commDetectMethod & COMM_DETECT_BLANKS)
         frameIsBlank = false;
 
-    if (commDetectMethod & COMM_DETECT_SCENE)
+    if ((commDetectMethod & COMM_DETECT_SCENE) && !pipelined)
     {
         sceneChangeDetector->processFrame(frame);
     }
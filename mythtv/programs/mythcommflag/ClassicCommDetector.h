@@ -6,6 +6,8 @@
 
 // Qt headers
 #include <QObject>
+#include <QMutex>
+#include <QList>
 #include <QMap>
 #include <QDateTime>
 
@@ -19,6 +21,8 @@
 class MythPlayer;
 class LogoDetectorBase;
 class SceneChangeDetectorBase;
+class FramePipeline;
+class FramePipelineStage;
 
 enum frameMaskValues {
     COMM_FRAME_SKIPPED       = 0x0001,
@@ -53,7 +57,8 @@ class ClassicCommDetector : public CommDetectorBase
                             const QDateTime& startedAt_in,
                             const QDateTime& stopsAt_in,
                             const QDateTime& recordingStartedAt_in,
-                            const QDateTime& recordingStopsAt_in);
+                            const QDateTime& recordingStopsAt_in,
+                            unsigned int threads_in = 1);
         virtual void deleteLater(void);
 
         bool go();
@@ -68,6 +73,7 @@ class ClassicCommDetector : public CommDetectorBase
         void logoDetectorBreathe();
 
         friend class ClassicLogoDetector;
+        friend class ClassicFrameStage;
 
     protected:
         virtual ~ClassicCommDetector() {}
@@ -111,6 +117,12 @@ class ClassicCommDetector : public CommDetectorBase
             frm_dir_map_t &out, const show_map_t &in);
         void CleanupFrameInfo(void);
         void GetLogoCommBreakMap(show_map_t &map);
+        FramePipeline *StartPipeline(void);
+        void StopPipeline(FramePipeline *pipeline);
+        void PipelineFrame(VideoFrame *frame, long long frame_number);
+        void SetSceneChange(unsigned int framenum, bool isSceneChange,
+                            float debugValue);
+        void MergeSceneChanges(long long upTo);
 
         enum SkipTypes commDetectMethod;
         frm_dir_map_t lastSentCommBreakMap;
@@ -171,6 +183,22 @@ class ClassicCommDetector : public CommDetectorBase
 
         SceneChangeDetectorBase* sceneChangeDetector;
 
+        typedef struct scenechange
+        {
+            bool isSceneChange;
+            float debugValue;
+        }
+        SceneChange;
+
+        // With more than one thread, scene changes are found on a worker
+        // thread of their own and merged into frameInfo by the frame stage.
+        unsigned int threads;
+        bool pipelined;
+        float pipelineAspect;
+        QList<FramePipelineStage*> pipelineStages;
+        QMutex sceneChangeLock;
+        QMap<unsigned int, SceneChange> pendingSceneChanges;
+
 protected:
         MythPlayer *player;
         QDateTime startedAt, stopsAt;
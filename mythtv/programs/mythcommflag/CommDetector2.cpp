@@ -12,6 +12,8 @@ using namespace std;
 // Qt headers
 #include <QDir>
 #include <QFileInfo>
+#include <QElapsedTimer>
+#include <QStringList>
 #include <QCoreApplication>
 
 // MythTV headers
@@ -26,6 +28,7 @@ using namespace std;
 #include "CommDetector2.h"
 #include "CannyEdgeDetector.h"
 #include "FrameAnalyzer.h"
+#include "FramePipeline.h"
 #include "PGMConverter.h"
 #include "BorderDetector.h"
 #include "HistogramAnalyzer.h"
@@ -36,6 +39,9 @@ using namespace std;
 
 namespace {
 
+/* Frames queued between the decoding thread and the analyzer threads. */
+const unsigned int kPipelineDepth = 12;
+
 bool stopForBreath(bool isrecording, long long frameno)
 {
     return (isrecording && (frameno % 100) == 0) || (frameno % 500) == 0;
@@ -120,7 +126,8 @@ long long processFrame(FrameAnalyzerItem &pass,
                        FrameAnalyzerItem &finishedAnalyzers,
                        FrameAnalyzerItem &deadAnalyzers,
                        const VideoFrame *frame,
-                       long long frameno)
+                       long long frameno,
+                       AnalyzerTimeMap &times)
 {
     long long nextFrame;
     long long minNextFrame = FrameAnalyzer::ANYFRAME;
@@ -128,8 +135,13 @@ long long processFrame(FrameAnalyzerItem &pass,
     FrameAnalyzerItem::iterator it = pass.begin();
     while (it != pass.end())
     {
+        QElapsedTimer timer;
+        timer.start();
         FrameAnalyzer::analyzeFrameResult ares =
             (*it)->analyzeFrame(frame, frameno, &nextFrame);
+        AnalyzerTime &time = times[*it];
+        time.nsecs += timer.nsecsElapsed();
+        time.frames++;
 
         if ((FrameAnalyzer::ANALYZE_OK == ares) ||
             (FrameAnalyzer::ANALYZE_ERROR == ares))
@@ -174,15 +186,6 @@ int passFinished(FrameAnalyzerItem &pass, long long nframes, bool final)
     return 0;
 }
 
-int passReportTime(const FrameAnalyzerItem &pass)
-{
-    FrameAnalyzerItem::const_iterator it = pass.begin();
-    for (; it != pass.end(); ++it)
-        (void)(*it)->reportTime();
-
-    return 0;
-}
-
 bool searchingForLogo(TemplateFinder *tf, const FrameAnalyzerItem &pass)
 {
     if (!tf)
@@ -194,6 +197,122 @@ bool searchingForLogo(TemplateFinder *tf, const FrameAnalyzerItem &pass)
     return it != pass.end();
 }
 
+bool contains(const FrameAnalyzerItem &item, const FrameAnalyzer *fa)
+{
+    return std::find(item.begin(), item.end(), fa) != item.end();
+}
+
+/*
+ * A pipeline stage running the analyzers of a pass that share state (such as
+ * a HistogramAnalyzer) in the order processFrame would. Each lane keeps its own
+ * finished and dead analyzers and timings until the pass is collected.
+ */
+class AnalyzerLane : public FramePipelineStage
+{
+public:
+    AnalyzerLane(void) : nextFrame(-1) { }
+
+    QString name(void) const
+    {
+        QStringList names;
+        FrameAnalyzerItem::const_iterator it = analyzers.begin();
+        for (; it != analyzers.end(); ++it)
+            names << (*it)->name();
+        return names.join("+");
+    }
+
+    bool processFrame(const VideoFrame *frame, long long frameno)
+    {
+        /* Skip the frames our analyzers don't want. */
+        if (frameno >= nextFrame)
+        {
+            nextFrame = ::processFrame(analyzers, finished, dead, frame,
+                    frameno, times);
+        }
+        return !analyzers.empty();
+    }
+
+    FrameAnalyzerItem   analyzers;
+    FrameAnalyzerItem   finished;
+    FrameAnalyzerItem   dead;
+    AnalyzerTimeMap     times;
+    long long           nextFrame;
+};
+
+typedef vector<AnalyzerLane*> AnalyzerLaneList;
+
+/*
+ * Split "pass" into lanes and spread them over up to "threads" - 1 workers;
+ * the decoding thread is the other one.
+ */
+FramePipeline *startPipeline(const FrameAnalyzerItem &pass,
+        const QMap<const FrameAnalyzer*, int> &analyzerLanes,
+        unsigned int threads, AnalyzerLaneList &lanes)
+{
+    QMap<int, AnalyzerLane*> byLane;
+    FrameAnalyzerItem::const_iterator it = pass.begin();
+    for (; it != pass.end(); ++it)
+    {
+        /* Analyzers without a lane share nothing; give them their own. */
+        int lane = analyzerLanes.value(*it, -1 - (int)(it - pass.begin()));
+        if (!byLane.contains(lane))
+        {
+            byLane[lane] = new AnalyzerLane();
+            lanes.push_back(byLane[lane]);
+        }
+        byLane[lane]->analyzers.push_back(*it);
+    }
+
+    unsigned int nworkers = min((unsigned int)lanes.size(), threads - 1);
+    vector<QList<FramePipelineStage*> > workers(nworkers);
+    for (unsigned int ii = 0; ii < lanes.size(); ii++)
+        workers[ii % nworkers] << lanes[ii];
+
+    FramePipeline *pipeline = new FramePipeline(kPipelineDepth);
+    for (unsigned int ii = 0; ii < nworkers; ii++)
+        pipeline->addWorker(workers[ii]);
+    pipeline->start();
+
+    return pipeline;
+}
+
+/*
+ * Ordered reduction of the lanes' state: the pass's analyzers that are still
+ * running and those that have finished, in the pass's original order.
+ * Only call this while the pipeline is drained.
+ */
+void collectLanes(const AnalyzerLaneList &lanes, const FrameAnalyzerItem &all,
+        const FrameAnalyzerItem &finishedBefore, FrameAnalyzerItem &pass,
+        FrameAnalyzerItem &finishedAnalyzers)
+{
+    pass.clear();
+    finishedAnalyzers = finishedBefore;
+
+    FrameAnalyzerItem::const_iterator it = all.begin();
+    for (; it != all.end(); ++it)
+    {
+        AnalyzerLaneList::const_iterator lane = lanes.begin();
+        for (; lane != lanes.end(); ++lane)
+        {
+            if (contains((*lane)->analyzers, *it))
+                pass.push_back(*it);
+            else if (contains((*lane)->finished, *it))
+                finishedAnalyzers.push_back(*it);
+        }
+    }
+}
+
+void stopPipeline(FramePipeline *&pipeline, AnalyzerLaneList &lanes)
+{
+    delete pipeline;
+    pipeline = NULL;
+
+    AnalyzerLaneList::iterator lane = lanes.begin();
+    for (; lane != lanes.end(); ++lane)
+        delete *lane;
+    lanes.clear();
+}
+
 };  // namespace
 
 namespace commDetector2 {
@@ -313,7 +432,8 @@ CommDetector2::CommDetector2(
     const QDateTime   &endts_in,
     const QDateTime   &recstartts_in,
     const QDateTime   &recendts_in,
-    bool               useDB) :
+    bool               useDB,
+    unsigned int       threads_in) :
     commDetectMethod((enum SkipTypes)(commDetectMethod_in & ~COMM_DETECT_2)),
     showProgress(showProgress_in),  fullSpeed(fullSpeed_in),
     player(player_in),
@@ -322,6 +442,7 @@ CommDetector2::CommDetector2(
     isRecording(MythDate::current() < recendts),
     sendBreakMapUpdates(false),     breakMapUpdateRequested(false),
     finished(false),                currentFrameNumber(0),
+    threads(max(threads_in, 1U)),
     logoFinder(NULL),               logoMatcher(NULL),
     blankFrameDetector(NULL),       sceneChangeDetector(NULL),
     debugdir("")
@@ -357,6 +478,7 @@ CommDetector2::CommDetector2(
             blankFrameDetector = new BlankFrameDetector(histogramAnalyzer,
                     debugdir);
             pass1.push_back(blankFrameDetector);
+            analyzerLanes[blankFrameDetector] = 0;
         }
     }
 
@@ -383,6 +505,7 @@ CommDetector2::CommDetector2(
             sceneChangeDetector = new SceneChangeDetector(histogramAnalyzer,
                     debugdir);
             pass1.push_back(sceneChangeDetector);
+            analyzerLanes[sceneChangeDetector] = 0;
         }
     }
 
@@ -415,9 +538,17 @@ CommDetector2::CommDetector2(
 
         if (!logoMatcher)
         {
-            logoMatcher = new TemplateMatcher(pgmConverter, cannyEdgeDetector,
-                    logoFinder, debugdir);
+            /*
+             * The HistogramAnalyzer converts each frame with pgmConverter too,
+             * so give the matcher its own when they may run on separate
+             * threads.
+             */
+            PGMConverter *matchConverter = threads > 1 ?
+                new PGMConverter() : pgmConverter;
+            logoMatcher = new TemplateMatcher(matchConverter,
+                    cannyEdgeDetector, logoFinder, debugdir);
             pass1.push_back(logoMatcher);
+            analyzerLanes[logoMatcher] = 1;
         }
     }
 
@@ -473,6 +604,24 @@ void CommDetector2::reportState(int elapsedms, long long frameno,
     }
 }
 
+void CommDetector2::reportAnalyzerTimes(const FrameAnalyzerItem &pass,
+        float fps) const
+{
+    FrameAnalyzerItem::const_iterator it = pass.begin();
+    for (; it != pass.end(); ++it)
+    {
+        AnalyzerTime time = analyzerTimes.value(*it);
+        double secs = time.nsecs / 1e9;
+        LOG(VB_COMMFLAG, LOG_INFO,
+            QString("%1 Time: %2 frames in %3s (%4 fps, %5x realtime)")
+                .arg((*it)->name()).arg(time.frames)
+                .arg(secs, 0, 'f', 3)
+                .arg(secs > 0 ? time.frames / secs : 0.0, 0, 'f', 1)
+                .arg(secs > 0 && fps > 0 ? time.frames / fps / secs : 0.0,
+                     0, 'f', 1));
+    }
+}
+
 int CommDetector2::computeBreaks(long long nframes)
 {
     int             trow, tcol, twidth, theight;
@@ -577,6 +726,23 @@ bool CommDetector2::go(void)
             return false;
         }
 
+        /*
+         * Passes that don't skip around the file to sample it can be analyzed
+         * while the next frames are decoded.
+         */
+        FramePipeline *pipeline = NULL;
+        AnalyzerLaneList lanes;
+        const FrameAnalyzerItem passAnalyzers = *currentPass;
+        const FrameAnalyzerItem finishedBefore = finishedAnalyzers;
+        bool pipelineActive = false;
+        if (threads > 1 && !currentPass->empty() &&
+                !searchingForLogo(logoFinder, *currentPass))
+        {
+            pipeline = startPipeline(*currentPass, analyzerLanes, threads,
+                    lanes);
+            pipelineActive = true;
+        }
+
         player->DiscardVideoFrame(player->GetRawVideoFrame(0));
         long long nextFrame = -1;
         currentFrameNumber = 0;
@@ -593,7 +759,8 @@ bool CommDetector2::go(void)
         clock.start();
         passTime.start();
         memset(&getframetime, 0, sizeof(getframetime));
-        while (!(*currentPass).empty() && player->GetEof() == kEofStateNone)
+        while ((pipeline ? pipelineActive : !(*currentPass).empty()) &&
+                player->GetEof() == kEofStateNone)
         {
             struct timeval start, end, elapsedtv;
 
@@ -625,6 +792,7 @@ bool CommDetector2::go(void)
                 if (m_bStop)
                 {
                     player->DiscardVideoFrame(currentFrame);
+                    stopPipeline(pipeline, lanes);
                     return false;
                 }
             }
@@ -643,9 +811,19 @@ bool CommDetector2::go(void)
                         nframes, passno, npasses);
             }
 
-            nextFrame = processFrame(
-                *currentPass, finishedAnalyzers,
-                deadAnalyzers, currentFrame, currentFrameNumber);
+            if (pipeline)
+            {
+                pipelineActive = pipeline->push(currentFrame,
+                        currentFrameNumber);
+                nextFrame = currentFrameNumber + 1;
+            }
+            else
+            {
+                nextFrame = processFrame(
+                    *currentPass, finishedAnalyzers,
+                    deadAnalyzers, currentFrame, currentFrameNumber,
+                    analyzerTimes);
+            }
 
             if (((currentFrameNumber >= 1) && (nframes > 0) &&
                  (((nextFrame * 10) / nframes) !=
@@ -682,6 +860,14 @@ bool CommDetector2::go(void)
             {
                 frm_dir_map_t breakMap;
 
+                if (pipeline)
+                {
+                    /* Let the analyzers catch up, and hold them still. */
+                    pipeline->drain();
+                    collectLanes(lanes, passAnalyzers, finishedBefore,
+                            *currentPass, finishedAnalyzers);
+                }
+
                 GetCommercialBreakList(breakMap);
 
                 frm_dir_map_t::const_iterator ii, jj;
@@ -708,6 +894,21 @@ bool CommDetector2::go(void)
             player->DiscardVideoFrame(currentFrame);
         }
 
+        if (pipeline)
+        {
+            pipeline->finish();
+            collectLanes(lanes, passAnalyzers, finishedBefore,
+                    *currentPass, finishedAnalyzers);
+            for (unsigned int ii = 0; ii < lanes.size(); ii++)
+            {
+                AnalyzerTimeMap::const_iterator tt = lanes[ii]->times.begin();
+                for (; tt != lanes[ii]->times.end(); ++tt)
+                    analyzerTimes[tt.key()] = *tt;
+            }
+            pipeline->reportTime();
+            stopPipeline(pipeline, lanes);
+        }
+
         // Save total duration only on the last pass, which hopefully does
         // no skipping.
         if (passno + 1 == npasses)
@@ -725,8 +926,7 @@ bool CommDetector2::go(void)
 
         LOG(VB_COMMFLAG, LOG_INFO, QString("NVP Time: GetRawVideoFrame=%1s")
                 .arg(strftimeval(&getframetime)));
-        if (passReportTime(*currentPass))
-            return false;
+        reportAnalyzerTimes(*currentPass, player->GetFrameRate());
     }
 
     if (showProgress)
@@ -7,6 +7,7 @@ using namespace std;
 
 // Qt headers
 #include <QDateTime>
+#include <QMap>
 
 // MythTV headers
 #include "programinfo.h"
@@ -34,6 +35,13 @@ QString strftimeval(const struct timeval *tv);
 typedef vector<FrameAnalyzer*>    FrameAnalyzerItem;
 typedef vector<FrameAnalyzerItem> FrameAnalyzerList;
 
+/* Frames analyzed and time spent in analyzeFrame, per analyzer. */
+typedef struct analyzertime {
+    long long   frames;
+    long long   nsecs;
+} AnalyzerTime;
+typedef QMap<const FrameAnalyzer*, AnalyzerTime> AnalyzerTimeMap;
+
 class CommDetector2 : public CommDetectorBase
 {
   public:
@@ -41,7 +49,8 @@ class CommDetector2 : public CommDetectorBase
         SkipType commDetectMethod,
         bool showProgress, bool fullSpeed, MythPlayer* player,
         int chanid, const QDateTime& startts, const QDateTime& endts,
-        const QDateTime& recstartts, const QDateTime& recendts, bool useDB);
+        const QDateTime& recstartts, const QDateTime& recendts, bool useDB,
+        unsigned int threads = 1);
     virtual bool go(void);
     virtual void GetCommercialBreakList(frm_dir_map_t &comms);
     virtual void recordingFinished(long long totalFileSize);
@@ -55,6 +64,7 @@ class CommDetector2 : public CommDetectorBase
     void reportState(int elapsed_sec, long long frameno, long long nframes,
             unsigned int passno, unsigned int npasses);
     int computeBreaks(long long nframes);
+    void reportAnalyzerTimes(const FrameAnalyzerItem &pass, float fps) const;
 
   private:
     enum SkipTypes          commDetectMethod;
@@ -73,6 +83,14 @@ class CommDetector2 : public CommDetectorBase
     FrameAnalyzerList::iterator currentPass;
     FrameAnalyzerItem       finishedAnalyzers;
 
+    /*
+     * With more than one thread, pass analyzers that don't share state run on
+     * their own FramePipeline workers; analyzerLanes groups those that do.
+     */
+    unsigned int            threads;
+    QMap<const FrameAnalyzer*, int> analyzerLanes;
+    AnalyzerTimeMap         analyzerTimes;
+
     FrameAnalyzer::FrameMap breaks;
 
     TemplateFinder          *logoFinder;
@@ -16,7 +16,8 @@ CommDetectorFactory::makeCommDetector(
     const QDateTime& stopsAt,
     const QDateTime& recordingStartedAt,
     const QDateTime& recordingStopsAt,
-    bool useDB)
+    bool useDB,
+    unsigned int threads)
 {
     if(commDetectMethod & COMM_DETECT_PREPOSTROLL)
     {
@@ -30,11 +31,12 @@ CommDetectorFactory::makeCommDetector(
         return new CommDetector2(
             commDetectMethod, showProgress, fullSpeed,
             player, chanid, startedAt, stopsAt,
-            recordingStartedAt, recordingStopsAt, useDB);
+            recordingStartedAt, recordingStopsAt, useDB, threads);
     }
 
     return new ClassicCommDetector(commDetectMethod, showProgress, fullSpeed,
-            player, startedAt, stopsAt, recordingStartedAt, recordingStopsAt);
+            player, startedAt, stopsAt, recordingStartedAt, recordingStopsAt,
+            threads);
 }
 
 
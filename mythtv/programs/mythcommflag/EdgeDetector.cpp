@@ -19,6 +19,7 @@ extern "C" {
 // Commercial Flagging headers
 #include "FrameAnalyzer.h"
 #include "EdgeDetector.h"
+#include "pgmkernels.h"
 
 namespace edgeDetector {
 
@@ -36,26 +37,31 @@ sgm_init_exclude(unsigned int *sgm, const AVPicture *src, int srcheight,
      * that pixel: how much it differs from its neighbors.
      */
     const int       srcwidth = src->linesize[0];
-    int             rr, cc, dx, dy, rr2, cc2;
+    int             rr, rr2, cc1, cc2, cc3;
     unsigned char   *rr0, *rr1;
+    unsigned int    *sgmrow;
 
     memset(sgm, 0, srcwidth * srcheight * sizeof(*sgm));
     rr2 = srcheight - 1;
-    cc2 = srcwidth - 1;
+    cc3 = srcwidth - 1;
     for (rr = 0; rr < rr2; rr++)
     {
-        for (cc = 0; cc < cc2; cc++)
+        rr0 = &src->data[0][rr * srcwidth];
+        rr1 = &src->data[0][(rr + 1) * srcwidth];
+        sgmrow = &sgm[rr * srcwidth];
+
+        if (rr < excluderow || rr >= excluderow + excludeheight ||
+                excludewidth <= 0)
         {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                rr0 = &src->data[0][rr * srcwidth + cc];
-                rr1 = &src->data[0][(rr + 1) * srcwidth + cc];
-                dx = rr1[1] - rr0[0];   /* southeast - northwest */
-                dy = rr1[0] - rr0[1];   /* southwest - northeast */
-                sgm[rr * srcwidth + cc] = dx * dx + dy * dy;
-            }
+            pgm_sgm_row(sgmrow, rr0, rr1, cc3);
+            continue;
         }
+
+        /* Skip the excluded columns [cc1, cc2). */
+        cc1 = min(max(excludecol, 0), cc3);
+        cc2 = min(max(excludecol + excludewidth, cc1), cc3);
+        pgm_sgm_row(sgmrow, rr0, rr1, cc1);
+        pgm_sgm_row(sgmrow + cc2, rr0 + cc2, rr1 + cc2, cc3 - cc2);
     }
     return sgm;
 }
@@ -0,0 +1,281 @@
+// ANSI C headers
+#include <cstring>
+
+// C++ headers
+#include <algorithm>
+
+// Qt headers
+#include <QElapsedTimer>
+
+// MythTV headers
+#include "mythlogging.h"
+#include "mythframe.h"
+#include "mthread.h"
+
+// Commercial Flagging headers
+#include "FramePipeline.h"
+
+class FramePipelineWorker : public MThread
+{
+public:
+    FramePipelineWorker(FramePipeline *_pipeline,
+            const QList<FramePipelineStage*> &_stages, int _index)
+        : MThread(QString("CommFlagWorker%1").arg(_index))
+        , pipeline(_pipeline)
+        , index(_index)
+        , stages(_stages)
+        , active(_stages.size(), true)
+        , nsecs(_stages.size(), 0)
+        , frames(_stages.size(), 0)
+        , consumed(0)
+        , done(_stages.isEmpty())
+        , wait_nsecs(0)
+    {
+    }
+
+    void run(void)
+    {
+        RunProlog();
+
+        for (long long seq = 0;; seq++)
+        {
+            QElapsedTimer timer;
+            timer.start();
+            const FramePipeline::Slot *slot = pipeline->waitForFrame(seq);
+            wait_nsecs += timer.nsecsElapsed();
+            if (!slot)
+                break;
+
+            if (!done)
+                analyze(slot);
+
+            pipeline->frameDone(this);
+        }
+
+        RunEpilog();
+    }
+
+    void analyze(const FramePipeline::Slot *slot)
+    {
+        bool any = false;
+        for (int ii = 0; ii < stages.size(); ii++)
+        {
+            if (!active[ii])
+                continue;
+
+            QElapsedTimer timer;
+            timer.start();
+            active[ii] = stages[ii]->processFrame(slot->frame, slot->frameno);
+            nsecs[ii] += timer.nsecsElapsed();
+            frames[ii]++;
+
+            any |= active[ii];
+        }
+
+        if (!any)
+        {
+            QMutexLocker locker(&pipeline->lock);
+            done = true;
+        }
+    }
+
+    FramePipeline                   *pipeline;
+    int                             index;
+    QList<FramePipelineStage*>      stages;
+    vector<bool>                    active;
+    vector<long long>               nsecs;
+    vector<long long>               frames;
+
+    /* Protected by the pipeline's lock. */
+    long long                       consumed;
+    bool                            done;
+
+    long long                       wait_nsecs;
+};
+
+FramePipeline::FramePipeline(unsigned int depth)
+    : ring(depth ? depth : 1)
+    , pushed(0)
+    , finishing(false)
+    , started(false)
+    , wait_nsecs(0)
+    , copy_nsecs(0)
+{
+    for (unsigned int ii = 0; ii < ring.size(); ii++)
+    {
+        ring[ii].frame = new VideoFrame;
+        memset(ring[ii].frame, 0, sizeof(*ring[ii].frame));
+        ring[ii].buf = NULL;
+        ring[ii].bufsize = 0;
+        ring[ii].frameno = -1;
+    }
+}
+
+FramePipeline::~FramePipeline(void)
+{
+    finish();
+
+    for (unsigned int ii = 0; ii < workers.size(); ii++)
+        delete workers[ii];
+
+    for (unsigned int ii = 0; ii < ring.size(); ii++)
+    {
+        delete ring[ii].frame;
+        delete [] ring[ii].buf;
+    }
+}
+
+void FramePipeline::addWorker(const QList<FramePipelineStage*> &stages)
+{
+    workers.push_back(new FramePipelineWorker(this, stages, workers.size()));
+}
+
+void FramePipeline::start(void)
+{
+    QMutexLocker locker(&lock);
+    if (started)
+        return;
+    started = true;
+
+    for (unsigned int ii = 0; ii < workers.size(); ii++)
+        workers[ii]->start();
+
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("FramePipeline: %1 worker(s), %2 frame(s) deep")
+            .arg(workers.size()).arg(ring.size()));
+}
+
+long long FramePipeline::consumedLocked(void) const
+{
+    long long consumed = pushed;
+    for (unsigned int ii = 0; ii < workers.size(); ii++)
+    {
+        if (!workers[ii]->done)
+            consumed = min(consumed, workers[ii]->consumed);
+    }
+    return consumed;
+}
+
+bool FramePipeline::push(const VideoFrame *frame, long long frameno)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker locker(&lock);
+    while (pushed - consumedLocked() >= (long long)ring.size())
+        frameConsumed.wait(&lock);
+
+    Slot &slot = ring[pushed % ring.size()];
+    locker.unlock();
+
+    wait_nsecs += timer.nsecsElapsed();
+    timer.start();
+
+    /*
+     * Nothing reads this slot until "pushed" moves past it. The pitches and
+     * offsets are relative to the buffer, so a flat copy keeps them valid.
+     */
+    if (slot.bufsize < frame->size)
+    {
+        delete [] slot.buf;
+        slot.buf = new unsigned char[frame->size];
+        slot.bufsize = frame->size;
+    }
+    *slot.frame = *frame;
+    slot.frame->buf = slot.buf;
+    slot.frame->qscale_table = NULL;
+    slot.frame->qstride = 0;
+    memcpy(slot.buf, frame->buf, frame->size);
+    slot.frameno = frameno;
+
+    copy_nsecs += timer.nsecsElapsed();
+
+    locker.relock();
+    pushed++;
+    frameAvailable.wakeAll();
+
+    for (unsigned int ii = 0; ii < workers.size(); ii++)
+    {
+        if (!workers[ii]->done)
+            return true;
+    }
+    return false;
+}
+
+const FramePipeline::Slot *FramePipeline::waitForFrame(long long seq)
+{
+    QMutexLocker locker(&lock);
+    while (seq >= pushed && !finishing)
+        frameAvailable.wait(&lock);
+
+    if (seq >= pushed)
+        return NULL;
+
+    return &ring[seq % ring.size()];
+}
+
+void FramePipeline::frameDone(FramePipelineWorker *worker)
+{
+    QMutexLocker locker(&lock);
+    worker->consumed++;
+    frameConsumed.wakeAll();
+}
+
+void FramePipeline::drain(void)
+{
+    QMutexLocker locker(&lock);
+    while (consumedLocked() < pushed)
+        frameConsumed.wait(&lock);
+}
+
+void FramePipeline::finish(void)
+{
+    lock.lock();
+    finishing = true;
+    frameAvailable.wakeAll();
+    lock.unlock();
+
+    for (unsigned int ii = 0; ii < workers.size(); ii++)
+        workers[ii]->wait();
+}
+
+bool FramePipeline::isActive(void) const
+{
+    QMutexLocker locker(&lock);
+    for (unsigned int ii = 0; ii < workers.size(); ii++)
+    {
+        if (!workers[ii]->done)
+            return true;
+    }
+    return false;
+}
+
+void FramePipeline::reportTime(void) const
+{
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("FramePipeline: %1 frames, decoder copied for %2s, "
+                "waited for workers for %3s")
+            .arg(pushed)
+            .arg(copy_nsecs / 1e9, 0, 'f', 3)
+            .arg(wait_nsecs / 1e9, 0, 'f', 3));
+
+    for (unsigned int ii = 0; ii < workers.size(); ii++)
+    {
+        const FramePipelineWorker *worker = workers[ii];
+        for (int jj = 0; jj < worker->stages.size(); jj++)
+        {
+            LOG(VB_COMMFLAG, LOG_INFO,
+                QString("FramePipeline: worker %1 %2: %3 frames in %4s")
+                    .arg(worker->index)
+                    .arg(worker->stages[jj]->name())
+                    .arg(worker->frames[jj])
+                    .arg(worker->nsecs[jj] / 1e9, 0, 'f', 3));
+        }
+        LOG(VB_COMMFLAG, LOG_INFO,
+            QString("FramePipeline: worker %1 waited for frames for %2s")
+                .arg(worker->index)
+                .arg(worker->wait_nsecs / 1e9, 0, 'f', 3));
+    }
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,107 @@
+/*
+ * FramePipeline
+ *
+ * Feed decoded frames from the decoding thread to frame analysis running on
+ * worker threads.
+ *
+ * The decoding thread copies each frame into a bounded ring of slots, so that
+ * it can go on decoding while the frame is analyzed. Every worker sees every
+ * frame, in order, and runs its stages on it one after the other. A slot is
+ * reused once every worker has finished with it, so decoding blocks when the
+ * slowest worker falls the ring's depth behind.
+ *
+ * Stages that share state must run on the same worker; stages on different
+ * workers must not touch each other's state.
+ */
+
+#ifndef __FRAMEPIPELINE_H__
+#define __FRAMEPIPELINE_H__
+
+// C++ headers
+#include <vector>
+using namespace std;
+
+// Qt headers
+#include <QWaitCondition>
+#include <QString>
+#include <QMutex>
+#include <QList>
+
+typedef struct VideoFrame_ VideoFrame;
+class FramePipelineWorker;
+
+class FramePipelineStage
+{
+public:
+    virtual ~FramePipelineStage(void) { }
+
+    virtual QString name(void) const = 0;
+
+    /*
+     * Called on a worker thread for each frame in turn. Return false once the
+     * stage wants no more frames.
+     */
+    virtual bool processFrame(const VideoFrame *frame, long long frameno) = 0;
+};
+
+class FramePipeline
+{
+public:
+    explicit FramePipeline(unsigned int depth);
+    ~FramePipeline(void);
+
+    /* Run "stages", in order, on each frame on a thread of their own. */
+    void addWorker(const QList<FramePipelineStage*> &stages);
+    unsigned int workerCount(void) const { return workers.size(); }
+
+    void start(void);
+
+    /*
+     * Queue a copy of "frame" for the workers, blocking while the ring is
+     * full. Returns false once no stage wants more frames.
+     */
+    bool push(const VideoFrame *frame, long long frameno);
+
+    /* Wait for the workers to finish every frame pushed so far. */
+    void drain(void);
+
+    /* Drain, then stop the worker threads. */
+    void finish(void);
+
+    bool isActive(void) const;
+
+    void reportTime(void) const;
+
+private:
+    friend class FramePipelineWorker;
+
+    typedef struct slot
+    {
+        VideoFrame      *frame;
+        unsigned char   *buf;
+        int             bufsize;
+        long long       frameno;
+    } Slot;
+
+    const Slot *waitForFrame(long long seq);
+    void frameDone(FramePipelineWorker *worker);
+    long long consumedLocked(void) const;
+
+    vector<Slot>                    ring;
+    vector<FramePipelineWorker*>    workers;
+
+    mutable QMutex                  lock;
+    QWaitCondition                  frameAvailable;
+    QWaitCondition                  frameConsumed;
+    long long                       pushed;
+    bool                            finishing;
+    bool                            started;
+
+    /* Time the decoding thread spent waiting for a free slot & copying. */
+    long long                       wait_nsecs;
+    long long                       copy_nsecs;
+};
+
+#endif  /* !__FRAMEPIPELINE_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
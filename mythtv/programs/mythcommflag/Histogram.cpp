@@ -4,6 +4,7 @@
 #include <cstring>
 
 #include "mythframe.h"
+#include "pgmkernels.h"
 
 Histogram::Histogram()
 {
@@ -74,15 +75,7 @@ unsigned int Histogram::getThresholdForPercentageOfPixels(float percentage)
 
 float Histogram::calculateSimilarityWith(const Histogram& other) const
 {
-    long similar = 0;
-
-    for(unsigned int i = 0; i < 256; i++)
-    {
-        if (data[i] < other.data[i])
-            similar += data[i];
-        else
-            similar += other.data[i];
-    }
+    long similar = histogram_intersect(data, other.data, 256);
 
     //Using c style cast for old gcc compatibility.
     return static_cast<float>(similar) / static_cast<float>(numberOfSamples);
@@ -61,6 +61,10 @@ void MythCommFlagCommandLineParser::LoadArguments(void)
         "off, blank, scene, blankscene, logo, all, "
         "d2, d2_logo, d2_blank, d2_scene, d2_all", "")
             ->SetGroup("Commflagging");
+    add("--threads", "threads", 1U,
+        "Number of threads to decode and analyze frames on. "
+        "1 analyzes each frame on the decoding thread.", "")
+            ->SetGroup("Commflagging");
     add("--outputmethod", "outputmethod", "",
         "Format of output written to outputfile, essentials, full.", "")
             ->SetGroup("Commflagging");
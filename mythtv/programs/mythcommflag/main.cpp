@@ -536,7 +536,8 @@ static int DoFlagCommercials(
         program_info->GetScheduledStartTime(),
         program_info->GetScheduledEndTime(),
         program_info->GetRecordingStartTime(),
-        program_info->GetRecordingEndTime(), useDB);
+        program_info->GetRecordingEndTime(), useDB,
+        cmdline.toUInt("threads"));
 
     if (jobid > 0)
         LOG(VB_COMMFLAG, LOG_INFO,
@@ -21,7 +21,7 @@ HEADERS += ClassicCommDetector.h
 HEADERS += Histogram.h
 HEADERS += quickselect.h
 HEADERS += CommDetector2.h
-HEADERS += pgm.h
+HEADERS += pgm.h pgmkernels.h
 HEADERS += EdgeDetector.h CannyEdgeDetector.h
 HEADERS += PGMConverter.h BorderDetector.h
 HEADERS += FrameAnalyzer.h
@@ -30,6 +30,7 @@ HEADERS += HistogramAnalyzer.h
 HEADERS += BlankFrameDetector.h
 HEADERS += SceneChangeDetector.h
 HEADERS += PrePostRollFlagger.h
+HEADERS += FramePipeline.h
 
 HEADERS += LogoDetectorBase.h SceneChangeDetectorBase.h
 HEADERS += SlotRelayer.h CustomEventRelayer.h
@@ -42,7 +43,7 @@ SOURCES += ClassicCommDetector.cpp
 SOURCES += Histogram.cpp
 SOURCES += quickselect.c
 SOURCES += CommDetector2.cpp
-SOURCES += pgm.cpp
+SOURCES += pgm.cpp pgmkernels.cpp
 SOURCES += EdgeDetector.cpp CannyEdgeDetector.cpp
 SOURCES += PGMConverter.cpp BorderDetector.cpp
 SOURCES += FrameAnalyzer.cpp
@@ -51,6 +52,7 @@ SOURCES += HistogramAnalyzer.cpp
 SOURCES += BlankFrameDetector.cpp
 SOURCES += SceneChangeDetector.cpp
 SOURCES += PrePostRollFlagger.cpp
+SOURCES += FramePipeline.cpp
 
 SOURCES += main.cpp commandlineparser.cpp
 
@@ -0,0 +1,390 @@
+// ANSI C headers
+#include <cstring>
+
+#include "mythconfig.h"
+
+// MythTV headers
+#include "mythframe.h"          // cpu_has_sse2, cpu_has_avx2
+#include "mythlogging.h"
+
+// Commercial Flagging headers
+#include "pgmkernels.h"
+
+/*
+ * The SSE2 and AVX2 versions are built with the compiler's intrinsics and
+ * enabled per function, so the rest of mythcommflag is still built for the
+ * baseline CPU.
+ *
+ * They do the same double precision multiplies and adds as the C version,
+ * in the same order for each pixel, and only work on several pixels at once.
+ * They never use fused multiply-adds, which would round differently.
+ */
+#if ARCH_X86 && HAVE_SSE2 && defined(__GNUC__)
+#define PGM_HAVE_SIMD 1
+#include <immintrin.h>
+#define PGM_SSE2 __attribute__((target("sse2")))
+#define PGM_AVX2 __attribute__((target("avx2")))
+#endif
+
+static int kernels_in_use = -1;
+
+PGMKernels pgm_kernels_best(void)
+{
+#ifdef PGM_HAVE_SIMD
+    if (cpu_has_avx2())
+        return PGM_KERNELS_AVX2;
+    if (cpu_has_sse2())
+        return PGM_KERNELS_SSE2;
+#endif
+    return PGM_KERNELS_C;
+}
+
+bool pgm_kernels_supported(PGMKernels kernels)
+{
+    switch (kernels)
+    {
+        case PGM_KERNELS_C:
+            return true;
+#ifdef PGM_HAVE_SIMD
+        case PGM_KERNELS_SSE2:
+            return cpu_has_sse2();
+        case PGM_KERNELS_AVX2:
+            return cpu_has_avx2();
+#endif
+        default:
+            return false;
+    }
+}
+
+const char *pgm_kernels_name(PGMKernels kernels)
+{
+    switch (kernels)
+    {
+        case PGM_KERNELS_C:     return "C";
+        case PGM_KERNELS_SSE2:  return "SSE2";
+        case PGM_KERNELS_AVX2:  return "AVX2";
+    }
+    return "unknown";
+}
+
+PGMKernels pgm_kernels(void)
+{
+    if (kernels_in_use < 0)
+    {
+        kernels_in_use = pgm_kernels_best();
+        LOG(VB_COMMFLAG, LOG_INFO, QString("Image analysis using %1 kernels")
+                .arg(pgm_kernels_name((PGMKernels)kernels_in_use)));
+    }
+    return (PGMKernels)kernels_in_use;
+}
+
+PGMKernels pgm_kernels_select(PGMKernels kernels)
+{
+    PGMKernels previous = pgm_kernels();
+    kernels_in_use = pgm_kernels_supported(kernels) ?
+        kernels : pgm_kernels_best();
+    return previous;
+}
+
+/*
+ * Plain C versions; these also finish the last few pixels of a row for the
+ * SIMD versions.
+ */
+
+static void convolve_row_c(unsigned char *dst, const unsigned char *src,
+        int step, int start, int count, const double *mask, int mask_radius)
+{
+    for (int xx = start; xx < count; xx++)
+    {
+        double sum = 0;
+        for (int ii = -mask_radius; ii <= mask_radius; ii++)
+            sum += mask[ii + mask_radius] * src[xx + ii * step];
+        dst[xx] = (unsigned char)(sum + 0.5);
+    }
+}
+
+static void sgm_row_c(unsigned int *sgm, const unsigned char *row0,
+        const unsigned char *row1, int start, int count)
+{
+    for (int xx = start; xx < count; xx++)
+    {
+        int dx = row1[xx + 1] - row0[xx];   /* southeast - northwest */
+        int dy = row1[xx] - row0[xx + 1];   /* southwest - northeast */
+        sgm[xx] = dx * dx + dy * dy;
+    }
+}
+
+static long histogram_intersect_c(const int *a, const int *b, int start,
+        int count)
+{
+    long similar = 0;
+    for (int ii = start; ii < count; ii++)
+        similar += a[ii] < b[ii] ? a[ii] : b[ii];
+    return similar;
+}
+
+#ifdef PGM_HAVE_SIMD
+
+/* SSE2: 4 pixels per step (2 doubles per register). */
+
+PGM_SSE2
+static int convolve_row_sse2(unsigned char *dst, const unsigned char *src,
+        int step, int count, const double *mask, int mask_radius)
+{
+    const __m128i   zero = _mm_setzero_si128();
+    const __m128d   half = _mm_set1_pd(0.5);
+    int             xx;
+
+    for (xx = 0; xx + 4 <= count; xx += 4)
+    {
+        __m128d sum0 = _mm_setzero_pd();
+        __m128d sum1 = _mm_setzero_pd();
+
+        for (int ii = -mask_radius; ii <= mask_radius; ii++)
+        {
+            int pixels;
+            memcpy(&pixels, src + xx + ii * step, sizeof(pixels));
+            __m128i vv = _mm_unpacklo_epi16(
+                _mm_unpacklo_epi8(_mm_cvtsi32_si128(pixels), zero), zero);
+            __m128d mm = _mm_set1_pd(mask[ii + mask_radius]);
+
+            sum0 = _mm_add_pd(sum0, _mm_mul_pd(mm, _mm_cvtepi32_pd(vv)));
+            sum1 = _mm_add_pd(sum1, _mm_mul_pd(mm,
+                        _mm_cvtepi32_pd(_mm_srli_si128(vv, 8))));
+        }
+
+        __m128i out = _mm_unpacklo_epi64(
+            _mm_cvttpd_epi32(_mm_add_pd(sum0, half)),
+            _mm_cvttpd_epi32(_mm_add_pd(sum1, half)));
+        out = _mm_packs_epi32(out, out);
+        out = _mm_packus_epi16(out, out);
+        int pixels = _mm_cvtsi128_si32(out);
+        memcpy(dst + xx, &pixels, sizeof(pixels));
+    }
+    return xx;
+}
+
+/* SSE2: 8 pixels per step. */
+
+PGM_SSE2
+static int sgm_row_sse2(unsigned int *sgm, const unsigned char *row0,
+        const unsigned char *row1, int count)
+{
+    const __m128i   zero = _mm_setzero_si128();
+    int             xx;
+
+    for (xx = 0; xx + 8 <= count; xx += 8)
+    {
+        __m128i nw = _mm_unpacklo_epi8(
+            _mm_loadl_epi64((const __m128i*)(row0 + xx)), zero);
+        __m128i ne = _mm_unpacklo_epi8(
+            _mm_loadl_epi64((const __m128i*)(row0 + xx + 1)), zero);
+        __m128i sw = _mm_unpacklo_epi8(
+            _mm_loadl_epi64((const __m128i*)(row1 + xx)), zero);
+        __m128i se = _mm_unpacklo_epi8(
+            _mm_loadl_epi64((const __m128i*)(row1 + xx + 1)), zero);
+        __m128i dx = _mm_sub_epi16(se, nw);
+        __m128i dy = _mm_sub_epi16(sw, ne);
+
+        /* (dx, dy) pairs; madd gives dx * dx + dy * dy. */
+        __m128i lo = _mm_unpacklo_epi16(dx, dy);
+        __m128i hi = _mm_unpackhi_epi16(dx, dy);
+        _mm_storeu_si128((__m128i*)(sgm + xx), _mm_madd_epi16(lo, lo));
+        _mm_storeu_si128((__m128i*)(sgm + xx + 4), _mm_madd_epi16(hi, hi));
+    }
+    return xx;
+}
+
+/*
+ * SSE2: 4 buckets per step. The buckets hold pixel counts, so a lane's sum
+ * can't exceed the number of pixels sampled.
+ */
+
+PGM_SSE2
+static long histogram_intersect_sse2(const int *a, const int *b, int count,
+        int *done)
+{
+    __m128i sum = _mm_setzero_si128();
+    int     ii;
+
+    for (ii = 0; ii + 4 <= count; ii += 4)
+    {
+        __m128i aa = _mm_loadu_si128((const __m128i*)(a + ii));
+        __m128i bb = _mm_loadu_si128((const __m128i*)(b + ii));
+        __m128i lt = _mm_cmplt_epi32(aa, bb);
+        sum = _mm_add_epi32(sum, _mm_or_si128(_mm_and_si128(lt, aa),
+                    _mm_andnot_si128(lt, bb)));
+    }
+
+    int lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, sum);
+    *done = ii;
+    return (long)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+/* AVX2: 8 pixels per step (4 doubles per register). */
+
+PGM_AVX2
+static int convolve_row_avx2(unsigned char *dst, const unsigned char *src,
+        int step, int count, const double *mask, int mask_radius)
+{
+    const __m256d   half = _mm256_set1_pd(0.5);
+    int             xx;
+
+    for (xx = 0; xx + 8 <= count; xx += 8)
+    {
+        __m256d sum0 = _mm256_setzero_pd();
+        __m256d sum1 = _mm256_setzero_pd();
+
+        for (int ii = -mask_radius; ii <= mask_radius; ii++)
+        {
+            __m256i vv = _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64((const __m128i*)(src + xx + ii * step)));
+            __m256d mm = _mm256_set1_pd(mask[ii + mask_radius]);
+
+            sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(mm,
+                        _mm256_cvtepi32_pd(_mm256_castsi256_si128(vv))));
+            sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(mm,
+                        _mm256_cvtepi32_pd(_mm256_extracti128_si256(vv, 1))));
+        }
+
+        __m128i out = _mm_packs_epi32(
+            _mm256_cvttpd_epi32(_mm256_add_pd(sum0, half)),
+            _mm256_cvttpd_epi32(_mm256_add_pd(sum1, half)));
+        out = _mm_packus_epi16(out, out);
+        _mm_storel_epi64((__m128i*)(dst + xx), out);
+    }
+    return xx;
+}
+
+/* AVX2: 16 pixels per step. */
+
+PGM_AVX2
+static int sgm_row_avx2(unsigned int *sgm, const unsigned char *row0,
+        const unsigned char *row1, int count)
+{
+    int xx;
+
+    for (xx = 0; xx + 16 <= count; xx += 16)
+    {
+        __m256i nw = _mm256_cvtepu8_epi16(
+            _mm_loadu_si128((const __m128i*)(row0 + xx)));
+        __m256i ne = _mm256_cvtepu8_epi16(
+            _mm_loadu_si128((const __m128i*)(row0 + xx + 1)));
+        __m256i sw = _mm256_cvtepu8_epi16(
+            _mm_loadu_si128((const __m128i*)(row1 + xx)));
+        __m256i se = _mm256_cvtepu8_epi16(
+            _mm_loadu_si128((const __m128i*)(row1 + xx + 1)));
+        __m256i dx = _mm256_sub_epi16(se, nw);
+        __m256i dy = _mm256_sub_epi16(sw, ne);
+
+        /*
+         * The unpacks work within each 128-bit half: "lo" holds pixels 0-3
+         * and 8-11, "hi" pixels 4-7 and 12-15.
+         */
+        __m256i lo = _mm256_unpacklo_epi16(dx, dy);
+        __m256i hi = _mm256_unpackhi_epi16(dx, dy);
+        lo = _mm256_madd_epi16(lo, lo);
+        hi = _mm256_madd_epi16(hi, hi);
+        _mm256_storeu_si256((__m256i*)(sgm + xx),
+                _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(sgm + xx + 8),
+                _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    return xx;
+}
+
+/* AVX2: 8 buckets per step. */
+
+PGM_AVX2
+static long histogram_intersect_avx2(const int *a, const int *b, int count,
+        int *done)
+{
+    __m256i sum = _mm256_setzero_si256();
+    int     ii;
+
+    for (ii = 0; ii + 8 <= count; ii += 8)
+    {
+        __m256i aa = _mm256_loadu_si256((const __m256i*)(a + ii));
+        __m256i bb = _mm256_loadu_si256((const __m256i*)(b + ii));
+        sum = _mm256_add_epi32(sum, _mm256_min_epi32(aa, bb));
+    }
+
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, sum);
+    *done = ii;
+    long similar = 0;
+    for (int jj = 0; jj < 8; jj++)
+        similar += lanes[jj];
+    return similar;
+}
+
+#endif /* PGM_HAVE_SIMD */
+
+void pgm_convolve_row(unsigned char *dst, const unsigned char *src,
+        int step, int count, const double *mask, int mask_radius)
+{
+    int done = 0;
+
+#ifdef PGM_HAVE_SIMD
+    switch (pgm_kernels())
+    {
+        case PGM_KERNELS_AVX2:
+            done = convolve_row_avx2(dst, src, step, count, mask, mask_radius);
+            break;
+        case PGM_KERNELS_SSE2:
+            done = convolve_row_sse2(dst, src, step, count, mask, mask_radius);
+            break;
+        default:
+            break;
+    }
+#endif
+
+    convolve_row_c(dst, src, step, done, count, mask, mask_radius);
+}
+
+void pgm_sgm_row(unsigned int *sgm, const unsigned char *row0,
+        const unsigned char *row1, int count)
+{
+    int done = 0;
+
+#ifdef PGM_HAVE_SIMD
+    switch (pgm_kernels())
+    {
+        case PGM_KERNELS_AVX2:
+            done = sgm_row_avx2(sgm, row0, row1, count);
+            break;
+        case PGM_KERNELS_SSE2:
+            done = sgm_row_sse2(sgm, row0, row1, count);
+            break;
+        default:
+            break;
+    }
+#endif
+
+    sgm_row_c(sgm, row0, row1, done, count);
+}
+
+long histogram_intersect(const int *a, const int *b, int count)
+{
+    long    similar = 0;
+    int     done = 0;
+
+#ifdef PGM_HAVE_SIMD
+    switch (pgm_kernels())
+    {
+        case PGM_KERNELS_AVX2:
+            similar = histogram_intersect_avx2(a, b, count, &done);
+            break;
+        case PGM_KERNELS_SSE2:
+            similar = histogram_intersect_sse2(a, b, count, &done);
+            break;
+        default:
+            break;
+    }
+#endif
+
+    return similar + histogram_intersect_c(a, b, done, count);
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
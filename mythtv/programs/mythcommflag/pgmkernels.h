@@ -0,0 +1,56 @@
+/*
+ * pgmkernels.h
+ *
+ * Inner loops of the greyscale image analysis, with SSE2 and AVX2 versions
+ * picked at run time. Every version gives bit-exact results with the plain C
+ * version.
+ */
+
+#ifndef __PGMKERNELS_H__
+#define __PGMKERNELS_H__
+
+enum PGMKernels
+{
+    PGM_KERNELS_C = 0,
+    PGM_KERNELS_SSE2,
+    PGM_KERNELS_AVX2
+};
+
+/* The fastest set of kernels this CPU can run. */
+PGMKernels pgm_kernels_best(void);
+bool pgm_kernels_supported(PGMKernels kernels);
+const char *pgm_kernels_name(PGMKernels kernels);
+
+/* The set of kernels in use, the best one unless another was selected. */
+PGMKernels pgm_kernels(void);
+
+/*
+ * Use "kernels" from now on, or the best one if this CPU can't run them.
+ * Returns the set previously in use. For the tests and benchmarks; not to be
+ * called while frames are being analyzed.
+ */
+PGMKernels pgm_kernels_select(PGMKernels kernels);
+
+/*
+ * One row of a convolution with a (2 * mask_radius + 1)-wide mask:
+ * dst[x] = sum(mask[ii + mask_radius] * src[x + ii * step]) rounded, for
+ * "count" pixels. "step" is 1 for a horizontal convolution and the image
+ * width for a vertical one.
+ */
+void pgm_convolve_row(unsigned char *dst, const unsigned char *src,
+        int step, int count, const double *mask, int mask_radius);
+
+/*
+ * One row of squared gradient magnitudes, on 45-degree rotated axes, of the
+ * pixels in "row0" using their neighbours in "row0" and "row1". Both rows
+ * must hold "count" + 1 pixels.
+ */
+void pgm_sgm_row(unsigned int *sgm, const unsigned char *row0,
+        const unsigned char *row1, int count);
+
+/* The sum of min(a[ii], b[ii]) of two histograms of "count" buckets. */
+long histogram_intersect(const int *a, const int *b, int count);
+
+#endif  /* !__PGMKERNELS_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,148 @@
+/*
+ *  Class BenchPGMKernels
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "bench_pgmkernels.h"
+
+#include <QElapsedTimer>
+
+#include "pgmsamples.h"
+#include "pgmkernels.h"
+#include "Histogram.h"
+
+void BenchPGMKernels::initTestCase(void)
+{
+    pgm_sample_frames(m_frames, m_mask);
+}
+
+void BenchPGMKernels::cleanup(void)
+{
+    pgm_kernels_select(pgm_kernels_best());
+}
+
+void BenchPGMKernels::convolve_data(void)
+{
+    pgm_sample_kernels_data(true);
+}
+
+void BenchPGMKernels::convolve(void)
+{
+    QFETCH(PGMKernels, kernels);
+    if (!pgm_kernels_supported(kernels))
+        MSKIP("CPU doesn't support these kernels");
+    pgm_kernels_select(kernels);
+
+    const int w = WIDTH + 2 * RADIUS;
+    const int h = HEIGHT + 2 * RADIUS;
+    AVPicture s1, s2, dst;
+    avpicture_alloc(&s1, AV_PIX_FMT_GRAY8, w, h);
+    avpicture_alloc(&s2, AV_PIX_FMT_GRAY8, w, h);
+    avpicture_alloc(&dst, AV_PIX_FMT_GRAY8, w, h);
+
+    QElapsedTimer timer;
+    timer.start();
+    uint64_t frames = 0;
+    QBENCHMARK
+    {
+        for (int ff = 0; ff < m_frames.size(); ff++)
+            pgm_sample_convolve(&dst, &s1, &s2, m_frames[ff], m_mask);
+        frames += m_frames.size();
+    }
+    qint64 ns = timer.nsecsElapsed();
+    qDebug() << QString("%1 convolve: %2 ms/frame")
+        .arg(pgm_kernels_name(kernels))
+        .arg(frames ? ns / 1000000.0 / frames : 0.0, 0, 'f', 3);
+
+    avpicture_free(&dst);
+    avpicture_free(&s2);
+    avpicture_free(&s1);
+}
+
+void BenchPGMKernels::sgm_data(void)
+{
+    pgm_sample_kernels_data(true);
+}
+
+void BenchPGMKernels::sgm(void)
+{
+    QFETCH(PGMKernels, kernels);
+    if (!pgm_kernels_supported(kernels))
+        MSKIP("CPU doesn't support these kernels");
+    pgm_kernels_select(kernels);
+
+    QVector<unsigned int> sgm(WIDTH * HEIGHT);
+
+    QElapsedTimer timer;
+    timer.start();
+    uint64_t frames = 0;
+    QBENCHMARK
+    {
+        for (int ff = 0; ff < m_frames.size(); ff++)
+        {
+            const unsigned char *buf = reinterpret_cast<const unsigned char*>(
+                m_frames[ff].constData());
+            for (int yy = 0; yy < HEIGHT - 1; yy++)
+            {
+                pgm_sgm_row(sgm.data() + yy * WIDTH, buf + yy * WIDTH,
+                            buf + (yy + 1) * WIDTH, WIDTH - 1);
+            }
+        }
+        frames += m_frames.size();
+    }
+    qint64 ns = timer.nsecsElapsed();
+    qDebug() << QString("%1 sgm: %2 ms/frame")
+        .arg(pgm_kernels_name(kernels))
+        .arg(frames ? ns / 1000000.0 / frames : 0.0, 0, 'f', 3);
+}
+
+void BenchPGMKernels::histogram_data(void)
+{
+    pgm_sample_kernels_data(true);
+}
+
+void BenchPGMKernels::histogram(void)
+{
+    QFETCH(PGMKernels, kernels);
+    if (!pgm_kernels_supported(kernels))
+        MSKIP("CPU doesn't support these kernels");
+    pgm_kernels_select(kernels);
+
+    // As ClassicSceneChangeDetector: build a histogram, compare with the
+    // previous frame's
+    QElapsedTimer timer;
+    timer.start();
+    uint64_t frames = 0;
+    float similar = 0;
+    QBENCHMARK
+    {
+        Histogram histogram, previous;
+        for (int ff = 0; ff < m_frames.size(); ff++)
+        {
+            pgm_sample_histogram(histogram, m_frames[ff]);
+            similar += histogram.calculateSimilarityWith(previous);
+            previous = histogram;
+        }
+        frames += m_frames.size();
+    }
+    qint64 ns = timer.nsecsElapsed();
+    qDebug() << QString("%1 histogram: %2 ms/frame")
+        .arg(pgm_kernels_name(kernels))
+        .arg(frames ? ns / 1000000.0 / frames : 0.0, 0, 'f', 3);
+    QVERIFY(similar >= 0);
+}
+
+QTEST_APPLESS_MAIN(BenchPGMKernels)
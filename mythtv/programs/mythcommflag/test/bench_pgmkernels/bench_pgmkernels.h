@@ -0,0 +1,50 @@
+/*
+ *  Class BenchPGMKernels
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QByteArray>
+#include <QList>
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+#define MSKIP(MSG) QSKIP(MSG, SkipSingle)
+#else
+#define MSKIP(MSG) QSKIP(MSG)
+#endif
+
+class BenchPGMKernels: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    // called at the beginning of these sets of tests
+    void initTestCase(void);
+    void cleanup(void);
+
+    /** ms/frame of each kernel set over the same sample frames */
+    void convolve_data(void);
+    void convolve(void);
+    void sgm_data(void);
+    void sgm(void);
+    void histogram_data(void);
+    void histogram(void);
+
+  private:
+    /// The sample frames of pgm_sample_frames()
+    QList<QByteArray> m_frames;
+    double m_mask[5];
+};
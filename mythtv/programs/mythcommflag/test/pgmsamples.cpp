@@ -0,0 +1,93 @@
+/*
+ *  Sample frames for the image analysis kernel tests and benchmarks
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "pgmsamples.h"
+
+#include <QtTest/QtTest>
+#include <cmath>
+
+#include "mythframe.h"
+#include "pgm.h"
+#include "Histogram.h"
+
+void pgm_sample_frames(QList<QByteArray> &frames, double *mask)
+{
+    // Same Gaussian mask as CannyEdgeDetector, sigma = 0.5
+    double sum = 0;
+    for (int rr = -RADIUS; rr <= RADIUS; rr++)
+    {
+        mask[rr + RADIUS] = exp(-(rr * rr) / 0.5);
+        sum += mask[rr + RADIUS];
+    }
+    for (int ii = 0; ii < 2 * RADIUS + 1; ii++)
+        mask[ii] /= sum;
+
+    // Fixed seed, so every run and every kernel set sees the same frames
+    uint seed = 12345;
+    for (int ff = 0; ff < FRAMES; ff++)
+    {
+        QByteArray frame(WIDTH * HEIGHT, 0);
+        unsigned char *buf = reinterpret_cast<unsigned char*>(frame.data());
+        for (int yy = 0; yy < HEIGHT; yy++)
+        {
+            for (int xx = 0; xx < WIDTH; xx++)
+            {
+                seed = seed * 1103515245 + 12345;
+                int val = (xx + yy * ff) % 256;
+                val = (val + (int)((seed >> 16) % 64) - 32) & 0xff;
+                if (ff == 2 && (yy < 60 || yy >= HEIGHT - 60))
+                    val = 16;                       // letterboxed
+                if (ff == 3 && (xx < 90 || xx >= WIDTH - 90))
+                    val = 16;                       // pillarboxed
+                if (ff >= 4 && xx >= 600 && xx < 680 && yy >= 40 && yy < 80)
+                    val = ((xx / 8 + yy / 8) & 1) ? 235 : 40;   // logo
+                if (ff == FRAMES - 1)
+                    val = 16;                       // blank
+                buf[yy * WIDTH + xx] = val;
+            }
+        }
+        frames.append(frame);
+    }
+}
+
+void pgm_sample_kernels_data(bool withC)
+{
+    QTest::addColumn<PGMKernels>("kernels");
+    if (withC)
+        QTest::newRow("C") << PGM_KERNELS_C;
+    QTest::newRow("SSE2") << PGM_KERNELS_SSE2;
+    QTest::newRow("AVX2") << PGM_KERNELS_AVX2;
+}
+
+void pgm_sample_convolve(AVPicture *dst, AVPicture *s1, AVPicture *s2,
+                         const QByteArray &frame, const double *mask)
+{
+    AVPicture src;
+    avpicture_fill(&src, (uint8_t*)frame.constData(), AV_PIX_FMT_GRAY8,
+                   WIDTH, HEIGHT);
+    pgm_convolve_radial(dst, s1, s2, &src, HEIGHT, mask, RADIUS);
+}
+
+void pgm_sample_histogram(Histogram &histogram, const QByteArray &frame)
+{
+    VideoFrame vf;
+    init(&vf, FMT_YV12, (unsigned char*)frame.constData(), WIDTH, HEIGHT,
+         frame.size(), NULL, NULL, -1.0f, -1.0f, 0);
+    histogram.generateFromImage(&vf, WIDTH, HEIGHT, 20, WIDTH - 20,
+                                20, HEIGHT - 20, 4, 4);
+}
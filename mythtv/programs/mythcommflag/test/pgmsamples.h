@@ -0,0 +1,53 @@
+/*
+ *  Sample frames for the image analysis kernel tests and benchmarks
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef PGMSAMPLES_H
+#define PGMSAMPLES_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMetaType>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+#include "pgmkernels.h"
+
+class Histogram;
+
+#define FRAMES  8
+#define WIDTH   720
+#define HEIGHT  480
+#define RADIUS  2
+
+Q_DECLARE_METATYPE(PGMKernels)
+
+/// Fills \p frames with a fixed sample of greyscale frames: gradients,
+/// noise, a logo, letterboxing and a blank frame.  \p mask gets the
+/// Gaussian mask of CannyEdgeDetector.
+void pgm_sample_frames(QList<QByteArray> &frames, double *mask);
+
+/// Adds a "kernels" column with a row for each kernel set
+void pgm_sample_kernels_data(bool withC);
+
+void pgm_sample_convolve(AVPicture *dst, AVPicture *s1, AVPicture *s2,
+                         const QByteArray &frame, const double *mask);
+void pgm_sample_histogram(Histogram &histogram, const QByteArray &frame);
+
+#endif
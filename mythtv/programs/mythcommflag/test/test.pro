@@ -0,0 +1,15 @@
+include (../../../settings.pro)
+
+TEMPLATE = subdirs
+
+SUBDIRS += $$files(test_*)
+SUBDIRS += bench_pgmkernels
+
+unittest.target = test
+unittest.commands = ../../scripts/unittests.sh
+unix:QMAKE_EXTRA_TARGETS += unittest
+
+# ms/frame of each image analysis kernel set over the same sample frames
+benchmark.target = benchmark
+benchmark.commands = bench_pgmkernels/bench_pgmkernels
+unix:QMAKE_EXTRA_TARGETS += benchmark
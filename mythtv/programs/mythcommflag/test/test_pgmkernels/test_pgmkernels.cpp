@@ -0,0 +1,147 @@
+/*
+ *  Class TestPGMKernels
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_pgmkernels.h"
+
+#include "pgmsamples.h"
+#include "pgmkernels.h"
+#include "Histogram.h"
+
+void TestPGMKernels::initTestCase(void)
+{
+    pgm_sample_frames(m_frames, m_mask);
+}
+
+void TestPGMKernels::cleanup(void)
+{
+    pgm_kernels_select(pgm_kernels_best());
+}
+
+void TestPGMKernels::convolve_data(void)
+{
+    pgm_sample_kernels_data(false);
+}
+
+void TestPGMKernels::convolve(void)
+{
+    QFETCH(PGMKernels, kernels);
+    if (!pgm_kernels_supported(kernels))
+        MSKIP("CPU doesn't support these kernels");
+
+    const int w = WIDTH + 2 * RADIUS;
+    const int h = HEIGHT + 2 * RADIUS;
+    AVPicture s1, s2, ref, out;
+    avpicture_alloc(&s1, AV_PIX_FMT_GRAY8, w, h);
+    avpicture_alloc(&s2, AV_PIX_FMT_GRAY8, w, h);
+    avpicture_alloc(&ref, AV_PIX_FMT_GRAY8, w, h);
+    avpicture_alloc(&out, AV_PIX_FMT_GRAY8, w, h);
+
+    for (int ff = 0; ff < m_frames.size(); ff++)
+    {
+        pgm_kernels_select(PGM_KERNELS_C);
+        pgm_sample_convolve(&ref, &s1, &s2, m_frames[ff], m_mask);
+        pgm_kernels_select(kernels);
+        pgm_sample_convolve(&out, &s1, &s2, m_frames[ff], m_mask);
+        QVERIFY2(memcmp(ref.data[0], out.data[0], w * h) == 0,
+                 qPrintable(QString("frame %1").arg(ff)));
+    }
+
+    avpicture_free(&out);
+    avpicture_free(&ref);
+    avpicture_free(&s2);
+    avpicture_free(&s1);
+}
+
+void TestPGMKernels::sgm_data(void)
+{
+    pgm_sample_kernels_data(false);
+}
+
+void TestPGMKernels::sgm(void)
+{
+    QFETCH(PGMKernels, kernels);
+    if (!pgm_kernels_supported(kernels))
+        MSKIP("CPU doesn't support these kernels");
+
+    QVector<unsigned int> ref(WIDTH), out(WIDTH);
+    for (int ff = 0; ff < m_frames.size(); ff++)
+    {
+        const unsigned char *buf =
+            reinterpret_cast<const unsigned char*>(m_frames[ff].constData());
+        for (int yy = 0; yy < HEIGHT - 1; yy++)
+        {
+            // Odd starts and lengths exercise unaligned loads and the tails
+            int start = yy % 17;
+            int count = WIDTH - 1 - start - (yy % 5);
+            const unsigned char *row0 = buf + yy * WIDTH + start;
+            const unsigned char *row1 = row0 + WIDTH;
+
+            ref.fill(0);
+            out.fill(0);
+            pgm_kernels_select(PGM_KERNELS_C);
+            pgm_sgm_row(ref.data(), row0, row1, count);
+            pgm_kernels_select(kernels);
+            pgm_sgm_row(out.data(), row0, row1, count);
+            QVERIFY2(ref == out,
+                     qPrintable(QString("frame %1 row %2").arg(ff).arg(yy)));
+        }
+    }
+}
+
+void TestPGMKernels::histogram_data(void)
+{
+    pgm_sample_kernels_data(false);
+}
+
+void TestPGMKernels::histogram(void)
+{
+    QFETCH(PGMKernels, kernels);
+    if (!pgm_kernels_supported(kernels))
+        MSKIP("CPU doesn't support these kernels");
+
+    QVector<Histogram> histograms(m_frames.size());
+    for (int ff = 0; ff < m_frames.size(); ff++)
+        pgm_sample_histogram(histograms[ff], m_frames[ff]);
+
+    for (int ff = 0; ff < m_frames.size(); ff++)
+    {
+        for (int gg = 0; gg < m_frames.size(); gg++)
+        {
+            pgm_kernels_select(PGM_KERNELS_C);
+            float ref = histograms[ff].calculateSimilarityWith(histograms[gg]);
+            pgm_kernels_select(kernels);
+            float out = histograms[ff].calculateSimilarityWith(histograms[gg]);
+            QVERIFY2(ref == out,
+                     qPrintable(QString("frames %1 and %2").arg(ff).arg(gg)));
+        }
+    }
+
+    // Bucket counts that don't fill a whole register
+    int a[13], b[13];
+    for (int ii = 0; ii < 13; ii++)
+    {
+        a[ii] = ii * 1000;
+        b[ii] = 12000 - ii * 1000;
+    }
+    pgm_kernels_select(PGM_KERNELS_C);
+    long ref = histogram_intersect(a, b, 13);
+    pgm_kernels_select(kernels);
+    QCOMPARE(histogram_intersect(a, b, 13), ref);
+}
+
+QTEST_APPLESS_MAIN(TestPGMKernels)
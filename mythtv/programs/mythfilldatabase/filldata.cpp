@@ -306,24 +306,47 @@ bool FillData::GrabDDData(Source source, int poffset,
 }
 
 // XMLTV stuff
+
+/// Hands what the XMLTV parser reads to the database as it goes
+class FillDataXMLTVHandler : public XMLTVHandler
+{
+  public:
+    FillDataXMLTVHandler(FillData &filldata, int id) :
+        m_filldata(filldata), m_id(id), m_count(0) {}
+
+    void HandleChannels(ChannelInfoList &chanlist)
+    {
+        m_filldata.chan_data.handleChannels(m_id, &chanlist);
+    }
+
+    void HandlePrograms(ProgInfoMap &proglist)
+    {
+        ProgInfoMap::const_iterator it = proglist.constBegin();
+        for (; it != proglist.constEnd(); ++it)
+            m_count += it->size();
+        m_filldata.prog_data.HandlePrograms(m_id, proglist);
+    }
+
+    uint GetCount(void) const { return m_count; }
+
+  private:
+    FillData &m_filldata;
+    int       m_id;
+    uint      m_count;
+};
+
 bool FillData::GrabDataFromFile(int id, QString &filename)
 {
-    ChannelInfoList chanlist;
-    QMap<QString, QList<ProgInfo> > proglist;
+    FillDataXMLTVHandler handler(*this, id);
 
-    if (!xmltv_parser.parseFile(filename, &chanlist, &proglist))
+    if (!xmltv_parser.parseFile(filename, handler))
         return false;
 
-    chan_data.handleChannels(id, &chanlist);
-    if (proglist.count() == 0)
+    if (handler.GetCount() == 0)
     {
         LOG(VB_GENERAL, LOG_INFO, "No programs found in data.");
         endofdata = true;
     }
-    else
-    {
-        prog_data.HandlePrograms(id, proglist);
-    }
     return true;
 }
 
@@ -11,19 +11,38 @@
 
 class ProgInfo;
 class QUrl;
-class QDomElement;
+class QXmlStreamReader;
+
+typedef QMap<QString, QList<ProgInfo> > ProgInfoMap;
+
+/** \class XMLTVHandler
+ *  \brief Receives the data XMLTVParser::parseFile() reads as it goes.
+ *
+ *  HandleChannels() is called once, before any programmes are handed
+ *  over.  HandlePrograms() is called with batches of programmes keyed by
+ *  xmltvid, and may be called more than once for the same channel.
+ */
+class XMLTVHandler
+{
+  public:
+    virtual ~XMLTVHandler() {}
+    virtual void HandleChannels(ChannelInfoList &chanlist) = 0;
+    virtual void HandlePrograms(ProgInfoMap &proglist) = 0;
+};
 
 class XMLTVParser
 {
   public:
     XMLTVParser();
 
-    ChannelInfo *parseChannel(QDomElement &element, QUrl &baseUrl);
-    ProgInfo *parseProgram(QDomElement &element);
-    bool parseFile(QString filename, ChannelInfoList *chanlist,
-                   QMap<QString, QList<ProgInfo> > *proglist);
+    ChannelInfo *parseChannel(QXmlStreamReader &xml, QUrl &baseUrl);
+    ProgInfo *parseProgram(QXmlStreamReader &xml);
+    bool parseFile(QString filename, XMLTVHandler &handler);
 
   private:
+    void FlushPrograms(XMLTVHandler &handler, ProgInfoMap &pending,
+                       uint &pendingCount, bool keepLast);
+
     unsigned int current_year;
 };
 
@@ -157,7 +157,8 @@ GalleryThumbView::GalleryThumbView(MythScreenStack *parent, const char *name)
       // This screen uses a single fixed view (Parent dir, ordered dirs, ordered images)
       m_view(new DirectoryView(kOrdered)),
       m_infoList(*this),
-      m_scanProgress(),         m_scanActive(),         m_menuState(),
+      m_scanProgress(),         m_scanRate(),
+      m_scanActive(),           m_menuState(),
       m_pendingMap(),           m_thumbExists(),
       // Start in edit mode unless a password exists
       m_editsAllowed(gCoreContext->GetSetting("GalleryPassword").isEmpty())
@@ -446,10 +447,11 @@ void GalleryThumbView::customEvent(QEvent *event)
             // Refresh display
             LoadData(m_view->GetParentId());
         }
-        else if (token[0] == "IMAGE_SCAN_STATUS" && extra.size() == 3)
+        else if (token[0] == "IMAGE_SCAN_STATUS" && extra.size() >= 3)
         {
-            // Expects scanner id, scanned#, total#
-            UpdateScanProgress(extra[0], extra[1].toInt(), extra[2].toInt());
+            // Expects scanner id, scanned#, total#, optional images/sec
+            UpdateScanProgress(extra[0], extra[1].toInt(), extra[2].toInt(),
+                               extra.size() > 3 ? extra[3].toDouble() : 0.0);
         }
     }
     else if (event->type() == DialogCompletionEvent::kEventType)
@@ -585,11 +587,12 @@ void GalleryThumbView::RemoveImages(const QStringList &ids, bool deleted)
 void GalleryThumbView::Start()
 {
     // Detect any running BE scans
-    // Expects OK, scanner id, current#, total#
+    // Expects OK, scanner id, current#, total#, optional images/sec, duration
     QStringList message = m_mgr.ScanQuery();
-    if (message.size() == 4 && message[0] == "OK")
+    if (message.size() >= 4 && message[0] == "OK")
     {
-        UpdateScanProgress(message[1], message[2].toInt(), message[3].toInt());
+        UpdateScanProgress(message[1], message[2].toInt(), message[3].toInt(),
+                           message.size() > 4 ? message[4].toDouble() : 0.0);
     }
 
     // Only receive events after device/scan status has been established
@@ -841,12 +844,14 @@ void GalleryThumbView::UpdateThumbnail(MythUIButtonListItem *button,
  \param scanner Scanner id
  \param current Number of images scanned
  \param total Total number of images to scan
+ \param rate Images processed per second, 0 if not reported
 */
 void GalleryThumbView::UpdateScanProgress(const QString &scanner,
-                                          int current, int total)
+                                          int current, int total, double rate)
 {
     // Scan update
     m_scanProgress.insert(scanner, qMakePair(current, total));
+    m_scanRate.insert(scanner, rate);
 
     // Detect end of this scan
     if (current >= total)
@@ -856,6 +861,7 @@ void GalleryThumbView::UpdateScanProgress(const QString &scanner,
 
         // Mark inactive scanner
         m_scanActive.remove(scanner);
+        m_scanRate.remove(scanner);
 
         // Detect end of last scan
         if (m_scanActive.isEmpty())
@@ -872,6 +878,7 @@ void GalleryThumbView::UpdateScanProgress(const QString &scanner,
             }
 
             m_scanProgress.clear();
+            m_scanRate.clear();
 
             return;
         }
@@ -914,8 +921,21 @@ void GalleryThumbView::UpdateScanProgress(const QString &scanner,
         m_scanProgressBar->SetUsed(currentAgg);
         m_scanProgressBar->SetTotal(totalAgg);
     }
+    double rateAgg = 0.0;
+    foreach (double scanRate, m_scanRate.values())
+        rateAgg += scanRate;
+
     if (m_scanProgressText)
-        m_scanProgressText->SetText(tr("%L1 of %L3").arg(currentAgg).arg(totalAgg));
+    {
+        if (rateAgg > 0.0)
+            m_scanProgressText->SetText(tr("%L1 of %L3 (%L2/sec)")
+                                        .arg(currentAgg)
+                                        .arg(rateAgg, 0, 'f', 1)
+                                        .arg(totalAgg));
+        else
+            m_scanProgressText->SetText(tr("%L1 of %L3")
+                                        .arg(currentAgg).arg(totalAgg));
+    }
 }
 
 
@@ -43,7 +43,7 @@ private:
     void    TransformItem(ImageFileTransform tran = kRotateCW);
     void    TransformMarked(ImageFileTransform tran = kRotateCW);
     void    UpdateImageItem(MythUIButtonListItem *);
-    void    UpdateScanProgress(const QString &, int, int);
+    void    UpdateScanProgress(const QString &, int, int, double rate = 0.0);
     void    StartSlideshow(ImageSlideShowType mode);
     void    SelectZoomWidget(int change);
     QString CheckThumbnail(MythUIButtonListItem *, ImagePtrK,
@@ -133,6 +133,8 @@ private:
 
     //! Last scan updates received from scanners
     QHash<QString, IntPair> m_scanProgress;
+    //! Last rates (images/sec) received from scanners that report one
+    QHash<QString, double> m_scanRate;
     //! Scanners currently scanning
     QSet<QString>          m_scanActive;
 
@@ -0,0 +1,289 @@
+// -*- Mode: c++ -*-
+// vim:set sw=4 ts=4 expandtab:
+// Distributed as part of MythTV under GPL version 2
+// (or at your option a later version)
+
+// C++ headers
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+// MythTV headers
+#include "guidedatacache.h"
+#include "mythdbcon.h"
+#include "mythdate.h"
+#include "mythlogging.h"
+
+#define LOC QString("GuideDataCache: ")
+
+GuideDataCache::GuideDataCache() : m_useCount(0)
+{
+}
+
+GuideDataCache::~GuideDataCache()
+{
+    Clear();
+}
+
+void GuideDataCache::GetPrograms(const QVector<uint> &chanids,
+                                 const QDateTime &start, const QDateTime &end,
+                                 const ProgramList &schedList,
+                                 QVector<ProgramList*> &proglists)
+{
+    QMutexLocker locker(&m_lock);
+
+    QVector<uint> needed;
+    for (int i = 0; i < chanids.size(); ++i)
+    {
+        if (!proglists[i])
+            needed.push_back(chanids[i]);
+    }
+    Load(needed, start, end, schedList);
+
+    const int64_t first = BlockOf(start);
+    const int64_t last  = BlockOf(end);
+
+    for (int i = 0; i < chanids.size(); ++i)
+    {
+        if (proglists[i])
+            continue;
+
+        ProgramList *proglist = new ProgramList();
+        for (int64_t b = first; b <= last; ++b)
+        {
+            Block *block = m_blocks.value(BlockKey(chanids[i], b));
+            if (!block)
+                continue;
+            block->m_lastUsed = ++m_useCount;
+
+            // Programs that started in an earlier block were taken
+            // from that block already
+            QDateTime blockStart = BlockStart(b);
+            ProgramList::const_iterator it = block->m_programs.begin();
+            for (; it != block->m_programs.end(); ++it)
+            {
+                const ProgramInfo *pginfo = *it;
+                if (b > first && pginfo->GetScheduledStartTime() < blockStart)
+                    continue;
+                if (pginfo->GetScheduledEndTime() < start ||
+                    pginfo->GetScheduledStartTime() > end)
+                    continue;
+                proglist->push_back(new ProgramInfo(*pginfo));
+            }
+        }
+        proglists[i] = proglist;
+    }
+
+    Expire();
+}
+
+void GuideDataCache::Prefetch(const QVector<uint> &chanids,
+                              const QDateTime &start, const QDateTime &end,
+                              const ProgramList &schedList)
+{
+    QMutexLocker locker(&m_lock);
+    Load(chanids, start, end, schedList);
+    Expire();
+}
+
+uint GuideDataCache::UpdateSchedule(const ProgramList &schedList)
+{
+    QMap<uint,QStringList> schedule;
+    ProgramList::const_iterator it = schedList.begin();
+    for (; it != schedList.end(); ++it)
+    {
+        const ProgramInfo *pginfo = *it;
+        schedule[pginfo->GetChanID()] << QString("%1 %2 %3 %4")
+            .arg(pginfo->GetScheduledStartTime(MythDate::ISODate))
+            .arg(pginfo->GetRecordingStatus())
+            .arg(pginfo->GetRecordingRuleType())
+            .arg(pginfo->GetRecordingRuleID());
+    }
+
+    QMap<uint,QStringList>::iterator sit = schedule.begin();
+    for (; sit != schedule.end(); ++sit)
+        (*sit).sort();
+
+    QMutexLocker locker(&m_lock);
+
+    QList<uint> chanids = m_schedule.keys() + schedule.keys();
+    sort(chanids.begin(), chanids.end());
+    chanids.erase(unique(chanids.begin(), chanids.end()), chanids.end());
+
+    uint dropped = 0;
+    QList<uint>::const_iterator cit = chanids.begin();
+    for (; cit != chanids.end(); ++cit)
+    {
+        if (m_schedule.value(*cit) != schedule.value(*cit))
+        {
+            Invalidate(*cit);
+            ++dropped;
+        }
+    }
+    m_schedule = schedule;
+
+    LOG(VB_GUI, LOG_DEBUG, LOC +
+        QString("Schedule changed on %1 channels").arg(dropped));
+
+    return dropped;
+}
+
+void GuideDataCache::Clear(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    Blocks::iterator it = m_blocks.begin();
+    for (; it != m_blocks.end(); ++it)
+        delete *it;
+    m_blocks.clear();
+    m_schedule.clear();
+}
+
+/** \brief Loads the blocks covering start to end which are missing or
+ *         stale for any of "chanids", with one query.
+ *
+ *   The query covers every block from the first to the last one missing,
+ *   for every channel missing any, so a guide page costs one round trip
+ *   whichever of its blocks are cached.
+ */
+void GuideDataCache::Load(const QVector<uint> &chanids,
+                          const QDateTime &start, const QDateTime &end,
+                          const ProgramList &schedList)
+{
+    const QDateTime now = MythDate::current();
+    const int64_t first = BlockOf(start);
+    const int64_t last  = BlockOf(end);
+
+    QStringList ids;
+    QVector<uint> missing;
+    int64_t lo = last + 1;
+    int64_t hi = first - 1;
+
+    for (int i = 0; i < chanids.size(); ++i)
+    {
+        bool chanMissing = false;
+        for (int64_t b = first; b <= last; ++b)
+        {
+            Block *block = m_blocks.value(BlockKey(chanids[i], b));
+            if (block && block->m_loaded.secsTo(now) < kMaxBlockAge)
+                continue;
+            lo = min(lo, b);
+            hi = max(hi, b);
+            chanMissing = true;
+        }
+        if (chanMissing && !missing.contains(chanids[i]))
+        {
+            missing.push_back(chanids[i]);
+            ids << QString::number(chanids[i]);
+        }
+    }
+
+    if (missing.empty())
+        return;
+
+    QString where = QString(
+        "program.chanid IN (%1) "
+        "  AND program.endtime >= :STARTTS "
+        "  AND program.starttime < :ENDTS "
+        "  AND program.starttime >= :STARTLIMITTS "
+        "  AND program.manualid = 0 ").arg(ids.join(","));
+    MSqlBindings bindings;
+    bindings[":STARTTS"] = BlockStart(lo);
+    bindings[":ENDTS"] = BlockStart(hi + 1);
+    bindings[":STARTLIMITTS"] = BlockStart(lo).addDays(-1);
+
+    ProgramList loaded;
+    if (!LoadFromProgram(loaded, where,
+                         "program.chanid, program.starttime, program.title",
+                         "program.chanid, program.starttime",
+                         bindings, schedList))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to load guide data");
+        return;
+    }
+
+    LOG(VB_GUI, LOG_DEBUG, LOC +
+        QString("Loaded %1 programs on %2 channels from %3 to %4")
+        .arg(loaded.size()).arg(missing.size())
+        .arg(BlockStart(lo).toString(Qt::ISODate))
+        .arg(BlockStart(hi + 1).toString(Qt::ISODate)));
+
+    for (int i = 0; i < missing.size(); ++i)
+    {
+        for (int64_t b = lo; b <= hi; ++b)
+        {
+            Block *&block = m_blocks[BlockKey(missing[i], b)];
+            delete block;
+            block = new Block();
+            block->m_loaded = now;
+            block->m_lastUsed = m_useCount;
+        }
+    }
+
+    // A program goes in every block it overlaps
+    ProgramList::const_iterator it = loaded.begin();
+    for (; it != loaded.end(); ++it)
+    {
+        const ProgramInfo *pginfo = *it;
+        int64_t b0 = max(lo, BlockOf(pginfo->GetScheduledStartTime()));
+        int64_t b1 = min(hi, BlockOf(pginfo->GetScheduledEndTime()));
+        for (int64_t b = b0; b <= b1; ++b)
+        {
+            Block *block = m_blocks.value(BlockKey(pginfo->GetChanID(), b));
+            if (block)
+                block->m_programs.push_back(new ProgramInfo(*pginfo));
+        }
+    }
+}
+
+void GuideDataCache::Invalidate(uint chanid)
+{
+    Blocks::iterator it = m_blocks.lowerBound(BlockKey(chanid, 0));
+    while (it != m_blocks.end() && it.key().first == chanid)
+    {
+        delete *it;
+        it = m_blocks.erase(it);
+    }
+}
+
+/// Drops the least recently used quarter of the blocks once there are
+/// more than kMaxBlocks.
+void GuideDataCache::Expire(void)
+{
+    if ((uint)m_blocks.size() <= kMaxBlocks)
+        return;
+
+    vector<uint64_t> used;
+    used.reserve(m_blocks.size());
+    Blocks::const_iterator cit = m_blocks.begin();
+    for (; cit != m_blocks.end(); ++cit)
+        used.push_back((*cit)->m_lastUsed);
+
+    vector<uint64_t>::iterator nth = used.begin() + used.size() / 4;
+    nth_element(used.begin(), nth, used.end());
+    uint64_t cutoff = *nth;
+
+    Blocks::iterator it = m_blocks.begin();
+    while (it != m_blocks.end())
+    {
+        if ((*it)->m_lastUsed <= cutoff)
+        {
+            delete *it;
+            it = m_blocks.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+int64_t GuideDataCache::BlockOf(const QDateTime &time)
+{
+    return time.toTime_t() / kBlockSecs;
+}
+
+QDateTime GuideDataCache::BlockStart(int64_t block)
+{
+    return MythDate::fromTime_t(block * kBlockSecs);
+}
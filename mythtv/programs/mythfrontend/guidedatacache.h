@@ -0,0 +1,97 @@
+// -*- Mode: c++ -*-
+// vim:set sw=4 ts=4 expandtab:
+#ifndef _GUIDE_DATA_CACHE_H_
+#define _GUIDE_DATA_CACHE_H_
+
+// ANSI C headers
+#include <stdint.h>
+
+// Qt headers
+#include <QStringList>
+#include <QDateTime>
+#include <QVector>
+#include <QMutex>
+#include <QPair>
+#include <QMap>
+
+// MythTV headers
+#include "programinfo.h"
+
+/** \brief Caches program guide listings by channel and time block.
+ *
+ *  Listings are kept in blocks of kBlockSecs per channel, so a guide
+ *  page scrolled sideways or up and down mostly finds its listings here
+ *  already. The blocks a request is missing are loaded for all of its
+ *  channels with a single query, and Prefetch() lets a background
+ *  thread load the pages next to the one shown before they are needed.
+ *
+ *  Blocks are reloaded after kMaxBlockAge seconds so new listings show
+ *  up, and the least recently used are dropped past kMaxBlocks.
+ */
+class GuideDataCache
+{
+  public:
+    GuideDataCache();
+    ~GuideDataCache();
+
+    /** \brief Sets "proglists[i]" to a new list of copies of the programs
+     *         on chanids[i] which overlap start to end, for every NULL
+     *         entry of "proglists".
+     *
+     *   The caller owns the new lists.
+     *  \param schedList Gives the recording status of loaded programs
+     */
+    void GetPrograms(const QVector<uint> &chanids,
+                     const QDateTime &start, const QDateTime &end,
+                     const ProgramList &schedList,
+                     QVector<ProgramList*> &proglists);
+
+    /// Loads the listings GetPrograms() would need if they aren't cached.
+    void Prefetch(const QVector<uint> &chanids,
+                  const QDateTime &start, const QDateTime &end,
+                  const ProgramList &schedList);
+
+    /** \brief Drops the channels whose scheduled recordings differ from
+     *         the last list given, since their programs' recording
+     *         status is out of date.
+     *  \return The number of channels dropped
+     */
+    uint UpdateSchedule(const ProgramList &schedList);
+
+    void Clear(void);
+
+    static const int  kBlockSecs   = 3 * 60 * 60;
+    static const int  kMaxBlockAge = 10 * 60;
+    static const uint kMaxBlocks   = 8192;
+
+  private:
+    typedef QPair<uint,int64_t> BlockKey; // chanid, block number
+
+    class Block
+    {
+      public:
+        Block() : m_lastUsed(0) {}
+        ProgramList m_programs;
+        QDateTime   m_loaded;
+        uint64_t    m_lastUsed;
+    };
+    typedef QMap<BlockKey,Block*> Blocks;
+
+    void Load(const QVector<uint> &chanids,
+              const QDateTime &start, const QDateTime &end,
+              const ProgramList &schedList);
+    void Invalidate(uint chanid);
+    void Expire(void);
+
+    static int64_t   BlockOf(const QDateTime &time);
+    static QDateTime BlockStart(int64_t block);
+
+  private:
+    QMutex              m_lock;
+    Blocks              m_blocks;
+    uint64_t            m_useCount;
+    /// Scheduled recordings on each channel, as of the last UpdateSchedule()
+    QMap<uint,QStringList> m_schedule;
+};
+
+#endif // _GUIDE_DATA_CACHE_H_
@@ -287,12 +287,11 @@ public:
             return false;
         }
 
+        m_guide->getProgramLists(m_channums, m_currentStartTime,
+                                 m_currentEndTime, m_proglists);
         for (unsigned int i = 0; i < m_numRows; ++i)
         {
             unsigned int row = i + m_firstRow;
-            if (!m_proglists[i])
-                m_proglists[i] =
-                    m_guide->getProgramListFromProgram(m_channums[i]);
             fillProgramRowInfosWith(row, m_channums[i],
                                     m_currentStartTime,
                                     m_proglists[i]);
@@ -355,6 +354,38 @@ public:
     QVector<bool> m_unavailables;
 };
 
+// Loads the guide data for the pages around the one shown into the
+// cache, so that scrolling to them doesn't wait for the database.
+class GuidePrefetch : public GuideUpdaterBase
+{
+public:
+    GuidePrefetch(GuideGrid *guide, uint startChan,
+                  const QDateTime &startTime, const QDateTime &endTime,
+                  const QVector<uint> &pageChanids,
+                  const QVector<uint> &nearChanids)
+        : GuideUpdaterBase(guide), m_currentStartChannel(startChan),
+          m_currentStartTime(startTime), m_currentEndTime(endTime),
+          m_pageChanids(pageChanids), m_nearChanids(nearChanids) {}
+    virtual bool ExecuteNonUI(void)
+    {
+        // The pages around the new position get their own prefetch
+        if (m_currentStartChannel == m_guide->GetCurrentStartChannel() &&
+            m_currentStartTime == m_guide->GetCurrentStartTime())
+        {
+            m_guide->prefetchPrograms(m_pageChanids, m_nearChanids,
+                                      m_currentStartTime, m_currentEndTime);
+        }
+        return false;
+    }
+    virtual void ExecuteUI(void) {}
+
+    const uint m_currentStartChannel;
+    const QDateTime m_currentStartTime;
+    const QDateTime m_currentEndTime;
+    const QVector<uint> m_pageChanids;
+    const QVector<uint> m_nearChanids;
+};
+
 class UpdateGuideEvent : public QEvent
 {
 public:
@@ -602,12 +633,15 @@ bool GuideGrid::Create()
 void GuideGrid::Load(void)
 {
     LoadFromScheduler(m_recList);
+    m_guideData.UpdateSchedule(m_recList);
     fillChannelInfos();
 
     int maxchannel = max((int)GetChannelCount() - 1, 0);
     setStartChannel((int)(m_currentStartChannel) - (int)(m_channelCount / 2));
     m_channelCount = min(m_channelCount, maxchannel + 1);
 
+    QVector<int> rows;
+    QVector<int> chanNums;
     for (int y = 0; y < m_channelCount; ++y)
     {
         int chanNum = y + m_currentStartChannel;
@@ -619,8 +653,17 @@ void GuideGrid::Load(void)
         if (chanNum < 0)
             chanNum = 0;
 
-        delete m_programs[y];
-        m_programs[y] = getProgramListFromProgram(chanNum);
+        rows.push_back(y);
+        chanNums.push_back(chanNum);
+    }
+
+    QVector<ProgramList*> proglists(chanNums.size(), NULL);
+    getProgramLists(chanNums, m_currentStartTime, m_currentEndTime,
+                    proglists);
+    for (int i = 0; i < rows.size(); ++i)
+    {
+        delete m_programs[rows[i]];
+        m_programs[rows[i]] = proglists[i];
     }
 }
 
@@ -1549,28 +1592,55 @@ void GuideGrid::fillProgramInfos(bool useExistingData)
     fillProgramRowInfos(-1, useExistingData);
 }
 
-ProgramList *GuideGrid::getProgramListFromProgram(int chanNum)
+/// Sets each NULL entry of proglists to the programs on the channel at
+/// the same index of chanNums, loading all the rows with one query.
+void GuideGrid::getProgramLists(const QVector<int> &chanNums,
+                                const QDateTime &start, const QDateTime &end,
+                                QVector<ProgramList*> &proglists)
 {
-    ProgramList *proglist = new ProgramList();
+    QVector<uint> chanids;
+    for (int i = 0; i < chanNums.size(); ++i)
+        chanids.push_back(GetChannelInfo(chanNums[i])->chanid);
 
-    if (proglist)
-    {
-        MSqlBindings bindings;
-        QString querystr = "WHERE program.chanid = :CHANID "
-                           "  AND program.endtime >= :STARTTS "
-                           "  AND program.starttime <= :ENDTS "
-                           "  AND program.starttime >= :STARTLIMITTS "
-                           "  AND program.manualid = 0 ";
-        QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
-        bindings[":CHANID"]  = GetChannelInfo(chanNum)->chanid;
-        bindings[":STARTTS"] = starttime;
-        bindings[":STARTLIMITTS"] = starttime.addDays(-1);
-        bindings[":ENDTS"] = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+    QDateTime starttime = start.addSecs(0 - start.time().second());
+    QDateTime endtime = end.addSecs(0 - end.time().second());
+    m_guideData.GetPrograms(chanids, starttime, endtime, m_recList, proglists);
+}
 
-        LoadFromProgram(*proglist, querystr, bindings, m_recList);
-    }
+void GuideGrid::prefetchPrograms(const QVector<uint> &pageChanids,
+                                 const QVector<uint> &nearChanids,
+                                 const QDateTime &start, const QDateTime &end)
+{
+    QDateTime starttime = start.addSecs(0 - start.time().second());
+    QDateTime endtime = end.addSecs(0 - end.time().second());
+    int span = starttime.secsTo(endtime);
 
-    return proglist;
+    // The pages above and below, then those before and after
+    m_guideData.Prefetch(nearChanids, starttime, endtime, m_recList);
+    m_guideData.Prefetch(pageChanids, endtime, endtime.addSecs(span),
+                         m_recList);
+    m_guideData.Prefetch(pageChanids, starttime.addSecs(-span), starttime,
+                         m_recList);
+}
+
+/// Returns the chanids of "count" rows from "firstChan", wrapping round
+/// the channel list, but never the same channel twice.
+QVector<uint> GuideGrid::GetChanIDs(int firstChan, int count) const
+{
+    QVector<uint> chanids;
+    int total = GetChannelCount();
+    if (!total)
+        return chanids;
+
+    count = min(count, total);
+    for (int i = 0; i < count; ++i)
+    {
+        int idx = ((firstChan + i) % total + total) % total;
+        const ChannelInfo *chinfo = GetChannelInfo(idx);
+        if (chinfo)
+            chanids.push_back(chinfo->chanid);
+    }
+    return chanids;
 }
 
 void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
@@ -1638,6 +1708,20 @@ void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
     GuideUpdateProgramRow *updater =
         new GuideUpdateProgramRow(this, gs, proglists);
     m_threadPool.start(new GuideHelper(this, updater), "GuideHelper");
+
+    if (allRows)
+    {
+        // Queued behind any page the user moves to meanwhile
+        int pageRows = m_channelCount;
+        QVector<uint> nearChanids =
+            GetChanIDs((int)m_currentStartChannel - pageRows, pageRows);
+        nearChanids += GetChanIDs(m_currentStartChannel + pageRows, pageRows);
+        GuidePrefetch *prefetch = new GuidePrefetch(
+            this, m_currentStartChannel, m_currentStartTime, m_currentEndTime,
+            GetChanIDs(m_currentStartChannel, pageRows), nearChanids);
+        m_threadPool.start(new GuideHelper(this, prefetch),
+                           "GuidePrefetch", 1);
+    }
 }
 
 void GuideUpdateProgramRow::fillProgramRowInfosWith(int row, int chanNum,
@@ -1885,6 +1969,8 @@ void GuideGrid::customEvent(QEvent *event)
         {
             GuideHelper::Wait(this);
             LoadFromScheduler(m_recList);
+            // Only the rows whose recordings changed need reloading
+            m_guideData.UpdateSchedule(m_recList);
             fillProgramInfos();
         }
         else if (message == "STOP_VIDEO_REFRESH_TIMER")
@@ -2277,6 +2363,7 @@ void GuideGrid::generateListings()
     m_channelCount = min(m_guideGrid->getChannelCount(), maxchannel + 1);
 
     LoadFromScheduler(m_recList);
+    m_guideData.UpdateSchedule(m_recList);
     fillProgramInfos();
 }
 
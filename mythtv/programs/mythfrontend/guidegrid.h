@@ -23,6 +23,7 @@ using namespace std;
 
 // mythfrontend
 #include "schedulecommon.h"
+#include "guidedatacache.h"
 
 using namespace std;
 
@@ -210,7 +211,12 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
     void fillProgramRowInfos(int row, bool useExistingData);
 public:
     // These need to be public so that the helper classes can operate.
-    ProgramList *getProgramListFromProgram(int chanNum);
+    void getProgramLists(const QVector<int> &chanNums,
+                         const QDateTime &start, const QDateTime &end,
+                         QVector<ProgramList*> &proglists);
+    void prefetchPrograms(const QVector<uint> &pageChanids,
+                          const QVector<uint> &nearChanids,
+                          const QDateTime &start, const QDateTime &end);
     void updateProgramsUI(unsigned int firstRow, unsigned int numRows,
                           int progPast,
                           const QVector<ProgramList*> &proglists,
@@ -228,6 +234,7 @@ private:
     const ChannelInfo *GetChannelInfo(uint chan_idx, int sel = -1) const;
     uint                 GetChannelCount(void) const;
     int                  GetStartChannelOffset(int row = -1) const;
+    QVector<uint>        GetChanIDs(int firstChan, int count) const;
 
     ProgramList GetProgramList(uint chanid) const;
     uint GetAlternateChannelIndex(uint chan_idx, bool with_same_channum) const;
@@ -243,6 +250,7 @@ private:
     vector<ProgramList*> m_programs;
     ProgInfoGuideArray m_programInfos;
     ProgramList  m_recList;
+    GuideDataCache m_guideData;
 
     QDateTime m_originalStartTime;
     QDateTime m_currentStartTime;
@@ -581,7 +581,8 @@ bool PlaybackBox::Create()
 
 void PlaybackBox::Load(void)
 {
-    m_programInfoCache.WaitForLoadToComplete();
+    // The list saved on the last run is shown while the changes load
+    m_programInfoCache.WaitForList();
     PreviewGeneratorQueue::AddListener(this);
 }
 
@@ -4082,6 +4083,10 @@ void PlaybackBox::customEvent(QEvent *event)
         {
             UpdateUsageUI();
         }
+        else if (message == "FREE_SPACE_LIST")
+        {
+            m_helper.ForceFreeSpaceUpdate(me->ExtraDataList());
+        }
         else if (message == "RECONNECT_SUCCESS")
         {
             m_programInfoCache.ScheduleLoad();
@@ -36,7 +36,7 @@ class PBHEventHandler : public QObject
         StorageGroup::ClearGroupToUseCache();
     }
     virtual bool event(QEvent*); // QObject
-    void UpdateFreeSpaceEvent(void);
+    void UpdateFreeSpaceEvent(const QStringList &freespace = QStringList());
     AvailableStatusType CheckAvailability(const QStringList &slist);
     PlaybackBoxHelper &m_pbh;
     int m_freeSpaceTimerId;
@@ -159,7 +159,7 @@ bool PBHEventHandler::event(QEvent *e)
         MythEvent *me = (MythEvent*)e;
         if (me->Message() == "UPDATE_FREE_SPACE")
         {
-            UpdateFreeSpaceEvent();
+            UpdateFreeSpaceEvent(me->ExtraDataList());
             return true;
         }
         else if (me->Message() == "STOP_RECORDING")
@@ -305,11 +305,11 @@ bool PBHEventHandler::event(QEvent *e)
     return QObject::event(e);
 }
 
-void PBHEventHandler::UpdateFreeSpaceEvent(void)
+void PBHEventHandler::UpdateFreeSpaceEvent(const QStringList &freespace)
 {
     if (m_freeSpaceTimerId)
         killTimer(m_freeSpaceTimerId);
-    m_pbh.UpdateFreeSpace();
+    m_pbh.UpdateFreeSpace(freespace);
     m_freeSpaceTimerId = startTimer(kUpdateFreeSpaceInterval);
 }
 
@@ -323,8 +323,8 @@ PlaybackBoxHelper::PlaybackBoxHelper(QObject *listener) :
 {
     start();
     m_eventHandler->moveToThread(qthread());
-    // Prime the pump so the disk free display starts updating
-    ForceFreeSpaceUpdate();
+    // The disk free display starts updating once the listener passes on
+    // the free space its ProgramInfoCache fetched with the recordings
 }
 
 PlaybackBoxHelper::~PlaybackBoxHelper()
@@ -337,10 +337,14 @@ PlaybackBoxHelper::~PlaybackBoxHelper()
     m_eventHandler = NULL;
 }
 
-void PlaybackBoxHelper::ForceFreeSpaceUpdate(void)
+/** \brief Updates the free space now, and every 15 seconds after that
+ *  \param freespace A QUERY_FREE_SPACE_LIST reply already fetched, or
+ *                   empty to fetch it
+ */
+void PlaybackBoxHelper::ForceFreeSpaceUpdate(const QStringList &freespace)
 {
     QCoreApplication::postEvent(
-        m_eventHandler, new MythEvent("UPDATE_FREE_SPACE"));
+        m_eventHandler, new MythEvent("UPDATE_FREE_SPACE", freespace));
 }
 
 void PlaybackBoxHelper::StopRecording(const ProgramInfo &pginfo)
@@ -375,9 +379,19 @@ void PlaybackBoxHelper::UndeleteRecording(uint recordingID)
     QCoreApplication::postEvent(m_eventHandler, e);
 }
 
-void PlaybackBoxHelper::UpdateFreeSpace(void)
+void PlaybackBoxHelper::UpdateFreeSpace(const QStringList &freespace)
 {
-    QList<FileSystemInfo> fsInfos = FileSystemInfo::RemoteGetInfo();
+    QList<FileSystemInfo> fsInfos;
+    if (freespace.empty())
+    {
+        fsInfos = FileSystemInfo::RemoteGetInfo();
+    }
+    else
+    {
+        QStringList::const_iterator it = freespace.begin();
+        for (int i = 0; i < freespace.size() / NUMDISKINFOLINES; i++)
+            fsInfos.append(FileSystemInfo(it, freespace.end()));
+    }
 
     QMutexLocker locker(&m_lock);
     for (int i = 0; i < fsInfos.size(); i++)
@@ -34,7 +34,7 @@ class PlaybackBoxHelper : public MThread
     explicit PlaybackBoxHelper(QObject *listener);
     ~PlaybackBoxHelper(void);
 
-    void ForceFreeSpaceUpdate(void);
+    void ForceFreeSpaceUpdate(const QStringList &freespace = QStringList());
     void StopRecording(const ProgramInfo&);
     void DeleteRecording( uint recordingID, bool forceDelete,
                           bool forgetHistory);
@@ -52,7 +52,7 @@ class PlaybackBoxHelper : public MThread
     uint64_t GetFreeSpaceUsedMB(void) const;
 
   private:
-    void UpdateFreeSpace(void);
+    void UpdateFreeSpace(const QStringList &freespace);
 
   private:
     QObject            *m_listener;
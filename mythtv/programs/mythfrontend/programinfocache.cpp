@@ -10,12 +10,25 @@
 #include "programinfo.h"
 #include "remoteutil.h"
 #include "mythevent.h"
+#include "mythcorecontext.h"
+#include "mythversion.h"
+#include "mythdirs.h"
 
 #include <QCoreApplication>
+#include <QDataStream>
+#include <QSet>
 #include <QRunnable>
+#include <QFile>
+#include <QDir>
 
 #include <algorithm>
 
+#define LOC QString("ProgramInfoCache: ")
+
+// Snapshot file identification, "PICS" and the layout version
+static const quint32 kSnapshotMagic   = 0x50494353;
+static const quint32 kSnapshotVersion = 1;
+
 typedef vector<ProgramInfo*> *VPI_ptr;
 static void free_vec(VPI_ptr &v)
 {
@@ -46,7 +59,8 @@ class ProgramInfoLoader : public QRunnable
 
 ProgramInfoCache::ProgramInfoCache(QObject *o) :
     m_next_cache(NULL), m_listener(o),
-    m_load_is_queued(false), m_loads_in_progress(0)
+    m_load_is_queued(false), m_loads_in_progress(0),
+    m_sync_token("0"), m_snapshot_loaded(false), m_free_space_sent(false)
 {
 }
 
@@ -59,6 +73,10 @@ ProgramInfoCache::~ProgramInfoCache()
 
     Clear();
     free_vec(m_next_cache);
+
+    Cache::iterator it = m_synced.begin();
+    for (; it != m_synced.end(); ++it)
+        delete *it;
 }
 
 void ProgramInfoCache::ScheduleLoad(const bool updateUI)
@@ -80,16 +98,50 @@ void ProgramInfoCache::Load(const bool updateUI)
 
     locker.unlock();
     /**/
-    // Get an unsorted list (sort = 0) from RemoteGetRecordedList
-    // we sort the list later anyway.
-    vector<ProgramInfo*> *tmp = RemoteGetRecordedList(0);
+    QMutexLocker sync_locker(&m_sync_lock);
+
+    // Show the recordings as they were when we last ran while the
+    // changes since then are fetched.
+    bool shown = false;
+    if (!m_snapshot_loaded)
+    {
+        m_snapshot_loaded = true;
+        LoadSnapshot();
+        if (!m_synced.empty())
+        {
+            vector<ProgramInfo*> *tmp = CopySynced();
+            locker.relock();
+            free_vec(m_next_cache);
+            m_next_cache = tmp;
+            if (updateUI)
+                QCoreApplication::postEvent(
+                    m_listener, new MythEvent("UPDATE_UI_LIST"));
+            m_load_wait.wakeAll();
+            locker.unlock();
+            shown = true;
+        }
+    }
+
+    vector<ProgramInfo*> *tmp = NULL;
+    if (SyncChanges())
+    {
+        tmp = CopySynced();
+    }
+    else
+    {
+        // Get an unsorted list (sort = 0) from RemoteGetRecordedList
+        // we sort the list later anyway.
+        tmp = RemoteGetRecordedList(0);
+    }
+    sync_locker.unlock();
     /**/
     locker.relock();
 
     free_vec(m_next_cache);
     m_next_cache = tmp;
 
-    if (updateUI)
+    // The snapshot may already be on screen, so it must be replaced
+    if (updateUI || shown)
         QCoreApplication::postEvent(
             m_listener, new MythEvent("UPDATE_UI_LIST"));
 
@@ -97,6 +149,231 @@ void ProgramInfoCache::Load(const bool updateUI)
     m_load_wait.wakeAll();
 }
 
+/** \brief Brings m_synced up to date with the recordings changed since
+ *         m_sync_token, and saves it to the snapshot if any changed.
+ *
+ *  The recorded table's lastmodified column tells the backend what
+ *  changed, and a change to a recording's channel, rule or program
+ *  details gets them all sent again. Whether a recording is being
+ *  recorded or is in use isn't kept there, so those last seen in that
+ *  state are asked for again.
+ *
+ *  The first sync also fetches the free space list in the same round
+ *  trip, and sends it to the listener as a FREE_SPACE_LIST event, empty
+ *  if it couldn't be fetched, so opening the recordings screen doesn't
+ *  take a round trip for each.
+ *
+ *  \note m_sync_lock must be held when this is called.
+ *  \return false if the backend didn't send the changes
+ */
+bool ProgramInfoCache::SyncChanges(void)
+{
+    QList<uint> resend;
+    Cache::const_iterator cit = m_synced.begin();
+    for (; cit != m_synced.end(); ++cit)
+    {
+        const ProgramInfo *pginfo = *cit;
+        if (pginfo->GetRecordingStatus() == RecStatus::Recording ||
+            (pginfo->GetProgramFlags() &
+             (FL_INUSERECORDING | FL_INUSEPLAYING | FL_INUSEOTHER |
+              FL_COMMPROCESSING)))
+        {
+            resend.push_back(cit.key());
+        }
+    }
+
+    QString token = m_sync_token;
+    QList<uint> recordedids;
+    vector<ProgramInfo*> changed;
+    QList<QStringList> batch;
+    if (!m_free_space_sent)
+        batch.push_back(QStringList("QUERY_FREE_SPACE_LIST"));
+
+    bool ok = RemoteGetRecordingChanges(token, resend, recordedids, changed,
+                                        &batch);
+
+    if (!m_free_space_sent)
+    {
+        m_free_space_sent = true;
+        QCoreApplication::postEvent(
+            m_listener, new MythEvent("FREE_SPACE_LIST",
+                                      batch.empty() ? QStringList() :
+                                      batch.front()));
+    }
+
+    if (!ok)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            "Unable to fetch recording changes, fetching all recordings");
+        return false;
+    }
+
+    QSet<uint> current = recordedids.toSet();
+    uint dropped = 0;
+    Cache::iterator it = m_synced.begin();
+    while (it != m_synced.end())
+    {
+        if (current.contains(it.key()))
+        {
+            ++it;
+            continue;
+        }
+        delete *it;
+        it = m_synced.erase(it);
+        dropped++;
+    }
+
+    vector<ProgramInfo*>::iterator vit = changed.begin();
+    for (; vit != changed.end(); ++vit)
+    {
+        uint recordedid = (*vit)->GetRecordingID();
+        if (!recordedid || !(*vit)->GetChanID())
+        {
+            delete *vit;
+            continue;
+        }
+        delete m_synced.value(recordedid);
+        m_synced[recordedid] = *vit;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("Received %1 changed recordings, dropped %2, of %3")
+        .arg(changed.size()).arg(dropped).arg(m_synced.size()));
+
+    m_sync_token = token;
+    if (!changed.empty() || dropped)
+        WriteSnapshot();
+
+    return true;
+}
+
+/// Returns copies of the ProgramInfos in m_synced, for m_next_cache.
+/// \note m_sync_lock must be held when this is called.
+vector<ProgramInfo*> *ProgramInfoCache::CopySynced(void) const
+{
+    vector<ProgramInfo*> *list = new vector<ProgramInfo*>;
+    list->reserve(m_synced.size());
+    Cache::const_iterator it = m_synced.begin();
+    for (; it != m_synced.end(); ++it)
+        list->push_back(new ProgramInfo(**it));
+    return list;
+}
+
+/// The snapshot is only valid for the database it was written from.
+static QString snapshot_source(void)
+{
+    DatabaseParams params = gCoreContext->GetDatabaseParams();
+    return QString("%1:%2/%3").arg(params.dbHostName)
+        .arg(params.dbPort).arg(params.dbName);
+}
+
+QString ProgramInfoCache::SnapshotFilename(void)
+{
+    return GetConfDir() + "/cache/recordings.bin";
+}
+
+/** \brief Reads the recordings and sync token saved by WriteSnapshot().
+ *
+ *  A snapshot which is missing, unreadable, from another database or
+ *  written with another protocol version is ignored, and every
+ *  recording is fetched from the backend instead.
+ *
+ *  \note m_sync_lock must be held when this is called.
+ */
+void ProgramInfoCache::LoadSnapshot(void)
+{
+    QFile file(SnapshotFilename());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic, version, count;
+    QString protocol, source, token;
+    QStringList strlist;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok ||
+        magic != kSnapshotMagic || version != kSnapshotVersion)
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC + "Ignoring unknown snapshot " +
+            file.fileName());
+        return;
+    }
+
+    stream >> protocol >> source >> token >> count >> strlist;
+    if (stream.status() != QDataStream::Ok ||
+        protocol != MYTH_PROTO_VERSION || source != snapshot_source() ||
+        (int)count * NUMPROGRAMLINES != strlist.size())
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC + "Ignoring stale snapshot " +
+            file.fileName());
+        return;
+    }
+
+    QStringList::const_iterator it = strlist.begin();
+    for (quint32 i = 0; i < count; i++)
+    {
+        ProgramInfo *pginfo = new ProgramInfo(it, strlist.end());
+        if (!pginfo->GetRecordingID() || m_synced.contains(
+                pginfo->GetRecordingID()))
+        {
+            delete pginfo;
+            continue;
+        }
+        m_synced[pginfo->GetRecordingID()] = pginfo;
+    }
+    m_sync_token = token;
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("Read %1 recordings from snapshot").arg(m_synced.size()));
+}
+
+/** \brief Saves m_synced and m_sync_token, replacing the snapshot.
+ *  \note m_sync_lock must be held when this is called.
+ */
+void ProgramInfoCache::WriteSnapshot(void) const
+{
+    QStringList strlist;
+    Cache::const_iterator it = m_synced.begin();
+    for (; it != m_synced.end(); ++it)
+        (*it)->ToStringList(strlist);
+
+    QString filename = SnapshotFilename();
+    QDir().mkpath(filename.section('/', 0, -2));
+
+    // Write to a temporary file first so a crash leaves the old snapshot
+    QFile file(filename + ".tmp");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to write snapshot " +
+            file.fileName() + ENO);
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << kSnapshotMagic << kSnapshotVersion
+           << QString(MYTH_PROTO_VERSION) << snapshot_source()
+           << m_sync_token << (quint32)m_synced.size() << strlist;
+    bool ok = (stream.status() == QDataStream::Ok);
+    file.close();
+
+    if (ok)
+    {
+        QFile::remove(filename);
+        ok = file.rename(filename);
+    }
+    if (!ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to write snapshot " +
+            filename);
+        file.remove();
+    }
+}
+
 bool ProgramInfoCache::IsLoadInProgress(void) const
 {
     QMutexLocker locker(&m_lock);
@@ -110,6 +387,15 @@ void ProgramInfoCache::WaitForLoadToComplete(void) const
         m_load_wait.wait(&m_lock);
 }
 
+/// Waits until Refresh() has a list to use, which may be the one saved
+/// on the last run, or until no load is in progress.
+void ProgramInfoCache::WaitForList(void) const
+{
+    QMutexLocker locker(&m_lock);
+    while (m_loads_in_progress && !m_next_cache)
+        m_load_wait.wait(&m_lock);
+}
+
 /** \brief Refreshed the cache.
  *
  *  If a new list has been loaded this fills the cache with that list
@@ -30,6 +30,7 @@ class ProgramInfoCache
     void ScheduleLoad(const bool updateUI = true);
     bool IsLoadInProgress(void) const;
     void WaitForLoadToComplete(void) const;
+    void WaitForList(void) const;
 
     // All the following public methods must only be called from the UI Thread.
     void Refresh(void);
@@ -46,6 +47,11 @@ class ProgramInfoCache
   private:
     void Load(const bool updateUI = true);
     void Clear(void);
+    bool SyncChanges(void);
+    vector<ProgramInfo*> *CopySynced(void) const;
+    void LoadSnapshot(void);
+    void WriteSnapshot(void) const;
+    static QString SnapshotFilename(void);
 
   private:
     // NOTE: Hash would be faster for lookups and updates, but we need a sorted
@@ -62,6 +68,14 @@ class ProgramInfoCache
     bool                    m_load_is_queued;
     uint                    m_loads_in_progress;
     mutable QWaitCondition  m_load_wait;
+
+    /// Serializes Load(), and guards the following
+    QMutex                  m_sync_lock;
+    /// The backend's recordings as of m_sync_token
+    Cache                   m_synced;
+    QString                 m_sync_token;
+    bool                    m_snapshot_loaded;
+    bool                    m_free_space_sent;
 };
 
 #endif // _PROGRAM_INFO_CACHE_H_
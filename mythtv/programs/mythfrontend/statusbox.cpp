@@ -819,22 +819,40 @@ void StatusBox::doTunerStatus()
         return;
     }
 
+    // Ask for the state of every tuner in one round trip
+    QList<int> cardids;
+    QStringList cardtypes;
+    QStringList videodevices;
+    QList<QStringList> states;
     while (query.next())
     {
-        int cardid = query.value(0).toInt();
+        cardids.push_back(query.value(0).toInt());
+        cardtypes.push_back(query.value(1).toString());
+        videodevices.push_back(query.value(2).toString());
 
-        QString cmd = QString("QUERY_REMOTEENCODER %1").arg(cardid);
-        QStringList strlist( cmd );
+        QStringList strlist(
+            QString("QUERY_REMOTEENCODER %1").arg(cardids.back()));
         strlist << "GET_STATE";
+        states.push_back(strlist);
+    }
+    if (!states.empty() && !RemoteBatchQuery(states))
+    {
+        QList<QStringList>::iterator it = states.begin();
+        for (; it != states.end(); ++it)
+            gCoreContext->SendReceiveStringList(*it);
+    }
+
+    for (int i = 0; i < cardids.size(); ++i)
+    {
+        int cardid = cardids[i];
 
-        gCoreContext->SendReceiveStringList(strlist);
-        int state = strlist[0].toInt();
+        QStringList strlist;
+        int state = states[i].empty() ? kState_Error : states[i][0].toInt();
 
         QString status;
         QString fontstate;
         if (state == kState_Error)
         {
-            strlist.clear();
             strlist << QString("QUERY_REMOTEENCODER %1").arg(cardid);
             strlist << "GET_SLEEPSTATUS";
 
@@ -860,7 +878,7 @@ void StatusBox::doTunerStatus()
 
         QString tun = tr("Tuner %1 %2 %3");
         QString devlabel = CardUtil::GetDeviceLabel(
-            query.value(1).toString(), query.value(2).toString());
+            cardtypes[i], videodevices[i]);
 
         QString shorttuner = tun.arg(cardid).arg("").arg(status);
         QString longtuner = tun.arg(cardid).arg(devlabel).arg(status);
@@ -24,3 +24,25 @@ using_backend {
 }
 
 using_mythtranscode: SUBDIRS += mythtranscode
+
+# unit tests mythcommflag
+using_frontend {
+    mythcommflag-test.depends = sub-mythcommflag
+    mythcommflag-test.target = buildtestmythcommflag
+    mythcommflag-test.commands = cd mythcommflag/test && $(QMAKE) && $(MAKE)
+    unix:QMAKE_EXTRA_TARGETS += mythcommflag-test
+    unittest.depends += mythcommflag-test
+}
+
+# unit tests mythbackend
+using_backend {
+    mythbackend-test.depends = sub-mythbackend
+    mythbackend-test.target = buildtestmythbackend
+    mythbackend-test.commands = cd mythbackend/test && $(QMAKE) && $(MAKE)
+    unix:QMAKE_EXTRA_TARGETS += mythbackend-test
+    unittest.depends += mythbackend-test
+}
+
+unittest.target = test
+unittest.commands = scripts/unittests.sh
+unix:QMAKE_EXTRA_TARGETS += unittest